@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <ostream>
 #include <string>
 
@@ -10,7 +11,7 @@ namespace r2rml {
 /**
  * Common base for the R2RML mapping-model classes (term maps, predicate-object
  * maps, triples maps). Provides the shared human-readable printing contract
- * plus helpers used when generating RDF terms and writing RDF statements.
+ * plus helpers used when generating RDF terms.
  */
 class AbstractMap {
 public:
@@ -25,9 +26,8 @@ protected:
 	/// Percent-encode a string per RFC 3986 unreserved-character rules
 	/// (encodes all bytes that are not A-Z a-z 0-9 - _ . ~).
 	static std::string percentEncode(const std::string &value);
-
-	/// Throw std::runtime_error if writing an RDF statement via Serd failed.
-	static void checkWriteStatus(SerdStatus status);
+	/// percentEncode() of `n` bytes at `s`, appended to `out`.
+	static void appendPercentEncoded(std::string &out, const char *s, std::size_t n);
 };
 
 } // namespace r2rml
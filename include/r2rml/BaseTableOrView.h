@@ -7,7 +7,9 @@ namespace r2rml {
 
 /**
  * Logical table representing a direct reference to a base table or view
- * (rr:tableName).
+ * (rr:tableName).  A partitioned export splits it on partitionColumn, or on
+ * DuckDB's rowid pseudo-column when none is declared (a view has no rowid,
+ * so without a declared column it is exported whole).
  */
 class BaseTableOrView : public LogicalTable {
 public:
@@ -18,6 +20,8 @@ public:
 	std::unique_ptr<SQLResultSet> getRows(SQLConnection &dbConnection) override;
 
 	std::vector<std::string> getColumnNames() override;
+	std::string selectQuery() const override;
+	std::string partitionKey() const override;
 
 	bool isValid() const override {
 		return !tableName.empty();
@@ -26,6 +30,10 @@ public:
 	std::ostream &print(std::ostream &os) const override;
 
 	std::string tableName;
+
+protected:
+	/** The table itself, so that rowid is visible. */
+	std::string partitionSource() const override;
 };
 
 } // namespace r2rml
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "StatementSink.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <serd/serd.h>
+
+namespace r2rml {
+
+class ConstantPool;
+
+/**
+ * A StatementSink writing a compact binary RDF stream: IRIs are written as
+ * an entry of a prefix table plus the rest, or as an entry of a name table,
+ * so a loader doesn't re-parse the same few hundred namespaces in every
+ * statement.
+ *
+ * The prefix table starts out with the IRI template prefixes of a mapping's
+ * ConstantPool (every IRI an rr:template generates starts with one), plus
+ * any addPrefix() adds; an IRI is split at the longest prefix it starts
+ * with.  The name table holds whole IRIs and language tags that recur by
+ * construction: predicates, datatypes, graphs and the pool's constant
+ * terms.  Entries are defined in the stream just before first use.  A term
+ * equal to the one in the same position of the previous statement is
+ * written as a one-byte repeat.
+ *
+ * Stream layout (integers are unsigned LEB128 varints, strings a varint
+ * length and that many bytes):
+ *
+ *     stream := "SRDF" version:1 record*
+ *     record := 0x01 id string            prefix definition (ids from 1)
+ *             | 0x02 id string            name definition (ids from 1)
+ *             | 0x03 term term term       triple
+ *             | 0x04 term term term term  quad (graph last)
+ *     term   := 0x00                      same as in the previous statement
+ *             | 0x01 name                 IRI from the name table
+ *             | 0x02 prefix string        IRI: prefix (0 = none) + string
+ *             | 0x03 string               blank node label
+ *             | 0x04 string               plain literal
+ *             | 0x05 string name          literal with datatype IRI `name`
+ *             | 0x06 string name          literal with language tag `name`
+ *
+ * Output is buffered and handed to `sink` like NTriplesWriter's.  `env`,
+ * which may be null, expands CURIEs.  Not thread-safe: use one writer per
+ * stream.
+ */
+class BinaryRdfWriter : public StatementSink {
+public:
+	/** Output is buffered up to this many bytes unless told otherwise. */
+	static const std::size_t defaultBufferSize = 1 << 20;
+
+	/** Name table entries past which other IRIs are no longer added. */
+	static const std::size_t maxNames = 1 << 16;
+
+	/** Format version written after the magic bytes. */
+	static const unsigned char version = 1;
+
+	/**
+	 * `constants`, which may be null and must outlive the writer, seeds the
+	 * prefix table and names its terms (normally R2RMLMapping::constants).
+	 */
+	BinaryRdfWriter(const SerdEnv *env, const ConstantPool *constants, SerdSink sink, void *stream,
+	                std::size_t bufferSize = defaultBufferSize);
+
+	/** Flushes, ignoring errors: call flush() to see them. */
+	~BinaryRdfWriter() override;
+
+	BinaryRdfWriter(const BinaryRdfWriter &) = delete;
+	BinaryRdfWriter &operator=(const BinaryRdfWriter &) = delete;
+
+	/** Add `prefix` to the prefix table, if it isn't there already. */
+	void addPrefix(const std::string &prefix);
+
+	void write(const SerdNode *graph, const SerdNode &subject, const SerdNode &predicate, const SerdNode &object,
+	           const SerdNode *datatype, const SerdNode *lang) override;
+
+	/** Hand the buffer to the sink; throws std::runtime_error if it takes less. */
+	void flush() override;
+
+private:
+	enum Position { Subject, Predicate, Object, Graph, Positions };
+
+	/// One encoded term: its tag and whichever of the fields that tag uses.
+	struct Term {
+		unsigned char tag {0xff};
+		std::uint64_t id {0};
+		std::string text;
+		std::uint64_t extra {0};
+
+		bool operator==(const Term &other) const {
+			return tag == other.tag && id == other.id && extra == other.extra && text == other.text;
+		}
+	};
+
+	void encodeResource(const SerdNode &node, bool named, Term &term);
+	void encodeIRI(std::size_t poolIndex, const char *iri, std::size_t size, bool named, Term &term);
+	void encodeLiteral(const SerdNode &node, const SerdNode *datatype, const SerdNode *lang, Term &term);
+	void putTerm(Position position);
+
+	std::size_t poolIndex(const SerdNode &node) const;
+	std::uint64_t nameOf(std::size_t poolIndex, const char *value, std::size_t size, bool force);
+	std::uint64_t longestPrefix(const char *iri, std::size_t size, std::size_t &length) const;
+	void putVarint(std::uint64_t value);
+	void putString(const char *data, std::size_t size);
+
+	const SerdEnv *env_;
+	const ConstantPool *constants_;
+	SerdSink sink_;
+	void *stream_;
+	std::size_t bufferSize_;
+	std::string buffer_;
+
+	/// The prefix table, sorted by prefix, with ids.
+	std::vector<std::pair<std::string, std::uint64_t>> prefixes_;
+	std::unordered_map<std::string, std::uint64_t> names_;
+	/// Name ids of the pool's terms, by ConstantPool::indexOf(); 0 until named.
+	std::vector<std::uint64_t> poolNames_;
+	std::string key_;
+
+	Term current_[Positions];
+	Term previous_[Positions];
+};
+
+} // namespace r2rml
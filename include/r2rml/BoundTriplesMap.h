@@ -0,0 +1,90 @@
+#pragma once
+
+#include "PredicateObjectMap.h"
+#include "StatementSink.h"
+#include "TermBatch.h"
+#include "TermMap.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <serd/serd.h>
+
+namespace r2rml {
+
+class JoinIndexCache;
+class R2RMLMapping;
+class RowBatch;
+class SQLConnection;
+class TriplesMap;
+struct TriplesMapMetrics;
+
+/**
+ * A TriplesMap bound to the schema of one result set.
+ *
+ * TriplesMap::generateTriples(batch, ...) has to find every column its term
+ * maps read by name, and allocate term buffers, for every batch.  A
+ * BoundTriplesMap resolves those columns to RowBatch ordinals the first time
+ * it sees a batch (see TermMap::bindColumns()) and keeps its term buffers
+ * between batches, so for the rest of a getRows() result every column access
+ * is by position.  It re-binds only if a batch arrives with different column
+ * names.
+ *
+ * The TriplesMap and mapping must outlive the BoundTriplesMap.
+ */
+class BoundTriplesMap {
+public:
+	BoundTriplesMap(const TriplesMap &triplesMap, const R2RMLMapping &mapping);
+
+	BoundTriplesMap(const BoundTriplesMap &) = delete;
+	BoundTriplesMap &operator=(const BoundTriplesMap &) = delete;
+
+	/**
+	 * Emit the triples of every row of `batch`; same output, in the same
+	 * order, as TriplesMap::generateTriples(batch, ...).
+	 */
+	void generateTriples(const RowBatch &batch, StatementSink &rdfSink, SQLConnection &dbConnection,
+	                     JoinIndexCache *joinIndexes = nullptr);
+
+	/** As above, writing through a SerdWriter. */
+	void generateTriples(const RowBatch &batch, SerdWriter &rdfWriter, SQLConnection &dbConnection,
+	                     JoinIndexCache *joinIndexes = nullptr);
+
+	/**
+	 * Resolve column ordinals against `batch`'s schema now rather than on
+	 * the first generateTriples() (a no-op if already bound to it).  The
+	 * batch may be empty.
+	 */
+	void bind(const RowBatch &batch);
+
+	/**
+	 * Add what generateTriples() does from now on to `metrics` (null to
+	 * stop): rows, statements, skipped nulls and join probes, and the time
+	 * spent generating terms, probing join indexes and writing statements.
+	 * `metrics` must stay valid while it is set.
+	 */
+	void collectMetrics(TriplesMapMetrics *metrics);
+
+	/** Number of times column ordinals were resolved (once per schema seen). */
+	std::size_t binds() const {
+		return binds_;
+	}
+
+private:
+	const TriplesMap &triplesMap_;
+	const R2RMLMapping &mapping_;
+
+	std::vector<std::string> schema_; ///< column names the ordinals were resolved against
+	std::size_t binds_ {0};
+
+	ColumnOrdinals subjectColumns_;
+	std::vector<ColumnOrdinals> subjectGraphColumns_;
+	TermBatch subjects_;
+	std::vector<TermBatch> subjectGraphs_;
+	std::vector<PredicateObjectMap::BatchTerms> pomTerms_;
+	std::vector<SerdNode> classNodes_;
+	TriplesMapMetrics *metrics_ {nullptr};
+};
+
+} // namespace r2rml
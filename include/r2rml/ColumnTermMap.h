@@ -16,7 +16,18 @@ public:
 
 	SerdNode generateRDFTerm(const SQLRow &row, const SerdEnv &env) const override;
 
+	void generateRDFTerms(const RowBatch &batch, const SerdEnv &env, TermBatch &out) const override;
+	void generateRDFTerms(const RowBatch &batch, const ColumnOrdinals &columns, const SerdEnv &env,
+	                      TermBatch &out) const override;
+
 	std::string computeDatatypeIRI(const SQLRow &row) const override;
+	const std::string &datatypeIRIView(const SQLRow &row) const override;
+	std::string computeDatatypeIRI(const RowBatch &batch) const override;
+	std::string computeDatatypeIRI(const RowBatch &batch, const ColumnOrdinals &columns) const override;
+
+	std::vector<std::string> referencedColumns() const override {
+		return {columnName};
+	}
 
 	bool isValid() const override {
 		// columnName must not be empty
@@ -28,6 +39,8 @@ public:
 	std::string columnName;
 
 private:
+	SerdType nodeType() const;
+
 	/// Buffer for the last column value; keeps buf pointer in returned SerdNode valid.
 	mutable std::string cachedValue_;
 };
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <serd/serd.h>
+
+namespace r2rml {
+
+/**
+ * The constant RDF terms of a mapping, interned once (see
+ * R2RMLMapping::compile()).
+ *
+ * Every distinct (type, value) pair is stored once, and the SerdNode handed
+ * out for it stays valid, at the same address, for the life of the pool
+ * (moves included), so term maps can hold it instead of rebuilding the node
+ * per row.  IRIs and blank nodes whose N-Triples form doesn't depend on an
+ * environment (absolute IRIs, blank node labels) are also kept serialized;
+ * NTriplesWriter recognizes the pool's nodes by address and copies that form
+ * instead of escaping them again.
+ *
+ * The pool also keeps the static leading text of every IRI rr:template,
+ * for writers that encode generated IRIs as a shared prefix plus the rest
+ * (BinaryRdfWriter).
+ *
+ * rdf:type and the XSD datatypes SQL values report are interned up front.
+ * Interning is not thread-safe, lookups are: intern everything before an
+ * export starts.
+ */
+class ConstantPool {
+public:
+	static const std::size_t npos = static_cast<std::size_t>(-1);
+
+	ConstantPool();
+
+	ConstantPool(const ConstantPool &) = delete;
+	ConstantPool &operator=(const ConstantPool &) = delete;
+
+	// moves keep every node's address; a moved-from pool is empty
+	ConstantPool(ConstantPool &&) = default;
+	ConstantPool &operator=(ConstantPool &&) = default;
+
+	/** The pool's node for `n` bytes at `s` as a `type` node, adding it if new. */
+	const SerdNode &intern(SerdType type, const char *s, std::size_t n);
+
+	const SerdNode &intern(SerdType type, const std::string &value) {
+		return intern(type, value.data(), value.size());
+	}
+
+	/** The pool's copy of `node` (whose type and bytes must be set). */
+	const SerdNode &intern(const SerdNode &node) {
+		return intern(node.type, reinterpret_cast<const char *>(node.buf), node.n_bytes);
+	}
+
+	/** The pool's node for `value` as a `type` node, or nullptr if never interned. */
+	const SerdNode *find(SerdType type, const std::string &value) const;
+
+	/**
+	 * The serialized N-Triples form of `node` if it is one of this pool's
+	 * nodes (same buffer, type and length) and has one, else nullptr.
+	 */
+	const std::string *encoded(const SerdNode &node) const;
+
+	/**
+	 * The position, in order of interning, of `node` among the pool's terms
+	 * if it is one of the pool's nodes, else npos.
+	 */
+	std::size_t indexOf(const SerdNode &node) const;
+
+	/** Record `prefix`, the literal text an IRI template starts with. */
+	void addIRIPrefix(const std::string &prefix);
+
+	/** The IRI template prefixes recorded, each once, in order of recording. */
+	const std::vector<std::string> &iriPrefixes() const {
+		return iriPrefixes_;
+	}
+
+	/** The rdf:type IRI. */
+	const SerdNode &rdfType() const {
+		return entries_.front().node;
+	}
+
+	/** Number of distinct terms interned. */
+	std::size_t size() const {
+		return entries_.size();
+	}
+
+private:
+	struct Entry {
+		std::string value;
+		SerdNode node;
+		std::string encoded; ///< empty when the form depends on an environment
+	};
+
+	std::deque<Entry> entries_; // a deque never moves its elements
+	std::unordered_map<std::string, std::size_t> byValue_[SERD_BLANK + 1]; // by SerdType
+	std::unordered_map<const uint8_t *, std::size_t> byBuffer_;
+	std::vector<std::string> iriPrefixes_;
+	std::unordered_set<std::string> iriPrefixSet_;
+};
+
+} // namespace r2rml
@@ -21,6 +21,12 @@ public:
 
 	SerdNode generateRDFTerm(const SQLRow &row, const SerdEnv &env) const override;
 
+	using TermMap::generateRDFTerms;
+	void generateRDFTerms(const RowBatch &batch, const SerdEnv &env, TermBatch &out) const override;
+
+	/** Also replaces constantValue with the pooled node. */
+	void internConstants(ConstantPool &pool) override;
+
 	bool isValid() const override {
 		// constantValue must not be a null SerdNode
 		return constantValue.type != 0;
@@ -31,7 +37,8 @@ public:
 	SerdNode constantValue {nullptr};
 
 private:
-	/// Owns the string data that constantValue.buf points into (when non-empty).
+	/// Owns the string data that constantValue.buf points into (when non-empty
+	/// and not interned).
 	std::string ownedUri_;
 };
 
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "DuplicateFilter.h"
+#include "StatementSink.h"
+
+#include <cstddef>
+#include <string>
+
+namespace r2rml {
+
+/**
+ * StatementSink dropping statements already written, in front of another
+ * sink (ExportOptions::dedup).  Statements are compared whole, graph
+ * included unless the sink behind doesn't write graphs.
+ *
+ * While the DuplicateFilter keeps up within `memoryLimit`, statements are
+ * passed on as they come, nodes untouched, so output is that of the sink
+ * alone minus the repeats.  Statements held back once the limit is reached
+ * are written by flush(), in no particular order; call it at the end.
+ */
+class DedupSink : public StatementSink {
+public:
+	/** `out` must outlive the sink. */
+	DedupSink(StatementSink &out, std::size_t memoryLimit);
+
+	void write(const SerdNode *graph, const SerdNode &subject, const SerdNode &predicate, const SerdNode &object,
+	           const SerdNode *datatype, const SerdNode *lang) override;
+
+	/** Write any statements held back, then flush the sink behind. */
+	void flush() override;
+
+	bool writesGraphs() const override {
+		return graphs_;
+	}
+
+	/** Statements dropped so far. */
+	std::size_t duplicates() const {
+		return filter_.duplicates();
+	}
+
+	/** Sorted runs spilled to temporary files so far. */
+	std::size_t spills() const {
+		return filter_.spills();
+	}
+
+private:
+	void forward(const char *record, std::size_t size);
+
+	StatementSink &out_;
+	bool graphs_;
+	/// The statement being filtered: its nodes' types and bytes.
+	std::string record_;
+	/// Set while write() runs, so a statement let straight through keeps its nodes.
+	const SerdNode *current_[6];
+	bool writing_ {false};
+	/// Node bytes of a statement read back from a spilled run.
+	std::string nodes_[6];
+	DuplicateFilter filter_;
+};
+
+} // namespace r2rml
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace r2rml {
+
+/**
+ * Drops repeated records (serialized statements) from a stream, passing on
+ * the first occurrence of each.  Records are compared by a 128-bit hash of
+ * their bytes, so two different records are taken for duplicates only on a
+ * hash collision.
+ *
+ * While the hashes of everything seen fit in `memoryLimit` bytes each new
+ * record is emitted as soon as it is added, in order.  Past that the filter
+ * stops emitting: the hashes seen so far are spilled to a temporary file as
+ * a sorted run, and new records are buffered up to the same limit and
+ * spilled as sorted runs in their turn.  finish() merges the runs, emitting
+ * each new record that wasn't seen before; those come out in hash order, not
+ * the order they were added in.  After finish() the filter still remembers
+ * every record emitted (as a run on disk) and can take more.
+ *
+ * Temporary files come from std::tmpfile() and go away with the filter.  Not
+ * thread-safe.
+ */
+class DuplicateFilter {
+public:
+	/** Receives each record that gets through. */
+	using Emit = std::function<void(const char *data, std::size_t size)>;
+
+	/** 128-bit record hash. */
+	struct Hash {
+		std::uint64_t hi;
+		std::uint64_t lo;
+
+		bool operator==(const Hash &other) const {
+			return hi == other.hi && lo == other.lo;
+		}
+		bool operator<(const Hash &other) const {
+			return hi != other.hi ? hi < other.hi : lo < other.lo;
+		}
+	};
+
+	/** MurmurHash3 (x64, 128-bit) of `size` bytes at `data`. */
+	static Hash hash(const char *data, std::size_t size);
+
+	DuplicateFilter(std::size_t memoryLimit, Emit emit);
+	~DuplicateFilter();
+
+	DuplicateFilter(const DuplicateFilter &) = delete;
+	DuplicateFilter &operator=(const DuplicateFilter &) = delete;
+
+	/** Emit the record unless it was added before (possibly not yet). */
+	void add(const char *data, std::size_t size);
+
+	/**
+	 * Emit every buffered or spilled record that isn't a duplicate.  Throws
+	 * std::runtime_error if a temporary file can't be written or read back.
+	 */
+	void finish();
+
+	/** Records dropped as duplicates so far. */
+	std::size_t duplicates() const {
+		return duplicates_;
+	}
+
+	/** Sorted runs written to temporary files so far. */
+	std::size_t spills() const {
+		return spills_;
+	}
+
+private:
+	struct HashHasher {
+		std::size_t operator()(const Hash &h) const {
+			return static_cast<std::size_t>(h.lo);
+		}
+	};
+
+	/// A record buffered once the limit was reached; its bytes are in arena_.
+	struct Pending {
+		Hash hash;
+		std::uint64_t seq;
+		std::size_t offset;
+		std::size_t size;
+	};
+
+	/// A sorted run on disk: either hashes already emitted, or pending records.
+	struct Run {
+		std::FILE *file;
+		bool emitted;
+	};
+
+	void spillSeen();
+	void spillPending();
+
+	std::size_t memoryLimit_;
+	Emit emit_;
+	/// Still emitting as records arrive (nothing has been spilled).
+	bool streaming_ {true};
+	std::unordered_set<Hash, HashHasher> seen_;
+	std::vector<Pending> pending_;
+	std::string arena_;
+	std::vector<Run> runs_;
+	std::uint64_t added_ {0};
+	std::size_t duplicates_ {0};
+	std::size_t spills_ {0};
+};
+
+} // namespace r2rml
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+
+namespace r2rml {
+
+class WatermarkState;
+
+/**
+ * Settings for one R2RMLMapping::processDatabase() export.
+ */
+struct ExportOptions {
+	/// Evaluate each rr:refObjectMap as a single SQL join of the child and
+	/// parent logical tables (ReferencingObjectMap::joinQuery()) so the
+	/// database does the join, instead of probing a client-side JoinIndex
+	/// per child row.  Joins that can't be expressed in SQL still use the
+	/// index.  The triples are the same, but those of a pushed-down join are
+	/// written after the rest of their TriplesMap's rather than interleaved.
+	bool pushDownJoins {false};
+	/// Worker threads for the parallel processDatabase() overload, each
+	/// exporting whole TriplesMaps over its own connection; 0 means
+	/// std::thread::hardware_concurrency().  The single-connection overloads
+	/// always run on the calling thread.
+	unsigned threads {1};
+	/// For the parallel processDatabase() overload: split each TriplesMap
+	/// whose logical table can be partitioned (LogicalTable::partitionKey())
+	/// into this many key ranges of equal width, each exported by its own
+	/// query so workers can share one large table.  Partitions are written
+	/// in key order, so output is deterministic but grouped by key range
+	/// rather than in table order.  A table whose default key can't be
+	/// queried (an rr:tableName naming a view has no rowid) is exported
+	/// whole.  1 disables partitioning.
+	unsigned partitions {1};
+	/// Drop statements already written (DedupSink), comparing them by a
+	/// 128-bit hash.  The parallel overload filters the lines of its
+	/// N-Triples or N-Quads output instead, and rejects other syntaxes.
+	bool dedup {false};
+	/// Memory the dedup stage may use for hashes before it spills sorted
+	/// runs to temporary files.  Statements held back past this point are
+	/// written at the end of the export, in hash order.
+	std::size_t dedupMemory {std::size_t(1) << 30};
+	/// Incremental export: when set, each TriplesMap whose logical table
+	/// has a LogicalTable::watermarkColumn exports only the rows whose
+	/// watermark lies above the TriplesMap's mark here (every row when it
+	/// has none yet) and at most the column's maximum when the TriplesMap
+	/// starts, which then becomes its new mark.  Rows whose watermark is
+	/// null are never exported, on the first run or any later one, so a
+	/// table with no watermark yet exports nothing and records no mark.
+	/// Such a TriplesMap is neither partitioned nor has its joins pushed
+	/// down.  TriplesMaps without a watermark column are exported in full.
+	WatermarkState *watermarks {nullptr};
+	/// Fill ExportReport::triplesMaps with per-TriplesMap and
+	/// per-PredicateObjectMap metrics.  The clock is read a few times per
+	/// result batch and statements are counted through one more sink call,
+	/// so it is cheap enough to leave on.
+	bool metrics {false};
+};
+
+} // namespace r2rml
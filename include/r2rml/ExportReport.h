@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace r2rml {
+
+/**
+ * What one PredicateObjectMap of a TriplesMap did in an export
+ * (ExportOptions::metrics).
+ */
+struct PredicateObjectMapMetrics {
+	/// Statements written, including those of pushed-down joins.
+	std::size_t triples {0};
+	/// Predicate and object terms that were null for a row with a subject,
+	/// so no statement was written for them.
+	std::size_t nullsSkipped {0};
+	/// Child rows looked up in a join index by its rr:refObjectMaps.
+	std::size_t joinProbes {0};
+	/// Seconds spent generating its terms.
+	double termSeconds {0};
+	/// Seconds spent looking its rows up in join indexes.
+	double joinSeconds {0};
+
+	PredicateObjectMapMetrics &operator+=(const PredicateObjectMapMetrics &other);
+};
+
+/**
+ * Where the time of one TriplesMap went in an export, and what it produced
+ * (ExportOptions::metrics).  Times are sampled with std::chrono::steady_clock
+ * once per result batch rather than per row or statement, and are summed
+ * over the partitions and workers that exported the TriplesMap.
+ */
+struct TriplesMapMetrics {
+	std::string id;
+	/// Rows read from its logical table.
+	std::size_t rows {0};
+	/// Statements written, rdf:type ones and pushed-down joins included.
+	std::size_t triples {0};
+	/// Rows skipped for a null subject.
+	std::size_t nullsSkipped {0};
+	/// Child rows looked up in join indexes, over all predicateObjectMaps.
+	std::size_t joinProbes {0};
+	/// Seconds in SQLConnection::execute() (or LogicalTable::getRows()) for
+	/// its rows, and in pushed-down joins, which run and write together.
+	double executeSeconds {0};
+	/// Seconds fetching result batches.
+	double iterateSeconds {0};
+	/// Seconds generating subject, graph, predicate and object terms.
+	double termSeconds {0};
+	/// Seconds looking up child rows in join indexes.
+	double joinSeconds {0};
+	/// Seconds writing statements to the sink.
+	double writeSeconds {0};
+	/// Like TriplesMap::predicateObjectMaps.
+	std::vector<PredicateObjectMapMetrics> predicateObjectMaps;
+
+	double seconds() const {
+		return executeSeconds + iterateSeconds + termSeconds + joinSeconds + writeSeconds;
+	}
+
+	/** Add `other`, which must describe the same TriplesMap. */
+	TriplesMapMetrics &operator+=(const TriplesMapMetrics &other);
+};
+
+/**
+ * Statistics gathered by R2RMLMapping::processDatabase() for one export.
+ */
+struct ExportReport {
+	/// Statements generated, counted on their way to the sink.  With
+	/// ExportOptions::dedup, duplicatesDropped of them were not written.
+	std::size_t statements {0};
+	/// Join indexes built for rr:refObjectMap evaluation, i.e. parent table
+	/// scans.  One per distinct (parent TriplesMap, parent join columns).
+	std::size_t joinIndexBuilds {0};
+	/// Child rows looked up in a join index, summed over all rr:refObjectMaps.
+	std::size_t joinIndexProbes {0};
+	/// rr:refObjectMaps evaluated as one SQL join (ExportOptions::pushDownJoins).
+	std::size_t joinQueries {0};
+	/// Row queries run for one key range of a partitioned logical table
+	/// (ExportOptions::partitions).
+	std::size_t partitionQueries {0};
+	/// Statements dropped as duplicates (ExportOptions::dedup).
+	std::size_t duplicatesDropped {0};
+	/// Sorted runs the dedup stage spilled to temporary files.
+	std::size_t dedupSpills {0};
+	/// With ExportOptions::metrics, one entry per exported TriplesMap, in
+	/// mapping order; empty otherwise.
+	std::vector<TriplesMapMetrics> triplesMaps;
+
+	/**
+	 * The report as a JSON object: the counters above, and each TriplesMap's
+	 * metrics with its rows and triples per second of its time.
+	 */
+	std::string toJson() const;
+};
+
+} // namespace r2rml
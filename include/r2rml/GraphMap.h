@@ -1,12 +1,16 @@
 #pragma once
 
 #include "TermMap.h"
-#include <functional>
+#include "TermBatch.h"
+#include <cstddef>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace r2rml {
 
+class RowBatch;
+
 /**
  * Represents a mapping that yields the named graph IRI for a triple.  Uses
  * the same machinery as other term maps.
@@ -15,21 +19,139 @@ class GraphMap : public TermMap {
 public:
 	GraphMap() = default;
 	~GraphMap() override;
+
+	/**
+	 * How the graph this map yields is known.  A constant graph map is
+	 * classified once, when the mapping is compiled (see classifyConstant()),
+	 * so emitting a triple neither evaluates it nor compares it with
+	 * rr:defaultGraph; any other graph map is evaluated once per row.
+	 */
+	enum class Kind { PerRow, DefaultGraph, NamedGraph };
+	Kind kind {Kind::PerRow};
+	/// The graph when kind is NamedGraph (the mapping's pooled node).
+	SerdNode namedGraph = SERD_NODE_NULL;
+
+	/** Classify this graph map as always yielding `node`. */
+	void classifyConstant(const SerdNode &node);
 };
 
 /**
- * Invoke `emit` once per RDF graph a triple should be written into, given the
- * rr:graph/rr:graphMap annotations of its enclosing subject map and (if any)
- * predicate-object map. Per R2RML §12, the graphs that apply to a triple are
- * the union of both sets.
+ * The graphs the triples of one row are written into.  Per R2RML §12 these
+ * are the union of the graphs of the enclosing subject map and (if any)
+ * predicate-object map; each side is resolved once per row into a RowGraphs,
+ * dropping null terms and rr:defaultGraph, and reused for every triple of
+ * that row.
  *
- * If that union is empty, or every entry resolves to a null term or to the
- * special rr:defaultGraph IRI, `emit` is invoked exactly once with a null
+ * Nodes point into the graph maps' (or the graph TermBatches') own buffers,
+ * so they are valid until those are generated again.  Up to four graphs are
+ * held without allocating.
+ */
+class RowGraphs {
+public:
+	/** Resolve `graphMaps` (null entries allowed) against `row`. */
+	void resolve(const std::vector<std::unique_ptr<GraphMap>> &graphMaps, const SQLRow &row, const SerdEnv &env);
+
+	/**
+	 * Resolve row `row` of the graph terms generateGraphTerms() produced for
+	 * `graphMaps`; the maps' classification spares reading constant ones.
+	 */
+	void resolve(const std::vector<std::unique_ptr<GraphMap>> &graphMaps, const std::vector<TermBatch> &graphs,
+	             std::size_t row);
+
+	/** resolve() of graph terms whose graph maps are unknown. */
+	void resolve(const std::vector<TermBatch> &graphs, std::size_t row);
+
+	std::size_t size() const {
+		return size_;
+	}
+	bool empty() const {
+		return size_ == 0;
+	}
+	const SerdNode &operator[](std::size_t i) const {
+		return i < kInline ? inline_[i] : overflow_[i - kInline];
+	}
+
+private:
+	static const std::size_t kInline = 4;
+
+	void clear() {
+		size_ = 0;
+		overflow_.clear();
+	}
+	/// Keep `node` unless it is null or rr:defaultGraph.
+	void add(const SerdNode &node);
+	void push(const SerdNode &node);
+
+	SerdNode inline_[kInline] {};
+	std::vector<SerdNode> overflow_;
+	std::size_t size_ {0};
+};
+
+/**
+ * Invoke `emit` (callable as `emit(const SerdNode *)`) once per RDF graph a
+ * triple should be written into: each of `subjectGraphs`, then each of
+ * `pomGraphs`.  If both are empty, `emit` is invoked exactly once with a null
  * graph pointer, i.e. the default graph (this also preserves prior
  * quad-less-output behaviour for mappings that don't use rr:graph at all).
  */
+template <typename Emit>
+void forEachGraphNode(const RowGraphs &subjectGraphs, const RowGraphs &pomGraphs, Emit &&emit) {
+	if (subjectGraphs.empty() && pomGraphs.empty()) {
+		emit(static_cast<const SerdNode *>(nullptr));
+		return;
+	}
+	for (std::size_t i = 0; i < subjectGraphs.size(); ++i) {
+		emit(&subjectGraphs[i]);
+	}
+	for (std::size_t i = 0; i < pomGraphs.size(); ++i) {
+		emit(&pomGraphs[i]);
+	}
+}
+
+/**
+ * forEachGraphNode() for a single triple: resolves the subject map's and
+ * predicate-object map's graph maps against `row` first.  Resolve a
+ * RowGraphs once instead when a row yields several triples.
+ */
+template <typename Emit>
 void forEachGraphNode(const std::vector<std::unique_ptr<GraphMap>> &subjectGraphMaps,
                       const std::vector<std::unique_ptr<GraphMap>> &pomGraphMaps, const SQLRow &row, const SerdEnv &env,
-                      const std::function<void(const SerdNode *)> &emit);
+                      Emit &&emit) {
+	RowGraphs subjectGraphs;
+	RowGraphs pomGraphs;
+	subjectGraphs.resolve(subjectGraphMaps, row, env);
+	pomGraphs.resolve(pomGraphMaps, row, env);
+	forEachGraphNode(subjectGraphs, pomGraphs, std::forward<Emit>(emit));
+}
+
+/**
+ * Evaluate each graph map over a whole batch into `out` (resized to one
+ * TermBatch per graph map; a null entry in `graphMaps` yields null terms).
+ */
+void generateGraphTerms(const std::vector<std::unique_ptr<GraphMap>> &graphMaps, const RowBatch &batch,
+                        const SerdEnv &env, std::vector<TermBatch> &out);
+
+/** TermMap::bindColumns() of each graph map (empty ordinals for a null entry). */
+std::vector<ColumnOrdinals> bindGraphColumns(const std::vector<std::unique_ptr<GraphMap>> &graphMaps,
+                                             const RowBatch &batch);
+
+/** generateGraphTerms() with columns bound by bindGraphColumns(). */
+void generateGraphTerms(const std::vector<std::unique_ptr<GraphMap>> &graphMaps, const RowBatch &batch,
+                        const std::vector<ColumnOrdinals> &columns, const SerdEnv &env, std::vector<TermBatch> &out);
+
+/**
+ * Batch counterpart of the single-triple forEachGraphNode(): the same union
+ * and default-graph rules, applied to row `row` of graph terms produced by
+ * generateGraphTerms.
+ */
+template <typename Emit>
+void forEachGraphNode(const std::vector<TermBatch> &subjectGraphs, const std::vector<TermBatch> &pomGraphs,
+                      std::size_t row, Emit &&emit) {
+	RowGraphs subject;
+	RowGraphs pom;
+	subject.resolve(subjectGraphs, row);
+	pom.resolve(pomGraphs, row);
+	forEachGraphNode(subject, pom, std::forward<Emit>(emit));
+}
 
 } // namespace r2rml
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "TermBatch.h"
+#include "TermMap.h"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <serd/serd.h>
+
+namespace r2rml {
+
+class ReferencingObjectMap;
+class RowBatch;
+class SQLConnection;
+class SQLRow;
+class TriplesMap;
+
+/**
+ * Hash index over a parent TriplesMap's logical table, keyed on the values of
+ * a list of parent join columns and holding the parent subject term of every
+ * row.
+ *
+ * Evaluating an rr:refObjectMap with ReferencingObjectMap::getJoinedRows()
+ * re-runs the parent query and compares every parent row for every child
+ * row.  A JoinIndex scans the parent once; each child row is then a single
+ * hash lookup.  Matching follows getJoinedRows() exactly: values are compared
+ * by their lexical form (SQLValue::asString()), a null on either side never
+ * matches, parent rows whose subject is null are dropped, and matches come
+ * back in parent-table order.  With no join conditions every parent row
+ * matches.
+ */
+class JoinIndex {
+public:
+	/**
+	 * Scan the parent of `rom` over `dbConnection`, indexing its rows on
+	 * rom's parent join columns.  An unresolved parent, or one without a
+	 * logical table or subject map, gives an empty index.
+	 */
+	JoinIndex(const ReferencingObjectMap &rom, SQLConnection &dbConnection, const SerdEnv &env);
+
+	JoinIndex(const JoinIndex &) = delete;
+	JoinIndex &operator=(const JoinIndex &) = delete;
+
+	/**
+	 * Parent subject terms matching `childRow` on `rom`'s child join columns,
+	 * or nullptr when none do.  The returned entries index subject().
+	 */
+	const std::vector<std::size_t> *probe(const ReferencingObjectMap &rom, const SQLRow &childRow);
+
+	/** As probe(rom, childRow), for row `row` of a batch. */
+	const std::vector<std::size_t> *probe(const ReferencingObjectMap &rom, const RowBatch &batch, std::size_t row);
+
+	/**
+	 * As probe(rom, batch, row) with rom's child join columns already
+	 * resolved: `childColumns[j]` is the batch ordinal of
+	 * rom.joinConditions[j].childColumn (RowBatch::npos if absent).
+	 */
+	const std::vector<std::size_t> *probe(const RowBatch &batch, const ColumnOrdinals &childColumns, std::size_t row);
+
+	/** Subject term of the i-th indexed parent row. */
+	SerdNode subject(std::size_t i) const {
+		return subjects_.node(i);
+	}
+
+	/** Parent rows indexed (rows with a null join value or subject excluded). */
+	std::size_t size() const {
+		return subjects_.size();
+	}
+
+	/** Number of probe() calls made against this index. */
+	std::size_t probes() const {
+		return probes_;
+	}
+
+private:
+	const std::vector<std::size_t> *find(const std::string &key) const;
+
+	TermBatch subjects_;
+	std::unordered_map<std::string, std::vector<std::size_t>> rows_;
+	std::string key_; ///< scratch buffer reused across probes
+	std::size_t probes_ {0};
+};
+
+/**
+ * The JoinIndexes of one export, shared by every rr:refObjectMap that joins
+ * the same parent TriplesMap on the same parent columns, so each parent table
+ * is scanned at most once per column list.  An export build()s the indexes of
+ * a TriplesMap before it queries the child rows: a backend that allows one
+ * open result per connection would otherwise have to buffer the whole child
+ * result to run the parent query in the middle of it.
+ *
+ * It also records the rr:refObjectMaps an export evaluates with a
+ * database-side join instead (ExportOptions::pushDownJoins); the per-row
+ * paths skip those.
+ */
+class JoinIndexCache {
+public:
+	JoinIndexCache() = default;
+	JoinIndexCache(const JoinIndexCache &) = delete;
+	JoinIndexCache &operator=(const JoinIndexCache &) = delete;
+
+	/** Build the index for `rom`'s parent and parent columns unless it exists. */
+	JoinIndex &build(const ReferencingObjectMap &rom, SQLConnection &dbConnection, const SerdEnv &env);
+
+	/**
+	 * The index for `rom`'s parent and parent columns.  Built on a miss, for
+	 * callers of TriplesMap::generateTriples() that didn't build() it first.
+	 */
+	JoinIndex &get(const ReferencingObjectMap &rom, SQLConnection &dbConnection, const SerdEnv &env);
+
+	/** Number of indexes built (parent table scans). */
+	std::size_t builds() const {
+		return indexes_.size();
+	}
+
+	/** Total probes across all indexes. */
+	std::size_t probes() const;
+
+	/** Record that `rom` is evaluated by TriplesMap::generateJoinedTriples(). */
+	void markPushedDown(const ReferencingObjectMap &rom) {
+		pushedDown_.insert(&rom);
+	}
+	bool isPushedDown(const ReferencingObjectMap &rom) const {
+		return pushedDown_.count(&rom) != 0;
+	}
+
+private:
+	using Key = std::pair<const TriplesMap *, std::vector<std::string>>;
+	std::map<Key, std::unique_ptr<JoinIndex>> indexes_;
+	std::set<const ReferencingObjectMap *> pushedDown_;
+};
+
+} // namespace r2rml
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+
+namespace r2rml {
+
+/** Append `value` to `out` as a JSON string, quoted and escaped. */
+void appendJsonString(std::string &out, const std::string &value);
+
+} // namespace r2rml
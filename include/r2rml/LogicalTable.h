@@ -10,6 +10,12 @@ namespace r2rml {
 class SQLConnection;
 class SQLResultSet;
 
+/** `name` as a double-quoted SQL identifier, with embedded quotes doubled. */
+std::string quoteIdentifier(const std::string &name);
+
+/** `value` as a SQL string literal, which the database casts to the column's type. */
+std::string sqlLiteral(const std::string &value);
+
 /**
  * Abstract base representing a logical table in an R2RML mapping.  A logical
  * table can be backed by a plain table, view or arbitrary SQL query.
@@ -26,10 +32,64 @@ public:
 
 	/**
 	 * Return a list of column names that will be available when iterating rows
-	 * from this logical table.  This may require introspecting the query.
+	 * from this logical table.  This may require introspecting the query;
+	 * empty when they aren't known.
 	 */
 	virtual std::vector<std::string> getColumnNames() = 0;
 
+	/**
+	 * The SELECT statement getRows() runs, suitable for embedding as a
+	 * subquery (no trailing semicolon).  Empty when this logical table can't
+	 * be expressed as one, which is the base implementation.
+	 */
+	virtual std::string selectQuery() const;
+
+	/**
+	 * The SQL getRows() runs; by default selectQuery().  Only computed, so
+	 * concurrent exports of one mapping can call getRows() freely.
+	 */
+	virtual std::string rowQuery() const;
+
+	/**
+	 * The integer SQL expression a partitioned export splits this logical
+	 * table on: partitionColumn, quoted as an identifier, when set, otherwise the subclass's
+	 * default.  Empty when the table can't be partitioned, which is the base
+	 * default: a query result has no row id, so an R2RMLView is partitioned
+	 * only on a declared column.
+	 */
+	virtual std::string partitionKey() const;
+
+	/**
+	 * SELECT returning the lowest and highest partitionKey() as columns
+	 * "lower" and "upper" (both null for an empty table).  Empty when the
+	 * table can't be partitioned.
+	 */
+	std::string partitionBoundsQuery() const;
+
+	/**
+	 * The rows of getRows() whose partitionKey() lies in [lower, upper]
+	 * (inclusive), in the same column layout.  Empty when the table can't be
+	 * partitioned.
+	 */
+	std::string partitionQuery(long long lower, long long upper) const;
+
+	/**
+	 * SELECT returning the highest watermarkColumn value as column "upper",
+	 * cast to VARCHAR by the database so the mark keeps every digit (null
+	 * for an empty table).  Empty when no watermark column is set or the
+	 * table can't be queried as a whole.
+	 */
+	std::string watermarkBoundQuery() const;
+
+	/**
+	 * The rows of getRows() whose watermarkColumn lies above `after` and at
+	 * most `upto`, both SQL values in text form compared as the column's
+	 * type.  An empty `after` means no previous mark: every row up to
+	 * `upto`.  Rows with a null watermark are never selected.  Empty when
+	 * no watermark column is set.
+	 */
+	std::string watermarkQuery(const std::string &after, const std::string &upto) const;
+
 	/**
 	 * Return true if this logical table has all required properties set.
 	 */
@@ -45,9 +105,46 @@ public:
 
 	/**
 	 * The SQL text that defines this logical table.  Derived classes may
-	 * populate this as needed.
+	 * populate this as needed; R2RMLMapping::compile() sets it to
+	 * rowQuery().
 	 */
 	std::string effectiveSqlQuery;
+
+	/**
+	 * Integer column to partition this logical table on in a partitioned
+	 * export (ExportOptions::partitions); empty for the default key.
+	 */
+	std::string partitionColumn;
+
+	/**
+	 * Column that grows with every insert or update of a row, e.g. an
+	 * updated_at timestamp, for an incremental export
+	 * (ExportOptions::watermarks); empty for none.
+	 */
+	std::string watermarkColumn;
+
+	/**
+	 * The columns to select, in order, instead of every column of the
+	 * table or query; empty selects them all.  R2RMLMapping::compile() sets
+	 * it to the columns the mapping reads from this table, so a columnar
+	 * database scans only those.  The partition and watermark queries
+	 * select partitionColumn and watermarkColumn as well.
+	 */
+	std::vector<std::string> projection;
+
+protected:
+	/**
+	 * What the partition and watermark queries select from: by default
+	 * selectQuery() as a derived table.
+	 */
+	virtual std::string partitionSource() const;
+
+	/**
+	 * The SELECT list of projection as quoted identifiers, plus
+	 * partitionColumn and watermarkColumn when `keys` is set; "*" when
+	 * projection is empty.
+	 */
+	std::string selectList(bool keys = false) const;
 };
 
 } // namespace r2rml
@@ -25,6 +25,7 @@ public:
 	MapSQLRow &operator=(MapSQLRow &&) = default;
 
 	std::unique_ptr<SQLValue> getValue(const std::string &columnName) const override;
+	SQLValueView getValueView(const std::string &columnName) const override;
 	bool isNull(const std::string &columnName) const override;
 	std::vector<std::string> columnNames() const override;
 	std::unique_ptr<SQLRow> clone() const override;
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "StatementSink.h"
+
+#include <cstddef>
+#include <string>
+
+#include <serd/serd.h>
+
+namespace r2rml {
+
+class ConstantPool;
+
+/**
+ * A StatementSink that serializes N-Triples or N-Quads directly, without a
+ * SerdWriter.
+ *
+ * Line-based syntaxes need none of the state SerdWriter keeps for Turtle
+ * abbreviation, so this writer formats each statement straight into one
+ * large buffer, handed to `sink` only when full (or on flush()).  Escaping
+ * scans for the bytes that need it sixteen at a time where SSE2 is
+ * available.  Nodes of a mapping's ConstantPool, when given one, are copied
+ * in the form the pool serialized them in; other IRIs in predicate and
+ * datatype position, which are nearly always constants too, are kept
+ * pre-serialized in a small cache.  Output is byte-for-byte that of a SerdWriter with no style flags:
+ * the same \\uXXXX escapes, valid UTF-8 written as-is and U+FFFD for
+ * invalid bytes.
+ *
+ * `env`, which may be null, expands CURIEs and supplies the base URI that
+ * makes relative IRIs writable; like SerdWriter, a relative IRI without one
+ * is an error.  Not thread-safe: use one writer per thread.
+ */
+class NTriplesWriter : public StatementSink {
+public:
+	/** Output is buffered up to this many bytes unless told otherwise. */
+	static const std::size_t defaultBufferSize = 1 << 20;
+
+	/**
+	 * `syntax` must be SERD_NTRIPLES or SERD_NQUADS (std::invalid_argument
+	 * otherwise); graphs are only written for N-Quads.  `sink` and `stream`
+	 * are used like SerdWriter's, e.g. serd_file_sink and a FILE *.
+	 */
+	NTriplesWriter(SerdSyntax syntax, const SerdEnv *env, SerdSink sink, void *stream,
+	               std::size_t bufferSize = defaultBufferSize);
+
+	/**
+	 * As above, recognizing the nodes of `constants` (which may be null and
+	 * must outlive the writer), normally R2RMLMapping::constants.
+	 */
+	NTriplesWriter(SerdSyntax syntax, const SerdEnv *env, const ConstantPool *constants, SerdSink sink, void *stream,
+	               std::size_t bufferSize = defaultBufferSize);
+
+	NTriplesWriter(const NTriplesWriter &) = delete;
+	NTriplesWriter &operator=(const NTriplesWriter &) = delete;
+
+	/** Flushes what is buffered; call flush() first to see write errors. */
+	~NTriplesWriter() override;
+
+	/** True for the syntaxes this writer produces. */
+	static bool supports(SerdSyntax syntax) {
+		return syntax == SERD_NTRIPLES || syntax == SERD_NQUADS;
+	}
+
+	void write(const SerdNode *graph, const SerdNode &subject, const SerdNode &predicate, const SerdNode &object,
+	           const SerdNode *datatype, const SerdNode *lang) override;
+
+	/**
+	 * Append the N-Triples form of `node` to `out` if it doesn't depend on an
+	 * environment, i.e. `node` is an absolute IRI or a blank node, and return
+	 * true; otherwise append nothing and return false.
+	 */
+	static bool appendConstant(std::string &out, const SerdNode &node);
+
+	/**
+	 * Hand everything buffered to the sink.  Throws std::runtime_error if
+	 * the sink accepts fewer bytes.
+	 */
+	void flush() override;
+
+	/** True for N-Quads. */
+	bool writesGraphs() const override {
+		return quads_;
+	}
+
+	/** Bytes formatted but not yet handed to the sink. */
+	std::size_t buffered() const {
+		return buffer_.size();
+	}
+
+private:
+	/** A pre-serialized IRI, valid while the node still has `raw` at `buf`. */
+	struct CachedNode {
+		const uint8_t *buf {nullptr};
+		SerdType type {SERD_NOTHING};
+		std::string raw;
+		std::string serialized;
+	};
+
+	bool writeConstant(const SerdNode &node);
+	void writeCachedNode(const SerdNode &node);
+	void writeResource(const SerdNode &node);
+	void writeLiteral(const SerdNode &node, const SerdNode *datatype, const SerdNode *lang);
+
+	bool quads_;
+	const SerdEnv *env_;
+	const ConstantPool *constants_;
+	SerdSink sink_;
+	void *stream_;
+	std::size_t bufferSize_;
+	std::string buffer_;
+	CachedNode cache_[64];
+};
+
+} // namespace r2rml
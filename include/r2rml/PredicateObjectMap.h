@@ -1,20 +1,30 @@
 #pragma once
 
 #include "AbstractMap.h"
+#include "StatementSink.h"
+#include "TermBatch.h"
+#include "TermMap.h"
 
 #include <memory>
+#include <cstddef>
 #include <ostream>
+#include <string>
 #include <vector>
 
 #include <serd/serd.h>
 
 namespace r2rml {
 
-class TermMap;
+class ConstantPool;
 class GraphMap;
+class RowGraphs;
 class SQLRow;
 class SQLConnection;
 class R2RMLMapping;
+class RowBatch;
+class JoinIndex;
+class JoinIndexCache;
+struct PredicateObjectMapMetrics;
 
 /**
  * Encapsulates mapping rules that generate predicate-object pairs (and
@@ -27,14 +37,114 @@ public:
 
 	/**
 	 * Process a single row given a subject node and emit one or more triples
-	 * by invoking the provided SerdWriter. `subjectGraphMaps` are the
+	 * into the provided StatementSink. `subjectGraphMaps` are the
 	 * enclosing triples map's subject-level rr:graph/rr:graphMap annotations
 	 * (may be empty); per R2RML §12, the graphs a generated triple is written
 	 * into are the union of those and this predicate-object map's own
 	 * graphMaps.
+	 *
+	 * rr:refObjectMaps are evaluated against `joinIndexes` when given (see
+	 * JoinIndexCache); without one each child row re-queries the parent
+	 * through ReferencingObjectMap::getJoinedRows().
 	 */
+	void processRow(const SQLRow &row, const SerdNode &subject, StatementSink &rdfSink, const R2RMLMapping &mapping,
+	                SQLConnection &dbConnection, const std::vector<std::unique_ptr<GraphMap>> &subjectGraphMaps,
+	                JoinIndexCache *joinIndexes = nullptr) const;
+
+	/**
+	 * As above, with the subject map's graphs already resolved for `row`
+	 * (TriplesMap resolves them once for all of a row's triples).
+	 */
+	void processRow(const SQLRow &row, const SerdNode &subject, StatementSink &rdfSink, const R2RMLMapping &mapping,
+	                SQLConnection &dbConnection, const RowGraphs &subjectGraphs,
+	                JoinIndexCache *joinIndexes = nullptr) const;
+
+	/** As above, writing through a SerdWriter. */
 	void processRow(const SQLRow &row, const SerdNode &subject, SerdWriter &rdfWriter, const R2RMLMapping &mapping,
-	                SQLConnection &dbConnection, const std::vector<std::unique_ptr<GraphMap>> &subjectGraphMaps) const;
+	                SQLConnection &dbConnection, const std::vector<std::unique_ptr<GraphMap>> &subjectGraphMaps,
+	                JoinIndexCache *joinIndexes = nullptr) const;
+
+	/**
+	 * The terms of this predicate-object map for a whole RowBatch, filled by
+	 * generateTerms() and consumed row by row by the batch processRow(), plus
+	 * the column ordinals they are read from, set by bindColumns().
+	 * Vectors are indexed like predicateMaps/objectMaps/graphMaps; term
+	 * entries for rr:refObjectMaps are left empty since those are joined per
+	 * row, through their joinColumns.
+	 */
+	struct BatchTerms {
+		std::vector<TermBatch> predicates;
+		std::vector<TermBatch> objects;
+		std::vector<std::string> datatypes; ///< per object map; empty = no rr:datatype/inferred type
+		/// Per object map: `datatypes` as a node (pooled when possible), and
+		/// the rr:language tag; null nodes when there is none.
+		std::vector<SerdNode> datatypeNodes;
+		std::vector<SerdNode> languageNodes;
+		std::vector<TermBatch> graphs;
+
+		std::vector<ColumnOrdinals> predicateColumns;
+		std::vector<ColumnOrdinals> objectColumns;
+		std::vector<ColumnOrdinals> graphColumns;
+		/// Per object map: child join column ordinals of an rr:refObjectMap.
+		std::vector<ColumnOrdinals> joinColumns;
+
+		/// Set by probeJoins() for the batch generateTerms() last filled.
+		bool probed {false};
+		/// Per object map evaluated through a join index, once probed: the
+		/// index, and each row's matches (null for none or for a row that
+		/// emits nothing).
+		std::vector<JoinIndex *> joinIndexes;
+		std::vector<std::vector<const std::vector<std::size_t> *>> joinMatches;
+	};
+
+	/**
+	 * Resolve the columns every term map of this predicate-object map reads
+	 * against `batch`'s schema, into `terms`.  Needed once per result schema,
+	 * before generateTerms() and processRow() see batches of that schema.
+	 */
+	void bindColumns(const RowBatch &batch, BatchTerms &terms) const;
+
+	/**
+	 * Generate every predicate, object and graph term for `batch` at once,
+	 * reading the columns `terms` was bound to.  Datatypes and language tags
+	 * are resolved to nodes once for the batch, taken from `constants` (the
+	 * mapping's, may be null) when interned there.
+	 */
+	void generateTerms(const RowBatch &batch, const SerdEnv &env, BatchTerms &terms,
+	                   const ConstantPool *constants = nullptr) const;
+
+	/**
+	 * Look up the rows of `batch` in the join index of every rr:refObjectMap
+	 * `joinIndexes` evaluates, after generateTerms(), into `terms`: once per
+	 * row with a subject in `subjects` and a predicate, however many
+	 * predicates it has.  The batch processRow() then emits the matches
+	 * rather than probing row by row.  Probes are added to `metrics` when
+	 * given.  Returns whether any object map joins through an index.
+	 */
+	bool probeJoins(const RowBatch &batch, const TermBatch &subjects, const SerdEnv &env, BatchTerms &terms,
+	                SQLConnection &dbConnection, JoinIndexCache &joinIndexes,
+	                PredicateObjectMapMetrics *metrics = nullptr) const;
+
+	/**
+	 * Batch counterpart of processRow(row, ...): emit the triples of row `row`
+	 * of `batch`, using terms already produced by generateTerms().
+	 * `subjectGraphs` are the enclosing subject map's graph terms for the same
+	 * batch (see generateGraphTerms()).
+	 */
+	void processRow(const RowBatch &batch, std::size_t row, const SerdNode &subject, const BatchTerms &terms,
+	                StatementSink &rdfSink, const R2RMLMapping &mapping, SQLConnection &dbConnection,
+	                const std::vector<TermBatch> &subjectGraphs, JoinIndexCache *joinIndexes = nullptr) const;
+
+	/**
+	 * As above, with the subject map's graphs already resolved for `row`.
+	 * With `metrics`, the predicate and object terms skipped as null are
+	 * added to it as they happen, and so are join index probes if
+	 * probeJoins() hasn't made them.
+	 */
+	void processRow(const RowBatch &batch, std::size_t row, const SerdNode &subject, const BatchTerms &terms,
+	                StatementSink &rdfSink, const R2RMLMapping &mapping, SQLConnection &dbConnection,
+	                const RowGraphs &subjectGraphs, JoinIndexCache *joinIndexes = nullptr,
+	                PredicateObjectMapMetrics *metrics = nullptr) const;
 
 	bool isValid() const;
 
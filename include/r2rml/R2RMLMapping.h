@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -7,11 +9,25 @@
 
 #include <serd/serd.h>
 
+#include "ConstantPool.h"
+#include "ExportOptions.h"
+#include "ExportReport.h"
+#include "StatementSink.h"
+
 namespace r2rml {
 
+class JoinIndexCache;
+class ShardedOutput;
 class TriplesMap;
 class SQLConnection;
 
+/**
+ * Opens a database connection for one worker of a parallel export (see
+ * R2RMLMapping::processDatabase(const ConnectionFactory &, ...)).  Called
+ * once per worker thread, from that thread.
+ */
+using ConnectionFactory = std::function<std::unique_ptr<SQLConnection>()>;
+
 /**
  * Represents a complete R2RML mapping document. Handles loading the mapping
  * and driving RDF generation over a database connection.
@@ -36,11 +52,82 @@ public:
 	 */
 	void loadMapping(const std::string &mappingFilePath);
 
+	/**
+	 * Intern every constant term of the mapping into `constants`: rr:class
+	 * IRIs, rr:constant values (constant predicates, objects, subjects and
+	 * graphs), rr:datatype IRIs and rr:language tags.  Term maps keep the
+	 * pooled nodes, so generating a row only builds the column-dependent
+	 * terms, and an NTriplesWriter given `constants` writes the rest
+	 * pre-serialized.  Also sets each logical table's projection to the
+	 * columns the mapping reads from it, so exports select only those.
+	 *
+	 * R2RMLParser compiles the mappings it builds, and processDatabase()
+	 * compiles a mapping that hasn't been; call it again after changing a
+	 * compiled mapping.  An uncompiled term map still works, building its
+	 * constant nodes as it goes.
+	 */
+	void compile();
+
 	/**
 	 * Process the provided database connection using the loaded mapping rules
 	 * and serialize generated triples via the supplied SerdWriter.
+	 *
+	 * rr:refObjectMap joins are evaluated with one hash index per parent
+	 * TriplesMap and parent column list, built on first use and shared by
+	 * every predicate-object map joining it.  When `report` is non-null it
+	 * receives the export's statistics.
+	 */
+	void processDatabase(SQLConnection &dbConnection, SerdWriter &rdfWriter, ExportReport *report = nullptr);
+
+	/** As above, with explicit export settings (see ExportOptions). */
+	void processDatabase(SQLConnection &dbConnection, SerdWriter &rdfWriter, const ExportOptions &options,
+	                     ExportReport *report = nullptr);
+
+	/**
+	 * As above, emitting statements into `rdfSink`, e.g. an NTriplesWriter
+	 * (flush it afterwards).
 	 */
-	void processDatabase(SQLConnection &dbConnection, SerdWriter &rdfWriter);
+	void processDatabase(SQLConnection &dbConnection, StatementSink &rdfSink, const ExportOptions &options,
+	                     ExportReport *report = nullptr);
+
+	/**
+	 * Export with `options.threads` worker threads.  Each worker opens its
+	 * own connection with `connect` and takes whole TriplesMaps in turn (or,
+	 * with `options.partitions`, key ranges of one; see ExportOptions),
+	 * serializing each one's triples as `syntax` in `style` into a private
+	 * buffer (N-Triples and N-Quads with an NTriplesWriter, other syntaxes
+	 * with a SerdWriter).  Buffers are passed to `sink` strictly in TriplesMap order, as
+	 * soon as every earlier one has been, so unpartitioned N-Triples and
+	 * N-Quads output is byte-for-byte that of the single-threaded export;
+	 * Turtle holds the same triples, but abbreviation restarts at each
+	 * buffer.  Prefix directives are not written: emit them to `sink` first.
+	 *
+	 * A buffer is held in memory until it is its turn.  Join indexes are
+	 * per worker, so a parent table may be scanned once per worker that
+	 * joins it; `report` sums the workers' statistics.  The mapping must not
+	 * be modified while the export runs.  The first error, in output order,
+	 * is rethrown once the workers have stopped; output before it has been
+	 * written.
+	 */
+	void processDatabase(const ConnectionFactory &connect, SerdSyntax syntax, SerdStyle style, SerdSink sink,
+	                     void *stream, const ExportOptions &options, ExportReport *report = nullptr);
+
+	/**
+	 * Export into the shard files of `output` (see ShardedOutput) rather
+	 * than one stream.  Work is split as in the parallel export above, but
+	 * each of the `options.threads` workers writes its statements straight
+	 * into shards of its own through a ShardWriter, so shards are written
+	 * concurrently and nothing is buffered for a merge.  A shard holds the
+	 * TriplesMaps (or key ranges) its worker took, in the order it took them;
+	 * with one thread, that is mapping order and shards are deterministic.
+	 * A single worker runs on the calling thread.
+	 *
+	 * `options.dedup` is not supported (std::invalid_argument).  The first
+	 * error is rethrown once the workers have stopped.  Call
+	 * output.writeManifest() afterwards to list the shards.
+	 */
+	void processDatabase(const ConnectionFactory &connect, ShardedOutput &output, const ExportOptions &options,
+	                     ExportReport *report = nullptr);
 
 	/**
 	 * Return true if all contained triples maps are valid.
@@ -72,6 +159,25 @@ public:
 	 * the parser was run in strict (throwing) mode.
 	 */
 	std::vector<std::string> parseErrors;
+
+	/// The mapping's interned constant terms (see compile()).
+	ConstantPool constants;
+
+private:
+	bool compiled_ {false};
+
+	/**
+	 * Export one TriplesMap: its row pass over `rowQuery` (getRows() when
+	 * empty), then, if `pushedDownJoins`, any joins pushed down to the
+	 * database.  With options.watermarks and a watermarked logical table,
+	 * the row pass covers the rows past the TriplesMap's mark instead, and
+	 * the new mark is recorded after it.  With `metrics`, adds what it did
+	 * there (see ExportOptions::metrics).  Shared by all exports.
+	 */
+	void exportTriplesMap(const TriplesMap &tm, SQLConnection &dbConnection, StatementSink &rdfSink,
+	                      const ExportOptions &options, JoinIndexCache &joinIndexes, std::size_t &joinQueries,
+	                      const std::string &rowQuery = std::string(), bool pushedDownJoins = true,
+	                      TriplesMapMetrics *metrics = nullptr) const;
 };
 
 } // namespace r2rml
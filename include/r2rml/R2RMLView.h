@@ -20,6 +20,8 @@ public:
 
 	std::unique_ptr<SQLResultSet> getRows(SQLConnection &dbConnection) override;
 	std::vector<std::string> getColumnNames() override;
+	std::string selectQuery() const override;
+	std::string rowQuery() const override;
 
 	bool isValid() const override {
 		return !sqlQuery.empty();
@@ -29,6 +31,14 @@ public:
 
 	std::string sqlQuery;
 	std::vector<std::string> sqlVersions;
+
+protected:
+	/** selectQuery() with the partition and watermark columns projected too. */
+	std::string partitionSource() const override;
+
+private:
+	/** The query as a subquery, projected onto selectList(keys). */
+	std::string projectedQuery(bool keys) const;
 };
 
 } // namespace r2rml
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "BoundTriplesMap.h"
+#include "RowBatch.h"
+#include "SQLValue.h"
+#include "StatementSink.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace r2rml {
+
+class R2RMLMapping;
+class SQLConnection;
+class TriplesMap;
+
+/**
+ * Push-style ("inside-out") export of one TriplesMap.
+ *
+ * processDatabase() pulls rows through an SQLConnection.  Here the host
+ * engine drives instead: DuckDB running COPY ... TO, for one, executes the
+ * query itself and hands over its result a vector of rows at a time.
+ * begin() binds the triples map to the layout of that result once; each
+ * consume() then generates the terms of a whole batch column by column and
+ * writes its triples to a StatementSink, in the order the pull path would.
+ *
+ * Only a TriplesMap valid inside-out (TriplesMap::isValidInsideOut(): no
+ * logical table, no rr:refObjectMap) can be run, so the sink never needs to
+ * query anything.  It does not depend on DuckDB: the host copies its chunks
+ * into a RowBatch.
+ *
+ * The mapping, triples map and StatementSink must outlive the sink.  Not
+ * thread-safe.
+ */
+class RdfSink {
+public:
+	/** One column of the rows a sink consumes. */
+	struct Column {
+		Column(std::string name, SQLValue::Type type = SQLValue::Type::String, std::string datatypeIRI = "")
+		    : name(std::move(name)), type(type), datatypeIRI(std::move(datatypeIRI)) {
+		}
+
+		std::string name;
+		SQLValue::Type type;
+		/// XSD datatype IRI of the column's values; empty for plain literals.
+		std::string datatypeIRI;
+	};
+
+	/**
+	 * Throws std::invalid_argument if `triplesMap` is not valid inside-out.
+	 * `mapping` is the mapping it belongs to (its environment and constants
+	 * are used).
+	 */
+	RdfSink(const R2RMLMapping &mapping, const TriplesMap &triplesMap, StatementSink &out);
+	~RdfSink();
+
+	RdfSink(const RdfSink &) = delete;
+	RdfSink &operator=(const RdfSink &) = delete;
+
+	/**
+	 * Start a stream of rows with the given columns, binding the triples
+	 * map's column references to their positions.  Throws
+	 * std::invalid_argument if the triples map reads a column `schema` lacks,
+	 * std::logic_error if a stream is already open.
+	 */
+	void begin(const std::vector<Column> &schema);
+
+	/**
+	 * Emit the triples of every row of `batch`, whose columns are those
+	 * given to begin(), in the same order.  Throws std::logic_error outside
+	 * begin()/finish(), and whatever the StatementSink throws.
+	 */
+	void consume(const RowBatch &batch);
+
+	/** End the stream and flush the StatementSink. */
+	void finish();
+
+	/** Rows consumed since begin(). */
+	std::size_t rows() const {
+		return rows_;
+	}
+
+	/**
+	 * The triples map of `mapping` named `id`: its full IRI, or the part
+	 * after its last '#' or '/' (so "Emp", "#Emp" and "<#Emp>" all name
+	 * <http://example.com/mapping#Emp>).  An empty id names a mapping's only
+	 * triples map.  Throws std::invalid_argument when there is no such map or
+	 * the name is ambiguous.
+	 */
+	static const TriplesMap &findTriplesMap(const R2RMLMapping &mapping, const std::string &id);
+
+private:
+	const TriplesMap &triplesMap_;
+	StatementSink &out_;
+	BoundTriplesMap bound_;
+	/// Answers the SQLConnection BoundTriplesMap asks for; never queried.
+	std::unique_ptr<SQLConnection> noQueries_;
+	std::vector<std::string> schema_;
+	bool open_ {false};
+	std::size_t rows_ {0};
+};
+
+} // namespace r2rml
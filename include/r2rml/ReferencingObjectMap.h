@@ -3,12 +3,14 @@
 #include "TermMap.h"
 #include "JoinCondition.h"
 
+#include <string>
 #include <vector>
 #include <memory>
 
 namespace r2rml {
 
 class TriplesMap;
+class LogicalTable;
 class SQLConnection;
 class SQLRow;
 class SQLResultSet;
@@ -26,6 +28,23 @@ public:
 
 	std::unique_ptr<SQLResultSet> getJoinedRows(SQLConnection &dbConnection, const SQLRow &childRow) const;
 
+	/**
+	 * The R2RML joint SQL query (§8) of `childTable` and the parent's logical
+	 * table, for evaluating this map with a single database-side join.  Each
+	 * result row carries every child column plus, for each column the
+	 * parent's subject map reads, that column aliased as
+	 * parentColumnPrefix + name.  Empty when either table has no
+	 * selectQuery() or the parent subject map's input columns are unknown.
+	 */
+	std::string joinQuery(const LogicalTable &childTable) const;
+
+	/** Columns the parent subject map reads (see joinQuery()). */
+	std::vector<std::string> parentSubjectColumns() const;
+
+	/// Alias prefix of parent columns in joinQuery() results.  Upper case,
+	/// since backends such as DuckDB report result column names upper-cased.
+	static const char *const parentColumnPrefix;
+
 	SerdNode generateRDFTerm(const SQLRow &childRow, const SQLRow &parentRow, const SerdEnv &env) const;
 
 	std::ostream &print(std::ostream &os) const override;
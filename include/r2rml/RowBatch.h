@@ -0,0 +1,154 @@
+#pragma once
+
+#include "SQLRow.h"
+#include "SQLValue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace r2rml {
+
+/**
+ * A column-oriented block of SQL result rows, filled by
+ * SQLResultSet::nextBatch().
+ *
+ * Each column keeps its values' lexical forms back to back in one contiguous
+ * character buffer (with an offset array and a validity mask), together with
+ * the column's SQL type and the XSD datatype IRI its values carry.  Term maps
+ * read those buffers directly instead of going through one SQLRow::getValue()
+ * clone per cell.
+ *
+ * Batches are meant to be reused: reset() drops the schema and rows but keeps
+ * every buffer's capacity, so refilling a batch for the next chunk of a
+ * result does not allocate once the buffers have grown to size.
+ */
+class RowBatch {
+public:
+	/// Row count backends aim for; matches DuckDB's vector size.
+	static const std::size_t kDefaultCapacity = 2048;
+
+	/** One column of a RowBatch. */
+	class Column {
+	public:
+		std::string name;
+		SQLValue::Type type {SQLValue::Type::Null};
+		/// XSD datatype IRI of this column's non-null values, or empty for
+		/// plain literals (see SQLValue::datatypeIRI()).
+		std::string datatypeIRI;
+
+		std::size_t size() const {
+			return valid_.size();
+		}
+		bool isNull(std::size_t row) const {
+			return valid_[row] == 0;
+		}
+		/** Lexical form of row `row`; NUL-terminated, empty for nulls. */
+		const char *data(std::size_t row) const {
+			return chars_.data() + offsets_[row];
+		}
+		std::size_t length(std::size_t row) const {
+			return offsets_[row + 1] - offsets_[row] - 1;
+		}
+		std::string str(std::size_t row) const {
+			return std::string(data(row), length(row));
+		}
+
+		void append(const char *s, std::size_t n);
+		void append(const std::string &s) {
+			append(s.data(), s.size());
+		}
+		void appendNull();
+
+		/** Drop all values, keeping buffer capacity. */
+		void clear();
+
+	private:
+		std::string chars_;
+		std::vector<std::size_t> offsets_ {0};
+		std::vector<uint8_t> valid_;
+	};
+
+	RowBatch() = default;
+	RowBatch(const RowBatch &) = delete;
+	RowBatch &operator=(const RowBatch &) = delete;
+
+	/** Number of rows currently in the batch. */
+	std::size_t size() const {
+		return size_;
+	}
+	bool empty() const {
+		return size_ == 0;
+	}
+
+	std::size_t columnCount() const {
+		return columnCount_;
+	}
+	Column &column(std::size_t i) {
+		return *columns_[i];
+	}
+	const Column &column(std::size_t i) const {
+		return *columns_[i];
+	}
+
+	/** Index of the named column, or npos when the batch has no such column. */
+	std::size_t findColumn(const std::string &name) const;
+	static const std::size_t npos = static_cast<std::size_t>(-1);
+
+	/**
+	 * Append a column to the schema.  Any rows already in the batch read as
+	 * null in the new column.  Reuses the storage of a column dropped by an
+	 * earlier reset().
+	 */
+	Column &addColumn(const std::string &name, SQLValue::Type type = SQLValue::Type::Null);
+
+	/** Record that every column now holds `n` rows. */
+	void setSize(std::size_t n) {
+		size_ = n;
+	}
+
+	/** Drop schema and rows, keeping allocated buffers for reuse. */
+	void reset();
+
+private:
+	std::vector<std::unique_ptr<Column>> columns_;
+	std::size_t columnCount_ {0};
+	std::size_t size_ {0};
+	std::map<std::string, std::size_t> index_;
+};
+
+/**
+ * Read-only SQLRow view of one row of a RowBatch, for code that still works
+ * a row at a time (e.g. rr:refObjectMap joins or term maps without a batch
+ * implementation).  Values are copied out on getValue() and borrowed straight
+ * from the column buffers by getValueView(); the view itself is valid only
+ * while the batch is unchanged.
+ */
+class RowBatchRow : public SQLRow {
+public:
+	RowBatchRow(const RowBatch &batch, std::size_t row) : batch_(&batch), row_(row) {
+	}
+
+	void setRow(std::size_t row) {
+		row_ = row;
+	}
+	std::size_t row() const {
+		return row_;
+	}
+
+	std::unique_ptr<SQLValue> getValue(const std::string &columnName) const override;
+	SQLValueView getValueView(const std::string &columnName) const override;
+	const std::string &getDatatypeIRI(const std::string &columnName) const override;
+	bool isNull(const std::string &columnName) const override;
+	std::vector<std::string> columnNames() const override;
+	std::unique_ptr<SQLRow> clone() const override;
+
+private:
+	const RowBatch *batch_;
+	std::size_t row_;
+};
+
+} // namespace r2rml
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "RowBatch.h"
+
+#include <cstddef>
+
 namespace r2rml {
 
 class SQLRow;
@@ -18,6 +22,19 @@ public:
 
 	/** Return the row at the current cursor position. */
 	virtual const SQLRow &getCurrentRow() const = 0;
+
+	/**
+	 * Refill `batch` with up to `maxRows` of the remaining rows, replacing its
+	 * previous schema and contents.  Returns false (with an empty batch) once
+	 * the result is exhausted.  Do not mix with next() on the same result set.
+	 *
+	 * The default implementation assembles the batch from next() and
+	 * getCurrentRow(), taking the schema as the union of the rows' column
+	 * names (missing cells read as null) and each column's type and datatype
+	 * from its first non-null value.  Backends that already hold columnar data
+	 * (DuckDB's DataChunks) override it to fill the column buffers directly.
+	 */
+	virtual bool nextBatch(RowBatch &batch, std::size_t maxRows = RowBatch::kDefaultCapacity);
 };
 
 } // namespace r2rml
@@ -18,15 +18,54 @@ class SQLRow {
 public:
 	virtual ~SQLRow() = default;
 
+	SQLRow() = default;
+	// Copies share no borrowed value (see getValueView()).
+	SQLRow(const SQLRow &) {
+	}
+	SQLRow &operator=(const SQLRow &) {
+		return *this;
+	}
+
+	/** Copy of the value of `columnName`; a missing column reads as null. */
 	virtual std::unique_ptr<SQLValue> getValue(const std::string &columnName) const = 0;
 	virtual bool isNull(const std::string &columnName) const = 0;
 
+	/**
+	 * Borrow the value of `columnName` without copying or allocating; a
+	 * missing column reads as null.  The view stays valid until the row is
+	 * changed (e.g. its result set advances) or destroyed, which is what the
+	 * term maps need while they build one row's terms.
+	 *
+	 * The default implementation, for rows that only implement getValue(),
+	 * holds on to one fetched value, so its view is only valid until the next
+	 * getValueView() call on the same row.  Row types in this library all
+	 * override it.
+	 */
+	virtual SQLValueView getValueView(const std::string &columnName) const;
+
+	/**
+	 * Borrow the XSD datatype IRI of the value of `columnName` (see
+	 * SQLValue::datatypeIRI()); empty for a plain literal, a null or a missing
+	 * column.  Valid for as long as a getValueView() view would be.
+	 *
+	 * A result column's type is fixed, so rows over a result set answer this
+	 * from the column instead of copying the value.  The default
+	 * implementation goes through getValue().
+	 */
+	virtual const std::string &getDatatypeIRI(const std::string &columnName) const;
+
 	/** Column names present on this row, e.g. for printing headers. */
 	virtual std::vector<std::string> columnNames() const = 0;
 
 	/** Deep-copy this row.  Used internally when rows must be cached (e.g.
 	 *  join evaluation). */
 	virtual std::unique_ptr<SQLRow> clone() const = 0;
+
+private:
+	/// Keeps the value behind the default getValueView()'s view alive.
+	mutable std::unique_ptr<SQLValue> borrowed_;
+	/// Backs the default getDatatypeIRI().
+	mutable std::string borrowedDatatype_;
 };
 
 } // namespace r2rml
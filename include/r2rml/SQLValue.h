@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <string>
 
@@ -35,4 +36,52 @@ public:
 	}
 };
 
+/**
+ * A borrowed, non-owning view of one SQL value: its lexical form as a
+ * pointer and length, its type, and whether it is null.  Returned by
+ * SQLRow::getValueView(); it points into storage owned by the row (or the
+ * batch or chunk behind it), so it is only valid while that row is current.
+ * Call str() to keep a copy.
+ */
+class SQLValueView {
+public:
+	/** A null value. */
+	SQLValueView() = default;
+
+	SQLValueView(SQLValue::Type type, const char *data, std::size_t length)
+	    : type_(type), data_(data), length_(length) {
+	}
+	SQLValueView(SQLValue::Type type, const std::string &value)
+	    : type_(type), data_(value.data()), length_(value.size()) {
+	}
+
+	bool isNull() const {
+		return data_ == nullptr;
+	}
+	SQLValue::Type type() const {
+		return type_;
+	}
+	/** Lexical form; not NUL-terminated in general. */
+	const char *data() const {
+		return data_;
+	}
+	std::size_t length() const {
+		return length_;
+	}
+	std::string str() const {
+		return data_ ? std::string(data_, length_) : std::string();
+	}
+
+	/** Whether both are non-null with the same lexical form. */
+	bool sameValue(const SQLValueView &other) const {
+		return data_ && other.data_ && length_ == other.length_ &&
+		       std::char_traits<char>::compare(data_, other.data_, length_) == 0;
+	}
+
+private:
+	SQLValue::Type type_ {SQLValue::Type::Null};
+	const char *data_ {nullptr};
+	std::size_t length_ {0};
+};
+
 } // namespace r2rml
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "StatementSink.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <serd/serd.h>
+
+namespace r2rml {
+
+class ConstantPool;
+class NTriplesWriter;
+
+/**
+ * The output of a sharded export (R2RMLMapping::processDatabase(const
+ * ConnectionFactory &, ShardedOutput &, ...)): N-Triples or N-Quads split
+ * over numbered files in one directory, so a bulk loader can read them in
+ * parallel without another pass to split one large file.
+ *
+ * A new shard is started at every TriplesMap when `perTriplesMap` is set,
+ * and whenever the current one has reached `maxStatements` statements or
+ * `maxBytes` bytes (0 = no limit).  Shards end between statements, so one
+ * can exceed `maxBytes` by a line.  Files are named shard-00000.nt (.nq for
+ * N-Quads), numbered in the order they were started; writeManifest() lists
+ * them with their statement and byte counts and the TriplesMaps that wrote
+ * to them.  Files already in the directory are overwritten or left alone,
+ * so the manifest, not the directory listing, says what an export wrote.
+ *
+ * Shards are written by ShardWriters, one per thread; ShardedOutput itself
+ * is thread-safe.
+ */
+class ShardedOutput {
+public:
+	/** A finished shard. */
+	struct Shard {
+		/// File name within the directory.
+		std::string file;
+		std::size_t statements {0};
+		std::size_t bytes {0};
+		/// Ids of the TriplesMaps that wrote to it, in the order they first did.
+		std::vector<std::string> triplesMaps;
+	};
+
+	/** Name of the manifest writeManifest() writes into the directory. */
+	static const char *const manifestName;
+
+	/**
+	 * Shard into `directory`, which is created if it doesn't exist (its
+	 * parent must).  `syntax` must be SERD_NTRIPLES or SERD_NQUADS.  Throws
+	 * std::invalid_argument for another syntax and std::runtime_error if
+	 * the directory can't be created.
+	 */
+	ShardedOutput(const std::string &directory, SerdSyntax syntax, bool perTriplesMap, std::size_t maxStatements = 0,
+	              std::size_t maxBytes = 0);
+
+	ShardedOutput(const ShardedOutput &) = delete;
+	ShardedOutput &operator=(const ShardedOutput &) = delete;
+
+	const std::string &directory() const {
+		return directory_;
+	}
+
+	SerdSyntax syntax() const {
+		return syntax_;
+	}
+
+	/** The finished shards, in file name order. */
+	std::vector<Shard> shards() const;
+
+	/**
+	 * Write the manifest, a JSON object listing the finished shards, to
+	 * manifestName in the directory and return its path.  Throws
+	 * std::runtime_error if it can't be written.
+	 */
+	std::string writeManifest() const;
+
+private:
+	friend class ShardWriter;
+
+	/// Reserve the next shard's number and return its file name.
+	std::string startShard(std::size_t &index);
+	void finishShard(std::size_t index, const Shard &shard);
+	std::string path(const std::string &file) const;
+
+	std::string directory_;
+	SerdSyntax syntax_;
+	bool perTriplesMap_;
+	std::size_t maxStatements_;
+	std::size_t maxBytes_;
+
+	mutable std::mutex mutex_;
+	/// Every shard started, by number; `file` is empty until it is finished.
+	std::vector<Shard> shards_;
+};
+
+/**
+ * A StatementSink writing into the shards of a ShardedOutput: it opens a
+ * shard on the first statement, rolls over to a new one at the output's
+ * limits, and records each shard with the output when it closes it.  Lines
+ * are formatted by an NTriplesWriter, so they are byte-for-byte those of an
+ * unsharded export.  Not thread-safe: use one writer per thread.
+ */
+class ShardWriter : public StatementSink {
+public:
+	/**
+	 * `env` and `constants` are passed to the NTriplesWriter (normally the
+	 * mapping's serdEnvironment and constants); `output` and `constants`
+	 * must outlive the writer.
+	 */
+	ShardWriter(ShardedOutput &output, const SerdEnv *env, const ConstantPool *constants);
+
+	/** Closes the current shard, ignoring errors: call finish() to see them. */
+	~ShardWriter() override;
+
+	ShardWriter(const ShardWriter &) = delete;
+	ShardWriter &operator=(const ShardWriter &) = delete;
+
+	/**
+	 * Attribute the statements that follow to the TriplesMap `id`; with
+	 * `perTriplesMap`, they go to a new shard.
+	 */
+	void startTriplesMap(const std::string &id);
+
+	void write(const SerdNode *graph, const SerdNode &subject, const SerdNode &predicate, const SerdNode &object,
+	           const SerdNode *datatype, const SerdNode *lang) override;
+
+	/** Hand what is buffered to the current shard's file. */
+	void flush() override;
+
+	/** True for N-Quads. */
+	bool writesGraphs() const override;
+
+	/**
+	 * Close the current shard, if any, and record it with the output.
+	 * Throws std::runtime_error if the file can't be written.
+	 */
+	void finish();
+
+private:
+	void open();
+	static std::size_t sink(const void *buf, std::size_t len, void *stream);
+
+	ShardedOutput &output_;
+	const SerdEnv *env_;
+	const ConstantPool *constants_;
+	std::string triplesMap_;
+	/// triplesMap_ isn't in shard_.triplesMaps yet.
+	bool newTriplesMap_ {false};
+
+	std::FILE *file_ {nullptr};
+	std::size_t index_ {0};
+	/// Bytes the NTriplesWriter has handed to file_.
+	std::size_t written_ {0};
+	std::unique_ptr<NTriplesWriter> writer_;
+	ShardedOutput::Shard shard_;
+};
+
+} // namespace r2rml
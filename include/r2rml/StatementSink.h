@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+
+#include <serd/serd.h>
+
+namespace r2rml {
+
+/**
+ * Destination of the RDF statements a mapping generates.
+ *
+ * TriplesMap, BoundTriplesMap and PredicateObjectMap emit every statement
+ * through one of these, so the serializer behind them can be swapped: a
+ * SerdWriterSink hands statements to a SerdWriter (any syntax), an
+ * NTriplesWriter formats N-Triples/N-Quads itself.
+ */
+class StatementSink {
+public:
+	virtual ~StatementSink();
+
+	/**
+	 * Write one statement; `graph`, `datatype` and `lang` may be null, and
+	 * the nodes follow serd_writer_write_statement()'s conventions.  Throws
+	 * std::runtime_error if the statement can't be written.
+	 */
+	virtual void write(const SerdNode *graph, const SerdNode &subject, const SerdNode &predicate,
+	                   const SerdNode &object, const SerdNode *datatype, const SerdNode *lang) = 0;
+
+	/** Push out anything buffered.  The default has nothing to flush. */
+	virtual void flush() {
+	}
+
+	/**
+	 * False when the graph of a statement is dropped rather than written
+	 * (N-Triples), so statements differing only in graph come out the same.
+	 */
+	virtual bool writesGraphs() const {
+		return true;
+	}
+};
+
+/**
+ * StatementSink writing through a SerdWriter, which must outlive it.
+ */
+class SerdWriterSink : public StatementSink {
+public:
+	explicit SerdWriterSink(SerdWriter &rdfWriter) : rdfWriter_(rdfWriter) {
+	}
+
+	void write(const SerdNode *graph, const SerdNode &subject, const SerdNode &predicate, const SerdNode &object,
+	           const SerdNode *datatype, const SerdNode *lang) override;
+
+private:
+	SerdWriter &rdfWriter_;
+};
+
+/**
+ * Passes statements on to another sink, adding one to `*count` for each;
+ * point `count` at whichever counter the next statements belong to.
+ */
+class CountingSink : public StatementSink {
+public:
+	CountingSink(StatementSink &sink, std::size_t *count) : count(count), sink_(sink) {
+	}
+
+	void write(const SerdNode *graph, const SerdNode &subject, const SerdNode &predicate, const SerdNode &object,
+	           const SerdNode *datatype, const SerdNode *lang) override {
+		sink_.write(graph, subject, predicate, object, datatype, lang);
+		++*count;
+	}
+
+	void flush() override {
+		sink_.flush();
+	}
+
+	bool writesGraphs() const override {
+		return sink_.writesGraphs();
+	}
+
+	std::size_t *count;
+
+private:
+	StatementSink &sink_;
+};
+
+} // namespace r2rml
@@ -21,6 +21,9 @@ public:
 
 	bool isValid() const override;
 
+	/** Also interns the rr:class IRIs, as classNodes, and the graph maps. */
+	void internConstants(ConstantPool &pool) override;
+
 	std::ostream &print(std::ostream &os) const override;
 
 	/// The term-generation strategy (rr:template/rr:column/rr:constant) that
@@ -34,6 +37,8 @@ public:
 	virtual const TermMap *valueTermMap() const = 0;
 
 	std::vector<std::string> classIRIs;
+	/// classIRIs as pooled nodes once internConstants() has run, else empty.
+	std::vector<SerdNode> classNodes;
 	std::vector<std::unique_ptr<GraphMap>> graphMaps;
 };
 
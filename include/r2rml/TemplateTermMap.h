@@ -2,23 +2,71 @@
 
 #include "TermMap.h"
 
+#include <cstddef>
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace r2rml {
 
 /**
  * A term map defined by an RFC 6570-style template string.  Placeholders are
  * filled with column values from the current row.
+ *
+ * The template is parsed once into a Plan, on construction or setTemplate(),
+ * and again by internConstants() (so R2RMLMapping::compile()) for a
+ * templateString assigned directly.  Generating a term is then a single pass
+ * of appends over the plan's segments, which reads it unchecked.
  */
 class TemplateTermMap : public TermMap {
 public:
+	/**
+	 * A parsed template: literal text runs and placeholders in template
+	 * order.  A placeholder's `slot` indexes `columns`, the distinct
+	 * placeholder names in order of first use (so also the ordinals given by
+	 * bindColumns()); literal segments have slot npos.  Parsing stops at an
+	 * unmatched '{', dropping the rest of the template.
+	 */
+	struct Plan {
+		static const std::size_t npos = static_cast<std::size_t>(-1);
+		struct Segment {
+			std::string text;
+			std::size_t slot;
+		};
+		std::vector<Segment> segments;
+		std::vector<std::string> columns;
+		/// Initial capacity for an expansion: the literal text plus a
+		/// typical value per placeholder.
+		std::size_t sizeHint {0};
+	};
+
 	TemplateTermMap() = default;
 	explicit TemplateTermMap(const std::string &templ);
 	~TemplateTermMap() override;
 
+	/** Set templateString to `templ` and parse it. */
+	void setTemplate(const std::string &templ);
+
+	/** The parsed form of templateString. */
+	const Plan &plan() const {
+		return plan_;
+	}
+
 	SerdNode generateRDFTerm(const SQLRow &row, const SerdEnv &env) const override;
 
+	void generateRDFTerms(const RowBatch &batch, const SerdEnv &env, TermBatch &out) const override;
+	void generateRDFTerms(const RowBatch &batch, const ColumnOrdinals &columns, const SerdEnv &env,
+	                      TermBatch &out) const override;
+
+	/**
+	 * Also re-parses templateString and records an IRI template's leading
+	 * literal text as a pool IRI prefix.
+	 */
+	void internConstants(ConstantPool &pool) override;
+
+	/** The {COLUMN} placeholders of the template, in order of first use. */
+	std::vector<std::string> referencedColumns() const override;
+
 	bool isValid() const override {
 		// templateString must not be empty
 		return !templateString.empty();
@@ -29,8 +77,12 @@ public:
 	std::string templateString;
 
 private:
-	/// Buffer for the last expanded URI; keeps buf pointer in returned SerdNode valid.
+	SerdType nodeType() const;
+	void buildPlan();
+
+	/// Buffer for the last generateRDFTerm() expansion; keeps buf pointer in returned SerdNode valid.
 	mutable std::string expanded_;
+	Plan plan_;
 };
 
 } // namespace r2rml
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <serd/serd.h>
+
+namespace r2rml {
+
+/**
+ * The RDF terms one term map produced for every row of a RowBatch.
+ *
+ * Terms are stored back to back in a single character buffer, so nodes are
+ * only materialised (via node()) once the whole batch has been generated and
+ * the buffer can no longer move.  A batch can also be a single constant node
+ * repeated for every row, which is how rr:constant term maps avoid copying
+ * their value 2048 times.  Like RowBatch, a TermBatch is meant to be reused
+ * across batches: clear() keeps capacity.
+ */
+class TermBatch {
+public:
+	/** Drop all terms, keeping buffer capacity. */
+	void clear();
+
+	/** Append the term for the next row. */
+	void append(SerdType type, const char *s, std::size_t n);
+	void append(SerdType type, const std::string &s) {
+		append(type, s.data(), s.size());
+	}
+	/** Append a copy of `node` (SERD_NOTHING appends a null). */
+	void append(const SerdNode &node);
+	/** Append a null term for a row that produces no RDF term. */
+	void appendNull();
+
+	/**
+	 * Make every row's term `node`, for `rows` rows.  The node's buffer must
+	 * outlive this batch's use (term maps pass their own constant).
+	 */
+	void setConstant(const SerdNode &node, std::size_t rows);
+
+	std::size_t size() const {
+		return constant_ ? constantRows_ : types_.size();
+	}
+	bool isNull(std::size_t row) const {
+		return constant_ ? constantNode_.type == SERD_NOTHING : types_[row] == SERD_NOTHING;
+	}
+
+	/** The term for row `row`; SERD_NODE_NULL for rows without a term. */
+	SerdNode node(std::size_t row) const;
+
+private:
+	std::string chars_;
+	std::vector<std::size_t> offsets_;
+	std::vector<SerdType> types_;
+	bool constant_ {false};
+	SerdNode constantNode_ = SERD_NODE_NULL;
+	std::size_t constantRows_ {0};
+};
+
+} // namespace r2rml
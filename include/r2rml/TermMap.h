@@ -2,21 +2,34 @@
 
 #include "AbstractMap.h"
 
+#include <cstddef>
 #include <string>
 #include <memory>
 #include <ostream>
+#include <vector>
 
 #include <serd/serd.h>
 
 namespace r2rml {
 
+class ConstantPool;
 class SQLRow;
+class RowBatch;
+class TermBatch;
 
 /**
  * Enumeration of possible term types in R2RML.
  */
 enum class TermType { IRI, BlankNode, Literal };
 
+/**
+ * Batch ordinals of the columns a term map reads: entry i is the position in
+ * a RowBatch of the term map's referencedColumns()[i], or RowBatch::npos when
+ * the batch has no such column.  Produced by TermMap::bindColumns() once per
+ * result schema, so per-row access never looks a column up by name.
+ */
+using ColumnOrdinals = std::vector<std::size_t>;
+
 /**
  * Abstract base class representing a term map (subject, predicate, object,
  * or graph).  Subclasses implement specific mapping strategies (constant,
@@ -31,6 +44,25 @@ public:
 	 */
 	virtual SerdNode generateRDFTerm(const SQLRow &row, const SerdEnv &env) const = 0;
 
+	/**
+	 * Produce the RDF term for every row of `batch` into `out` (cleared
+	 * first), one entry per row, with null entries where generateRDFTerm
+	 * would return a null node.  The base implementation calls
+	 * generateRDFTerm through a RowBatchRow view; column, template and
+	 * constant term maps override it to read the column buffers directly.
+	 */
+	virtual void generateRDFTerms(const RowBatch &batch, const SerdEnv &env, TermBatch &out) const;
+
+	/**
+	 * As generateRDFTerms(batch, env, out) with the columns already resolved:
+	 * `columns` is bindColumns() of a batch with the same schema as `batch`.
+	 * The base implementation ignores `columns` and calls the unbound
+	 * overload; column and template term maps override it and read the
+	 * bound ordinals directly.
+	 */
+	virtual void generateRDFTerms(const RowBatch &batch, const ColumnOrdinals &columns, const SerdEnv &env,
+	                              TermBatch &out) const;
+
 	/**
 	 * Validate that the term map instance has required properties and correct cardinality.
 	 * To be overridden by subclasses for specific validation logic.
@@ -48,6 +80,42 @@ public:
 	 */
 	virtual std::string computeDatatypeIRI(const SQLRow &row) const;
 
+	/**
+	 * computeDatatypeIRI(row) without the copy: the IRI is borrowed from this
+	 * term map or from `row` (see SQLRow::getDatatypeIRI()), so it is only
+	 * valid while the row is current.  Used on the per-row export path.
+	 */
+	virtual const std::string &datatypeIRIView(const SQLRow &row) const;
+
+	/**
+	 * Batch counterpart of computeDatatypeIRI(row): the datatype IRI shared by
+	 * every literal this term map produces from `batch`.  A result column's
+	 * type is fixed, so one answer covers the whole batch.
+	 */
+	virtual std::string computeDatatypeIRI(const RowBatch &batch) const;
+
+	/** computeDatatypeIRI(batch) with bound columns (see generateRDFTerms()). */
+	virtual std::string computeDatatypeIRI(const RowBatch &batch, const ColumnOrdinals &columns) const;
+
+	/**
+	 * Names of the logical-table columns this term map reads, in first-use
+	 * order without duplicates.  Empty for constants and for term maps that
+	 * don't describe their inputs (the base implementation).
+	 */
+	virtual std::vector<std::string> referencedColumns() const;
+
+	/** Resolve referencedColumns() against `batch`'s schema. */
+	ColumnOrdinals bindColumns(const RowBatch &batch) const;
+
+	/**
+	 * Intern this term map's constant terms into `pool` and keep the pooled
+	 * nodes (see R2RMLMapping::compile()).  The base implementation sets
+	 * datatypeNode and languageNode; constant term maps also swap their
+	 * value for the pooled node, and term maps that delegate to another
+	 * forward to it.
+	 */
+	virtual void internConstants(ConstantPool &pool);
+
 	/**
 	 * Write a human-readable representation to the given stream.
 	 * Subclasses should override this and call TermMap::print for base fields.
@@ -61,6 +129,11 @@ public:
 	std::unique_ptr<std::string> languageTag;
 	std::unique_ptr<std::string> datatypeIRI;
 	std::unique_ptr<std::string> inverseExpression;
+
+	/// datatypeIRI and languageTag as pooled nodes once internConstants()
+	/// has run; null nodes before that, or when the string is unset.
+	SerdNode datatypeNode {SERD_NODE_NULL};
+	SerdNode languageNode {SERD_NODE_NULL};
 };
 
 } // namespace r2rml
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "AbstractMap.h"
+#include "StatementSink.h"
 
 #include <memory>
 #include <ostream>
@@ -14,9 +15,13 @@ namespace r2rml {
 class LogicalTable;
 class SubjectMap;
 class PredicateObjectMap;
+class ReferencingObjectMap;
 class SQLRow;
 class SQLConnection;
 class R2RMLMapping;
+class RowBatch;
+class JoinIndexCache;
+class BoundTriplesMap;
 
 /**
  * A TriplesMap describes how each row of a logical table is converted into a
@@ -28,12 +33,41 @@ public:
 	~TriplesMap() override; // NOLINT(performance-trivially-destructible)
 
 	/**
-	 * Process the supplied row, emitting zero or more triples via the
-	 * SerdWriter object.  The mapping context may be needed for referencing
-	 * other maps (e.g. for referencing object maps).
+	 * Process the supplied row, emitting zero or more triples into the
+	 * StatementSink.  The mapping context may be needed for referencing
+	 * other maps (e.g. for referencing object maps), and `joinIndexes`, when
+	 * given, is used to evaluate those joins (see JoinIndexCache).
 	 */
+	void generateTriples(const SQLRow &row, StatementSink &rdfSink, const R2RMLMapping &mapping,
+	                     SQLConnection &dbConnection, JoinIndexCache *joinIndexes = nullptr) const;
+
+	/** As above, writing through a SerdWriter. */
 	void generateTriples(const SQLRow &row, SerdWriter &rdfWriter, const R2RMLMapping &mapping,
-	                     SQLConnection &dbConnection) const;
+	                     SQLConnection &dbConnection, JoinIndexCache *joinIndexes = nullptr) const;
+
+	/**
+	 * Batch counterpart of generateTriples(row, ...): generates the subject,
+	 * predicate, object and graph terms for every row of `batch` column by
+	 * column, then emits the triples in the same row-by-row order as calling
+	 * the per-row overload for each row.  Binds a fresh BoundTriplesMap on
+	 * every call; use one directly to convert a whole result set.
+	 */
+	void generateTriples(const RowBatch &batch, StatementSink &rdfSink, const R2RMLMapping &mapping,
+	                     SQLConnection &dbConnection, JoinIndexCache *joinIndexes = nullptr) const;
+
+	/** As above, writing through a SerdWriter. */
+	void generateTriples(const RowBatch &batch, SerdWriter &rdfWriter, const R2RMLMapping &mapping,
+	                     SQLConnection &dbConnection, JoinIndexCache *joinIndexes = nullptr) const;
+
+	/**
+	 * Emit the triples of `rom`, an object map of this TriplesMap's
+	 * predicate-object map `pom`, from a single database-side join: runs
+	 * rom.joinQuery() over this map's logical table and writes one triple per
+	 * joined row and predicate, into the graphs of the subject map and `pom`.
+	 * Writes nothing when the join can't be expressed in SQL.
+	 */
+	void generateJoinedTriples(const PredicateObjectMap &pom, const ReferencingObjectMap &rom, StatementSink &rdfSink,
+	                           const R2RMLMapping &mapping, SQLConnection &dbConnection) const;
 
 	bool isValid() const;
 
@@ -44,6 +78,15 @@ public:
 	 */
 	bool isValidInsideOut() const;
 
+	/**
+	 * Append to `columns` those a row of this TriplesMap is read through that
+	 * it doesn't hold yet, in first-use order: the columns of its term maps
+	 * and the child columns of its rr:joinConditions (not the parent's).
+	 * Returns false if a term map doesn't report its inputs, and so may read
+	 * any column.
+	 */
+	bool referencedColumns(std::vector<std::string> &columns) const;
+
 	std::ostream &print(std::ostream &os) const override;
 
 	friend std::ostream &operator<<(std::ostream &os, const TriplesMap &tm);
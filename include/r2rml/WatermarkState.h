@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace r2rml {
+
+/**
+ * The high-water marks of an incremental export (ExportOptions::watermarks):
+ * for each TriplesMap, by id, the highest watermarkColumn value of its
+ * logical table that an earlier run has exported.  An export reads the
+ * marks to select only newer rows and records the new ones as it finishes
+ * each TriplesMap; save() them once the export has succeeded, so a failed
+ * run is simply repeated.
+ *
+ * The state file is text, one "id<TAB>value" line per TriplesMap, with
+ * backslash, tab and newline escaped as \\, \t and \n.  Thread-safe.
+ */
+class WatermarkState {
+public:
+	WatermarkState() = default;
+
+	WatermarkState(const WatermarkState &) = delete;
+	WatermarkState &operator=(const WatermarkState &) = delete;
+
+	/**
+	 * Replace the marks with those saved at `path`.  A missing file is no
+	 * marks, i.e. a first run.  Throws std::runtime_error if the file can't
+	 * be read or is malformed.
+	 */
+	void load(const std::string &path);
+
+	/**
+	 * Write the marks to `path`, through a temporary file renamed over it so
+	 * a crash leaves the old state.  Throws std::runtime_error on failure.
+	 */
+	void save(const std::string &path) const;
+
+	/** The mark of `triplesMap` into `value`; false if it has none. */
+	bool get(const std::string &triplesMap, std::string &value) const;
+
+	/** Record `value` (non-empty) as the mark of `triplesMap`. */
+	void set(const std::string &triplesMap, const std::string &value);
+
+	std::size_t size() const;
+
+private:
+	mutable std::mutex mutex_;
+	std::map<std::string, std::string> marks_;
+};
+
+} // namespace r2rml
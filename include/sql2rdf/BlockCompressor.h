@@ -0,0 +1,134 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sql2rdf {
+
+/// Compression the CLI can apply to the RDF it writes.
+enum class Compression { None, Gzip, Zstd };
+
+/// The compression a file name asks for: ".gz" is Gzip, ".zst" Zstd,
+/// anything else None.
+Compression compressionForPath(const std::string &path);
+
+/// Parse a --compress argument: "none", "gzip" (or "gz"), "zstd" (or
+/// "zst").  Throws std::invalid_argument on anything else.
+Compression parseCompression(const std::string &name);
+
+/// Whether this build can write `compression`: Zstd needs libzstd when
+/// sql2rdf is configured, the others are always there.
+bool compressionAvailable(Compression compression);
+
+/// Compresses a byte stream into a FILE* on worker threads, the way pigz
+/// does: input is cut into fixed-size blocks, each compressed on its own
+/// by whichever worker is free, and the results are written strictly in
+/// order, so generating the data and writing it never wait on one
+/// compressor.
+///
+/// Gzip output is one ordinary gzip member: every block is raw deflate
+/// primed with the last 32 KiB of the block before it and ended on a byte
+/// boundary with a sync flush, so the blocks join up into a single deflate
+/// stream; the CRC-32 is combined from the blocks'.  Zstd output is one
+/// frame per block, which zstd reads back as one stream.
+///
+/// At most two blocks per worker are in flight; write() waits for the
+/// oldest one when that many are, so memory stays bounded however far the
+/// producer runs ahead.  Completed blocks are written by the thread calling
+/// write() or finish().  Not thread-safe itself: one producer only.
+class BlockCompressor {
+public:
+	/// Write `compression` to `file`, which must outlive the compressor and
+	/// is not closed by it.  `threads` is the number of compression workers
+	/// (0 = one per core).  Throws std::invalid_argument for None or a
+	/// compression this build can't write.
+	BlockCompressor(Compression compression, std::FILE *file, unsigned threads = 0,
+	                std::size_t blockSize = std::size_t(1) << 20);
+
+	/// Finishes the stream if finish() wasn't called, ignoring errors, and
+	/// stops the workers.
+	~BlockCompressor();
+
+	BlockCompressor(const BlockCompressor &) = delete;
+	BlockCompressor &operator=(const BlockCompressor &) = delete;
+
+	/// Append `size` bytes to the stream.  Throws std::runtime_error if a
+	/// block failed to compress or the file can't be written.
+	void write(const void *data, std::size_t size);
+
+	/// Compress and write what is left, end the stream and flush the file.
+	/// Throws as write() does, including for an error a SerdSink call to
+	/// sink() had to swallow.  Later calls do nothing.
+	void finish();
+
+	/// SerdSink writing to the BlockCompressor at `stream`.  Errors can't
+	/// cross Serd's C frames, so one is kept for finish() to throw and 0
+	/// is returned, which the writers report as a short write.
+	static std::size_t sink(const void *buf, std::size_t len, void *stream);
+
+	/// Uncompressed bytes taken so far.
+	unsigned long long bytesIn() const {
+		return bytesIn_;
+	}
+
+	/// Compressed bytes written to the file so far.
+	unsigned long long bytesOut() const {
+		return bytesOut_;
+	}
+
+private:
+	struct Block {
+		std::string input;
+		/// Gzip: up to 32 KiB of input preceding this block.
+		std::string dictionary;
+		std::string output;
+		std::size_t inputSize {0};
+		unsigned long crc {0};
+		bool last {false};
+		bool done {false};
+		std::exception_ptr error;
+	};
+
+	void submit(bool last);
+	void drain(std::unique_lock<std::mutex> &lock, bool all);
+	void emit(Block &block);
+	void compress(Block &block) const;
+	void writeFile(const void *data, std::size_t size);
+	void work();
+
+	Compression compression_;
+	std::FILE *file_;
+	std::size_t blockSize_;
+	std::size_t maxInFlight_;
+	std::string current_;
+	/// Last 32 KiB of input submitted so far (Gzip only).
+	std::string window_;
+	unsigned long crc_ {0};
+	unsigned long long bytesIn_ {0};
+	unsigned long long bytesOut_ {0};
+	bool started_ {false};
+	bool finished_ {false};
+	/// A block failed to compress or write; nothing more goes out.
+	bool failed_ {false};
+	std::exception_ptr sinkError_;
+
+	std::mutex mutex_;
+	std::condition_variable work_;
+	std::condition_variable done_;
+	/// Blocks submitted and not yet written, oldest first.
+	std::deque<std::unique_ptr<Block>> inFlight_;
+	/// Blocks no worker has picked up yet.
+	std::deque<Block *> todo_;
+	bool stopping_ {false};
+	std::vector<std::thread> workers_;
+};
+
+} // namespace sql2rdf
@@ -0,0 +1,319 @@
+#include "sql2rdf/BlockCompressor.h"
+
+#include <zlib.h>
+#ifdef SQL2RDF_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <utility>
+
+namespace sql2rdf {
+
+namespace {
+
+/// Deflate's window: how much earlier input a block may refer back to.
+const std::size_t windowSize = 32768;
+
+bool endsWith(const std::string &s, const std::string &suffix) {
+	return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void putLittleEndian32(unsigned char *out, unsigned long value) {
+	for (int i = 0; i < 4; ++i) {
+		out[i] = static_cast<unsigned char>((value >> (8 * i)) & 0xff);
+	}
+}
+
+void deflateBlock(const std::string &input, const std::string &dictionary, bool last, std::string &output) {
+	z_stream stream {};
+	if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+		throw std::runtime_error("cannot initialize gzip compression");
+	}
+	struct End {
+		z_stream &stream;
+		~End() {
+			deflateEnd(&stream);
+		}
+	} end {stream};
+	if (!dictionary.empty() &&
+	    deflateSetDictionary(&stream, reinterpret_cast<const Bytef *>(dictionary.data()),
+	                         static_cast<uInt>(dictionary.size())) != Z_OK) {
+		throw std::runtime_error("cannot prime gzip compression with the previous block");
+	}
+
+	stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+	stream.avail_in = static_cast<uInt>(input.size());
+	// The bound leaves out the sync flush's empty stored block; a little
+	// slack covers it, and the loop grows the buffer if that falls short.
+	output.resize(deflateBound(&stream, static_cast<uLong>(input.size())) + 64);
+	const int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+	std::size_t used = 0;
+	for (;;) {
+		stream.next_out = reinterpret_cast<Bytef *>(&output[used]);
+		stream.avail_out = static_cast<uInt>(output.size() - used);
+		int rc = deflate(&stream, flush);
+		used = output.size() - stream.avail_out;
+		if (rc == Z_STREAM_END || (!last && rc == Z_OK && stream.avail_in == 0 && stream.avail_out != 0)) {
+			break;
+		}
+		if (rc != Z_OK && rc != Z_BUF_ERROR) {
+			throw std::runtime_error("gzip compression failed");
+		}
+		output.resize(output.size() * 2);
+	}
+	output.resize(used);
+}
+
+#ifdef SQL2RDF_HAVE_ZSTD
+const int zstdLevel = 3;
+
+void zstdBlock(const std::string &input, std::string &output) {
+	output.resize(ZSTD_compressBound(input.size()));
+	std::size_t size = ZSTD_compress(&output[0], output.size(), input.data(), input.size(), zstdLevel);
+	if (ZSTD_isError(size)) {
+		throw std::runtime_error(std::string("zstd compression failed: ") + ZSTD_getErrorName(size));
+	}
+	output.resize(size);
+}
+#endif
+
+} // namespace
+
+Compression compressionForPath(const std::string &path) {
+	std::string lower = path;
+	std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+	if (endsWith(lower, ".gz")) {
+		return Compression::Gzip;
+	}
+	if (endsWith(lower, ".zst")) {
+		return Compression::Zstd;
+	}
+	return Compression::None;
+}
+
+Compression parseCompression(const std::string &name) {
+	if (name == "none") {
+		return Compression::None;
+	}
+	if (name == "gzip" || name == "gz") {
+		return Compression::Gzip;
+	}
+	if (name == "zstd" || name == "zst") {
+		return Compression::Zstd;
+	}
+	throw std::invalid_argument("unknown compression '" + name + "' (use gzip, zstd or none)");
+}
+
+bool compressionAvailable(Compression compression) {
+#ifdef SQL2RDF_HAVE_ZSTD
+	(void)compression;
+	return true;
+#else
+	return compression != Compression::Zstd;
+#endif
+}
+
+BlockCompressor::BlockCompressor(Compression compression, std::FILE *file, unsigned threads, std::size_t blockSize)
+    : compression_(compression), file_(file), blockSize_(std::max<std::size_t>(blockSize, 1)) {
+	if (compression == Compression::None) {
+		throw std::invalid_argument("BlockCompressor needs a compression other than none");
+	}
+	if (!compressionAvailable(compression)) {
+		throw std::invalid_argument("this build of sql2rdf cannot write zstd (libzstd was not found)");
+	}
+	if (threads == 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	maxInFlight_ = 2 * threads;
+	current_.reserve(blockSize_);
+	for (unsigned i = 0; i < threads; ++i) {
+		workers_.emplace_back(&BlockCompressor::work, this);
+	}
+}
+
+BlockCompressor::~BlockCompressor() {
+	try {
+		finish();
+	} catch (...) {
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+	work_.notify_all();
+	for (std::thread &worker : workers_) {
+		worker.join();
+	}
+}
+
+void BlockCompressor::write(const void *data, std::size_t size) {
+	if (finished_) {
+		throw std::logic_error("BlockCompressor::write() after finish()");
+	}
+	const char *bytes = static_cast<const char *>(data);
+	while (size) {
+		std::size_t take = std::min(size, blockSize_ - current_.size());
+		current_.append(bytes, take);
+		bytes += take;
+		size -= take;
+		bytesIn_ += take;
+		if (current_.size() == blockSize_) {
+			submit(false);
+		}
+	}
+}
+
+void BlockCompressor::finish() {
+	if (finished_) {
+		return;
+	}
+	finished_ = true;
+	if (sinkError_) {
+		std::rethrow_exception(sinkError_);
+	}
+	submit(true);
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		drain(lock, true);
+	}
+	if (std::fflush(file_) != 0) {
+		throw std::runtime_error("cannot write compressed output");
+	}
+}
+
+std::size_t BlockCompressor::sink(const void *buf, std::size_t len, void *stream) {
+	BlockCompressor *self = static_cast<BlockCompressor *>(stream);
+	if (self->sinkError_) {
+		return 0;
+	}
+	try {
+		self->write(buf, len);
+		return len;
+	} catch (...) {
+		self->sinkError_ = std::current_exception();
+		return 0;
+	}
+}
+
+void BlockCompressor::submit(bool last) {
+	if (failed_) {
+		throw std::runtime_error("cannot write compressed output after an earlier error");
+	}
+	std::unique_ptr<Block> block(new Block);
+	block->input.swap(current_);
+	block->last = last;
+	if (compression_ == Compression::Gzip) {
+		block->dictionary = window_;
+		const std::size_t tail = std::min(block->input.size(), windowSize);
+		window_.append(block->input, block->input.size() - tail, tail);
+		if (window_.size() > windowSize) {
+			window_.erase(0, window_.size() - windowSize);
+		}
+	}
+	if (!last) {
+		current_.reserve(blockSize_);
+	}
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	todo_.push_back(block.get());
+	inFlight_.push_back(std::move(block));
+	work_.notify_one();
+	drain(lock, false);
+}
+
+void BlockCompressor::drain(std::unique_lock<std::mutex> &lock, bool all) {
+	while (!inFlight_.empty()) {
+		Block &front = *inFlight_.front();
+		if (!front.done) {
+			if (!all && inFlight_.size() <= maxInFlight_) {
+				return;
+			}
+			done_.wait(lock, [&front] { return front.done; });
+		}
+		std::unique_ptr<Block> block = std::move(inFlight_.front());
+		inFlight_.pop_front();
+		lock.unlock();
+		try {
+			emit(*block);
+		} catch (...) {
+			// the stream has a hole now; don't write anything after it
+			failed_ = true;
+			lock.lock();
+			throw;
+		}
+		lock.lock();
+	}
+}
+
+void BlockCompressor::emit(Block &block) {
+	if (block.error) {
+		std::rethrow_exception(block.error);
+	}
+	if (compression_ == Compression::Gzip && !started_) {
+		// magic, deflate, no flags, no mtime, no extra flags, Unix
+		const unsigned char header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3};
+		writeFile(header, sizeof(header));
+	}
+	started_ = true;
+	writeFile(block.output.data(), block.output.size());
+	if (compression_ == Compression::Gzip) {
+		crc_ = crc32_combine(crc_, block.crc, static_cast<z_off_t>(block.inputSize));
+		if (block.last) {
+			unsigned char trailer[8];
+			putLittleEndian32(trailer, crc_);
+			putLittleEndian32(trailer + 4, static_cast<unsigned long>(bytesIn_ & 0xffffffffULL));
+			writeFile(trailer, sizeof(trailer));
+		}
+	}
+}
+
+void BlockCompressor::compress(Block &block) const {
+	block.inputSize = block.input.size();
+	if (compression_ == Compression::Gzip) {
+		block.crc = crc32(0L, reinterpret_cast<const Bytef *>(block.input.data()), static_cast<uInt>(block.inputSize));
+		deflateBlock(block.input, block.dictionary, block.last, block.output);
+	} else {
+#ifdef SQL2RDF_HAVE_ZSTD
+		zstdBlock(block.input, block.output);
+#endif
+	}
+	std::string().swap(block.input);
+	std::string().swap(block.dictionary);
+}
+
+void BlockCompressor::writeFile(const void *data, std::size_t size) {
+	if (size && std::fwrite(data, 1, size, file_) != size) {
+		throw std::runtime_error("cannot write compressed output");
+	}
+	bytesOut_ += size;
+}
+
+void BlockCompressor::work() {
+	for (;;) {
+		Block *block;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			work_.wait(lock, [this] { return stopping_ || !todo_.empty(); });
+			if (todo_.empty()) {
+				return;
+			}
+			block = todo_.front();
+			todo_.pop_front();
+		}
+		try {
+			compress(*block);
+		} catch (...) {
+			block->error = std::current_exception();
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			block->done = true;
+		}
+		done_.notify_all();
+	}
+}
+
+} // namespace sql2rdf
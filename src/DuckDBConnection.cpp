@@ -1,20 +1,78 @@
 #include "DuckDBConnection.h"
+#include "DuckDBVectors.h"
 #include "r2rml/MapSQLRow.h"
+#include "r2rml/RowBatch.h"
 #include "r2rml/SQLResultSet.h"
 #include "r2rml/SQLRow.h"
 #include "r2rml/SQLValue.h"
+#include "r2rml/StringSQLValue.h"
 
 #include "duckdb.hpp"
 
 #include <algorithm>
 #include <cctype>
+#include <deque>
 #include <map>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace r2rml {
 
+// ---------------------------------------------------------------------------
+// Value conversion
+//
+// The SQLValue::Type and lexical form of a non-null duckdb::Value, shared by
+// DuckDBSQLValue and the borrowing DuckDBChunkRow::getValueView().
+// ---------------------------------------------------------------------------
+namespace {
+
+SQLValue::Type convertValue(const duckdb::Value &val, std::string &out) {
+	switch (val.type().id()) {
+	case duckdb::LogicalTypeId::BOOLEAN:
+		out = val.GetValue<bool>() ? "true" : "false";
+		return SQLValue::Type::Boolean;
+
+	case duckdb::LogicalTypeId::TINYINT:
+	case duckdb::LogicalTypeId::SMALLINT:
+	case duckdb::LogicalTypeId::INTEGER:
+	case duckdb::LogicalTypeId::UTINYINT:
+	case duckdb::LogicalTypeId::USMALLINT:
+	case duckdb::LogicalTypeId::UINTEGER:
+		out = std::to_string(val.GetValue<int32_t>());
+		return SQLValue::Type::Integer;
+
+	// BIGINT and larger: store as string to avoid precision loss
+	case duckdb::LogicalTypeId::BIGINT:
+	case duckdb::LogicalTypeId::UBIGINT:
+	case duckdb::LogicalTypeId::HUGEINT:
+		out = val.ToString();
+		return SQLValue::Type::String;
+
+	case duckdb::LogicalTypeId::FLOAT:
+		out = std::to_string(static_cast<double>(val.GetValue<float>()));
+		return SQLValue::Type::Double;
+
+	case duckdb::LogicalTypeId::DOUBLE:
+		out = std::to_string(val.GetValue<double>());
+		return SQLValue::Type::Double;
+
+	case duckdb::LogicalTypeId::VARCHAR:
+	case duckdb::LogicalTypeId::BLOB:
+		out = val.GetValue<std::string>();
+		return SQLValue::Type::String;
+
+	default:
+		// Dates, timestamps, decimals, etc.: use string representation
+		out = val.ToString();
+		return SQLValue::Type::String;
+	}
+}
+
+} // namespace
+
 // ---------------------------------------------------------------------------
 // DuckDBSQLValue
 //
@@ -23,8 +81,9 @@ namespace r2rml {
 // ---------------------------------------------------------------------------
 class DuckDBSQLValue : public SQLValue {
 public:
-	explicit DuckDBSQLValue(duckdb::Value val) // NOLINT(performance-unnecessary-value-param)
-	    : val_(std::move(val)) {
+	// NOLINTNEXTLINE(performance-unnecessary-value-param)
+	DuckDBSQLValue(duckdb::Value val, std::string datatypeIRI)
+	    : val_(std::move(val)), datatypeIRI_(std::move(datatypeIRI)) {
 	}
 
 	bool isNull() const override {
@@ -42,11 +101,16 @@ public:
 	}
 
 	std::unique_ptr<SQLValue> clone() const override {
-		return std::unique_ptr<SQLValue>(new DuckDBSQLValue(val_));
+		return std::unique_ptr<SQLValue>(new DuckDBSQLValue(val_, datatypeIRI_));
+	}
+
+	std::string datatypeIRI() const override {
+		return val_.IsNull() ? std::string() : datatypeIRI_;
 	}
 
 private:
 	duckdb::Value val_;
+	std::string datatypeIRI_; ///< the column's (see literalDatatypeOf())
 	mutable Type type_ {Type::Null};
 	mutable std::string string_;
 	mutable bool converted_ {false};
@@ -56,101 +120,281 @@ private:
 			return;
 		}
 		converted_ = true;
+		if (!val_.IsNull()) {
+			type_ = convertValue(val_, string_);
+		}
+	}
+};
 
-		if (val_.IsNull()) {
-			type_ = Type::Null;
-			return;
+// ---------------------------------------------------------------------------
+// DuckDBColumnIndex
+//
+// Column names of one query result, upper-cased once, plus the name -> column
+// lookup shared by every row view over that result.  When a result repeats a
+// column name the last occurrence wins, as it always has.  Each column's
+// literal datatype is decided here too, once for the whole result.
+// ---------------------------------------------------------------------------
+struct DuckDBColumnIndex {
+	std::vector<std::string> names;
+	std::vector<std::string> datatypes;
+	std::map<std::string, duckdb::idx_t> byName;
+
+	DuckDBColumnIndex(const std::vector<std::string> &resultNames, const std::vector<duckdb::LogicalType> &types) {
+		names.reserve(resultNames.size());
+		datatypes.reserve(types.size());
+		for (duckdb::idx_t col = 0; col < resultNames.size(); ++col) {
+			std::string colName = resultNames[col];
+			std::transform(colName.begin(), colName.end(), colName.begin(),
+			               [](unsigned char c) { return std::toupper(c); });
+			byName[colName] = col;
+			names.push_back(std::move(colName));
+			datatypes.push_back(literalDatatypeOf(types[col]));
 		}
+	}
 
-		switch (val_.type().id()) {
-		case duckdb::LogicalTypeId::BOOLEAN:
-			type_ = Type::Boolean;
-			string_ = val_.GetValue<bool>() ? "true" : "false";
-			break;
-
-		case duckdb::LogicalTypeId::TINYINT:
-		case duckdb::LogicalTypeId::SMALLINT:
-		case duckdb::LogicalTypeId::INTEGER:
-		case duckdb::LogicalTypeId::UTINYINT:
-		case duckdb::LogicalTypeId::USMALLINT:
-		case duckdb::LogicalTypeId::UINTEGER:
-			type_ = Type::Integer;
-			string_ = std::to_string(val_.GetValue<int32_t>());
-			break;
-
-		// BIGINT and larger: store as string to avoid precision loss
-		case duckdb::LogicalTypeId::BIGINT:
-		case duckdb::LogicalTypeId::UBIGINT:
-		case duckdb::LogicalTypeId::HUGEINT:
-			type_ = Type::String;
-			string_ = val_.ToString();
-			break;
-
-		case duckdb::LogicalTypeId::FLOAT:
-			type_ = Type::Double;
-			string_ = std::to_string(static_cast<double>(val_.GetValue<float>()));
-			break;
-
-		case duckdb::LogicalTypeId::DOUBLE:
-			type_ = Type::Double;
-			string_ = std::to_string(val_.GetValue<double>());
-			break;
-
-		case duckdb::LogicalTypeId::VARCHAR:
-		case duckdb::LogicalTypeId::BLOB:
-			type_ = Type::String;
-			string_ = val_.GetValue<std::string>();
-			break;
-
-		default:
-			// Dates, timestamps, decimals, etc.: use string representation
-			type_ = Type::String;
-			string_ = val_.ToString();
-			break;
+	/** Returns false when the result has no such column. */
+	bool find(const std::string &columnName, duckdb::idx_t &col) const {
+		auto it = byName.find(columnName);
+		if (it == byName.end()) {
+			return false;
 		}
+		col = it->second;
+		return true;
 	}
 };
 
+// ---------------------------------------------------------------------------
+// DuckDBChunkRow
+//
+// A row view over one position of a (flattened) DataChunk.  Values are only
+// wrapped when asked for, so unreferenced columns cost nothing, and
+// getValueView() reads them without allocating a DuckDBSQLValue.  The view is
+// repositioned by the owning result set on every next(); clone() produces a
+// MapSQLRow that no longer depends on the chunk.
+// ---------------------------------------------------------------------------
+class DuckDBChunkRow : public SQLRow {
+public:
+	explicit DuckDBChunkRow(const DuckDBColumnIndex &columns) : columns_(columns), scratch_(columns.names.size()) {
+	}
+
+	void reset(duckdb::DataChunk *chunk, duckdb::idx_t row) {
+		chunk_ = chunk;
+		row_ = row;
+	}
+
+	std::unique_ptr<SQLValue> getValue(const std::string &columnName) const override {
+		duckdb::idx_t col;
+		if (!columns_.find(columnName, col)) {
+			return std::unique_ptr<SQLValue>(new StringSQLValue());
+		}
+		return std::unique_ptr<SQLValue>(new DuckDBSQLValue(chunk_->GetValue(col, row_), columns_.datatypes[col]));
+	}
+
+	SQLValueView getValueView(const std::string &columnName) const override {
+		duckdb::idx_t col;
+		if (!columns_.find(columnName, col)) {
+			return SQLValueView();
+		}
+		duckdb::Vector &vec = chunk_->data[col];
+		if (duckdb::FlatVector::IsNull(vec, row_)) {
+			return SQLValueView();
+		}
+		// Strings are borrowed from the chunk itself; everything else is
+		// rendered into this column's scratch buffer.
+		if (vec.GetType().id() == duckdb::LogicalTypeId::VARCHAR) {
+			const duckdb::string_t &s = duckdb::FlatVector::GetData<duckdb::string_t>(vec)[row_];
+			return SQLValueView(SQLValue::Type::String, s.GetData(), s.GetSize());
+		}
+		std::string &text = scratch_[col];
+		SQLValue::Type type = convertValue(vec.GetValue(row_), text);
+		return SQLValueView(type, text);
+	}
+
+	const std::string &getDatatypeIRI(const std::string &columnName) const override {
+		static const std::string none;
+		duckdb::idx_t col;
+		if (!columns_.find(columnName, col) || duckdb::FlatVector::IsNull(chunk_->data[col], row_)) {
+			return none;
+		}
+		return columns_.datatypes[col];
+	}
+
+	bool isNull(const std::string &columnName) const override {
+		duckdb::idx_t col;
+		if (!columns_.find(columnName, col)) {
+			return true;
+		}
+		return duckdb::FlatVector::IsNull(chunk_->data[col], row_);
+	}
+
+	std::vector<std::string> columnNames() const override {
+		std::vector<std::string> names;
+		names.reserve(columns_.byName.size());
+		for (const auto &p : columns_.byName) {
+			names.push_back(p.first);
+		}
+		return names;
+	}
+
+	std::unique_ptr<SQLRow> clone() const override {
+		std::map<std::string, std::unique_ptr<SQLValue>> cloned;
+		for (const auto &p : columns_.byName) {
+			cloned[p.first] = std::unique_ptr<SQLValue>(
+			    new DuckDBSQLValue(chunk_->GetValue(p.second, row_), columns_.datatypes[p.second]));
+		}
+		return std::unique_ptr<SQLRow>(new MapSQLRow(std::move(cloned)));
+	}
+
+private:
+	const DuckDBColumnIndex &columns_;
+	duckdb::DataChunk *chunk_ {nullptr};
+	duckdb::idx_t row_ {0};
+	/// Per-column lexical forms of non-string values handed out by getValueView().
+	mutable std::vector<std::string> scratch_;
+};
+
 // ---------------------------------------------------------------------------
 // DuckDBResultSet
 //
-// Materialises all rows from a query result into memory, then iterates
-// over them.  This avoids keeping the DuckDB result object alive across
-// calls to next()/getCurrentRow() and keeps the interface simple.
+// Iterates a duckdb::QueryResult one DataChunk at a time.  While streaming,
+// the result object is kept alive and Fetch() is only called once the rows of
+// the current chunk are used up.  Chunks fetched ahead of time (materialized
+// mode, or a stream that had to be detached because the connection ran
+// another query) wait in buffered_.
 // ---------------------------------------------------------------------------
 class DuckDBResultSet : public SQLResultSet {
 public:
-	explicit DuckDBResultSet(std::vector<MapSQLRow> rows) : rows_(std::move(rows)) {
+	DuckDBResultSet(duckdb::unique_ptr<duckdb::QueryResult> result, DuckDBResultSet **activeSlot)
+	    : result_(std::move(result)), columns_(result_->names, result_->types), row_(columns_),
+	      activeSlot_(activeSlot) {
 	}
 
+	~DuckDBResultSet() override {
+		if (activeSlot_ && *activeSlot_ == this) {
+			*activeSlot_ = nullptr;
+		}
+	}
+
+	DuckDBResultSet(const DuckDBResultSet &) = delete;
+	DuckDBResultSet &operator=(const DuckDBResultSet &) = delete;
+
 	bool next() override {
-		return ++cursor_ < static_cast<int>(rows_.size());
+		if (current_ && ++rowInChunk_ < current_->size()) {
+			row_.reset(current_.get(), rowInChunk_);
+			return true;
+		}
+		current_ = nextChunk();
+		if (!current_) {
+			return false;
+		}
+		rowInChunk_ = 0;
+		row_.reset(current_.get(), rowInChunk_);
+		return true;
 	}
 
 	const SQLRow &getCurrentRow() const override {
-		return rows_[static_cast<size_t>(cursor_)];
+		return row_;
+	}
+
+	bool nextBatch(RowBatch &batch, std::size_t maxRows) override {
+		batch.reset();
+		if (!current_ || batchPos_ >= current_->size()) {
+			current_ = nextChunk();
+			batchPos_ = 0;
+			if (!current_) {
+				return false;
+			}
+		}
+		duckdb::idx_t count = std::min<duckdb::idx_t>(maxRows, current_->size() - batchPos_);
+		chunkToBatch(*current_, batchPos_, count, columns_.names, columns_.datatypes, batch);
+		batchPos_ += count;
+		return true;
+	}
+
+	/** Pull every remaining chunk into memory and release the DuckDB result,
+	 *  freeing the connection for another query. */
+	void drain() {
+		while (result_) {
+			auto chunk = fetchFromResult();
+			if (!chunk) {
+				break;
+			}
+			buffered_.push_back(std::move(chunk));
+		}
 	}
 
 private:
-	std::vector<MapSQLRow> rows_;
-	int cursor_ {-1};
+	duckdb::unique_ptr<duckdb::QueryResult> result_;
+	DuckDBColumnIndex columns_;
+	DuckDBChunkRow row_;
+	DuckDBResultSet **activeSlot_;
+	std::deque<std::unique_ptr<duckdb::DataChunk>> buffered_;
+	std::unique_ptr<duckdb::DataChunk> current_;
+	duckdb::idx_t rowInChunk_ {0};
+	duckdb::idx_t batchPos_ {0};
+
+	std::unique_ptr<duckdb::DataChunk> nextChunk() {
+		if (!buffered_.empty()) {
+			auto chunk = std::move(buffered_.front());
+			buffered_.pop_front();
+			return chunk;
+		}
+		return fetchFromResult();
+	}
+
+	/** Next non-empty, flattened chunk from DuckDB, or null once exhausted
+	 *  (at which point the result is released). */
+	std::unique_ptr<duckdb::DataChunk> fetchFromResult() {
+		if (!result_) {
+			return nullptr;
+		}
+		auto chunk = result_->Fetch();
+		if (!chunk || chunk->size() == 0) {
+			bool failed = result_->HasError();
+			std::string error = failed ? result_->GetError() : std::string();
+			result_.reset();
+			if (activeSlot_ && *activeSlot_ == this) {
+				*activeSlot_ = nullptr;
+			}
+			if (failed) {
+				throw std::runtime_error("DuckDB query error: " + error);
+			}
+			return nullptr;
+		}
+		chunk->Flatten();
+		return std::unique_ptr<duckdb::DataChunk>(chunk.release());
+	}
 };
 
 // ---------------------------------------------------------------------------
 // DuckDBConnection::Impl
 // ---------------------------------------------------------------------------
 struct DuckDBConnection::Impl {
-	duckdb::DuckDB db;
+	/// Shared by every connection made with connect().
+	std::shared_ptr<duckdb::DuckDB> db;
 	duckdb::Connection con;
+	FetchMode fetchMode;
+	/// The result set currently streaming from con, if any.
+	DuckDBResultSet *activeStream {nullptr};
 
-	explicit Impl(const std::string &path) : db(path), con(db) {
+	Impl(std::shared_ptr<duckdb::DuckDB> database, FetchMode mode)
+	    : db(std::move(database)), con(*db), fetchMode(mode) {
 	}
 };
 
 // ---------------------------------------------------------------------------
 // DuckDBConnection
 // ---------------------------------------------------------------------------
-DuckDBConnection::DuckDBConnection(const std::string &path) : impl_(new Impl(path)) {
+DuckDBConnection::DuckDBConnection(const std::string &path, FetchMode fetchMode)
+    : impl_(new Impl(std::make_shared<duckdb::DuckDB>(path), fetchMode)) {
+}
+
+DuckDBConnection::DuckDBConnection(std::unique_ptr<Impl> impl) : impl_(std::move(impl)) {
+}
+
+std::unique_ptr<DuckDBConnection> DuckDBConnection::connect() const {
+	return std::unique_ptr<DuckDBConnection>(
+	    new DuckDBConnection(std::unique_ptr<Impl>(new Impl(impl_->db, impl_->fetchMode))));
 }
 
 DuckDBConnection::~DuckDBConnection() = default;
@@ -160,33 +404,30 @@ std::string DuckDBConnection::getDefaultSchema() {
 }
 
 std::unique_ptr<SQLResultSet> DuckDBConnection::execute(const std::string &sqlQuery) {
-	auto result = impl_->con.Query(sqlQuery);
+	// DuckDB invalidates an open stream as soon as the connection runs
+	// another query, so park whatever the current stream has left first.
+	if (impl_->activeStream) {
+		impl_->activeStream->drain();
+	}
+
+	duckdb::unique_ptr<duckdb::QueryResult> result;
+	if (impl_->fetchMode == FetchMode::Streaming) {
+		result = impl_->con.SendQuery(sqlQuery);
+	} else {
+		result = impl_->con.Query(sqlQuery);
+	}
 
 	if (result->HasError()) {
 		throw std::runtime_error("DuckDB query error: " + result->GetError());
 	}
 
-	std::vector<MapSQLRow> rows;
-
-	while (true) {
-		auto chunk = result->Fetch();
-		if (!chunk || chunk->size() == 0) {
-			break;
-		}
-
-		for (duckdb::idx_t row = 0; row < chunk->size(); ++row) {
-			std::map<std::string, std::unique_ptr<SQLValue>> columns;
-			for (duckdb::idx_t col = 0; col < chunk->ColumnCount(); ++col) {
-				std::string colName = result->ColumnName(col);
-				std::transform(colName.begin(), colName.end(), colName.begin(),
-				               [](unsigned char c) { return std::toupper(c); });
-				columns[colName] = std::unique_ptr<SQLValue>(new DuckDBSQLValue(chunk->GetValue(col, row)));
-			}
-			rows.emplace_back(std::move(columns));
-		}
+	std::unique_ptr<DuckDBResultSet> rs(new DuckDBResultSet(std::move(result), &impl_->activeStream));
+	if (impl_->fetchMode == FetchMode::Streaming) {
+		impl_->activeStream = rs.get();
+	} else {
+		rs->drain();
 	}
-
-	return std::unique_ptr<SQLResultSet>(new DuckDBResultSet(std::move(rows)));
+	return std::unique_ptr<SQLResultSet>(rs.release());
 }
 
 } // namespace r2rml
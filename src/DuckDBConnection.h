@@ -16,16 +16,40 @@ namespace r2rml {
  *   DuckDBConnection conn("path/to/database.db");
  *   // or in-memory:
  *   DuckDBConnection conn(":memory:");
+ *
+ * Result sets stream by default: execute() returns as soon as DuckDB has
+ * planned the query, and each DataChunk (one vector, ~2048 rows) is fetched
+ * only when next() runs past the previous one, so peak memory follows the
+ * chunk size rather than the table size.  DuckDB allows a single open stream
+ * per connection; executing another query while a stream is still being read
+ * buffers that stream's remaining chunks first, so nested queries (e.g.
+ * rr:refObjectMap joins) keep working.  Result sets must not outlive the
+ * connection that produced them.
  */
 class DuckDBConnection : public SQLConnection {
 public:
+	/** How execute() pulls rows out of DuckDB. */
+	enum class FetchMode {
+		Streaming,   ///< fetch one DataChunk at a time as next() is called (default)
+		Materialized ///< drain the whole result into memory before returning
+	};
+
 	/**
 	 * Open (or create) the DuckDB database at the given file path.
 	 * Pass ":memory:" for a transient in-memory database.
 	 */
-	explicit DuckDBConnection(const std::string &path);
+	explicit DuckDBConnection(const std::string &path, FetchMode fetchMode = FetchMode::Streaming);
 	~DuckDBConnection() override;
 
+	/**
+	 * Open another connection to the same database (including a ":memory:"
+	 * one), with the same fetch mode.  DuckDB lets each connection run
+	 * queries on its own thread; opening the database file a second time
+	 * instead would fail on its lock.  The database stays open until every
+	 * connection to it is destroyed.
+	 */
+	std::unique_ptr<DuckDBConnection> connect() const;
+
 	std::unique_ptr<SQLResultSet> execute(const std::string &sqlQuery) override;
 
 	/** Returns "main", DuckDB's default schema name. */
@@ -33,6 +57,8 @@ public:
 
 private:
 	struct Impl;
+	explicit DuckDBConnection(std::unique_ptr<Impl> impl);
+
 	std::unique_ptr<Impl> impl_;
 };
 
@@ -0,0 +1,148 @@
+#include "DuckDBVectors.h"
+#include "sparql2sql/TermInfo.h"
+#include "sparql2sql/TypeCatalog.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace r2rml {
+
+// ---------------------------------------------------------------------------
+// DataChunk -> RowBatch conversion
+//
+// Column-at-a-time equivalent of DuckDBConnection.cpp's convertValue(): same
+// SQLValue::Type per logical type and the same lexical forms, but read
+// straight out of the flat vector instead of through a duckdb::Value per cell.
+// ---------------------------------------------------------------------------
+SQLValue::Type valueTypeOf(const duckdb::LogicalType &type) {
+	switch (type.id()) {
+	case duckdb::LogicalTypeId::BOOLEAN:
+		return SQLValue::Type::Boolean;
+	case duckdb::LogicalTypeId::TINYINT:
+	case duckdb::LogicalTypeId::SMALLINT:
+	case duckdb::LogicalTypeId::INTEGER:
+	case duckdb::LogicalTypeId::UTINYINT:
+	case duckdb::LogicalTypeId::USMALLINT:
+	case duckdb::LogicalTypeId::UINTEGER:
+		return SQLValue::Type::Integer;
+	case duckdb::LogicalTypeId::FLOAT:
+	case duckdb::LogicalTypeId::DOUBLE:
+		return SQLValue::Type::Double;
+	default:
+		return SQLValue::Type::String;
+	}
+}
+
+namespace {
+
+template <class T>
+void appendIntegers(duckdb::Vector &vec, duckdb::idx_t offset, duckdb::idx_t count, RowBatch::Column &out) {
+	const T *data = duckdb::FlatVector::GetData<T>(vec);
+	for (duckdb::idx_t i = offset; i < offset + count; ++i) {
+		if (duckdb::FlatVector::IsNull(vec, i)) {
+			out.appendNull();
+		} else {
+			out.append(std::to_string(data[i]));
+		}
+	}
+}
+
+} // namespace
+
+void appendVector(duckdb::Vector &vec, duckdb::idx_t offset, duckdb::idx_t count, RowBatch::Column &out) {
+	switch (vec.GetType().id()) {
+	case duckdb::LogicalTypeId::BOOLEAN: {
+		const bool *data = duckdb::FlatVector::GetData<bool>(vec);
+		for (duckdb::idx_t i = offset; i < offset + count; ++i) {
+			if (duckdb::FlatVector::IsNull(vec, i)) {
+				out.appendNull();
+			} else {
+				out.append(data[i] ? "true" : "false");
+			}
+		}
+		return;
+	}
+	case duckdb::LogicalTypeId::TINYINT:
+		return appendIntegers<int8_t>(vec, offset, count, out);
+	case duckdb::LogicalTypeId::SMALLINT:
+		return appendIntegers<int16_t>(vec, offset, count, out);
+	case duckdb::LogicalTypeId::INTEGER:
+		return appendIntegers<int32_t>(vec, offset, count, out);
+	case duckdb::LogicalTypeId::BIGINT:
+		return appendIntegers<int64_t>(vec, offset, count, out);
+	case duckdb::LogicalTypeId::UTINYINT:
+		return appendIntegers<uint8_t>(vec, offset, count, out);
+	case duckdb::LogicalTypeId::USMALLINT:
+		return appendIntegers<uint16_t>(vec, offset, count, out);
+	case duckdb::LogicalTypeId::UINTEGER:
+		return appendIntegers<uint32_t>(vec, offset, count, out);
+	case duckdb::LogicalTypeId::UBIGINT:
+		return appendIntegers<uint64_t>(vec, offset, count, out);
+	case duckdb::LogicalTypeId::FLOAT:
+	case duckdb::LogicalTypeId::DOUBLE: {
+		const bool isFloat = vec.GetType().id() == duckdb::LogicalTypeId::FLOAT;
+		for (duckdb::idx_t i = offset; i < offset + count; ++i) {
+			if (duckdb::FlatVector::IsNull(vec, i)) {
+				out.appendNull();
+			} else if (isFloat) {
+				out.append(std::to_string(static_cast<double>(duckdb::FlatVector::GetData<float>(vec)[i])));
+			} else {
+				out.append(std::to_string(duckdb::FlatVector::GetData<double>(vec)[i]));
+			}
+		}
+		return;
+	}
+	case duckdb::LogicalTypeId::VARCHAR: {
+		const duckdb::string_t *data = duckdb::FlatVector::GetData<duckdb::string_t>(vec);
+		for (duckdb::idx_t i = offset; i < offset + count; ++i) {
+			if (duckdb::FlatVector::IsNull(vec, i)) {
+				out.appendNull();
+			} else {
+				out.append(data[i].GetData(), data[i].GetSize());
+			}
+		}
+		return;
+	}
+	default:
+		// BLOB, HUGEINT, dates, timestamps, decimals, nested types: go through
+		// duckdb::Value exactly like the row-at-a-time path does.
+		for (duckdb::idx_t i = offset; i < offset + count; ++i) {
+			if (duckdb::FlatVector::IsNull(vec, i)) {
+				out.appendNull();
+				continue;
+			}
+			duckdb::Value val = vec.GetValue(i);
+			out.append(val.type().id() == duckdb::LogicalTypeId::BLOB ? val.GetValue<std::string>() : val.ToString());
+		}
+		return;
+	}
+}
+
+// The XSD datatype of a column's literals, decided once per result from its
+// LogicalType (R2RML's natural mapping, Section 10.2).  Character strings stay
+// plain literals, as they always have been; so do BLOB and TIMESTAMP, whose
+// lexical forms as rendered here (raw bytes, a space before the time) are not
+// valid xsd:hexBinary / xsd:dateTime.
+std::string literalDatatypeOf(const duckdb::LogicalType &type) {
+	std::string iri = sparql2sql::naturalXsdDatatype(type.ToString());
+	if (iri == sparql2sql::xsd::kString || iri == sparql2sql::xsd::kHexBinary ||
+	    iri == sparql2sql::xsd::kDateTime) {
+		return std::string();
+	}
+	return iri;
+}
+
+void chunkToBatch(duckdb::DataChunk &chunk, duckdb::idx_t offset, duckdb::idx_t count,
+                  const std::vector<std::string> &names, const std::vector<std::string> &datatypes, RowBatch &batch) {
+	batch.reset();
+	for (duckdb::idx_t col = 0; col < chunk.ColumnCount(); ++col) {
+		duckdb::Vector &vec = chunk.data[col];
+		RowBatch::Column &out = batch.addColumn(names[col], valueTypeOf(vec.GetType()));
+		out.datatypeIRI = datatypes[col];
+		appendVector(vec, offset, count, out);
+	}
+	batch.setSize(count);
+}
+
+} // namespace r2rml
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "r2rml/RowBatch.h"
+#include "r2rml/SQLValue.h"
+
+#include "duckdb.hpp"
+
+#include <string>
+#include <vector>
+
+namespace r2rml {
+
+/**
+ * DataChunk -> RowBatch conversion, shared by DuckDBConnection's result sets
+ * and the COPY TO extension (which is handed DuckDB's chunks directly).
+ */
+
+/** The SQLValue::Type a column of `type` converts to. */
+SQLValue::Type valueTypeOf(const duckdb::LogicalType &type);
+
+/**
+ * The XSD datatype of the literals of a column of `type`, or "" for plain
+ * literals.  Decided once per column, never per value.
+ */
+std::string literalDatatypeOf(const duckdb::LogicalType &type);
+
+/** Append rows [offset, offset + count) of the flat vector `vec` to `out`. */
+void appendVector(duckdb::Vector &vec, duckdb::idx_t offset, duckdb::idx_t count, RowBatch::Column &out);
+
+/**
+ * Reset `batch` to rows [offset, offset + count) of `chunk`, whose vectors
+ * must be flat, naming column i `names[i]` and typing its literals
+ * `datatypes[i]`.
+ */
+void chunkToBatch(duckdb::DataChunk &chunk, duckdb::idx_t offset, duckdb::idx_t count,
+                  const std::vector<std::string> &names, const std::vector<std::string> &datatypes, RowBatch &batch);
+
+} // namespace r2rml
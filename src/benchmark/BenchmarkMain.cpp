@@ -10,12 +10,19 @@
 // counts. It is meant for establishing a baseline against real-world (and
 // deliberately un-checked-in) customer data before optimizing the translator.
 //
+// With --export it benchmarks the forward (R2RML-to-RDF) path instead: it runs
+// R2RMLMapping::processDatabase() over the whole mapping the way the CLI does
+// for N-Triples, writing into a sink that drops the bytes unread (or, with
+// --output, into a real file), and prints min/median/max wall time,
+// triples per second and the process's peak RSS.
+//
 // Like the CLI, this target is the only-other place besides main.cpp that
 // touches DuckDB, and it is gated behind the same CMake conditions so it never
 // leaks into downstream FetchContent builds or the DuckDB-free test_runner.
 // -----------------------------------------------------------------------------
 
 #include <algorithm>
+#include <cerrno>
 #include <chrono>
 #include <cstdio>
 #include <cctype>
@@ -29,10 +36,17 @@
 #include <utility>
 #include <vector>
 
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
 #include <yaml-cpp/yaml.h>
 
 #include "DuckDBConnection.h"
+#include "r2rml/ExportOptions.h"
+#include "r2rml/ExportReport.h"
 #include "r2rml/MappingParser.h"
+#include "r2rml/NTriplesWriter.h"
 #include "r2rml/R2RMLMapping.h"
 #include "r2rml/SQLResultSet.h"
 #include "r2rml/SQLRow.h"
@@ -109,19 +123,140 @@ double elapsedMs(std::chrono::steady_clock::time_point start, std::chrono::stead
 	return std::chrono::duration<double, std::milli>(end - start).count();
 }
 
+// Where an --export run's N-Triples go: written to `file` if set, otherwise
+// dropped unread. Statements are counted by the export (ExportReport).
+struct ExportOutput {
+	std::FILE *file = nullptr;
+	std::size_t bytes = 0;
+};
+
+size_t writeExport(const void *buf, size_t len, void *stream) {
+	ExportOutput &out = *static_cast<ExportOutput *>(stream);
+	if (out.file && std::fwrite(buf, 1, len, out.file) != len) {
+		return 0;
+	}
+	out.bytes += len;
+	return len;
+}
+
+// Peak resident set size of this process in bytes; 0 where it can't be read.
+std::size_t peakRssBytes() {
+#ifdef _WIN32
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+#ifdef __APPLE__
+	return static_cast<std::size_t>(usage.ru_maxrss); // bytes
+#else
+	return static_cast<std::size_t>(usage.ru_maxrss) * 1024; // KiB
+#endif
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// --export: times whole-mapping exports, warmup runs first. Every run must
+// write the same number of statements, or the export isn't deterministic and
+// the timings compare different work. Returns the process exit code.
+// -----------------------------------------------------------------------------
+int benchmarkExport(r2rml::R2RMLMapping &mapping, r2rml::DuckDBConnection &db, const r2rml::ExportOptions &options,
+                    const char *outputFile, int warmup, int repeat) {
+	const bool sequential = options.threads == 1 && options.partitions == 1;
+	std::cerr << "Benchmarking export (" << warmup << " warmup + " << repeat << " measured iteration"
+	          << (repeat == 1 ? "" : "s") << ", " << (sequential ? std::string("1 thread") : "parallel") << ", to "
+	          << (outputFile ? "'" + std::string(outputFile) + "'" : std::string("a null sink")) << ")...\n";
+
+	std::vector<double> exportMs;
+	std::size_t statements = 0;
+	std::size_t bytes = 0;
+	std::cerr << "[export] running:";
+	for (int it = 0; it < warmup + repeat; ++it) {
+		std::cerr << "." << std::flush;
+		ExportOutput out;
+		if (outputFile) {
+			out.file = std::fopen(outputFile, "wb");
+			if (!out.file) {
+				std::cerr << "\nError: cannot create output file '" << outputFile << "': " << std::strerror(errno)
+				          << "\n";
+				return 1;
+			}
+		}
+		r2rml::ExportReport report;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		try {
+			if (sequential) {
+				r2rml::NTriplesWriter writer(SERD_NTRIPLES, mapping.serdEnvironment, &mapping.constants, writeExport,
+				                             &out);
+				mapping.processDatabase(db, writer, options, &report);
+				writer.flush();
+			} else {
+				mapping.processDatabase([&db]() { return std::unique_ptr<r2rml::SQLConnection>(db.connect()); },
+				                        SERD_NTRIPLES, static_cast<SerdStyle>(0), writeExport, &out, options, &report);
+			}
+		} catch (const std::exception &e) {
+			if (out.file) {
+				std::fclose(out.file);
+			}
+			std::cerr << "\nError: export failed: " << e.what() << "\n";
+			return 1;
+		}
+		if (out.file && std::fclose(out.file) != 0) {
+			std::cerr << "\nError: cannot write output file '" << outputFile << "'\n";
+			return 1;
+		}
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		std::size_t written = report.statements - report.duplicatesDropped;
+		if (it > 0 && written != statements) {
+			std::cerr << "\nError: run " << it + 1 << " wrote " << written << " statements, earlier runs "
+			          << statements << "\n";
+			return 1;
+		}
+		statements = written;
+		bytes = out.bytes;
+		if (it >= warmup) {
+			exportMs.push_back(elapsedMs(start, end));
+		}
+	}
+	std::cerr << "\n";
+
+	Stats t = summarize(exportMs);
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "statements          " << statements << "\n";
+	std::cout << "bytes               " << bytes << "\n";
+	std::cout << "wall ms (min/med/max) " << t.min << "/" << t.median << "/" << t.max << "\n";
+	std::cout << std::setprecision(0);
+	std::cout << "triples/s (median)  " << (t.median > 0 ? statements / (t.median / 1000.0) : 0.0) << "\n";
+	std::size_t rss = peakRssBytes();
+	std::cout << std::setprecision(1);
+	if (rss) {
+		std::cout << "peak RSS MiB        " << rss / (1024.0 * 1024.0) << "\n";
+	} else {
+		std::cout << "peak RSS MiB        n/a\n";
+	}
+	return 0;
+}
+
 void printHelp(const char *programName) {
 	std::cerr << "Usage: " << programName << " [options] <mapping.ttl|mapping.yml> <database.duckdb> <queries.yml>\n"
+	          << "       " << programName << " --export [options] <mapping.ttl|mapping.yml> <database.duckdb>\n"
 	          << "\n"
 	          << "Benchmarks the SPARQL-to-SQL pipeline against a real database. For each\n"
 	          << "named SPARQL query it times translation (parse + translateQuery) and\n"
 	          << "execution (DuckDB execute + row drain) separately, over warmup + measured\n"
 	          << "iterations, and prints min/median/max timings plus row counts.\n"
+	          << "With --export it times the R2RML-to-RDF export of the whole mapping\n"
+	          << "instead (as N-Triples), printing min/median/max wall time, triples per\n"
+	          << "second and peak RSS.\n"
 	          << "\n"
 	          << "Arguments:\n"
 	          << "  mapping.ttl|mapping.yml   R2RML (Turtle) or YARRRML (YAML) mapping; format\n"
 	          << "                            chosen by extension unless -y is given.\n"
 	          << "  database.duckdb           DuckDB database file.\n"
-	          << "  queries.yml               Flat YAML mapping of `name: \"SPARQL text\"`.\n"
+	          << "  queries.yml               Flat YAML mapping of `name: \"SPARQL text\"`;\n"
+	          << "                            not with --export.\n"
 	          << "\n"
 	          << "Options:\n"
 	          << "  --repeat N       Measured iterations per query (default 5).\n"
@@ -130,6 +265,15 @@ void printHelp(const char *programName) {
 	          << "  --query NAME     Only benchmark the named query (default: all).\n"
 	          << "  -y               Force the mapping to be parsed as YARRRML.\n"
 	          << "  --print-sql      Echo each query's translated SQL to stderr.\n"
+	          << "  --export         Benchmark the export instead of SPARQL queries.\n"
+	          << "  --output FILE    With --export, also write each run's output to FILE\n"
+	          << "                   (default: a null sink only).\n"
+	          << "  --threads N      With --export, export on N threads like the CLI's\n"
+	          << "                   --threads (default 1; 0 = one per core).\n"
+	          << "  --partitions N   With --export, split rr:tableName tables into N rowid\n"
+	          << "                   ranges like the CLI's --partitions (default 1).\n"
+	          << "  --push-down-joins\n"
+	          << "                   With --export, evaluate rr:refObjectMaps as SQL joins.\n"
 	          << "  -h, --help       Show this help message.\n";
 }
 
@@ -152,6 +296,9 @@ int parseCount(const char *arg, const char *flag) {
 int main(int argc, char *argv[]) {
 	bool forceYarrrml = false;
 	bool printSql = false;
+	bool exportMode = false;
+	const char *outputFile = nullptr;
+	r2rml::ExportOptions exportOptions;
 	int repeat = 5;
 	int warmup = 1;
 	const char *dialectName = "duckdb";
@@ -186,6 +333,28 @@ int main(int argc, char *argv[]) {
 				return 1;
 			}
 			dialectName = argv[i];
+		} else if (std::strcmp(argv[i], "--export") == 0) {
+			exportMode = true;
+		} else if (std::strcmp(argv[i], "--output") == 0) {
+			if (++i >= argc) {
+				std::cerr << "Error: --output requires a file argument\n";
+				return 1;
+			}
+			outputFile = argv[i];
+		} else if (std::strcmp(argv[i], "--threads") == 0) {
+			if (++i >= argc) {
+				std::cerr << "Error: --threads requires a count argument\n";
+				return 1;
+			}
+			exportOptions.threads = static_cast<unsigned>(parseCount(argv[i], "--threads"));
+		} else if (std::strcmp(argv[i], "--partitions") == 0) {
+			if (++i >= argc) {
+				std::cerr << "Error: --partitions requires a count argument\n";
+				return 1;
+			}
+			exportOptions.partitions = static_cast<unsigned>(parseCount(argv[i], "--partitions"));
+		} else if (std::strcmp(argv[i], "--push-down-joins") == 0) {
+			exportOptions.pushDownJoins = true;
 		} else if (std::strcmp(argv[i], "--query") == 0) {
 			if (++i >= argc) {
 				std::cerr << "Error: --query requires a query name argument\n";
@@ -197,7 +366,7 @@ int main(int argc, char *argv[]) {
 				mappingFile = argv[i];
 			} else if (!databaseFile) {
 				databaseFile = argv[i];
-			} else if (!queriesFile) {
+			} else if (!queriesFile && !exportMode) {
 				queriesFile = argv[i];
 			} else {
 				std::cerr << "Error: unexpected argument '" << argv[i] << "'\n";
@@ -211,15 +380,29 @@ int main(int argc, char *argv[]) {
 		}
 	}
 
-	if (!mappingFile || !databaseFile || !queriesFile) {
+	if (exportMode && (!mappingFile || !databaseFile)) {
+		std::cerr << "Error: --export requires a mapping file and a database file.\n";
+		printHelp(argv[0]);
+		return 1;
+	}
+	if (!exportMode && (!mappingFile || !databaseFile || !queriesFile)) {
 		std::cerr << "Error: mapping file, database file and queries YAML are all required.\n";
 		printHelp(argv[0]);
 		return 1;
 	}
+	if (!exportMode && (outputFile || exportOptions.threads != 1 || exportOptions.partitions != 1 ||
+	                    exportOptions.pushDownJoins)) {
+		std::cerr << "Error: --output, --threads, --partitions and --push-down-joins require --export\n";
+		return 1;
+	}
 	if (repeat < 1) {
 		std::cerr << "Error: --repeat must be >= 1\n";
 		return 1;
 	}
+	if (exportOptions.partitions < 1) {
+		std::cerr << "Error: --partitions must be >= 1\n";
+		return 1;
+	}
 
 	// ---- Parse the mapping ----------------------------------------------------
 	r2rml::R2RMLMapping mapping;
@@ -237,6 +420,17 @@ int main(int argc, char *argv[]) {
 		return 1;
 	}
 
+	if (exportMode) {
+		std::unique_ptr<r2rml::DuckDBConnection> db;
+		try {
+			db.reset(new r2rml::DuckDBConnection(databaseFile));
+		} catch (const std::exception &e) {
+			std::cerr << "Error: cannot open database '" << databaseFile << "': " << e.what() << "\n";
+			return 1;
+		}
+		return benchmarkExport(mapping, *db, exportOptions, outputFile, warmup, repeat);
+	}
+
 	// ---- Load the queries -----------------------------------------------------
 	std::vector<std::pair<std::string, std::string>> queries;
 	try {
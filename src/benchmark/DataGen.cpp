@@ -0,0 +1,458 @@
+// -----------------------------------------------------------------------------
+// sql2rdf_datagen - a dev-only generator of synthetic benchmark inputs: a DuckDB
+// database at a chosen scale, and R2RML and YARRRML mappings of it that map
+// the same triples.
+//
+// The data is computed from row numbers with DuckDB's hash(), so the same
+// options always give the same database, and rows are generated inside DuckDB
+// (CREATE TABLE ... AS SELECT ... FROM range(n)), so a billion rows need no
+// more memory than DuckDB itself uses. The schema covers the mapping features
+// whose cost export and SPARQL benchmarks want to see:
+//
+//   DEPARTMENT  rows/1000 departments, with German names (language-tagged)
+//   PERSON      --rows people: a multi-placeholder homepage template and a
+//               literal template, nullable email and English and French bios
+//               (language-tagged), a date, a timestamp, and joins to their
+//               department and to their orders (fan-out --fan-out)
+//   ORDERS      --fan-out orders per person, with a two-placeholder subject,
+//               a decimal, a nullable note and a join back to the person
+//   WIDE        --rows rows of --width integer, double and string columns,
+//               each nullable
+//   two rr:sqlQuery views: DeptStats (an aggregate over DEPARTMENT and
+//   PERSON) and Contacts (a filtered, computed projection of PERSON)
+//
+// Nullable columns are null in --null-percent percent of rows. Gated like the
+// CLI (needs DuckDB).
+// -----------------------------------------------------------------------------
+
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "DuckDBConnection.h"
+#include "r2rml/SQLResultSet.h"
+
+namespace {
+
+// The dataset's shape, from the command line.
+struct Scale {
+	long long rows = 10000;
+	long long fanOut = 4;
+	int width = 32;
+	int nullPercent = 10;
+
+	long long departments() const {
+		return rows / 1000 > 0 ? rows / 1000 : 1;
+	}
+};
+
+// Parses a count with an optional k/m/b (thousand, million, billion) suffix,
+// rejecting one too large for a long long.
+bool parseCount(const char *arg, long long &value) {
+	char *end = nullptr;
+	errno = 0;
+	long long number = std::strtoll(arg, &end, 10);
+	if (end == arg || number < 0 || errno == ERANGE) {
+		return false;
+	}
+	long long multiplier = 1;
+	switch (std::tolower(static_cast<unsigned char>(*end))) {
+	case '\0':
+		break;
+	case 'k':
+		multiplier = 1000;
+		++end;
+		break;
+	case 'm':
+		multiplier = 1000000;
+		++end;
+		break;
+	case 'b':
+	case 'g':
+		multiplier = 1000000000;
+		++end;
+		break;
+	default:
+		return false;
+	}
+	if (*end != '\0' || number > LLONG_MAX / multiplier) {
+		return false;
+	}
+	value = number * multiplier;
+	return true;
+}
+
+// `value`, or NULL in nullPercent percent of rows; `salt` decorrelates columns.
+std::string nullable(const Scale &scale, int salt, const std::string &value) {
+	return "CASE WHEN hash(range, " + std::to_string(salt) + ") % 100 < " + std::to_string(scale.nullPercent) +
+	       " THEN NULL ELSE " + value + " END";
+}
+
+// A deterministic pseudo-random integer in [0, bound) for each row.
+std::string pick(int salt, long long bound) {
+	return "(hash(range, " + std::to_string(salt) + ") % " + std::to_string(bound) + ")";
+}
+
+std::string wideColumn(int i) {
+	char name[16];
+	std::snprintf(name, sizeof(name), "c%03d", i + 1);
+	return name;
+}
+
+std::string departmentSql(const Scale &scale) {
+	return "CREATE OR REPLACE TABLE DEPARTMENT AS SELECT range AS id, 'Department ' || range::VARCHAR AS name, "
+	       "'Abteilung ' || range::VARCHAR AS name_de, (range % 50)::INTEGER AS region FROM range(" +
+	       std::to_string(scale.departments()) + ")";
+}
+
+std::string personSql(const Scale &scale) {
+	const std::string dept = pick(3, scale.departments());
+	return "CREATE OR REPLACE TABLE PERSON AS SELECT range AS id, 'Given' || " + pick(1, 5000) +
+	       "::VARCHAR AS given_name, 'Family' || " + pick(2, 20000) + "::VARCHAR AS family_name, " + dept +
+	       "::BIGINT AS dept_id, " + nullable(scale, 4, "'person' || range::VARCHAR || '@example.com'") +
+	       " AS email, DATE '1950-01-01' + " + pick(5, 20000) + "::INTEGER AS birth_date, " +
+	       nullable(scale, 6, "'Person ' || range::VARCHAR || ' works in department ' || " + dept + "::VARCHAR") +
+	       " AS bio_en, " +
+	       nullable(scale, 7,
+	                "'La personne ' || range::VARCHAR || ' travaille au département ' || " + dept + "::VARCHAR") +
+	       " AS bio_fr, epoch_ms(1577836800000 + range * 1000) AS updated_at FROM range(" +
+	       std::to_string(scale.rows) + ")";
+}
+
+std::string ordersSql(const Scale &scale) {
+	return "CREATE OR REPLACE TABLE ORDERS AS SELECT range AS id, range // " + std::to_string(scale.fanOut) +
+	       " AS person_id, (range % " + std::to_string(scale.fanOut) + ")::INTEGER AS seq, (" + pick(8, 1000000) +
+	       " / 100.0)::DECIMAL(12,2) AS amount, " + nullable(scale, 9, "'Order note ' || range::VARCHAR") +
+	       " AS note, epoch_ms(1577836800000 + range * 250) AS placed_at FROM range(" +
+	       std::to_string(scale.rows * scale.fanOut) + ")";
+}
+
+std::string wideSql(const Scale &scale) {
+	std::string sql = "CREATE OR REPLACE TABLE WIDE AS SELECT range AS id";
+	for (int i = 0; i < scale.width; ++i) {
+		const int salt = 100 + i;
+		std::string value;
+		switch (i % 3) {
+		case 0:
+			value = pick(salt, 1000000) + "::BIGINT";
+			break;
+		case 1:
+			value = "(" + pick(salt, 10000000) + " / 100.0)::DOUBLE";
+			break;
+		default:
+			value = "'value ' || " + pick(salt, 10000) + "::VARCHAR";
+			break;
+		}
+		sql += ", " + nullable(scale, 1000 + i, value) + " AS " + wideColumn(i);
+	}
+	return sql + " FROM range(" + std::to_string(scale.rows) + ")";
+}
+
+const char *const DEPT_STATS_QUERY = "SELECT d.id, d.name, count(p.id) AS staff, min(p.birth_date) AS oldest "
+                                     "FROM DEPARTMENT d LEFT JOIN PERSON p ON p.dept_id = d.id GROUP BY d.id, d.name";
+const char *const CONTACTS_QUERY =
+    "SELECT id, email, upper(family_name) AS family_upper FROM PERSON WHERE email IS NOT NULL";
+
+std::string r2rmlMapping(const Scale &scale) {
+	std::string ttl = "@prefix rr: <http://www.w3.org/ns/r2rml#>.\n"
+	                  "@prefix ex: <http://example.com/ns#>.\n"
+	                  "@prefix xsd: <http://www.w3.org/2001/XMLSchema#>.\n"
+	                  "\n"
+	                  "<#Department>\n"
+	                  "    rr:logicalTable [ rr:tableName \"DEPARTMENT\" ];\n"
+	                  "    rr:subjectMap [ rr:template \"http://example.com/department/{id}\"; "
+	                  "rr:class ex:Department ];\n"
+	                  "    rr:predicateObjectMap [ rr:predicate ex:name; rr:objectMap [ rr:column \"name\" ] ];\n"
+	                  "    rr:predicateObjectMap [ rr:predicate ex:name; "
+	                  "rr:objectMap [ rr:column \"name_de\"; rr:language \"de\" ] ];\n"
+	                  "    rr:predicateObjectMap [ rr:predicate ex:region; "
+	                  "rr:objectMap [ rr:template \"http://example.com/region/{region}\" ] ].\n"
+	                  "\n"
+	                  "<#Person>\n"
+	                  "    rr:logicalTable [ rr:tableName \"PERSON\" ];\n"
+	                  "    rr:subjectMap [ rr:template \"http://example.com/person/{id}\"; rr:class ex:Person ];\n"
+	                  "    rr:predicateObjectMap [ rr:predicate ex:label; rr:objectMap [ "
+	                  "rr:template \"{given_name} {family_name}\"; rr:termType rr:Literal ] ];\n"
+	                  "    rr:predicateObjectMap [ rr:predicate ex:homepage; rr:objectMap [ "
+	                  "rr:template \"http://example.com/people/{family_name}/{given_name}/{id}\" ] ];\n"
+	                  "    rr:predicateObjectMap [ rr:predicate ex:email; rr:objectMap [ rr:column \"email\" ] ];\n"
+	                  "    rr:predicateObjectMap [ rr:predicate ex:birthDate; "
+	                  "rr:objectMap [ rr:column \"birth_date\"; rr:datatype xsd:date ] ];\n"
+	                  "    rr:predicateObjectMap [ rr:predicate ex:bio; "
+	                  "rr:objectMap [ rr:column \"bio_en\"; rr:language \"en\" ] ];\n"
+	                  "    rr:predicateObjectMap [ rr:predicate ex:bio; "
+	                  "rr:objectMap [ rr:column \"bio_fr\"; rr:language \"fr\" ] ];\n"
+	                  "    rr:predicateObjectMap [ rr:predicate ex:updatedAt; "
+	                  "rr:objectMap [ rr:column \"updated_at\" ] ];\n"
+	                  "    rr:predicateObjectMap [ rr:predicate ex:department; rr:objectMap [ "
+	                  "rr:parentTriplesMap <#Department>; "
+	                  "rr:joinCondition [ rr:child \"dept_id\"; rr:parent \"id\" ] ] ];\n"
+	                  "    rr:predicateObjectMap [ rr:predicate ex:order; rr:objectMap [ "
+	                  "rr:parentTriplesMap <#Order>; "
+	                  "rr:joinCondition [ rr:child \"id\"; rr:parent \"person_id\" ] ] ].\n"
+	                  "\n"
+	                  "<#Order>\n"
+	                  "    rr:logicalTable [ rr:tableName \"ORDERS\" ];\n"
+	                  "    rr:subjectMap [ rr:template \"http://example.com/order/{person_id}/{seq}\"; "
+	                  "rr:class ex:Order ];\n"
+	                  "    rr:predicateObjectMap [ rr:predicate ex:amount; "
+	                  "rr:objectMap [ rr:column \"amount\"; rr:datatype xsd:decimal ] ];\n"
+	                  "    rr:predicateObjectMap [ rr:predicate ex:note; "
+	                  "rr:objectMap [ rr:column \"note\"; rr:language \"en\" ] ];\n"
+	                  "    rr:predicateObjectMap [ rr:predicate ex:placedAt; "
+	                  "rr:objectMap [ rr:column \"placed_at\" ] ];\n"
+	                  "    rr:predicateObjectMap [ rr:predicate ex:customer; rr:objectMap [ "
+	                  "rr:parentTriplesMap <#Person>; "
+	                  "rr:joinCondition [ rr:child \"person_id\"; rr:parent \"id\" ] ] ].\n"
+	                  "\n"
+	                  "<#Wide>\n"
+	                  "    rr:logicalTable [ rr:tableName \"WIDE\" ];\n"
+	                  "    rr:subjectMap [ rr:template \"http://example.com/wide/{id}\" ]";
+	for (int i = 0; i < scale.width; ++i) {
+		const std::string column = wideColumn(i);
+		ttl += ";\n    rr:predicateObjectMap [ rr:predicate ex:" + column + "; rr:objectMap [ rr:column \"" + column +
+		       "\" ] ]";
+	}
+	ttl += ".\n"
+	       "\n"
+	       "<#DeptStats>\n"
+	       "    rr:logicalTable [ rr:sqlQuery \"\"\"" +
+	       std::string(DEPT_STATS_QUERY) +
+	       "\"\"\" ];\n"
+	       "    rr:subjectMap [ rr:template \"http://example.com/department/{id}\" ];\n"
+	       "    rr:predicateObjectMap [ rr:predicate ex:staff; rr:objectMap [ rr:column \"staff\" ] ];\n"
+	       "    rr:predicateObjectMap [ rr:predicate ex:oldestBirthDate; rr:objectMap [ rr:column \"oldest\" ] ].\n"
+	       "\n"
+	       "<#Contacts>\n"
+	       "    rr:logicalTable [ rr:sqlQuery \"\"\"" +
+	       std::string(CONTACTS_QUERY) +
+	       "\"\"\" ];\n"
+	       "    rr:subjectMap [ rr:template \"http://example.com/contact/{id}\"; rr:class ex:Contact ];\n"
+	       "    rr:predicateObjectMap [ rr:predicate ex:mbox; rr:objectMap [ rr:template \"mailto:{email}\" ] ];\n"
+	       "    rr:predicateObjectMap [ rr:predicate ex:familyName; "
+	       "rr:objectMap [ rr:column \"family_upper\" ] ].\n";
+	return ttl;
+}
+
+std::string yarrrmlMapping(const Scale &scale) {
+	std::string yml = "prefixes:\n"
+	                  "  ex: http://example.com/ns#\n"
+	                  "  xsd: http://www.w3.org/2001/XMLSchema#\n"
+	                  "\n"
+	                  "mappings:\n"
+	                  "  Department:\n"
+	                  "    sources:\n"
+	                  "      - table: DEPARTMENT\n"
+	                  "    s: http://example.com/department/$(id)\n"
+	                  "    po:\n"
+	                  "      - [a, ex:Department]\n"
+	                  "      - [ex:name, $(name)]\n"
+	                  "      - [ex:name, $(name_de), de~lang]\n"
+	                  "      - [ex:region, http://example.com/region/$(region)~iri]\n"
+	                  "\n"
+	                  "  Person:\n"
+	                  "    sources:\n"
+	                  "      - table: PERSON\n"
+	                  "    s: http://example.com/person/$(id)\n"
+	                  "    po:\n"
+	                  "      - [a, ex:Person]\n"
+	                  "      - [ex:label, $(given_name) $(family_name)]\n"
+	                  "      - [ex:homepage, http://example.com/people/$(family_name)/$(given_name)/$(id)~iri]\n"
+	                  "      - [ex:email, $(email)]\n"
+	                  "      - [ex:birthDate, $(birth_date), xsd:date]\n"
+	                  "      - [ex:bio, $(bio_en), en~lang]\n"
+	                  "      - [ex:bio, $(bio_fr), fr~lang]\n"
+	                  "      - [ex:updatedAt, $(updated_at)]\n"
+	                  "      - p: ex:department\n"
+	                  "        o:\n"
+	                  "          - mapping: Department\n"
+	                  "            condition:\n"
+	                  "              function: equal\n"
+	                  "              parameters:\n"
+	                  "                - [str1, $(dept_id)]\n"
+	                  "                - [str2, $(id)]\n"
+	                  "      - p: ex:order\n"
+	                  "        o:\n"
+	                  "          - mapping: Order\n"
+	                  "            condition:\n"
+	                  "              function: equal\n"
+	                  "              parameters:\n"
+	                  "                - [str1, $(id)]\n"
+	                  "                - [str2, $(person_id)]\n"
+	                  "\n"
+	                  "  Order:\n"
+	                  "    sources:\n"
+	                  "      - table: ORDERS\n"
+	                  "    s: http://example.com/order/$(person_id)/$(seq)\n"
+	                  "    po:\n"
+	                  "      - [a, ex:Order]\n"
+	                  "      - [ex:amount, $(amount), xsd:decimal]\n"
+	                  "      - [ex:note, $(note), en~lang]\n"
+	                  "      - [ex:placedAt, $(placed_at)]\n"
+	                  "      - p: ex:customer\n"
+	                  "        o:\n"
+	                  "          - mapping: Person\n"
+	                  "            condition:\n"
+	                  "              function: equal\n"
+	                  "              parameters:\n"
+	                  "                - [str1, $(person_id)]\n"
+	                  "                - [str2, $(id)]\n"
+	                  "\n"
+	                  "  Wide:\n"
+	                  "    sources:\n"
+	                  "      - table: WIDE\n"
+	                  "    s: http://example.com/wide/$(id)\n"
+	                  "    po:\n";
+	for (int i = 0; i < scale.width; ++i) {
+		const std::string column = wideColumn(i);
+		yml += "      - [ex:" + column + ", $(" + column + ")]\n";
+	}
+	yml += "\n"
+	       "  DeptStats:\n"
+	       "    sources:\n"
+	       "      - query: \"" +
+	       std::string(DEPT_STATS_QUERY) +
+	       "\"\n"
+	       "    s: http://example.com/department/$(id)\n"
+	       "    po:\n"
+	       "      - [ex:staff, $(staff)]\n"
+	       "      - [ex:oldestBirthDate, $(oldest)]\n"
+	       "\n"
+	       "  Contacts:\n"
+	       "    sources:\n"
+	       "      - query: \"" +
+	       std::string(CONTACTS_QUERY) +
+	       "\"\n"
+	       "    s: http://example.com/contact/$(id)\n"
+	       "    po:\n"
+	       "      - [a, ex:Contact]\n"
+	       "      - [ex:mbox, mailto:$(email)~iri]\n"
+	       "      - [ex:familyName, $(family_upper)]\n";
+	return yml;
+}
+
+void writeFile(const char *path, const std::string &text) {
+	std::FILE *file = std::fopen(path, "wb");
+	if (!file) {
+		throw std::runtime_error("cannot create '" + std::string(path) + "'");
+	}
+	const bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+	if (std::fclose(file) != 0 || !written) {
+		throw std::runtime_error("cannot write '" + std::string(path) + "'");
+	}
+}
+
+void printHelp(const char *programName) {
+	std::cerr << "Usage: " << programName << " [options] <database.duckdb> <mapping.ttl> <mapping.yml>\n"
+	          << "\n"
+	          << "Creates (or replaces the tables of) a synthetic benchmark database, and\n"
+	          << "equivalent R2RML and YARRRML mappings of it. The same options always\n"
+	          << "produce the same data.\n"
+	          << "\n"
+	          << "Options:\n"
+	          << "  --rows N          People, and rows of WIDE (default 10k); k, m and b\n"
+	          << "                    suffixes multiply by a thousand, million and billion.\n"
+	          << "                    There are N/1000 departments.\n"
+	          << "  --fan-out N       Orders per person, i.e. ex:order links per person\n"
+	          << "                    (default 4).\n"
+	          << "  --width N         Value columns of WIDE (default 32).\n"
+	          << "  --null-percent N  Percentage of nulls in nullable columns (default 10).\n"
+	          << "  -h, --help        Show this help message.\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+	Scale scale;
+	const char *databaseFile = nullptr;
+	const char *r2rmlFile = nullptr;
+	const char *yarrrmlFile = nullptr;
+
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "-h") == 0 || std::strcmp(argv[i], "--help") == 0) {
+			printHelp(argv[0]);
+			return 0;
+		} else if (std::strcmp(argv[i], "--rows") == 0 || std::strcmp(argv[i], "--fan-out") == 0 ||
+		           std::strcmp(argv[i], "--width") == 0 || std::strcmp(argv[i], "--null-percent") == 0) {
+			const char *flag = argv[i];
+			long long value = 0;
+			if (++i >= argc || !parseCount(argv[i], value)) {
+				std::cerr << "Error: " << flag << " requires a count argument\n";
+				return 1;
+			}
+			if (std::strcmp(flag, "--rows") == 0) {
+				scale.rows = value;
+			} else if (std::strcmp(flag, "--fan-out") == 0) {
+				scale.fanOut = value;
+			} else if (std::strcmp(flag, "--width") == 0) {
+				scale.width = static_cast<int>(value < 999 ? value : 999);
+			} else {
+				scale.nullPercent = static_cast<int>(value < 100 ? value : 100);
+			}
+		} else if (argv[i][0] != '-') {
+			if (!databaseFile) {
+				databaseFile = argv[i];
+			} else if (!r2rmlFile) {
+				r2rmlFile = argv[i];
+			} else if (!yarrrmlFile) {
+				yarrrmlFile = argv[i];
+			} else {
+				std::cerr << "Error: unexpected argument '" << argv[i] << "'\n";
+				printHelp(argv[0]);
+				return 1;
+			}
+		} else {
+			std::cerr << "Error: unknown option '" << argv[i] << "'\n";
+			printHelp(argv[0]);
+			return 1;
+		}
+	}
+
+	if (!databaseFile || !r2rmlFile || !yarrrmlFile) {
+		std::cerr << "Error: database file and both mapping files are required.\n";
+		printHelp(argv[0]);
+		return 1;
+	}
+	if (scale.rows < 1 || scale.fanOut < 1) {
+		std::cerr << "Error: --rows and --fan-out must be >= 1\n";
+		return 1;
+	}
+
+	try {
+		writeFile(r2rmlFile, r2rmlMapping(scale));
+		writeFile(yarrrmlFile, yarrrmlMapping(scale));
+
+		r2rml::DuckDBConnection db(databaseFile);
+		const std::pair<const char *, std::string> tables[] = {
+		    {"DEPARTMENT", departmentSql(scale)},
+		    {"PERSON", personSql(scale)},
+		    {"ORDERS", ordersSql(scale)},
+		    {"WIDE", wideSql(scale)},
+		};
+		for (const auto &table : tables) {
+			std::cerr << "Creating " << table.first << "..." << std::flush;
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			db.execute(table.second);
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+			std::cerr << " " << std::fixed << std::setprecision(1)
+			          << std::chrono::duration<double>(end - start).count() << " s\n";
+		}
+	} catch (const std::exception &e) {
+		std::cerr << "Error: " << e.what() << "\n";
+		return 1;
+	}
+
+	std::cerr << "Written " << databaseFile << " (" << scale.rows << " people, " << scale.rows * scale.fanOut
+	          << " orders, " << scale.rows << " wide rows of " << scale.width << " columns), " << r2rmlFile << " and "
+	          << yarrrmlFile << "\n";
+	return 0;
+}
@@ -0,0 +1,152 @@
+// -----------------------------------------------------------------------------
+// sql2rdf_export_bench - a dev-only benchmark for forward (R2RML) export
+// throughput on one large table.
+//
+// It fills an in-memory DuckDB table with a configurable number of synthetic
+// employee rows, maps it with a single TriplesMap, and times
+// R2RMLMapping::processDatabase() single-threaded, through a SerdWriter and
+// through an NTriplesWriter ("plain" without the mapping's pre-serialized
+// constants, see R2RMLMapping::constants), against the parallel overload
+// with the table split into one rowid partition per thread (see
+// ExportOptions::partitions), for 2, 4, ... threads up to a limit.  Output
+// is N-Triples into a sink that only counts bytes, so the timings cover
+// query, term generation and serialization but not disk I/O; every run
+// must produce the same number of bytes as the SerdWriter one, which
+// speedups are relative to.
+//
+// Gated like the CLI (needs DuckDB).
+// -----------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <serd/serd.h>
+
+#include "DuckDBConnection.h"
+#include "r2rml/ExportOptions.h"
+#include "r2rml/NTriplesWriter.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/R2RMLParser.h"
+#include "r2rml/SQLResultSet.h"
+
+namespace {
+
+const char *const MAPPING = R"(
+@prefix rr: <http://www.w3.org/ns/r2rml#>.
+@prefix ex: <http://example.com/ns#>.
+<#Employee>
+    rr:logicalTable [ rr:tableName "EMP" ];
+    rr:subjectMap [ rr:template "http://data.example.com/employee/{EMPNO}"; rr:class ex:Employee ];
+    rr:predicateObjectMap [ rr:predicate ex:name; rr:objectMap [ rr:column "ENAME" ] ];
+    rr:predicateObjectMap [ rr:predicate ex:job; rr:objectMap [ rr:column "JOB" ] ];
+    rr:predicateObjectMap [ rr:predicate ex:salary; rr:objectMap [ rr:column "SAL" ] ];
+    rr:predicateObjectMap [
+        rr:predicate ex:department;
+        rr:objectMap [ rr:template "http://data.example.com/department/{DEPTNO}" ]
+    ].
+)";
+
+size_t countBytes(const void * /*buf*/, size_t len, void *stream) {
+	*static_cast<std::size_t *>(stream) += len;
+	return len;
+}
+
+double timeMs(const std::function<void()> &run) {
+	auto start = std::chrono::steady_clock::now();
+	run();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void printRow(const std::string &label, long rows, double ms, double baseline) {
+	std::cout << std::left << std::setw(10) << label << std::right << std::fixed << std::setprecision(1)
+	          << std::setw(12) << ms << std::setw(14) << std::setprecision(0) << rows / (ms / 1000.0) << std::setw(9)
+	          << std::setprecision(2) << baseline / ms << "x\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+	long rows = argc > 1 ? std::atol(argv[1]) : 2000000;
+	unsigned maxThreads = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : std::thread::hardware_concurrency();
+	if (rows <= 0 || maxThreads == 0) {
+		std::cerr << "usage: " << argv[0] << " [rows] [max-threads]\n";
+		return 1;
+	}
+
+	r2rml::DuckDBConnection db(":memory:");
+	db.execute("CREATE TABLE EMP AS SELECT range AS EMPNO, 'employee ' || range::VARCHAR AS ENAME, "
+	           "CASE range % 3 WHEN 0 THEN 'CLERK' WHEN 1 THEN 'ANALYST' ELSE 'MANAGER' END AS JOB, "
+	           "(range % 5000) * 1.5 AS SAL, range % 40 AS DEPTNO FROM range(" +
+	           std::to_string(rows) + ")");
+
+	r2rml::R2RMLParser parser;
+	r2rml::R2RMLMapping mapping = parser.parseString(MAPPING, "http://example.com/mapping/");
+	if (!mapping.isValid()) {
+		std::cerr << "Error: benchmark mapping is invalid\n";
+		return 1;
+	}
+
+	// Single-threaded baseline through the ordinary SerdWriter overload.
+	std::size_t baselineBytes = 0;
+	double baseline = timeMs([&] {
+		SerdWriter *writer = serd_writer_new(SERD_NTRIPLES, static_cast<SerdStyle>(0), mapping.serdEnvironment,
+		                                     nullptr, countBytes, &baselineBytes);
+		mapping.processDatabase(db, *writer);
+		serd_writer_finish(writer);
+		serd_writer_free(writer);
+	});
+
+	// The same, through the dedicated N-Triples writer, escaping every term...
+	std::size_t plainBytes = 0;
+	double plain = timeMs([&] {
+		r2rml::NTriplesWriter writer(SERD_NTRIPLES, mapping.serdEnvironment, countBytes, &plainBytes);
+		mapping.processDatabase(db, writer, r2rml::ExportOptions());
+		writer.flush();
+	});
+
+	// ...and copying the mapping's constants pre-serialized.
+	std::size_t directBytes = 0;
+	double direct = timeMs([&] {
+		r2rml::NTriplesWriter writer(SERD_NTRIPLES, mapping.serdEnvironment, &mapping.constants, countBytes,
+		                             &directBytes);
+		mapping.processDatabase(db, writer, r2rml::ExportOptions());
+		writer.flush();
+	});
+	if (plainBytes != baselineBytes || directBytes != baselineBytes) {
+		std::cerr << "Error: NTriplesWriter wrote " << plainBytes << " and " << directBytes << " bytes, expected "
+		          << baselineBytes << "\n";
+		return 1;
+	}
+
+	std::cout << rows << " rows, " << baselineBytes << " bytes of N-Triples\n";
+	std::cout << std::left << std::setw(10) << "threads" << std::right << std::setw(12) << "ms" << std::setw(14)
+	          << "rows/s" << std::setw(10) << "speedup" << "\n";
+	printRow("1 (serd)", rows, baseline, baseline);
+	printRow("1 (plain)", rows, plain, baseline);
+	printRow("1", rows, direct, baseline);
+
+	for (unsigned threads = 2; threads <= maxThreads; threads *= 2) {
+		r2rml::ExportOptions options;
+		options.threads = threads;
+		options.partitions = threads;
+		std::size_t bytes = 0;
+		double ms = timeMs([&] {
+			mapping.processDatabase([&db]() { return std::unique_ptr<r2rml::SQLConnection>(db.connect()); },
+			                        SERD_NTRIPLES, static_cast<SerdStyle>(0), countBytes, &bytes, options);
+		});
+		if (bytes != baselineBytes) {
+			std::cerr << "Error: " << threads << " threads wrote " << bytes << " bytes, expected " << baselineBytes
+			          << "\n";
+			return 1;
+		}
+		printRow(std::to_string(threads), rows, ms, baseline);
+	}
+	return 0;
+}
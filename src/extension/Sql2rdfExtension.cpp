@@ -0,0 +1,263 @@
+#define DUCKDB_EXTENSION_MAIN
+
+#include "extension/Sql2rdfExtension.h"
+#include "DuckDBVectors.h"
+#include "r2rml/MappingParser.h"
+#include "r2rml/NTriplesWriter.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/RdfSink.h"
+#include "r2rml/RowBatch.h"
+#include "r2rml/StatementSink.h"
+#include "r2rml/TriplesMap.h"
+
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/function/copy_function.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace r2rml {
+
+namespace {
+
+/// How much RDF a thread buffers before appending it to the file.
+const std::size_t flushBytes = 1 << 20;
+
+/// Discards statements; lets bind check a schema against the triples map.
+class DiscardSink : public StatementSink {
+public:
+	void write(const SerdNode * /*graph*/, const SerdNode & /*subject*/, const SerdNode & /*predicate*/,
+	           const SerdNode & /*object*/, const SerdNode * /*datatype*/, const SerdNode * /*lang*/) override {
+	}
+};
+
+size_t appendToString(const void *buf, size_t len, void *stream) {
+	static_cast<std::string *>(stream)->append(static_cast<const char *>(buf), len);
+	return len;
+}
+
+// ---------------------------------------------------------------------------
+// COPY ... TO state
+//
+// Bind data is shared, read-only, by every thread: the parsed mapping, the
+// chosen triples map and the result's column layout.  Each thread has its
+// own RdfSink and NTriplesWriter (so its own term buffers and node caches)
+// writing into a thread-local string; the global state only serializes
+// appends to the output file.
+// ---------------------------------------------------------------------------
+struct RdfCopyBindData : public duckdb::FunctionData {
+	std::shared_ptr<const R2RMLMapping> mapping;
+	const TriplesMap *triplesMap {nullptr};
+	SerdSyntax syntax {SERD_NTRIPLES};
+	std::vector<RdfSink::Column> schema;
+	std::vector<std::string> names;
+	std::vector<std::string> datatypes;
+
+	duckdb::unique_ptr<duckdb::FunctionData> Copy() const override {
+		return duckdb::make_uniq<RdfCopyBindData>(*this);
+	}
+
+	bool Equals(const duckdb::FunctionData &other) const override {
+		const auto &that = other.Cast<RdfCopyBindData>();
+		return mapping == that.mapping && triplesMap == that.triplesMap && syntax == that.syntax &&
+		       names == that.names && datatypes == that.datatypes;
+	}
+};
+
+struct RdfCopyGlobalState : public duckdb::GlobalFunctionData {
+	std::mutex lock;
+	duckdb::unique_ptr<duckdb::FileHandle> handle;
+
+	void append(std::string &buffer) {
+		if (buffer.empty()) {
+			return;
+		}
+		std::lock_guard<std::mutex> guard(lock);
+		handle->Write(const_cast<char *>(buffer.data()), buffer.size());
+		buffer.clear();
+	}
+};
+
+struct RdfCopyLocalState : public duckdb::LocalFunctionData {
+	explicit RdfCopyLocalState(const RdfCopyBindData &bind)
+	    : writer(bind.syntax, bind.mapping->serdEnvironment, &bind.mapping->constants, appendToString, &buffer),
+	      sink(*bind.mapping, *bind.triplesMap, writer) {
+		sink.begin(bind.schema);
+	}
+
+	/// Whole statements, appended to the file once flushBytes are waiting.
+	std::string buffer;
+	NTriplesWriter writer;
+	RdfSink sink;
+	RowBatch batch;
+};
+
+/// R2RML errors are std::exceptions; hand them to DuckDB as its own.
+template <class Fn>
+void reportingErrors(Fn &&fn) {
+	try {
+		fn();
+	} catch (const duckdb::Exception &) {
+		throw;
+	} catch (const std::exception &e) {
+		throw duckdb::InvalidInputException(e.what());
+	}
+}
+
+bool endsWith(const std::string &s, const std::string &suffix) {
+	return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+SerdSyntax syntaxOf(const std::string &format, const std::string &filePath) {
+	std::string lower = duckdb::StringUtil::Lower(format);
+	if (lower == "nquads") {
+		return SERD_NQUADS;
+	}
+	if (lower == "rdf" && endsWith(duckdb::StringUtil::Lower(filePath), ".nq")) {
+		return SERD_NQUADS;
+	}
+	return SERD_NTRIPLES;
+}
+
+// ---------------------------------------------------------------------------
+// Copy function callbacks
+// ---------------------------------------------------------------------------
+duckdb::unique_ptr<duckdb::FunctionData> rdfCopyBind(duckdb::ClientContext & /*context*/,
+                                                      duckdb::CopyFunctionBindInput &input,
+                                                      const duckdb::vector<std::string> &names,
+                                                      const duckdb::vector<duckdb::LogicalType> &sqlTypes) {
+	std::string mappingPath;
+	std::string triplesMapName;
+	for (const auto &option : input.info.options) {
+		std::string key = duckdb::StringUtil::Lower(option.first);
+		if (key != "mapping" && key != "triples_map") {
+			throw duckdb::BinderException("R2RML: unrecognized COPY option \"" + option.first +
+			                              "\" (expected MAPPING or TRIPLES_MAP)");
+		}
+		if (option.second.size() != 1) {
+			throw duckdb::BinderException("R2RML: COPY option " + option.first + " takes one value");
+		}
+		(key == "mapping" ? mappingPath : triplesMapName) = option.second[0].ToString();
+	}
+	if (mappingPath.empty()) {
+		throw duckdb::BinderException("R2RML: COPY ... (FORMAT " + input.info.format +
+		                              ") needs a MAPPING option naming the mapping file");
+	}
+
+	auto bind = duckdb::make_uniq<RdfCopyBindData>();
+	bind->syntax = syntaxOf(input.info.format, input.info.file_path);
+	for (duckdb::idx_t col = 0; col < names.size(); ++col) {
+		std::string name = names[col];
+		std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::toupper(c); });
+		bind->datatypes.push_back(literalDatatypeOf(sqlTypes[col]));
+		bind->schema.emplace_back(name, valueTypeOf(sqlTypes[col]), bind->datatypes.back());
+		bind->names.push_back(std::move(name));
+	}
+	try {
+		std::unique_ptr<MappingParser> parser = MappingParser::create(mappingPath);
+		bind->mapping = std::make_shared<R2RMLMapping>(parser->parse(mappingPath));
+		bind->triplesMap = &RdfSink::findTriplesMap(*bind->mapping, triplesMapName);
+		// fail here, not on the first chunk, if the map reads a missing column
+		DiscardSink discard;
+		RdfSink check(*bind->mapping, *bind->triplesMap, discard);
+		check.begin(bind->schema);
+	} catch (const std::exception &e) {
+		throw duckdb::BinderException(e.what());
+	}
+	return std::move(bind);
+}
+
+duckdb::unique_ptr<duckdb::GlobalFunctionData> rdfCopyInitializeGlobal(duckdb::ClientContext &context,
+                                                                       duckdb::FunctionData & /*bindData*/,
+                                                                       const std::string &filePath) {
+	auto global = duckdb::make_uniq<RdfCopyGlobalState>();
+	duckdb::FileSystem &fs = duckdb::FileSystem::GetFileSystem(context);
+	global->handle = fs.OpenFile(filePath, duckdb::FileFlags::FILE_FLAGS_WRITE |
+	                                           duckdb::FileFlags::FILE_FLAGS_FILE_CREATE_NEW |
+	                                           duckdb::FileLockType::WRITE_LOCK);
+	return std::move(global);
+}
+
+duckdb::unique_ptr<duckdb::LocalFunctionData> rdfCopyInitializeLocal(duckdb::ExecutionContext & /*context*/,
+                                                                     duckdb::FunctionData &bindData) {
+	return duckdb::make_uniq<RdfCopyLocalState>(bindData.Cast<RdfCopyBindData>());
+}
+
+void rdfCopySink(duckdb::ExecutionContext & /*context*/, duckdb::FunctionData &bindData,
+                 duckdb::GlobalFunctionData &globalState, duckdb::LocalFunctionData &localState,
+                 duckdb::DataChunk &input) {
+	auto &bind = bindData.Cast<RdfCopyBindData>();
+	auto &local = localState.Cast<RdfCopyLocalState>();
+	input.Flatten();
+	chunkToBatch(input, 0, input.size(), bind.names, bind.datatypes, local.batch);
+	reportingErrors([&] { local.sink.consume(local.batch); });
+	if (local.buffer.size() >= flushBytes) {
+		globalState.Cast<RdfCopyGlobalState>().append(local.buffer);
+	}
+}
+
+void rdfCopyCombine(duckdb::ExecutionContext & /*context*/, duckdb::FunctionData & /*bindData*/,
+                    duckdb::GlobalFunctionData &globalState, duckdb::LocalFunctionData &localState) {
+	auto &local = localState.Cast<RdfCopyLocalState>();
+	reportingErrors([&] { local.sink.finish(); });
+	globalState.Cast<RdfCopyGlobalState>().append(local.buffer);
+}
+
+void rdfCopyFinalize(duckdb::ClientContext & /*context*/, duckdb::FunctionData & /*bindData*/,
+                     duckdb::GlobalFunctionData &globalState) {
+	auto &global = globalState.Cast<RdfCopyGlobalState>();
+	global.handle->Sync();
+	global.handle->Close();
+	global.handle.reset();
+}
+
+duckdb::CopyFunctionExecutionMode rdfCopyExecutionMode(bool preserveInsertionOrder, bool /*supportsBatchIndex*/) {
+	return preserveInsertionOrder ? duckdb::CopyFunctionExecutionMode::REGULAR_COPY_TO_FILE
+	                              : duckdb::CopyFunctionExecutionMode::PARALLEL_COPY_TO_FILE;
+}
+
+duckdb::CopyFunction rdfCopyFunction(const std::string &name, const std::string &extension) {
+	duckdb::CopyFunction function(name);
+	function.copy_to_bind = rdfCopyBind;
+	function.copy_to_initialize_global = rdfCopyInitializeGlobal;
+	function.copy_to_initialize_local = rdfCopyInitializeLocal;
+	function.copy_to_sink = rdfCopySink;
+	function.copy_to_combine = rdfCopyCombine;
+	function.copy_to_finalize = rdfCopyFinalize;
+	function.execution_mode = rdfCopyExecutionMode;
+	function.extension = extension;
+	return function;
+}
+
+} // namespace
+
+void registerRdfCopyFunctions(duckdb::ExtensionLoader &loader) {
+	loader.RegisterFunction(rdfCopyFunction("rdf", "nt"));
+	loader.RegisterFunction(rdfCopyFunction("ntriples", "nt"));
+	loader.RegisterFunction(rdfCopyFunction("nquads", "nq"));
+}
+
+void Sql2rdfExtension::Load(duckdb::ExtensionLoader &loader) {
+	registerRdfCopyFunctions(loader);
+}
+
+std::string Sql2rdfExtension::Name() {
+	return "sql2rdf";
+}
+
+} // namespace r2rml
+
+extern "C" {
+
+// Entry point DuckDB calls when the extension is built loadable and LOADed.
+DUCKDB_CPP_EXTENSION_ENTRY(sql2rdf, loader) {
+	r2rml::registerRdfCopyFunctions(loader);
+}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+#include <string>
+
+namespace r2rml {
+
+/**
+ * DuckDB extension exporting query results as RDF through an R2RML mapping:
+ *
+ *   COPY (SELECT ...) TO 'out.nt' (FORMAT ntriples, MAPPING 'mapping.ttl');
+ *   COPY emp TO 'out.nq' (FORMAT nquads, MAPPING 'mapping.ttl', TRIPLES_MAP 'Emp');
+ *
+ * FORMAT rdf picks N-Quads for a ".nq" file and N-Triples otherwise.  The
+ * mapping (R2RML Turtle or YARRRML) is parsed once per statement and must
+ * be valid inside-out; TRIPLES_MAP names the triples map to run (see
+ * RdfSink::findTriplesMap()) and may be left out when there is only one.
+ * Every result column the map reads must be in the query, named as the
+ * mapping spells it (names are compared upper-cased, as DuckDBConnection
+ * does).
+ *
+ * Each DuckDB thread converts its own chunks into a thread-local buffer;
+ * the buffers are appended to the file whole statements at a time, and
+ * the rest at the combine step.  With preserve_insertion_order (DuckDB's
+ * default) the export runs on one thread and keeps the row order; turn it
+ * off to run in parallel.
+ */
+class Sql2rdfExtension : public duckdb::Extension {
+public:
+	void Load(duckdb::ExtensionLoader &loader) override;
+	std::string Name() override;
+};
+
+/** Register the rdf, ntriples and nquads COPY TO formats. */
+void registerRdfCopyFunctions(duckdb::ExtensionLoader &loader);
+
+} // namespace r2rml
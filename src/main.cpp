@@ -1,27 +1,38 @@
 #include <cerrno>
 #include <cstdio>
+#include <cstdlib>
 #include <cctype>
 #include <cstring>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <serd/serd.h>
 
 #include "DuckDBConnection.h"
+#include "r2rml/BaseTableOrView.h"
+#include "r2rml/BinaryRdfWriter.h"
+#include "r2rml/ExportOptions.h"
+#include "r2rml/ExportReport.h"
+#include "r2rml/LogicalTable.h"
 #include "r2rml/MappingParser.h"
+#include "r2rml/NTriplesWriter.h"
 #include "r2rml/R2RMLMapping.h"
 #include "r2rml/SQLResultSet.h"
 #include "r2rml/SQLRow.h"
 #include "r2rml/SQLValue.h"
+#include "r2rml/ShardedOutput.h"
 #include "r2rml/TriplesMap.h"
+#include "r2rml/WatermarkState.h"
 #include "sparql-parser/Parser.h"
 #include "sparql-parser/PrettyPrinter.h"
 #include "sparql2sql/DialectFactory.h"
 #include "sparql2sql/Translator.h"
 #include "sparql2sql/TypeCatalog.h"
+#include "sql2rdf/BlockCompressor.h"
 #include "sql2rdf/TypeCatalogLoader.h"
 #include "yarrrml/YARRRMLParser.h"
 
@@ -37,10 +48,69 @@ static void printHelp(const char *programName) {
 	          << "  output.nt                 Output RDF file\n"
 	          << "\n"
 	          << "Options:\n"
-	          << "  -f ntriples|turtle   Output format (default: ntriples); ignored with -T\n"
+	          << "  -f ntriples|turtle|binary\n"
+	          << "                       Output format (default: ntriples); ignored with -T.\n"
+	          << "                       binary is a compact stream with prefix and name\n"
+	          << "                       tables (see doc/api.md); not with --threads\n"
 	          << "  -y                   Force the mapping file to be parsed as YARRRML,\n"
 	          << "                       regardless of its extension\n"
 	          << "  -P                   Print the parsed mapping to stderr\n"
+	          << "  --push-down-joins    Evaluate each rr:refObjectMap as one SQL join in the\n"
+	          << "                       database instead of joining rows client-side\n"
+	          << "  --threads <n>        Export TriplesMaps on n threads, each with its own\n"
+	          << "                       database connection (default: 1; 0 = one per core);\n"
+	          << "                       output is still written in mapping order\n"
+	          << "  --partitions <n>     With --threads, split each rr:tableName table into n\n"
+	          << "                       rowid ranges exported as separate queries, so one\n"
+	          << "                       large table is shared by all threads; a view, which\n"
+	          << "                       has no rowid, is exported whole unless it has a\n"
+	          << "                       --partition-column\n"
+	          << "  --partition-column [name=]column\n"
+	          << "                       With --partitions, the integer column to split the\n"
+	          << "                       logical tables of the TriplesMaps called name (id or\n"
+	          << "                       local name) or over table name on instead of rowid;\n"
+	          << "                       all of them without name.  Also partitions rr:sqlQuery\n"
+	          << "                       views.  May be repeated\n"
+	          << "  --dedup              Drop repeated statements, comparing 128-bit hashes;\n"
+	          << "                       prints how many were dropped\n"
+	          << "  --dedup-memory <MiB> Memory for --dedup's hashes before it spills sorted\n"
+	          << "                       runs to temporary files (default: 1024); statements\n"
+	          << "                       held back past it are written last, unordered\n"
+	          << "  --compress <codec>   Compress the output: gzip, zstd or none (default:\n"
+	          << "                       chosen by the output file's extension, .gz or .zst);\n"
+	          << "                       zstd only if sql2rdf was built with libzstd\n"
+	          << "  --compress-threads <n>\n"
+	          << "                       Threads compressing output blocks (default: 0 =\n"
+	          << "                       one per core)\n"
+	          << "  --shard-per-map      Write output.nt as a directory of shards, starting a\n"
+	          << "                       new one at each TriplesMap, with a manifest.json\n"
+	          << "                       listing them; with --threads, shards are written\n"
+	          << "                       concurrently.  N-Triples only, no --dedup or\n"
+	          << "                       compression\n"
+	          << "  --shard-statements <n>\n"
+	          << "                       Shard as above, starting a new shard after n\n"
+	          << "                       statements\n"
+	          << "  --shard-size <MiB>   Shard as above, starting a new shard once one has\n"
+	          << "                       reached this size\n"
+	          << "  --incremental <state>\n"
+	          << "                       Export only the rows added or updated since the run\n"
+	          << "                       that last wrote the state file, judged by the\n"
+	          << "                       --watermark columns; the state is updated once the\n"
+	          << "                       export succeeds.  TriplesMaps without a watermark\n"
+	          << "                       column are exported in full; rows with a null\n"
+	          << "                       watermark and deleted rows go unseen\n"
+	          << "  --watermark [name=]column\n"
+	          << "                       With --incremental, the column growing with each\n"
+	          << "                       insert or update (e.g. a timestamp) of the logical\n"
+	          << "                       tables of the TriplesMaps called name (id or local\n"
+	          << "                       name) or over table name; all of them without\n"
+	          << "                       name.  May be repeated\n"
+	          << "  --metrics <file.json>\n"
+	          << "                       Write per-TriplesMap and per-predicateObjectMap\n"
+	          << "                       metrics to a JSON file: rows, triples, skipped nulls,\n"
+	          << "                       join probes and the time spent executing queries,\n"
+	          << "                       fetching rows, generating terms, probing join\n"
+	          << "                       indexes and writing statements\n"
 	          << "  -Q <file.rq>         Parse a SPARQL query file and print its AST to\n"
 	          << "                       stdout, then exit (bypasses the mapping/database/\n"
 	          << "                       output pipeline entirely)\n"
@@ -60,6 +130,68 @@ static void printHelp(const char *programName) {
 	          << "  -h                   Show this help message\n";
 }
 
+/// Add the `[name=]column` argument `arg` of `option` to `columns`; false,
+/// after saying why, if it is malformed.
+static bool addTableColumn(const char *option, const char *arg,
+                           std::vector<std::pair<std::string, std::string>> &columns) {
+	std::string column = arg ? arg : "";
+	std::size_t equals = column.find('=');
+	if (column.empty() || equals == 0 || (equals != std::string::npos && equals + 1 == column.size())) {
+		std::cerr << "Error: " << option << " requires a [name=]column argument\n";
+		return false;
+	}
+	if (equals == std::string::npos) {
+		columns.emplace_back(std::string(), column);
+	} else {
+		columns.emplace_back(column.substr(0, equals), column.substr(equals + 1));
+	}
+	return true;
+}
+
+/// Set the logical table `member` (watermarkColumn, partitionColumn) of the
+/// TriplesMaps each `option [name=]column` selects: those whose id, the id's
+/// local name after '#' or '/', or rr:tableName is `name`, or all of them
+/// without one.  False, after saying which, if a name selects none.
+static bool applyTableColumns(r2rml::R2RMLMapping &mapping,
+                              const std::vector<std::pair<std::string, std::string>> &columns,
+                              std::string r2rml::LogicalTable::*member, const char *option) {
+	for (const auto &column : columns) {
+		bool matched = false;
+		for (const auto &tm : mapping.triplesMaps) {
+			const std::string &id = tm->id;
+			const auto *table = dynamic_cast<const r2rml::BaseTableOrView *>(tm->logicalTable.get());
+			if (!column.first.empty() && column.first != id && column.first != id.substr(id.find_last_of("#/") + 1) &&
+			    !(table && column.first == table->tableName)) {
+				continue;
+			}
+			(*tm->logicalTable).*member = column.second;
+			matched = true;
+		}
+		if (!matched) {
+			std::cerr << "Error: " << option << " '" << column.first << "' matches no TriplesMap\n";
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Write `report` as JSON to `path` (ExportOptions::metrics); false, after
+/// saying why, if it can't be written.
+static bool writeMetrics(const char *path, const r2rml::ExportReport &report) {
+	std::string json = report.toJson();
+	FILE *file = std::fopen(path, "w");
+	if (!file) {
+		std::cerr << "Error: cannot create metrics file '" << path << "': " << std::strerror(errno) << "\n";
+		return false;
+	}
+	const bool written = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+	if (std::fclose(file) != 0 || !written) {
+		std::cerr << "Error: cannot write metrics file '" << path << "'\n";
+		return false;
+	}
+	return true;
+}
+
 int main(int argc, char *argv[]) {
 	if (argc < 2) {
 		printHelp(argv[0]);
@@ -69,6 +201,7 @@ int main(int argc, char *argv[]) {
 	bool printMapping = false;
 	bool forceYarrrml = false;
 	SerdSyntax outputFormat = SERD_NTRIPLES;
+	bool binaryOutput = false;
 	const char *mappingFile = nullptr;
 	const char *databaseFile = nullptr;
 	const char *outputFile = nullptr;
@@ -76,6 +209,16 @@ int main(int argc, char *argv[]) {
 	const char *translateQueryFile = nullptr;
 	const char *dialectName = "duckdb";
 	bool prettyPrint = false;
+	const char *compressName = nullptr;
+	unsigned compressThreads = 0;
+	bool shardPerMap = false;
+	unsigned long long shardStatements = 0;
+	unsigned long long shardMebibytes = 0;
+	const char *incrementalFile = nullptr;
+	std::vector<std::pair<std::string, std::string>> watermarks;
+	std::vector<std::pair<std::string, std::string>> partitionColumns;
+	const char *metricsFile = nullptr;
+	r2rml::ExportOptions exportOptions;
 
 	for (int i = 1; i < argc; ++i) {
 		if (std::strcmp(argv[i], "-h") == 0 || std::strcmp(argv[i], "--help") == 0) {
@@ -105,18 +248,110 @@ int main(int argc, char *argv[]) {
 			dialectName = argv[i];
 		} else if (std::strcmp(argv[i], "--pretty") == 0) {
 			prettyPrint = true;
+		} else if (std::strcmp(argv[i], "--push-down-joins") == 0) {
+			exportOptions.pushDownJoins = true;
+		} else if (std::strcmp(argv[i], "--threads") == 0) {
+			char *end = nullptr;
+			if (++i < argc) {
+				exportOptions.threads = static_cast<unsigned>(std::strtoul(argv[i], &end, 10));
+			}
+			if (i >= argc || !std::isdigit(static_cast<unsigned char>(argv[i][0])) || *end != '\0') {
+				std::cerr << "Error: --threads requires a thread count (0 = one per core)\n";
+				return 1;
+			}
+		} else if (std::strcmp(argv[i], "--partitions") == 0) {
+			char *end = nullptr;
+			if (++i < argc) {
+				exportOptions.partitions = static_cast<unsigned>(std::strtoul(argv[i], &end, 10));
+			}
+			if (i >= argc || !std::isdigit(static_cast<unsigned char>(argv[i][0])) || *end != '\0' ||
+			    exportOptions.partitions == 0) {
+				std::cerr << "Error: --partitions requires a positive partition count\n";
+				return 1;
+			}
+		} else if (std::strcmp(argv[i], "--dedup") == 0) {
+			exportOptions.dedup = true;
+		} else if (std::strcmp(argv[i], "--dedup-memory") == 0) {
+			char *end = nullptr;
+			unsigned long mebibytes = 0;
+			if (++i < argc) {
+				mebibytes = std::strtoul(argv[i], &end, 10);
+			}
+			if (i >= argc || !std::isdigit(static_cast<unsigned char>(argv[i][0])) || *end != '\0' ||
+			    mebibytes == 0) {
+				std::cerr << "Error: --dedup-memory requires a positive size in MiB\n";
+				return 1;
+			}
+			exportOptions.dedup = true;
+			exportOptions.dedupMemory = static_cast<std::size_t>(mebibytes) << 20;
+		} else if (std::strcmp(argv[i], "--compress") == 0) {
+			if (++i >= argc) {
+				std::cerr << "Error: --compress requires a codec argument (gzip|zstd|none)\n";
+				return 1;
+			}
+			compressName = argv[i];
+		} else if (std::strcmp(argv[i], "--compress-threads") == 0) {
+			char *end = nullptr;
+			if (++i < argc) {
+				compressThreads = static_cast<unsigned>(std::strtoul(argv[i], &end, 10));
+			}
+			if (i >= argc || !std::isdigit(static_cast<unsigned char>(argv[i][0])) || *end != '\0') {
+				std::cerr << "Error: --compress-threads requires a thread count (0 = one per core)\n";
+				return 1;
+			}
+		} else if (std::strcmp(argv[i], "--shard-per-map") == 0) {
+			shardPerMap = true;
+		} else if (std::strcmp(argv[i], "--shard-statements") == 0 || std::strcmp(argv[i], "--shard-size") == 0) {
+			const bool statements = std::strcmp(argv[i], "--shard-statements") == 0;
+			char *end = nullptr;
+			unsigned long long limit = 0;
+			if (++i < argc) {
+				limit = std::strtoull(argv[i], &end, 10);
+			}
+			if (i >= argc || !std::isdigit(static_cast<unsigned char>(argv[i][0])) || *end != '\0' || limit == 0) {
+				std::cerr << "Error: " << argv[i - 1] << " requires a positive "
+				          << (statements ? "statement count\n" : "size in MiB\n");
+				return 1;
+			}
+			(statements ? shardStatements : shardMebibytes) = limit;
+		} else if (std::strcmp(argv[i], "--incremental") == 0) {
+			if (++i >= argc) {
+				std::cerr << "Error: --incremental requires a state file argument\n";
+				return 1;
+			}
+			incrementalFile = argv[i];
+		} else if (std::strcmp(argv[i], "--watermark") == 0) {
+			if (!addTableColumn("--watermark", ++i < argc ? argv[i] : nullptr, watermarks)) {
+				return 1;
+			}
+		} else if (std::strcmp(argv[i], "--partition-column") == 0) {
+			if (!addTableColumn("--partition-column", ++i < argc ? argv[i] : nullptr, partitionColumns)) {
+				return 1;
+			}
+		} else if (std::strcmp(argv[i], "--metrics") == 0) {
+			if (++i >= argc) {
+				std::cerr << "Error: --metrics requires an output file argument\n";
+				return 1;
+			}
+			metricsFile = argv[i];
+			exportOptions.metrics = true;
 		} else if (std::strcmp(argv[i], "-f") == 0) {
 			if (++i >= argc) {
 				std::cerr << "Error: -f requires a format argument"
-				             " (ntriples|turtle)\n";
+				             " (ntriples|turtle|binary)\n";
 				return 1;
 			}
 			if (std::strcmp(argv[i], "ntriples") == 0) {
 				outputFormat = SERD_NTRIPLES;
+				binaryOutput = false;
 			} else if (std::strcmp(argv[i], "turtle") == 0) {
 				outputFormat = SERD_TURTLE;
+				binaryOutput = false;
+			} else if (std::strcmp(argv[i], "binary") == 0) {
+				outputFormat = SERD_NTRIPLES;
+				binaryOutput = true;
 			} else {
-				std::cerr << "Error: unknown format '" << argv[i] << "' (use ntriples or turtle)\n";
+				std::cerr << "Error: unknown format '" << argv[i] << "' (use ntriples, turtle or binary)\n";
 				return 1;
 			}
 		} else if (argv[i][0] != '-') {
@@ -270,6 +505,43 @@ int main(int argc, char *argv[]) {
 		return 1;
 	}
 
+	// The binary stream's tables are per writer, so parallel parts can't be
+	// concatenated the way line-based ones are.
+	if (binaryOutput && (exportOptions.threads != 1 || exportOptions.partitions != 1)) {
+		std::cerr << "Error: -f binary cannot be combined with --threads or --partitions\n";
+		return 1;
+	}
+
+	if (!partitionColumns.empty() && exportOptions.partitions == 1) {
+		std::cerr << "Error: --partition-column requires --partitions\n";
+		return 1;
+	}
+
+	if (!incrementalFile != watermarks.empty()) {
+		std::cerr << "Error: --incremental and --watermark must be given together\n";
+		return 1;
+	}
+
+	const bool sharded = shardPerMap || shardStatements || shardMebibytes;
+	if (sharded && (outputFormat != SERD_NTRIPLES || binaryOutput || exportOptions.dedup || compressName)) {
+		std::cerr << "Error: sharded output is N-Triples only and cannot be combined with --dedup or --compress\n";
+		return 1;
+	}
+
+	sql2rdf::Compression compression = sharded ? sql2rdf::Compression::None : sql2rdf::compressionForPath(outputFile);
+	if (compressName) {
+		try {
+			compression = sql2rdf::parseCompression(compressName);
+		} catch (const std::exception &e) {
+			std::cerr << "Error: " << e.what() << "\n";
+			return 1;
+		}
+	}
+	if (!sql2rdf::compressionAvailable(compression)) {
+		std::cerr << "Error: this build cannot write zstd output (it was built without libzstd)\n";
+		return 1;
+	}
+
 	// -------------------------------------------------------------------------
 	// Parse and validate the mapping (R2RML Turtle or YARRRML YAML, chosen by
 	// file extension unless -y forces YARRRML).
@@ -294,6 +566,26 @@ int main(int argc, char *argv[]) {
 		return 1;
 	}
 
+	// -------------------------------------------------------------------------
+	// Incremental export: the marks of the last run, or none on the first
+	// -------------------------------------------------------------------------
+	r2rml::WatermarkState watermarkState;
+	if (incrementalFile) {
+		if (!applyTableColumns(mapping, watermarks, &r2rml::LogicalTable::watermarkColumn, "--watermark")) {
+			return 1;
+		}
+		try {
+			watermarkState.load(incrementalFile);
+		} catch (const std::exception &e) {
+			std::cerr << "Error: " << e.what() << "\n";
+			return 1;
+		}
+		exportOptions.watermarks = &watermarkState;
+	}
+	if (!applyTableColumns(mapping, partitionColumns, &r2rml::LogicalTable::partitionColumn, "--partition-column")) {
+		return 1;
+	}
+
 	// -------------------------------------------------------------------------
 	// Open the DuckDB database
 	// -------------------------------------------------------------------------
@@ -305,6 +597,34 @@ int main(int argc, char *argv[]) {
 		return 1;
 	}
 
+	// -------------------------------------------------------------------------
+	// Sharded output: a directory of shards and a manifest, written by the
+	// export's workers themselves
+	// -------------------------------------------------------------------------
+	if (sharded) {
+		try {
+			r2rml::ShardedOutput shards(outputFile, SERD_NTRIPLES, shardPerMap,
+			                            static_cast<std::size_t>(shardStatements),
+			                            static_cast<std::size_t>(shardMebibytes << 20));
+			r2rml::DuckDBConnection &primary = *dbConn;
+			r2rml::ExportReport report;
+			mapping.processDatabase([&primary]() { return std::unique_ptr<r2rml::SQLConnection>(primary.connect()); },
+			                        shards, exportOptions, &report);
+			std::string manifest = shards.writeManifest();
+			if (metricsFile && !writeMetrics(metricsFile, report)) {
+				return 1;
+			}
+			if (incrementalFile) {
+				watermarkState.save(incrementalFile);
+			}
+			std::cerr << "Written " << shards.shards().size() << " shards, listed in " << manifest << "\n";
+		} catch (const std::exception &e) {
+			std::cerr << "Error: " << e.what() << "\n";
+			return 1;
+		}
+		return 0;
+	}
+
 	// -------------------------------------------------------------------------
 	// Open the output file
 	// -------------------------------------------------------------------------
@@ -314,6 +634,17 @@ int main(int argc, char *argv[]) {
 		return 1;
 	}
 
+	// Compressed output goes through a BlockCompressor, which compresses
+	// fixed-size blocks on its own threads while the export carries on.
+	SerdSink outSink = serd_file_sink;
+	void *outStream = outFile;
+	std::unique_ptr<sql2rdf::BlockCompressor> compressor;
+	if (compression != sql2rdf::Compression::None) {
+		compressor.reset(new sql2rdf::BlockCompressor(compression, outFile, compressThreads));
+		outSink = sql2rdf::BlockCompressor::sink;
+		outStream = compressor.get();
+	}
+
 	// -------------------------------------------------------------------------
 	// Create the Serd writer
 	// -------------------------------------------------------------------------
@@ -321,7 +652,7 @@ int main(int argc, char *argv[]) {
 	                                                : static_cast<SerdStyle>(0);
 
 	SerdWriter *writer = serd_writer_new(outputFormat, style, mapping.serdEnvironment,
-	                                     /*base_uri=*/nullptr, serd_file_sink, outFile);
+	                                     /*base_uri=*/nullptr, outSink, outStream);
 
 	// For Turtle output, emit the @prefix declarations collected by the parser
 	// so that the output is compact and readable.
@@ -333,8 +664,33 @@ int main(int argc, char *argv[]) {
 	// Execute the mapping
 	// -------------------------------------------------------------------------
 	int exitCode = 0;
+	r2rml::ExportReport report;
 	try {
-		mapping.processDatabase(*dbConn, *writer);
+		bool sequential = exportOptions.threads == 1 && exportOptions.partitions == 1;
+		if (binaryOutput) {
+			r2rml::BinaryRdfWriter binaryWriter(mapping.serdEnvironment, &mapping.constants, outSink, outStream);
+			mapping.processDatabase(*dbConn, binaryWriter, exportOptions, &report);
+			binaryWriter.flush();
+		} else if (sequential && r2rml::NTriplesWriter::supports(outputFormat)) {
+			// Line-based output skips SerdWriter for the dedicated writer.
+			r2rml::NTriplesWriter ntWriter(outputFormat, mapping.serdEnvironment, &mapping.constants, outSink,
+			                               outStream);
+			mapping.processDatabase(*dbConn, ntWriter, exportOptions, &report);
+			ntWriter.flush();
+		} else if (sequential) {
+			mapping.processDatabase(*dbConn, *writer, exportOptions, &report);
+		} else {
+			r2rml::DuckDBConnection &primary = *dbConn;
+			mapping.processDatabase([&primary]() { return std::unique_ptr<r2rml::SQLConnection>(primary.connect()); },
+			                        outputFormat, style, outSink, outStream, exportOptions, &report);
+		}
+		if (exportOptions.dedup) {
+			std::cerr << "Dropped " << report.duplicatesDropped << " duplicate statements";
+			if (report.dedupSpills) {
+				std::cerr << " (" << report.dedupSpills << " runs spilled to disk)";
+			}
+			std::cerr << "\n";
+		}
 	} catch (const std::exception &e) {
 		std::cerr << "Error: " << e.what() << "\n";
 		exitCode = 1;
@@ -345,7 +701,33 @@ int main(int argc, char *argv[]) {
 	// -------------------------------------------------------------------------
 	serd_writer_finish(writer);
 	serd_writer_free(writer);
-	std::fclose(outFile);
+	if (compressor) {
+		try {
+			compressor->finish();
+		} catch (const std::exception &e) {
+			std::cerr << "Error: " << e.what() << "\n";
+			exitCode = 1;
+		}
+		compressor.reset();
+	}
+	if (std::fclose(outFile) != 0 && exitCode == 0) {
+		std::cerr << "Error: cannot write output file '" << outputFile << "': " << std::strerror(errno) << "\n";
+		exitCode = 1;
+	}
+
+	if (exitCode == 0 && metricsFile && !writeMetrics(metricsFile, report)) {
+		exitCode = 1;
+	}
+
+	// The marks move on only once the delta they cover is safely written.
+	if (exitCode == 0 && incrementalFile) {
+		try {
+			watermarkState.save(incrementalFile);
+		} catch (const std::exception &e) {
+			std::cerr << "Error: " << e.what() << "\n";
+			exitCode = 1;
+		}
+	}
 
 	if (exitCode == 0) {
 		std::cerr << "Written to " << outputFile << "\n";
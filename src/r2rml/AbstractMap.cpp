@@ -1,35 +1,100 @@
 #include "r2rml/AbstractMap.h"
 
-#include <cstdio>
 #include <cstring>
-#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace r2rml {
 
 AbstractMap::~AbstractMap() = default;
 
+namespace {
+
+// unreserved[c] is 1 for the bytes RFC 3986 leaves as-is (A-Z a-z 0-9 - _ . ~)
+// and 0 for every byte percentEncode() escapes -- exactly DuckDB's
+// url_encode(), which the SPARQL-to-SQL translator relies on matching.
+struct UnreservedTable {
+	unsigned char unreserved[256];
+
+	UnreservedTable() {
+		std::memset(unreserved, 0, sizeof(unreserved));
+		for (int c = 'A'; c <= 'Z'; ++c) {
+			unreserved[c] = 1;
+			unreserved[c - 'A' + 'a'] = 1;
+		}
+		for (int c = '0'; c <= '9'; ++c) {
+			unreserved[c] = 1;
+		}
+		unreserved[static_cast<unsigned char>('-')] = 1;
+		unreserved[static_cast<unsigned char>('_')] = 1;
+		unreserved[static_cast<unsigned char>('.')] = 1;
+		unreserved[static_cast<unsigned char>('~')] = 1;
+	}
+};
+
+const UnreservedTable kUnreserved;
+
+const char kHexDigits[] = "0123456789ABCDEF";
+
+// Length of the leading run of unreserved bytes in s[0, n).
+std::size_t unreservedPrefix(const char *s, std::size_t n) {
+	std::size_t i = 0;
+#if defined(__SSE2__)
+	// Sixteen bytes at a time.  Signed compares treat bytes >= 0x80 as
+	// negative, so they never fall in a range and are always escaped.
+	const __m128i caseBit = _mm_set1_epi8(0x20);
+	const __m128i beforeLower = _mm_set1_epi8('a' - 1);
+	const __m128i afterLower = _mm_set1_epi8('z' + 1);
+	const __m128i beforeDigit = _mm_set1_epi8('0' - 1);
+	const __m128i afterDigit = _mm_set1_epi8('9' + 1);
+	const __m128i dash = _mm_set1_epi8('-');
+	const __m128i underscore = _mm_set1_epi8('_');
+	const __m128i dot = _mm_set1_epi8('.');
+	const __m128i tilde = _mm_set1_epi8('~');
+	for (; i + 16 <= n; i += 16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+		const __m128i folded = _mm_or_si128(v, caseBit); // 'A'-'Z' -> 'a'-'z'
+		__m128i ok = _mm_and_si128(_mm_cmpgt_epi8(folded, beforeLower), _mm_cmplt_epi8(folded, afterLower));
+		ok = _mm_or_si128(ok, _mm_and_si128(_mm_cmpgt_epi8(v, beforeDigit), _mm_cmplt_epi8(v, afterDigit)));
+		ok = _mm_or_si128(ok, _mm_or_si128(_mm_cmpeq_epi8(v, dash), _mm_cmpeq_epi8(v, underscore)));
+		ok = _mm_or_si128(ok, _mm_or_si128(_mm_cmpeq_epi8(v, dot), _mm_cmpeq_epi8(v, tilde)));
+		const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(ok));
+		if (mask != 0xFFFFu) {
+			return i + static_cast<std::size_t>(__builtin_ctz(~mask));
+		}
+	}
+#endif
+	while (i < n && kUnreserved.unreserved[static_cast<unsigned char>(s[i])]) {
+		++i;
+	}
+	return i;
+}
+
+} // namespace
+
 std::string AbstractMap::percentEncode(const std::string &value) {
-	static const char unreserved[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-	                                 "abcdefghijklmnopqrstuvwxyz"
-	                                 "0123456789-_.~";
 	std::string out;
 	out.reserve(value.size());
-	for (unsigned char c : value) {
-		if (std::strchr(unreserved, static_cast<char>(c))) {
-			out += static_cast<char>(c);
-		} else {
-			char buf[4];
-			std::snprintf(buf, sizeof(buf), "%%%02X", static_cast<unsigned>(c));
-			out += buf;
-		}
-	}
+	appendPercentEncoded(out, value.data(), value.size());
 	return out;
 }
 
-void AbstractMap::checkWriteStatus(SerdStatus status) {
-	if (status != SERD_SUCCESS) {
-		throw std::runtime_error(std::string("R2RML: failed to write RDF statement: ") +
-		                         reinterpret_cast<const char *>(serd_strerror(status)));
+void AbstractMap::appendPercentEncoded(std::string &out, const char *s, std::size_t n) {
+	std::size_t i = 0;
+	while (i < n) {
+		// Copy each run of unreserved bytes in one append (for the typical
+		// numeric or alphanumeric key, the whole value)...
+		const std::size_t run = unreservedPrefix(s + i, n - i);
+		out.append(s + i, run);
+		i += run;
+		// ...then escape the bytes up to the next unreserved one.
+		for (; i < n && !kUnreserved.unreserved[static_cast<unsigned char>(s[i])]; ++i) {
+			const unsigned char c = static_cast<unsigned char>(s[i]);
+			const char escaped[3] = {'%', kHexDigits[c >> 4], kHexDigits[c & 0x0F]};
+			out.append(escaped, 3);
+		}
 	}
 }
 
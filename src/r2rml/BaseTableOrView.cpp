@@ -7,19 +7,32 @@
 namespace r2rml {
 
 BaseTableOrView::BaseTableOrView(const std::string &table) : tableName(table) {
+	effectiveSqlQuery = selectQuery();
 }
 
 BaseTableOrView::~BaseTableOrView() = default;
 
 std::unique_ptr<SQLResultSet> BaseTableOrView::getRows(SQLConnection &dbConnection) {
+	// effectiveSqlQuery is left alone: concurrent exports of a compiled
+	// mapping (see R2RMLMapping's parallel processDatabase()) share it.
+	return dbConnection.execute(rowQuery());
+}
+
+std::string BaseTableOrView::selectQuery() const {
 	// Construct the effective SQL query for a base table or view.
-	std::string query = "SELECT * FROM \"" + tableName + "\"";
-	effectiveSqlQuery = query;
-	return dbConnection.execute(query);
+	return "SELECT " + selectList() + " FROM \"" + tableName + "\"";
+}
+
+std::string BaseTableOrView::partitionKey() const {
+	return partitionColumn.empty() ? std::string("rowid") : LogicalTable::partitionKey();
+}
+
+std::string BaseTableOrView::partitionSource() const {
+	return "\"" + tableName + "\"";
 }
 
 std::vector<std::string> BaseTableOrView::getColumnNames() {
-	return {};
+	return projection;
 }
 
 std::ostream &BaseTableOrView::print(std::ostream &os) const {
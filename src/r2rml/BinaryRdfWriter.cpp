@@ -0,0 +1,281 @@
+#include "r2rml/BinaryRdfWriter.h"
+#include "r2rml/ConstantPool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace r2rml {
+
+const std::size_t BinaryRdfWriter::defaultBufferSize;
+const std::size_t BinaryRdfWriter::maxNames;
+const unsigned char BinaryRdfWriter::version;
+
+namespace {
+
+enum Record : unsigned char { PrefixRecord = 1, NameRecord = 2, TripleRecord = 3, QuadRecord = 4 };
+
+enum Tag : unsigned char {
+	Repeat = 0,
+	NamedIRI = 1,
+	PrefixedIRI = 2,
+	BlankNode = 3,
+	PlainLiteral = 4,
+	TypedLiteral = 5,
+	LangLiteral = 6
+};
+
+bool isResource(const SerdNode &node) {
+	return node.buf && (node.type == SERD_URI || node.type == SERD_CURIE || node.type == SERD_BLANK);
+}
+
+[[noreturn]] void throwBadArgument() {
+	throw std::runtime_error(std::string("R2RML: failed to write RDF statement: ") +
+	                         reinterpret_cast<const char *>(serd_strerror(SERD_ERR_BAD_ARG)));
+}
+
+} // namespace
+
+BinaryRdfWriter::BinaryRdfWriter(const SerdEnv *env, const ConstantPool *constants, SerdSink sink, void *stream,
+                                 std::size_t bufferSize)
+    : env_(env), constants_(constants), sink_(sink), stream_(stream), bufferSize_(bufferSize) {
+	buffer_.reserve(bufferSize_);
+	buffer_.append("SRDF", 4);
+	buffer_ += static_cast<char>(version);
+	if (constants_) {
+		poolNames_.assign(constants_->size(), 0);
+		for (const std::string &prefix : constants_->iriPrefixes()) {
+			addPrefix(prefix);
+		}
+	}
+}
+
+BinaryRdfWriter::~BinaryRdfWriter() {
+	try {
+		flush();
+	} catch (...) { // NOLINT(bugprone-empty-catch) - errors are reported by an explicit flush()
+	}
+}
+
+void BinaryRdfWriter::addPrefix(const std::string &prefix) {
+	auto it = std::lower_bound(
+	    prefixes_.begin(), prefixes_.end(), prefix,
+	    [](const std::pair<std::string, std::uint64_t> &entry, const std::string &p) { return entry.first < p; });
+	if (prefix.empty() || (it != prefixes_.end() && it->first == prefix)) {
+		return;
+	}
+	const std::uint64_t id = prefixes_.size() + 1;
+	prefixes_.insert(it, std::make_pair(prefix, id));
+	buffer_ += static_cast<char>(PrefixRecord);
+	putVarint(id);
+	putString(prefix.data(), prefix.size());
+}
+
+void BinaryRdfWriter::write(const SerdNode *graph, const SerdNode &subject, const SerdNode &predicate,
+                            const SerdNode &object, const SerdNode *datatype, const SerdNode *lang) {
+	if (!isResource(subject) || !isResource(predicate) || !object.buf) {
+		throwBadArgument();
+	}
+	const bool quad = graph && graph->buf;
+	// Encoding may define table entries, which must precede the statement.
+	encodeResource(subject, false, current_[Subject]);
+	encodeResource(predicate, true, current_[Predicate]);
+	if (object.type == SERD_LITERAL) {
+		encodeLiteral(object, datatype, lang, current_[Object]);
+	} else {
+		encodeResource(object, false, current_[Object]);
+	}
+	if (quad) {
+		encodeResource(*graph, true, current_[Graph]);
+	}
+
+	buffer_ += static_cast<char>(quad ? QuadRecord : TripleRecord);
+	putTerm(Subject);
+	putTerm(Predicate);
+	putTerm(Object);
+	if (quad) {
+		putTerm(Graph);
+	}
+	if (buffer_.size() >= bufferSize_) {
+		flush();
+	}
+}
+
+void BinaryRdfWriter::flush() {
+	if (buffer_.empty()) {
+		return;
+	}
+	const std::size_t written = sink_(buffer_.data(), buffer_.size(), stream_);
+	const bool complete = written == buffer_.size();
+	buffer_.clear();
+	if (!complete) {
+		throw std::runtime_error("R2RML: failed to write RDF output");
+	}
+}
+
+void BinaryRdfWriter::encodeResource(const SerdNode &node, bool named, Term &term) {
+	switch (node.type) {
+	case SERD_URI:
+		encodeIRI(poolIndex(node), reinterpret_cast<const char *>(node.buf), node.n_bytes, named, term);
+		break;
+	case SERD_CURIE: {
+		SerdNode expanded = env_ ? serd_env_expand_node(env_, &node) : SERD_NODE_NULL;
+		if (!expanded.buf) {
+			throwBadArgument(); // undefined prefix
+		}
+		encodeIRI(ConstantPool::npos, reinterpret_cast<const char *>(expanded.buf), expanded.n_bytes, named, term);
+		serd_node_free(&expanded);
+		break;
+	}
+	case SERD_BLANK:
+		term.tag = BlankNode;
+		term.text.assign(reinterpret_cast<const char *>(node.buf), node.n_bytes);
+		break;
+	default:
+		throwBadArgument();
+	}
+}
+
+void BinaryRdfWriter::encodeIRI(std::size_t poolIndex, const char *iri, std::size_t size, bool named, Term &term) {
+	std::uint64_t name = named || poolIndex != ConstantPool::npos ? nameOf(poolIndex, iri, size, false) : 0;
+	if (name) {
+		term.tag = NamedIRI;
+		term.id = name;
+		term.text.clear();
+		return;
+	}
+	std::size_t length = 0;
+	term.tag = PrefixedIRI;
+	term.id = longestPrefix(iri, size, length);
+	term.text.assign(iri + length, size - length);
+}
+
+void BinaryRdfWriter::encodeLiteral(const SerdNode &node, const SerdNode *datatype, const SerdNode *lang,
+                                    Term &term) {
+	term.text.assign(reinterpret_cast<const char *>(node.buf), node.n_bytes);
+	term.id = 0;
+	if (lang && lang->buf) {
+		term.tag = LangLiteral;
+		term.extra = nameOf(poolIndex(*lang), reinterpret_cast<const char *>(lang->buf), lang->n_bytes, true);
+	} else if (datatype && datatype->buf && datatype->type == SERD_CURIE) {
+		SerdNode expanded = env_ ? serd_env_expand_node(env_, datatype) : SERD_NODE_NULL;
+		if (!expanded.buf) {
+			throwBadArgument(); // undefined prefix
+		}
+		term.tag = TypedLiteral;
+		term.extra =
+		    nameOf(ConstantPool::npos, reinterpret_cast<const char *>(expanded.buf), expanded.n_bytes, true);
+		serd_node_free(&expanded);
+	} else if (datatype && datatype->buf) {
+		term.tag = TypedLiteral;
+		term.extra =
+		    nameOf(poolIndex(*datatype), reinterpret_cast<const char *>(datatype->buf), datatype->n_bytes, true);
+	} else {
+		term.tag = PlainLiteral;
+		term.extra = 0;
+	}
+}
+
+void BinaryRdfWriter::putTerm(Position position) {
+	Term &term = current_[position];
+	Term &previous = previous_[position];
+	if (term == previous) {
+		buffer_ += static_cast<char>(Repeat);
+		return;
+	}
+	buffer_ += static_cast<char>(term.tag);
+	switch (term.tag) {
+	case NamedIRI:
+		putVarint(term.id);
+		break;
+	case PrefixedIRI:
+		putVarint(term.id);
+		putString(term.text.data(), term.text.size());
+		break;
+	case TypedLiteral:
+	case LangLiteral:
+		putString(term.text.data(), term.text.size());
+		putVarint(term.extra);
+		break;
+	default:
+		putString(term.text.data(), term.text.size());
+	}
+	std::swap(term, previous);
+}
+
+std::size_t BinaryRdfWriter::poolIndex(const SerdNode &node) const {
+	std::size_t index = constants_ ? constants_->indexOf(node) : ConstantPool::npos;
+	return index < poolNames_.size() ? index : ConstantPool::npos;
+}
+
+std::uint64_t BinaryRdfWriter::nameOf(std::size_t poolIndex, const char *value, std::size_t size, bool force) {
+	// a pool term is found by address once named; anything else by value
+	if (poolIndex != ConstantPool::npos && poolNames_[poolIndex]) {
+		return poolNames_[poolIndex];
+	}
+	key_.assign(value, size);
+	auto it = names_.find(key_);
+	std::uint64_t id;
+	if (it != names_.end()) {
+		id = it->second;
+	} else if (!force && poolIndex == ConstantPool::npos && names_.size() >= maxNames) {
+		return 0; // the table is full of per-row IRIs
+	} else {
+		id = names_.size() + 1;
+		names_.emplace(key_, id);
+		buffer_ += static_cast<char>(NameRecord);
+		putVarint(id);
+		putString(value, size);
+	}
+	if (poolIndex != ConstantPool::npos) {
+		poolNames_[poolIndex] = id;
+	}
+	return id;
+}
+
+std::uint64_t BinaryRdfWriter::longestPrefix(const char *iri, std::size_t size, std::size_t &length) const {
+	// Every prefix of the IRI sorts at or before it, and the last entry that
+	// does is the longest one if it is a prefix at all.  If it isn't, only
+	// entries before it sharing less than it does with the IRI are left.
+	auto end = prefixes_.end();
+	std::size_t limit = size;
+	while (limit > 0) {
+		auto it = std::upper_bound(
+		    prefixes_.begin(), end, limit,
+		    [iri](std::size_t n, const std::pair<std::string, std::uint64_t> &entry) {
+			    return entry.first.compare(0, entry.first.size(), iri, n) > 0;
+		    });
+		if (it == prefixes_.begin()) {
+			break;
+		}
+		--it;
+		const std::string &prefix = it->first;
+		const std::size_t n = std::min(prefix.size(), limit);
+		std::size_t common = 0;
+		while (common < n && prefix[common] == iri[common]) {
+			++common;
+		}
+		if (common == prefix.size()) {
+			length = prefix.size();
+			return it->second;
+		}
+		limit = common;
+		end = it;
+	}
+	length = 0;
+	return 0;
+}
+
+void BinaryRdfWriter::putVarint(std::uint64_t value) {
+	while (value >= 0x80) {
+		buffer_ += static_cast<char>((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	buffer_ += static_cast<char>(value);
+}
+
+void BinaryRdfWriter::putString(const char *data, std::size_t size) {
+	putVarint(size);
+	buffer_.append(data, size);
+}
+
+} // namespace r2rml
@@ -0,0 +1,200 @@
+#include "r2rml/BoundTriplesMap.h"
+#include "r2rml/ExportReport.h"
+#include "r2rml/GraphMap.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/RowBatch.h"
+#include "r2rml/SubjectMap.h"
+#include "r2rml/TriplesMap.h"
+
+#include <chrono>
+
+namespace r2rml {
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds(Clock::time_point from, Clock::time_point to) {
+	return std::chrono::duration<double>(to - from).count();
+}
+
+} // namespace
+
+BoundTriplesMap::BoundTriplesMap(const TriplesMap &triplesMap, const R2RMLMapping &mapping)
+    : triplesMap_(triplesMap), mapping_(mapping), pomTerms_(triplesMap.predicateObjectMaps.size()) {
+	const SubjectMap *subjectMap = triplesMap_.subjectMap.get();
+	if (subjectMap && subjectMap->classNodes.size() == subjectMap->classIRIs.size()) {
+		classNodes_ = subjectMap->classNodes;
+	} else if (subjectMap) {
+		for (const std::string &classIRI : subjectMap->classIRIs) {
+			classNodes_.push_back(
+			    serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>(classIRI.c_str())));
+		}
+	}
+}
+
+void BoundTriplesMap::bind(const RowBatch &batch) {
+	bool same = schema_.size() == batch.columnCount() && binds_ != 0;
+	for (std::size_t i = 0; same && i < schema_.size(); ++i) {
+		same = schema_[i] == batch.column(i).name;
+	}
+	if (same) {
+		return;
+	}
+
+	schema_.clear();
+	for (std::size_t i = 0; i < batch.columnCount(); ++i) {
+		schema_.push_back(batch.column(i).name);
+	}
+	const SubjectMap &subjectMap = *triplesMap_.subjectMap;
+	subjectColumns_ = subjectMap.bindColumns(batch);
+	subjectGraphColumns_ = bindGraphColumns(subjectMap.graphMaps, batch);
+	for (std::size_t i = 0; i < pomTerms_.size(); ++i) {
+		if (triplesMap_.predicateObjectMaps[i]) {
+			triplesMap_.predicateObjectMaps[i]->bindColumns(batch, pomTerms_[i]);
+		}
+	}
+	++binds_;
+}
+
+void BoundTriplesMap::collectMetrics(TriplesMapMetrics *metrics) {
+	metrics_ = metrics;
+	if (metrics_ && metrics_->predicateObjectMaps.size() < pomTerms_.size()) {
+		metrics_->predicateObjectMaps.resize(pomTerms_.size());
+	}
+}
+
+void BoundTriplesMap::generateTriples(const RowBatch &batch, SerdWriter &rdfWriter, SQLConnection &dbConnection,
+                                      JoinIndexCache *joinIndexes) {
+	SerdWriterSink rdfSink(rdfWriter);
+	generateTriples(batch, rdfSink, dbConnection, joinIndexes);
+}
+
+void BoundTriplesMap::generateTriples(const RowBatch &batch, StatementSink &rdfSink, SQLConnection &dbConnection,
+                                      JoinIndexCache *joinIndexes) {
+	if (!triplesMap_.subjectMap || batch.empty()) {
+		return;
+	}
+	bind(batch);
+
+	const SerdEnv *env = mapping_.serdEnvironment;
+	static SerdEnv *fallbackEnv = nullptr;
+	if (!env) {
+		if (!fallbackEnv) {
+			fallbackEnv = serd_env_new(nullptr);
+		}
+		env = fallbackEnv;
+	}
+
+	// With metrics, the clock is read between stages, once per batch, and
+	// statements, skipped terms and join probes are counted as they happen.
+	// Every stage but emission is timed per predicate-object map too.
+	Clock::time_point start = metrics_ ? Clock::now() : Clock::time_point();
+	Clock::time_point mark = start;
+
+	// Column-at-a-time term generation for the whole batch...
+	const auto &poms = triplesMap_.predicateObjectMaps;
+	triplesMap_.subjectMap->generateRDFTerms(batch, subjectColumns_, *env, subjects_);
+	generateGraphTerms(triplesMap_.subjectMap->graphMaps, batch, subjectGraphColumns_, *env, subjectGraphs_);
+	for (std::size_t i = 0; i < poms.size(); ++i) {
+		if (!poms[i]) {
+			continue;
+		}
+		if (metrics_) {
+			mark = Clock::now();
+		}
+		poms[i]->generateTerms(batch, *env, pomTerms_[i], &mapping_.constants);
+		if (metrics_) {
+			metrics_->predicateObjectMaps[i].termSeconds += seconds(mark, Clock::now());
+		}
+	}
+
+	// The POMs' totals so far, to add the batch's to the TriplesMap's.
+	PredicateObjectMapMetrics before;
+	if (metrics_) {
+		metrics_->termSeconds += seconds(start, Clock::now());
+		metrics_->rows += batch.size();
+		for (const PredicateObjectMapMetrics &pom : metrics_->predicateObjectMaps) {
+			before += pom;
+		}
+		start = Clock::now();
+	}
+
+	// ...the join index lookups of every row...
+	if (joinIndexes) {
+		bool joined = false;
+		for (std::size_t i = 0; i < poms.size(); ++i) {
+			if (!poms[i]) {
+				continue;
+			}
+			PredicateObjectMapMetrics *pomMetrics = metrics_ ? &metrics_->predicateObjectMaps[i] : nullptr;
+			if (metrics_) {
+				mark = Clock::now();
+			}
+			if (!poms[i]->probeJoins(batch, subjects_, *env, pomTerms_[i], dbConnection, *joinIndexes, pomMetrics)) {
+				continue;
+			}
+			joined = true;
+			if (metrics_) {
+				pomMetrics->joinSeconds += seconds(mark, Clock::now());
+			}
+		}
+		if (metrics_) {
+			if (joined) {
+				metrics_->joinSeconds += seconds(start, Clock::now());
+			}
+			start = Clock::now();
+		}
+	}
+
+	CountingSink counting(rdfSink, nullptr);
+	StatementSink &sink = metrics_ ? static_cast<StatementSink &>(counting) : rdfSink;
+
+	// ...then emission row by row, so output order matches the per-row path.
+	const SerdNode &rdfType = mapping_.constants.rdfType();
+	static const RowGraphs noGraphs;
+	RowGraphs subjectGraphs;
+	for (std::size_t row = 0; row < batch.size(); ++row) {
+		if (subjects_.isNull(row)) {
+			if (metrics_) {
+				++metrics_->nullsSkipped;
+			}
+			continue; // null subject – skip row
+		}
+		SerdNode subject = subjects_.node(row);
+		subjectGraphs.resolve(triplesMap_.subjectMap->graphMaps, subjectGraphs_, row);
+
+		if (metrics_) {
+			counting.count = &metrics_->triples;
+		}
+		for (const SerdNode &classNode : classNodes_) {
+			forEachGraphNode(subjectGraphs, noGraphs, [&](const SerdNode *graph) {
+				sink.write(graph, subject, rdfType, classNode, nullptr, nullptr);
+			});
+		}
+
+		for (std::size_t i = 0; i < poms.size(); ++i) {
+			if (poms[i]) {
+				PredicateObjectMapMetrics *pomMetrics = nullptr;
+				if (metrics_) {
+					pomMetrics = &metrics_->predicateObjectMaps[i];
+					counting.count = &pomMetrics->triples;
+				}
+				poms[i]->processRow(batch, row, subject, pomTerms_[i], sink, mapping_, dbConnection, subjectGraphs,
+				                    joinIndexes, pomMetrics);
+			}
+		}
+	}
+
+	if (metrics_) {
+		metrics_->writeSeconds += seconds(start, Clock::now());
+		PredicateObjectMapMetrics after;
+		for (const PredicateObjectMapMetrics &pom : metrics_->predicateObjectMaps) {
+			after += pom;
+		}
+		metrics_->triples += after.triples - before.triples;
+		metrics_->joinProbes += after.joinProbes - before.joinProbes;
+	}
+}
+
+} // namespace r2rml
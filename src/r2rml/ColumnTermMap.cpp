@@ -1,6 +1,8 @@
 #include "r2rml/ColumnTermMap.h"
+#include "r2rml/RowBatch.h"
 #include "r2rml/SQLRow.h"
 #include "r2rml/SQLValue.h"
+#include "r2rml/TermBatch.h"
 
 #include <ostream>
 
@@ -12,35 +14,77 @@ ColumnTermMap::ColumnTermMap(const std::string &column) : columnName(column) {
 ColumnTermMap::~ColumnTermMap() = default;
 
 SerdNode ColumnTermMap::generateRDFTerm(const SQLRow &row, const SerdEnv & /*env*/) const {
-	auto val = row.getValue(columnName);
-	if (val->isNull()) {
+	SQLValueView val = row.getValueView(columnName);
+	if (val.isNull()) {
 		return SERD_NODE_NULL;
 	}
 
-	cachedValue_ = val->asString();
+	cachedValue_.assign(val.data(), val.length());
+	return serd_node_from_string(nodeType(), reinterpret_cast<const uint8_t *>(cachedValue_.c_str()));
+}
+
+void ColumnTermMap::generateRDFTerms(const RowBatch &batch, const SerdEnv &env, TermBatch &out) const {
+	generateRDFTerms(batch, bindColumns(batch), env, out);
+}
 
+void ColumnTermMap::generateRDFTerms(const RowBatch &batch, const ColumnOrdinals &columns, const SerdEnv & /*env*/,
+                                     TermBatch &out) const {
+	out.clear();
+	const std::size_t col = columns[0];
+	if (col == RowBatch::npos) {
+		for (std::size_t i = 0; i < batch.size(); ++i) {
+			out.appendNull();
+		}
+		return;
+	}
+	const RowBatch::Column &values = batch.column(col);
+	const SerdType type = nodeType();
+	for (std::size_t i = 0; i < batch.size(); ++i) {
+		if (values.isNull(i)) {
+			out.appendNull();
+		} else {
+			out.append(type, values.data(i), values.length(i));
+		}
+	}
+}
+
+SerdType ColumnTermMap::nodeType() const {
 	// R2RML 7.4's three term types. rr:BlankNode takes the column's value as
 	// the blank node identifier; per the spec the mapping is responsible for
 	// that value being a valid one.
-	SerdType nodeType = SERD_LITERAL;
 	if (termType == TermType::IRI) {
-		nodeType = SERD_URI;
-	} else if (termType == TermType::BlankNode) {
-		nodeType = SERD_BLANK;
+		return SERD_URI;
 	}
-	return serd_node_from_string(nodeType, reinterpret_cast<const uint8_t *>(cachedValue_.c_str()));
+	if (termType == TermType::BlankNode) {
+		return SERD_BLANK;
+	}
+	return SERD_LITERAL;
 }
 
 std::string ColumnTermMap::computeDatatypeIRI(const SQLRow &row) const {
+	return datatypeIRIView(row);
+}
+
+const std::string &ColumnTermMap::datatypeIRIView(const SQLRow &row) const {
 	// Static rr:datatype in the mapping takes priority over inferred types.
 	if (datatypeIRI) {
 		return *datatypeIRI;
 	}
-	auto val = row.getValue(columnName);
-	if (!val || val->isNull()) {
+	return row.getDatatypeIRI(columnName);
+}
+
+std::string ColumnTermMap::computeDatatypeIRI(const RowBatch &batch) const {
+	return computeDatatypeIRI(batch, bindColumns(batch));
+}
+
+std::string ColumnTermMap::computeDatatypeIRI(const RowBatch &batch, const ColumnOrdinals &columns) const {
+	if (datatypeIRI) {
+		return *datatypeIRI;
+	}
+	if (columns[0] == RowBatch::npos) {
 		return std::string();
 	}
-	return val->datatypeIRI();
+	return batch.column(columns[0]).datatypeIRI;
 }
 
 std::ostream &ColumnTermMap::print(std::ostream &os) const {
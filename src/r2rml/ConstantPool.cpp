@@ -0,0 +1,72 @@
+#include "r2rml/ConstantPool.h"
+#include "r2rml/NTriplesWriter.h"
+
+namespace r2rml {
+
+const std::size_t ConstantPool::npos;
+
+static const char RDF_TYPE_URI[] = "http://www.w3.org/1999/02/22-rdf-syntax-ns#type";
+
+ConstantPool::ConstantPool() {
+	intern(SERD_URI, RDF_TYPE_URI, sizeof(RDF_TYPE_URI) - 1);
+	// the datatypes StringSQLValue::datatypeIRI() reports
+	intern(SERD_URI, std::string("http://www.w3.org/2001/XMLSchema#integer"));
+	intern(SERD_URI, std::string("http://www.w3.org/2001/XMLSchema#double"));
+	intern(SERD_URI, std::string("http://www.w3.org/2001/XMLSchema#boolean"));
+	// and the other natural datatypes a result column can carry (DuckDB)
+	intern(SERD_URI, std::string("http://www.w3.org/2001/XMLSchema#decimal"));
+	intern(SERD_URI, std::string("http://www.w3.org/2001/XMLSchema#date"));
+	intern(SERD_URI, std::string("http://www.w3.org/2001/XMLSchema#time"));
+}
+
+const SerdNode &ConstantPool::intern(SerdType type, const char *s, std::size_t n) {
+	std::unordered_map<std::string, std::size_t> &byValue = byValue_[type];
+	std::string value(s, n);
+	auto it = byValue.find(value);
+	if (it != byValue.end()) {
+		return entries_[it->second].node;
+	}
+
+	entries_.emplace_back();
+	Entry &entry = entries_.back();
+	entry.value = value;
+	entry.node = serd_node_from_substring(type, reinterpret_cast<const uint8_t *>(entry.value.data()), n);
+	NTriplesWriter::appendConstant(entry.encoded, entry.node);
+	byValue.emplace(std::move(value), entries_.size() - 1);
+	byBuffer_.emplace(entry.node.buf, entries_.size() - 1);
+	return entry.node;
+}
+
+const SerdNode *ConstantPool::find(SerdType type, const std::string &value) const {
+	const std::unordered_map<std::string, std::size_t> &byValue = byValue_[type];
+	auto it = byValue.find(value);
+	return it == byValue.end() ? nullptr : &entries_[it->second].node;
+}
+
+const std::string *ConstantPool::encoded(const SerdNode &node) const {
+	std::size_t index = indexOf(node);
+	if (index == npos || entries_[index].encoded.empty()) {
+		return nullptr;
+	}
+	return &entries_[index].encoded;
+}
+
+std::size_t ConstantPool::indexOf(const SerdNode &node) const {
+	auto it = byBuffer_.find(node.buf);
+	if (it == byBuffer_.end()) {
+		return npos;
+	}
+	const Entry &entry = entries_[it->second];
+	if (entry.node.type != node.type || entry.node.n_bytes != node.n_bytes) {
+		return npos;
+	}
+	return it->second;
+}
+
+void ConstantPool::addIRIPrefix(const std::string &prefix) {
+	if (!prefix.empty() && iriPrefixSet_.insert(prefix).second) {
+		iriPrefixes_.push_back(prefix);
+	}
+}
+
+} // namespace r2rml
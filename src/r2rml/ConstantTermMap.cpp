@@ -1,4 +1,7 @@
 #include "r2rml/ConstantTermMap.h"
+#include "r2rml/ConstantPool.h"
+#include "r2rml/RowBatch.h"
+#include "r2rml/TermBatch.h"
 
 #include <ostream>
 
@@ -19,6 +22,17 @@ SerdNode ConstantTermMap::generateRDFTerm(const SQLRow &, const SerdEnv &) const
 	return constantValue;
 }
 
+void ConstantTermMap::generateRDFTerms(const RowBatch &batch, const SerdEnv &, TermBatch &out) const {
+	out.setConstant(constantValue, batch.size());
+}
+
+void ConstantTermMap::internConstants(ConstantPool &pool) {
+	TermMap::internConstants(pool);
+	if (constantValue.type != SERD_NOTHING && constantValue.buf) {
+		constantValue = pool.intern(constantValue);
+	}
+}
+
 std::ostream &ConstantTermMap::print(std::ostream &os) const {
 	os << "ConstantTermMap { value=\"" << ownedUri_ << "\" ";
 	TermMap::print(os);
@@ -0,0 +1,101 @@
+#include "r2rml/DedupSink.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace r2rml {
+
+namespace {
+
+// A statement record is six slots - graph, subject, predicate, object,
+// datatype, lang - each a tag byte (0 for none, else 1 + the SerdType)
+// followed, when present, by a 32-bit length and the node's bytes.
+void appendNode(std::string &record, const SerdNode *node) {
+	if (!node || !node->buf) {
+		record += '\0';
+		return;
+	}
+	record += static_cast<char>(1 + node->type);
+	const std::uint32_t size = static_cast<std::uint32_t>(node->n_bytes);
+	record.append(reinterpret_cast<const char *>(&size), sizeof(size));
+	record.append(reinterpret_cast<const char *>(node->buf), node->n_bytes);
+}
+
+} // namespace
+
+DedupSink::DedupSink(StatementSink &out, std::size_t memoryLimit)
+    : out_(out), graphs_(out.writesGraphs()), current_ {},
+      filter_(memoryLimit, [this](const char *record, std::size_t size) { forward(record, size); }) {
+}
+
+void DedupSink::write(const SerdNode *graph, const SerdNode &subject, const SerdNode &predicate,
+                      const SerdNode &object, const SerdNode *datatype, const SerdNode *lang) {
+	record_.clear();
+	appendNode(record_, graphs_ ? graph : nullptr);
+	appendNode(record_, &subject);
+	appendNode(record_, &predicate);
+	appendNode(record_, &object);
+	appendNode(record_, datatype);
+	appendNode(record_, lang);
+
+	current_[0] = graph;
+	current_[1] = &subject;
+	current_[2] = &predicate;
+	current_[3] = &object;
+	current_[4] = datatype;
+	current_[5] = lang;
+	writing_ = true;
+	try {
+		filter_.add(record_.data(), record_.size());
+	} catch (...) {
+		writing_ = false;
+		throw;
+	}
+	writing_ = false;
+}
+
+void DedupSink::flush() {
+	filter_.finish();
+	out_.flush();
+}
+
+void DedupSink::forward(const char *record, std::size_t size) {
+	if (writing_) {
+		out_.write(current_[0], *current_[1], *current_[2], *current_[3], current_[4], current_[5]);
+		return;
+	}
+
+	// a held-back statement: rebuild its nodes from the record
+	SerdNode nodes[6];
+	const char *p = record;
+	const char *end = record + size;
+	for (int i = 0; i < 6; ++i) {
+		if (p == end) {
+			throw std::runtime_error("R2RML: corrupt statement record in duplicate elimination");
+		}
+		const unsigned char tag = static_cast<unsigned char>(*p++);
+		if (tag == 0) {
+			nodes[i] = SERD_NODE_NULL;
+			continue;
+		}
+		std::uint32_t length;
+		if (end - p < static_cast<std::ptrdiff_t>(sizeof(length))) {
+			throw std::runtime_error("R2RML: corrupt statement record in duplicate elimination");
+		}
+		std::memcpy(&length, p, sizeof(length));
+		p += sizeof(length);
+		if (static_cast<std::size_t>(end - p) < length) {
+			throw std::runtime_error("R2RML: corrupt statement record in duplicate elimination");
+		}
+		nodes_[i].assign(p, length);
+		p += length;
+		nodes[i] = serd_node_from_substring(static_cast<SerdType>(tag - 1),
+		                                    reinterpret_cast<const uint8_t *>(nodes_[i].c_str()), length);
+	}
+	auto optional = [&nodes](int i) -> const SerdNode * { return nodes[i].buf ? &nodes[i] : nullptr; };
+	out_.write(optional(0), nodes[1], nodes[2], nodes[3], optional(4), optional(5));
+}
+
+} // namespace r2rml
@@ -0,0 +1,294 @@
+#include "r2rml/DuplicateFilter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace r2rml {
+
+namespace {
+
+/// Approximate footprint of one hash in an std::unordered_set: the node
+/// (hash plus next pointer) and its share of the bucket array.
+const std::size_t seenEntryBytes = 48;
+
+inline std::uint64_t rotl64(std::uint64_t x, int r) {
+	return (x << r) | (x >> (64 - r));
+}
+
+inline std::uint64_t fmix64(std::uint64_t k) {
+	k ^= k >> 33;
+	k *= 0xff51afd7ed558ccdULL;
+	k ^= k >> 33;
+	k *= 0xc4ceb9fe1a85ec53ULL;
+	k ^= k >> 33;
+	return k;
+}
+
+std::FILE *newRunFile() {
+	std::FILE *file = std::tmpfile();
+	if (!file) {
+		throw std::runtime_error("R2RML: cannot create a temporary file for duplicate elimination");
+	}
+	return file;
+}
+
+void writeAll(std::FILE *file, const void *data, std::size_t size) {
+	if (size && std::fwrite(data, 1, size, file) != size) {
+		throw std::runtime_error("R2RML: cannot write a duplicate elimination spill file");
+	}
+}
+
+void readAll(std::FILE *file, void *data, std::size_t size) {
+	if (size && std::fread(data, 1, size, file) != size) {
+		throw std::runtime_error("R2RML: duplicate elimination spill file is truncated");
+	}
+}
+
+/// Reads a run back in order: a hash, and for a record run its sequence
+/// number, size and bytes.
+struct RunReader {
+	RunReader(std::FILE *file, bool emitted) : file(file), emitted(emitted) {
+	}
+
+	std::FILE *file;
+	bool emitted;
+	DuplicateFilter::Hash hash {0, 0};
+	std::uint64_t seq {0};
+	std::string record;
+
+	bool next() {
+		std::uint64_t words[2];
+		std::size_t got = std::fread(words, 1, sizeof(words), file);
+		if (got == 0 && std::feof(file)) {
+			return false;
+		}
+		if (got != sizeof(words)) {
+			throw std::runtime_error("R2RML: duplicate elimination spill file is truncated");
+		}
+		hash = DuplicateFilter::Hash {words[0], words[1]};
+		if (!emitted) {
+			std::uint64_t header[2];
+			readAll(file, header, sizeof(header));
+			seq = header[0];
+			record.resize(static_cast<std::size_t>(header[1]));
+			if (!record.empty()) {
+				readAll(file, &record[0], record.size());
+			}
+		}
+		return true;
+	}
+
+	/// Merge order: by hash, runs of emitted hashes first, then by sequence.
+	bool after(const RunReader &other) const {
+		if (!(hash == other.hash)) {
+			return other.hash < hash;
+		}
+		if (emitted != other.emitted) {
+			return !emitted;
+		}
+		return seq > other.seq;
+	}
+};
+
+} // namespace
+
+DuplicateFilter::Hash DuplicateFilter::hash(const char *data, std::size_t size) {
+	const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+	const std::uint64_t c1 = 0x87c37b91114253d5ULL;
+	const std::uint64_t c2 = 0x4cf5ad432745937fULL;
+	std::uint64_t h1 = 0;
+	std::uint64_t h2 = 0;
+
+	const std::size_t blocks = size / 16;
+	for (std::size_t i = 0; i < blocks; ++i) {
+		std::uint64_t k1;
+		std::uint64_t k2;
+		std::memcpy(&k1, bytes + i * 16, 8);
+		std::memcpy(&k2, bytes + i * 16 + 8, 8);
+
+		k1 *= c1;
+		k1 = rotl64(k1, 31);
+		k1 *= c2;
+		h1 ^= k1;
+		h1 = rotl64(h1, 27);
+		h1 += h2;
+		h1 = h1 * 5 + 0x52dce729;
+
+		k2 *= c2;
+		k2 = rotl64(k2, 33);
+		k2 *= c1;
+		h2 ^= k2;
+		h2 = rotl64(h2, 31);
+		h2 += h1;
+		h2 = h2 * 5 + 0x38495ab5;
+	}
+
+	const unsigned char *tail = bytes + blocks * 16;
+	const std::size_t rest = size & 15;
+	std::uint64_t k1 = 0;
+	std::uint64_t k2 = 0;
+	for (std::size_t i = rest; i > 8; --i) {
+		k2 ^= static_cast<std::uint64_t>(tail[i - 1]) << ((i - 9) * 8);
+	}
+	if (rest > 8) {
+		k2 *= c2;
+		k2 = rotl64(k2, 33);
+		k2 *= c1;
+		h2 ^= k2;
+	}
+	for (std::size_t i = std::min<std::size_t>(rest, 8); i > 0; --i) {
+		k1 ^= static_cast<std::uint64_t>(tail[i - 1]) << ((i - 1) * 8);
+	}
+	if (rest > 0) {
+		k1 *= c1;
+		k1 = rotl64(k1, 31);
+		k1 *= c2;
+		h1 ^= k1;
+	}
+
+	h1 ^= size;
+	h2 ^= size;
+	h1 += h2;
+	h2 += h1;
+	h1 = fmix64(h1);
+	h2 = fmix64(h2);
+	h1 += h2;
+	h2 += h1;
+	return Hash {h1, h2};
+}
+
+DuplicateFilter::DuplicateFilter(std::size_t memoryLimit, Emit emit)
+    : memoryLimit_(memoryLimit), emit_(std::move(emit)) {
+}
+
+DuplicateFilter::~DuplicateFilter() {
+	for (const Run &run : runs_) {
+		std::fclose(run.file);
+	}
+}
+
+void DuplicateFilter::add(const char *data, std::size_t size) {
+	const Hash h = hash(data, size);
+	const std::uint64_t seq = added_++;
+	if (streaming_) {
+		if (seen_.count(h)) {
+			++duplicates_;
+			return;
+		}
+		if ((seen_.size() + 1) * seenEntryBytes <= memoryLimit_) {
+			seen_.insert(h);
+			emit_(data, size);
+			return;
+		}
+		spillSeen();
+	}
+	if (!pending_.empty() && arena_.size() + size + (pending_.size() + 1) * sizeof(Pending) > memoryLimit_) {
+		spillPending();
+	}
+	pending_.push_back(Pending {h, seq, arena_.size(), size});
+	arena_.append(data, size);
+}
+
+void DuplicateFilter::spillSeen() {
+	std::vector<Hash> hashes(seen_.begin(), seen_.end());
+	std::unordered_set<Hash, HashHasher>().swap(seen_);
+	streaming_ = false;
+	if (hashes.empty()) {
+		return;
+	}
+	std::sort(hashes.begin(), hashes.end());
+	runs_.push_back(Run {newRunFile(), true});
+	++spills_;
+	for (const Hash &h : hashes) {
+		writeAll(runs_.back().file, &h, sizeof(h));
+	}
+}
+
+void DuplicateFilter::spillPending() {
+	if (pending_.empty()) {
+		return;
+	}
+	std::sort(pending_.begin(), pending_.end(), [](const Pending &a, const Pending &b) {
+		return a.hash == b.hash ? a.seq < b.seq : a.hash < b.hash;
+	});
+	runs_.push_back(Run {newRunFile(), false});
+	++spills_;
+	std::FILE *file = runs_.back().file;
+	const Hash *last = nullptr;
+	for (const Pending &p : pending_) {
+		if (last && *last == p.hash) {
+			++duplicates_;
+			continue;
+		}
+		last = &p.hash;
+		const std::uint64_t header[2] = {p.seq, static_cast<std::uint64_t>(p.size)};
+		writeAll(file, &p.hash, sizeof(p.hash));
+		writeAll(file, header, sizeof(header));
+		writeAll(file, arena_.data() + p.offset, p.size);
+	}
+	pending_.clear();
+	arena_.clear();
+}
+
+void DuplicateFilter::finish() {
+	spillPending();
+	if (std::none_of(runs_.begin(), runs_.end(), [](const Run &run) { return !run.emitted; })) {
+		return;
+	}
+
+	// Every hash of the merge goes to one new run of emitted hashes, which
+	// replaces the runs read here once they are done.
+	std::vector<Run> merging;
+	merging.swap(runs_);
+	struct CloseRuns {
+		std::vector<Run> &runs;
+		~CloseRuns() {
+			for (const Run &run : runs) {
+				std::fclose(run.file);
+			}
+		}
+	} closeRuns {merging};
+	runs_.push_back(Run {newRunFile(), true});
+	std::FILE *merged = runs_.back().file;
+
+	std::vector<RunReader> readers;
+	readers.reserve(merging.size());
+	std::vector<std::size_t> heap;
+	for (const Run &run : merging) {
+		std::rewind(run.file);
+		readers.emplace_back(run.file, run.emitted);
+		if (readers.back().next()) {
+			heap.push_back(readers.size() - 1);
+		}
+	}
+	auto later = [&readers](std::size_t a, std::size_t b) { return readers[a].after(readers[b]); };
+	std::make_heap(heap.begin(), heap.end(), later);
+
+	while (!heap.empty()) {
+		const Hash h = readers[heap.front()].hash;
+		bool emitted = false;
+		while (!heap.empty() && readers[heap.front()].hash == h) {
+			std::pop_heap(heap.begin(), heap.end(), later);
+			const std::size_t index = heap.back();
+			heap.pop_back();
+			RunReader &reader = readers[index];
+			if (reader.emitted) {
+				emitted = true;
+			} else if (!emitted) {
+				emit_(reader.record.data(), reader.record.size());
+				emitted = true;
+			} else {
+				++duplicates_;
+			}
+			if (reader.next()) {
+				heap.push_back(index);
+				std::push_heap(heap.begin(), heap.end(), later);
+			}
+		}
+		writeAll(merged, &h, sizeof(h));
+	}
+}
+
+} // namespace r2rml
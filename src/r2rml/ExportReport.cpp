@@ -0,0 +1,93 @@
+#include "r2rml/ExportReport.h"
+#include "r2rml/Json.h"
+
+#include <cstdio>
+
+namespace r2rml {
+
+namespace {
+
+std::string number(double value) {
+	char buf[32];
+	std::snprintf(buf, sizeof(buf), "%.6f", value);
+	return buf;
+}
+
+/** `count` per second of `seconds`; 0 when no time was measured. */
+std::string rate(std::size_t count, double seconds) {
+	return number(seconds > 0 ? static_cast<double>(count) / seconds : 0.0);
+}
+
+} // namespace
+
+PredicateObjectMapMetrics &PredicateObjectMapMetrics::operator+=(const PredicateObjectMapMetrics &other) {
+	triples += other.triples;
+	nullsSkipped += other.nullsSkipped;
+	joinProbes += other.joinProbes;
+	termSeconds += other.termSeconds;
+	joinSeconds += other.joinSeconds;
+	return *this;
+}
+
+TriplesMapMetrics &TriplesMapMetrics::operator+=(const TriplesMapMetrics &other) {
+	rows += other.rows;
+	triples += other.triples;
+	nullsSkipped += other.nullsSkipped;
+	joinProbes += other.joinProbes;
+	executeSeconds += other.executeSeconds;
+	iterateSeconds += other.iterateSeconds;
+	termSeconds += other.termSeconds;
+	joinSeconds += other.joinSeconds;
+	writeSeconds += other.writeSeconds;
+	if (predicateObjectMaps.size() < other.predicateObjectMaps.size()) {
+		predicateObjectMaps.resize(other.predicateObjectMaps.size());
+	}
+	for (std::size_t i = 0; i < other.predicateObjectMaps.size(); ++i) {
+		predicateObjectMaps[i] += other.predicateObjectMaps[i];
+	}
+	return *this;
+}
+
+std::string ExportReport::toJson() const {
+	std::string json = "{\n";
+	json += "  \"statements\": " + std::to_string(statements) + ",\n";
+	json += "  \"joinIndexBuilds\": " + std::to_string(joinIndexBuilds) + ",\n";
+	json += "  \"joinIndexProbes\": " + std::to_string(joinIndexProbes) + ",\n";
+	json += "  \"joinQueries\": " + std::to_string(joinQueries) + ",\n";
+	json += "  \"partitionQueries\": " + std::to_string(partitionQueries) + ",\n";
+	json += "  \"duplicatesDropped\": " + std::to_string(duplicatesDropped) + ",\n";
+	json += "  \"dedupSpills\": " + std::to_string(dedupSpills) + ",\n";
+	json += "  \"triplesMaps\": [";
+	for (std::size_t i = 0; i < triplesMaps.size(); ++i) {
+		const TriplesMapMetrics &tm = triplesMaps[i];
+		json += i ? ",\n    {\"id\": " : "\n    {\"id\": ";
+		appendJsonString(json, tm.id);
+		json += ", \"rows\": " + std::to_string(tm.rows);
+		json += ", \"triples\": " + std::to_string(tm.triples);
+		json += ", \"nullsSkipped\": " + std::to_string(tm.nullsSkipped);
+		json += ", \"joinProbes\": " + std::to_string(tm.joinProbes);
+		json += ",\n     \"seconds\": {\"execute\": " + number(tm.executeSeconds);
+		json += ", \"iterate\": " + number(tm.iterateSeconds);
+		json += ", \"terms\": " + number(tm.termSeconds);
+		json += ", \"join\": " + number(tm.joinSeconds);
+		json += ", \"write\": " + number(tm.writeSeconds);
+		json += ", \"total\": " + number(tm.seconds()) + "}";
+		json += ",\n     \"rowsPerSecond\": " + rate(tm.rows, tm.seconds());
+		json += ", \"triplesPerSecond\": " + rate(tm.triples, tm.seconds());
+		json += ",\n     \"predicateObjectMaps\": [";
+		for (std::size_t p = 0; p < tm.predicateObjectMaps.size(); ++p) {
+			const PredicateObjectMapMetrics &pom = tm.predicateObjectMaps[p];
+			json += p ? ",\n       " : "\n       ";
+			json += "{\"triples\": " + std::to_string(pom.triples);
+			json += ", \"nullsSkipped\": " + std::to_string(pom.nullsSkipped);
+			json += ", \"joinProbes\": " + std::to_string(pom.joinProbes);
+			json += ", \"termSeconds\": " + number(pom.termSeconds);
+			json += ", \"joinSeconds\": " + number(pom.joinSeconds) + "}";
+		}
+		json += tm.predicateObjectMaps.empty() ? "]}" : "\n     ]}";
+	}
+	json += triplesMaps.empty() ? "]\n}\n" : "\n  ]\n}\n";
+	return json;
+}
+
+} // namespace r2rml
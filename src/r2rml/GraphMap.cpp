@@ -1,6 +1,7 @@
 #include "r2rml/GraphMap.h"
+#include "r2rml/RowBatch.h"
 
-#include <string>
+#include <cstring>
 
 namespace r2rml {
 
@@ -8,44 +9,103 @@ GraphMap::~GraphMap() = default;
 
 namespace {
 
+const char kDefaultGraphIri[] = "http://www.w3.org/ns/r2rml#defaultGraph";
+
 /// True if `node` is a URI equal to rr:defaultGraph, i.e. an explicit way of
 /// saying "the default graph" rather than a real named graph.
 bool isDefaultGraphNode(const SerdNode &node) {
-	if (node.type != SERD_URI) {
-		return false;
-	}
-	static const char *const kDefaultGraphIri = "http://www.w3.org/ns/r2rml#defaultGraph";
-	return std::string(reinterpret_cast<const char *>(node.buf), node.n_bytes) == kDefaultGraphIri;
+	return node.type == SERD_URI && node.n_bytes == sizeof(kDefaultGraphIri) - 1 &&
+	       std::memcmp(node.buf, kDefaultGraphIri, sizeof(kDefaultGraphIri) - 1) == 0;
 }
 
 } // namespace
 
-void forEachGraphNode(const std::vector<std::unique_ptr<GraphMap>> &subjectGraphMaps,
-                      const std::vector<std::unique_ptr<GraphMap>> &pomGraphMaps, const SQLRow &row, const SerdEnv &env,
-                      const std::function<void(const SerdNode *)> &emit) {
-	bool emitted = false;
+void GraphMap::classifyConstant(const SerdNode &node) {
+	if (node.type == SERD_NOTHING || isDefaultGraphNode(node)) {
+		kind = Kind::DefaultGraph;
+		namedGraph = SERD_NODE_NULL;
+	} else {
+		kind = Kind::NamedGraph;
+		namedGraph = node;
+	}
+}
+
+void RowGraphs::add(const SerdNode &node) {
+	if (node.type != SERD_NOTHING && !isDefaultGraphNode(node)) {
+		push(node);
+	}
+}
+
+void RowGraphs::push(const SerdNode &node) {
+	if (size_ < kInline) {
+		inline_[size_] = node;
+	} else {
+		overflow_.push_back(node);
+	}
+	++size_;
+}
 
-	auto tryEmit = [&](const GraphMap *gm) {
-		if (!gm) {
-			return;
+void RowGraphs::resolve(const std::vector<std::unique_ptr<GraphMap>> &graphMaps, const SQLRow &row,
+                        const SerdEnv &env) {
+	clear();
+	for (const auto &gm : graphMaps) {
+		if (!gm || gm->kind == GraphMap::Kind::DefaultGraph) {
+			continue;
 		}
-		SerdNode node = gm->generateRDFTerm(row, env);
-		if (node.type == SERD_NOTHING || isDefaultGraphNode(node)) {
-			return;
+		if (gm->kind == GraphMap::Kind::NamedGraph) {
+			push(gm->namedGraph);
+		} else {
+			add(gm->generateRDFTerm(row, env));
 		}
-		emit(&node);
-		emitted = true;
-	};
+	}
+}
 
-	for (const auto &gm : subjectGraphMaps) {
-		tryEmit(gm.get());
+void RowGraphs::resolve(const std::vector<std::unique_ptr<GraphMap>> &graphMaps, const std::vector<TermBatch> &graphs,
+                        std::size_t row) {
+	clear();
+	for (std::size_t g = 0; g < graphs.size(); ++g) {
+		const GraphMap *gm = g < graphMaps.size() ? graphMaps[g].get() : nullptr;
+		if (gm && gm->kind == GraphMap::Kind::DefaultGraph) {
+			continue;
+		}
+		if (gm && gm->kind == GraphMap::Kind::NamedGraph) {
+			push(gm->namedGraph);
+		} else {
+			add(graphs[g].node(row));
+		}
 	}
-	for (const auto &gm : pomGraphMaps) {
-		tryEmit(gm.get());
+}
+
+void RowGraphs::resolve(const std::vector<TermBatch> &graphs, std::size_t row) {
+	static const std::vector<std::unique_ptr<GraphMap>> unknown;
+	resolve(unknown, graphs, row);
+}
+
+void generateGraphTerms(const std::vector<std::unique_ptr<GraphMap>> &graphMaps, const RowBatch &batch,
+                        const SerdEnv &env, std::vector<TermBatch> &out) {
+	generateGraphTerms(graphMaps, batch, bindGraphColumns(graphMaps, batch), env, out);
+}
+
+std::vector<ColumnOrdinals> bindGraphColumns(const std::vector<std::unique_ptr<GraphMap>> &graphMaps,
+                                             const RowBatch &batch) {
+	std::vector<ColumnOrdinals> columns(graphMaps.size());
+	for (std::size_t g = 0; g < graphMaps.size(); ++g) {
+		if (graphMaps[g]) {
+			columns[g] = graphMaps[g]->bindColumns(batch);
+		}
 	}
+	return columns;
+}
 
-	if (!emitted) {
-		emit(nullptr);
+void generateGraphTerms(const std::vector<std::unique_ptr<GraphMap>> &graphMaps, const RowBatch &batch,
+                        const std::vector<ColumnOrdinals> &columns, const SerdEnv &env, std::vector<TermBatch> &out) {
+	out.resize(graphMaps.size());
+	for (std::size_t g = 0; g < graphMaps.size(); ++g) {
+		if (graphMaps[g]) {
+			graphMaps[g]->generateRDFTerms(batch, columns[g], env, out[g]);
+		} else {
+			out[g].setConstant(SERD_NODE_NULL, batch.size());
+		}
 	}
 }
 
@@ -0,0 +1,138 @@
+#include "r2rml/JoinIndex.h"
+#include "r2rml/JoinCondition.h"
+#include "r2rml/LogicalTable.h"
+#include "r2rml/ReferencingObjectMap.h"
+#include "r2rml/RowBatch.h"
+#include "r2rml/SQLConnection.h"
+#include "r2rml/SQLResultSet.h"
+#include "r2rml/SQLRow.h"
+#include "r2rml/SQLValue.h"
+#include "r2rml/SubjectMap.h"
+#include "r2rml/TriplesMap.h"
+
+namespace r2rml {
+
+namespace {
+
+// Join keys are the join values length-prefixed and concatenated, so
+// ("a", "bc") and ("ab", "c") cannot collide.
+void appendKeyPart(std::string &key, const char *s, std::size_t n) {
+	key += std::to_string(n);
+	key += ':';
+	key.append(s, n);
+}
+
+} // namespace
+
+JoinIndex::JoinIndex(const ReferencingObjectMap &rom, SQLConnection &dbConnection, const SerdEnv &env) {
+	const TriplesMap *parent = rom.parentTriplesMap;
+	if (!parent || !parent->logicalTable || !parent->subjectMap) {
+		return;
+	}
+	auto parentRows = parent->logicalTable->getRows(dbConnection);
+	if (!parentRows) {
+		return;
+	}
+
+	RowBatch batch;
+	TermBatch terms;
+	std::vector<std::size_t> columns(rom.joinConditions.size());
+	while (parentRows->nextBatch(batch)) {
+		for (std::size_t j = 0; j < columns.size(); ++j) {
+			columns[j] = batch.findColumn(rom.joinConditions[j].parentColumn);
+		}
+		terms.clear();
+		parent->subjectMap->generateRDFTerms(batch, env, terms);
+
+		for (std::size_t row = 0; row < batch.size(); ++row) {
+			if (terms.isNull(row)) {
+				continue;
+			}
+			key_.clear();
+			bool ok = true;
+			for (std::size_t col : columns) {
+				if (col == RowBatch::npos || batch.column(col).isNull(row)) {
+					ok = false;
+					break;
+				}
+				const RowBatch::Column &c = batch.column(col);
+				appendKeyPart(key_, c.data(row), c.length(row));
+			}
+			if (ok) {
+				rows_[key_].push_back(subjects_.size());
+				subjects_.append(terms.node(row));
+			}
+		}
+	}
+}
+
+const std::vector<std::size_t> *JoinIndex::find(const std::string &key) const {
+	auto it = rows_.find(key);
+	return it == rows_.end() ? nullptr : &it->second;
+}
+
+const std::vector<std::size_t> *JoinIndex::probe(const ReferencingObjectMap &rom, const SQLRow &childRow) {
+	++probes_;
+	key_.clear();
+	for (const JoinCondition &jc : rom.joinConditions) {
+		SQLValueView value = childRow.getValueView(jc.childColumn);
+		if (value.isNull()) {
+			return nullptr;
+		}
+		appendKeyPart(key_, value.data(), value.length());
+	}
+	return find(key_);
+}
+
+const std::vector<std::size_t> *JoinIndex::probe(const ReferencingObjectMap &rom, const RowBatch &batch,
+                                                 std::size_t row) {
+	ColumnOrdinals childColumns;
+	for (const JoinCondition &jc : rom.joinConditions) {
+		childColumns.push_back(batch.findColumn(jc.childColumn));
+	}
+	return probe(batch, childColumns, row);
+}
+
+const std::vector<std::size_t> *JoinIndex::probe(const RowBatch &batch, const ColumnOrdinals &childColumns,
+                                                 std::size_t row) {
+	++probes_;
+	key_.clear();
+	for (std::size_t col : childColumns) {
+		if (col == RowBatch::npos || batch.column(col).isNull(row)) {
+			return nullptr;
+		}
+		const RowBatch::Column &c = batch.column(col);
+		appendKeyPart(key_, c.data(row), c.length(row));
+	}
+	return find(key_);
+}
+
+JoinIndex &JoinIndexCache::get(const ReferencingObjectMap &rom, SQLConnection &dbConnection, const SerdEnv &env) {
+	return build(rom, dbConnection, env);
+}
+
+JoinIndex &JoinIndexCache::build(const ReferencingObjectMap &rom, SQLConnection &dbConnection, const SerdEnv &env) {
+	Key key(rom.parentTriplesMap, std::vector<std::string>());
+	key.second.reserve(rom.joinConditions.size());
+	for (const JoinCondition &jc : rom.joinConditions) {
+		key.second.push_back(jc.parentColumn);
+	}
+
+	auto it = indexes_.find(key);
+	if (it == indexes_.end()) {
+		// Build before inserting so a failed parent query leaves no entry.
+		std::unique_ptr<JoinIndex> index(new JoinIndex(rom, dbConnection, env));
+		it = indexes_.emplace(std::move(key), std::move(index)).first;
+	}
+	return *it->second;
+}
+
+std::size_t JoinIndexCache::probes() const {
+	std::size_t total = 0;
+	for (const auto &entry : indexes_) {
+		total += entry.second->probes();
+	}
+	return total;
+}
+
+} // namespace r2rml
@@ -0,0 +1,23 @@
+#include "r2rml/Json.h"
+
+namespace r2rml {
+
+void appendJsonString(std::string &out, const std::string &value) {
+	static const char hex[] = "0123456789abcdef";
+	out += '"';
+	for (unsigned char c : value) {
+		if (c == '"' || c == '\\') {
+			out += '\\';
+			out += static_cast<char>(c);
+		} else if (c < 0x20) {
+			out += "\\u00";
+			out += hex[c >> 4];
+			out += hex[c & 0xf];
+		} else {
+			out += static_cast<char>(c);
+		}
+	}
+	out += '"';
+}
+
+} // namespace r2rml
@@ -1,11 +1,116 @@
 #include "r2rml/LogicalTable.h"
 
+#include <algorithm>
 #include <ostream>
+#include <string>
+#include <vector>
 
 namespace r2rml {
 
+std::string sqlLiteral(const std::string &value) {
+	std::string literal = "'";
+	for (char c : value) {
+		literal += c;
+		if (c == '\'') {
+			literal += c;
+		}
+	}
+	return literal + "'";
+}
+
+std::string quoteIdentifier(const std::string &name) {
+	std::string quoted = "\"";
+	for (char c : name) {
+		quoted += c;
+		if (c == '"') {
+			quoted += c;
+		}
+	}
+	return quoted + "\"";
+}
+
 LogicalTable::~LogicalTable() = default;
 
+std::string LogicalTable::selectQuery() const {
+	return std::string();
+}
+
+std::string LogicalTable::rowQuery() const {
+	return selectQuery();
+}
+
+std::string LogicalTable::partitionKey() const {
+	return partitionColumn.empty() ? std::string() : quoteIdentifier(partitionColumn);
+}
+
+std::string LogicalTable::partitionSource() const {
+	std::string query = selectQuery();
+	return query.empty() ? std::string() : "(" + query + ") AS \"partition\"";
+}
+
+std::string LogicalTable::selectList(bool keys) const {
+	if (projection.empty()) {
+		return "*";
+	}
+	std::vector<std::string> columns = projection;
+	for (const std::string *key : {&partitionColumn, &watermarkColumn}) {
+		if (keys && !key->empty() && std::find(columns.begin(), columns.end(), *key) == columns.end()) {
+			columns.push_back(*key);
+		}
+	}
+	std::string list;
+	for (const std::string &column : columns) {
+		if (!list.empty()) {
+			list += ", ";
+		}
+		list += quoteIdentifier(column);
+	}
+	return list;
+}
+
+std::string LogicalTable::partitionBoundsQuery() const {
+	std::string key = partitionKey();
+	std::string source = partitionSource();
+	if (key.empty() || source.empty()) {
+		return std::string();
+	}
+	return "SELECT min(" + key + ") AS \"lower\", max(" + key + ") AS \"upper\" FROM " + source;
+}
+
+std::string LogicalTable::partitionQuery(long long lower, long long upper) const {
+	std::string key = partitionKey();
+	std::string source = partitionSource();
+	if (key.empty() || source.empty()) {
+		return std::string();
+	}
+	return "SELECT " + selectList() + " FROM " + source + " WHERE " + key + " >= " + std::to_string(lower) + " AND " +
+	       key + " <= " + std::to_string(upper);
+}
+
+std::string LogicalTable::watermarkBoundQuery() const {
+	std::string source = partitionSource();
+	if (watermarkColumn.empty() || source.empty()) {
+		return std::string();
+	}
+	// As text from the database itself: the client's rendering of a
+	// DOUBLE or TIMESTAMP may round it, and a rounded-up mark skips rows.
+	return "SELECT CAST(max(" + quoteIdentifier(watermarkColumn) + ") AS VARCHAR) AS \"upper\" FROM " + source;
+}
+
+std::string LogicalTable::watermarkQuery(const std::string &after, const std::string &upto) const {
+	std::string source = partitionSource();
+	if (watermarkColumn.empty() || source.empty()) {
+		return std::string();
+	}
+	// Rows with a null watermark fail both comparisons, so no run takes them.
+	const std::string key = quoteIdentifier(watermarkColumn);
+	std::string query = "SELECT " + selectList() + " FROM " + source + " WHERE ";
+	if (!after.empty()) {
+		query += key + " > " + sqlLiteral(after) + " AND ";
+	}
+	return query + key + " <= " + sqlLiteral(upto);
+}
+
 std::ostream &LogicalTable::print(std::ostream &os) const {
 	return os << "LogicalTable { effectiveSqlQuery=\"" << effectiveSqlQuery << "\" }";
 }
@@ -28,6 +28,14 @@ std::unique_ptr<SQLValue> MapSQLRow::getValue(const std::string &columnName) con
 	return it->second->clone();
 }
 
+SQLValueView MapSQLRow::getValueView(const std::string &columnName) const {
+	auto it = columns_.find(columnName);
+	if (it == columns_.end() || it->second->isNull()) {
+		return SQLValueView();
+	}
+	return SQLValueView(it->second->type(), it->second->asString());
+}
+
 bool MapSQLRow::isNull(const std::string &columnName) const {
 	auto it = columns_.find(columnName);
 	if (it == columns_.end()) {
@@ -0,0 +1,377 @@
+#include "r2rml/NTriplesWriter.h"
+#include "r2rml/ConstantPool.h"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace r2rml {
+
+namespace {
+
+// escape[c] is 1 for the bytes that can't be copied into N-Triples as-is,
+// exactly as SerdWriter decides: in an IRI, controls, space, non-ASCII and
+// "<>\^`{|}; in a literal, controls, non-ASCII, backslash and quote.
+// Non-ASCII bytes are then copied after all when they form a UTF-8
+// character.
+struct EscapeTable {
+	unsigned char uri[256];
+	unsigned char literal[256];
+
+	EscapeTable() {
+		for (int c = 0; c < 256; ++c) {
+			uri[c] = literal[c] = (c < 0x20 || c > 0x7E) ? 1 : 0;
+		}
+		for (const char *s = " \"<>\\^`{|}"; *s; ++s) {
+			uri[static_cast<unsigned char>(*s)] = 1;
+		}
+		literal[static_cast<unsigned char>('\\')] = 1;
+		literal[static_cast<unsigned char>('"')] = 1;
+	}
+};
+
+const EscapeTable kEscape;
+
+const char kHexDigits[] = "0123456789ABCDEF";
+
+// Replacement character written for bytes that aren't UTF-8.
+const char kReplacementChar[] = "\xEF\xBF\xBD";
+
+// Length of the leading run of bytes in s[0, n) an IRI can hold unescaped.
+std::size_t uriSafePrefix(const uint8_t *s, std::size_t n) {
+	std::size_t i = 0;
+#if defined(__SSE2__)
+	// Signed compares treat bytes >= 0x80 as negative, so "below '!'" also
+	// catches them; "above 'z'" is {|}~ and DEL, of which '~' is allowed.
+	const __m128i bang = _mm_set1_epi8('!');
+	const __m128i z = _mm_set1_epi8('z');
+	const __m128i tilde = _mm_set1_epi8('~');
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i lt = _mm_set1_epi8('<');
+	const __m128i gt = _mm_set1_epi8('>');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i caret = _mm_set1_epi8('^');
+	const __m128i backtick = _mm_set1_epi8('`');
+	for (; i + 16 <= n; i += 16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+		__m128i bad = _mm_andnot_si128(_mm_cmpeq_epi8(v, tilde), _mm_cmpgt_epi8(v, z));
+		bad = _mm_or_si128(bad, _mm_cmplt_epi8(v, bang));
+		bad = _mm_or_si128(bad, _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, lt)));
+		bad = _mm_or_si128(bad, _mm_or_si128(_mm_cmpeq_epi8(v, gt), _mm_cmpeq_epi8(v, backslash)));
+		bad = _mm_or_si128(bad, _mm_or_si128(_mm_cmpeq_epi8(v, caret), _mm_cmpeq_epi8(v, backtick)));
+		const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(bad));
+		if (mask != 0) {
+			i += static_cast<std::size_t>(__builtin_ctz(mask));
+			break;
+		}
+	}
+#endif
+	while (i < n && !kEscape.uri[s[i]]) {
+		++i;
+	}
+	return i;
+}
+
+// Length of the leading run of bytes in s[0, n) a literal can hold
+// unescaped.
+std::size_t literalSafePrefix(const uint8_t *s, std::size_t n) {
+	std::size_t i = 0;
+#if defined(__SSE2__)
+	// As above: "below ' '" also catches every byte >= 0x80, and only DEL
+	// is above '~'.
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tilde = _mm_set1_epi8('~');
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	for (; i + 16 <= n; i += 16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+		__m128i bad = _mm_or_si128(_mm_cmplt_epi8(v, space), _mm_cmpgt_epi8(v, tilde));
+		bad = _mm_or_si128(bad, _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)));
+		const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(bad));
+		if (mask != 0) {
+			i += static_cast<std::size_t>(__builtin_ctz(mask));
+			break;
+		}
+	}
+#endif
+	while (i < n && !kEscape.literal[s[i]]) {
+		++i;
+	}
+	return i;
+}
+
+// Bytes in the UTF-8 character led by `c`; 0 if it can't lead one.
+std::size_t utf8Bytes(uint8_t c) {
+	if ((c & 0x80) == 0) {
+		return 1;
+	}
+	if ((c & 0xE0) == 0xC0) {
+		return 2;
+	}
+	if ((c & 0xF0) == 0xE0) {
+		return 3;
+	}
+	if ((c & 0xF8) == 0xF0) {
+		return 4;
+	}
+	return 0;
+}
+
+// Append the character at s[i] that the safe-prefix scan stopped on and
+// advance `i` past it: an ASCII byte as \u00XX, a UTF-8 character as-is,
+// anything else as U+FFFD (skipping to the next lead byte).
+void appendCharacter(std::string &out, const uint8_t *s, std::size_t n, std::size_t &i) {
+	const std::size_t size = utf8Bytes(s[i]);
+	if (size == 1) {
+		const char escaped[6] = {'\\', 'u', '0', '0', kHexDigits[s[i] >> 4], kHexDigits[s[i] & 0x0F]};
+		out.append(escaped, 6);
+		++i;
+	} else if (size == 0 || size > n - i) {
+		out.append(kReplacementChar, 3);
+		for (++i; i < n && (s[i] & 0x80); ++i) {
+		}
+	} else {
+		out.append(reinterpret_cast<const char *>(s + i), size);
+		i += size;
+	}
+}
+
+void appendUri(std::string &out, const uint8_t *s, std::size_t n) {
+	std::size_t i = 0;
+	while (i < n) {
+		const std::size_t run = uriSafePrefix(s + i, n - i);
+		out.append(reinterpret_cast<const char *>(s + i), run);
+		i += run;
+		if (i < n) {
+			appendCharacter(out, s, n, i);
+		}
+	}
+}
+
+void appendLiteralText(std::string &out, const uint8_t *s, std::size_t n) {
+	std::size_t i = 0;
+	while (i < n) {
+		const std::size_t run = literalSafePrefix(s + i, n - i);
+		out.append(reinterpret_cast<const char *>(s + i), run);
+		i += run;
+		if (i == n) {
+			break;
+		}
+		switch (s[i]) {
+		case '\\':
+			out.append("\\\\", 2);
+			break;
+		case '"':
+			out.append("\\\"", 2);
+			break;
+		case '\n':
+			out.append("\\n", 2);
+			break;
+		case '\r':
+			out.append("\\r", 2);
+			break;
+		case '\t':
+			out.append("\\t", 2);
+			break;
+		default:
+			appendCharacter(out, s, n, i);
+			continue;
+		}
+		++i;
+	}
+}
+
+bool isAlpha(uint8_t c) {
+	return (c | 0x20) >= 'a' && (c | 0x20) <= 'z';
+}
+
+// serd_uri_string_has_scheme() over a sized buffer.
+bool hasScheme(const uint8_t *s, std::size_t n) {
+	if (n == 0 || !isAlpha(s[0])) {
+		return false;
+	}
+	for (std::size_t i = 1; i < n; ++i) {
+		const uint8_t c = s[i];
+		if (c == ':') {
+			return true;
+		}
+		if (!isAlpha(c) && (c < '0' || c > '9') && c != '+' && c != '-' && c != '.') {
+			return false;
+		}
+	}
+	return false;
+}
+
+bool isResource(const SerdNode &node) {
+	return node.buf && (node.type == SERD_URI || node.type == SERD_CURIE || node.type == SERD_BLANK);
+}
+
+[[noreturn]] void throwBadArgument() {
+	throw std::runtime_error(std::string("R2RML: failed to write RDF statement: ") +
+	                         reinterpret_cast<const char *>(serd_strerror(SERD_ERR_BAD_ARG)));
+}
+
+} // namespace
+
+NTriplesWriter::NTriplesWriter(SerdSyntax syntax, const SerdEnv *env, SerdSink sink, void *stream,
+                               std::size_t bufferSize)
+    : NTriplesWriter(syntax, env, nullptr, sink, stream, bufferSize) {
+}
+
+NTriplesWriter::NTriplesWriter(SerdSyntax syntax, const SerdEnv *env, const ConstantPool *constants, SerdSink sink,
+                               void *stream, std::size_t bufferSize)
+    : quads_(syntax == SERD_NQUADS), env_(env), constants_(constants), sink_(sink), stream_(stream),
+      bufferSize_(bufferSize) {
+	if (!supports(syntax)) {
+		throw std::invalid_argument("R2RML: NTriplesWriter only writes N-Triples and N-Quads");
+	}
+	buffer_.reserve(bufferSize_);
+}
+
+NTriplesWriter::~NTriplesWriter() {
+	try {
+		flush();
+	} catch (...) { // NOLINT(bugprone-empty-catch) - errors are reported by an explicit flush()
+	}
+}
+
+void NTriplesWriter::write(const SerdNode *graph, const SerdNode &subject, const SerdNode &predicate,
+                           const SerdNode &object, const SerdNode *datatype, const SerdNode *lang) {
+	if (!isResource(subject) || !isResource(predicate) || !object.buf) {
+		throwBadArgument();
+	}
+	// A statement that fails half way is taken back out of the buffer.
+	const std::size_t start = buffer_.size();
+	try {
+		writeResource(subject);
+		buffer_ += ' ';
+		writeCachedNode(predicate);
+		buffer_ += ' ';
+		if (object.type == SERD_LITERAL) {
+			writeLiteral(object, datatype, lang);
+		} else if (!writeConstant(object)) {
+			writeResource(object);
+		}
+		if (quads_ && graph) {
+			buffer_ += ' ';
+			if (!writeConstant(*graph)) {
+				writeResource(*graph);
+			}
+		}
+		buffer_.append(" .\n", 3);
+	} catch (...) {
+		buffer_.resize(start);
+		throw;
+	}
+	if (buffer_.size() >= bufferSize_) {
+		flush();
+	}
+}
+
+void NTriplesWriter::flush() {
+	if (buffer_.empty()) {
+		return;
+	}
+	const std::size_t written = sink_(buffer_.data(), buffer_.size(), stream_);
+	const bool complete = written == buffer_.size();
+	buffer_.clear();
+	if (!complete) {
+		throw std::runtime_error("R2RML: failed to write RDF output");
+	}
+}
+
+bool NTriplesWriter::appendConstant(std::string &out, const SerdNode &node) {
+	if (node.type == SERD_BLANK && node.buf) {
+		out.append("_:", 2);
+		out.append(reinterpret_cast<const char *>(node.buf), node.n_bytes);
+		return true;
+	}
+	if (node.type != SERD_URI || !node.buf || !hasScheme(node.buf, node.n_bytes)) {
+		return false;
+	}
+	out += '<';
+	appendUri(out, node.buf, node.n_bytes);
+	out += '>';
+	return true;
+}
+
+bool NTriplesWriter::writeConstant(const SerdNode &node) {
+	const std::string *encoded = constants_ ? constants_->encoded(node) : nullptr;
+	if (!encoded) {
+		return false;
+	}
+	buffer_.append(*encoded);
+	return true;
+}
+
+void NTriplesWriter::writeCachedNode(const SerdNode &node) {
+	if (writeConstant(node)) {
+		return;
+	}
+	if (node.type != SERD_URI && node.type != SERD_CURIE) {
+		writeResource(node);
+		return;
+	}
+	CachedNode &entry = cache_[((reinterpret_cast<std::uintptr_t>(node.buf) >> 4) ^ node.n_bytes) % 64];
+	if (entry.buf == node.buf && entry.type == node.type && entry.raw.size() == node.n_bytes &&
+	    std::memcmp(entry.raw.data(), node.buf, node.n_bytes) == 0) {
+		buffer_.append(entry.serialized);
+		return;
+	}
+	const std::size_t start = buffer_.size();
+	writeResource(node);
+	entry.buf = node.buf;
+	entry.type = node.type;
+	entry.raw.assign(reinterpret_cast<const char *>(node.buf), node.n_bytes);
+	entry.serialized.assign(buffer_, start, std::string::npos);
+}
+
+void NTriplesWriter::writeResource(const SerdNode &node) {
+	switch (node.type) {
+	case SERD_URI:
+		if (!appendConstant(buffer_, node)) {
+			if (!env_ || !serd_env_get_base_uri(env_, nullptr)->buf) {
+				throwBadArgument(); // N-Triples has no relative IRIs
+			}
+			buffer_ += '<';
+			appendUri(buffer_, node.buf, node.n_bytes);
+			buffer_ += '>';
+		}
+		break;
+	case SERD_CURIE: {
+		SerdNode expanded = env_ ? serd_env_expand_node(env_, &node) : SERD_NODE_NULL;
+		if (!expanded.buf) {
+			throwBadArgument(); // undefined prefix
+		}
+		buffer_ += '<';
+		appendUri(buffer_, expanded.buf, expanded.n_bytes);
+		buffer_ += '>';
+		serd_node_free(&expanded);
+		break;
+	}
+	case SERD_BLANK:
+		appendConstant(buffer_, node);
+		break;
+	default:
+		throwBadArgument();
+	}
+}
+
+void NTriplesWriter::writeLiteral(const SerdNode &node, const SerdNode *datatype, const SerdNode *lang) {
+	buffer_ += '"';
+	appendLiteralText(buffer_, node.buf, node.n_bytes);
+	buffer_ += '"';
+	if (lang && lang->buf) {
+		buffer_ += '@';
+		buffer_.append(reinterpret_cast<const char *>(lang->buf), lang->n_bytes);
+	} else if (datatype && datatype->buf) {
+		buffer_.append("^^", 2);
+		writeCachedNode(*datatype);
+	}
+}
+
+} // namespace r2rml
@@ -1,8 +1,13 @@
 #include "r2rml/PredicateObjectMap.h"
+#include "r2rml/ConstantPool.h"
+#include "r2rml/ExportReport.h"
 #include "r2rml/TermMap.h"
 #include "r2rml/ReferencingObjectMap.h"
 #include "r2rml/GraphMap.h"
+#include "r2rml/JoinCondition.h"
+#include "r2rml/JoinIndex.h"
 #include "r2rml/R2RMLMapping.h"
+#include "r2rml/RowBatch.h"
 #include "r2rml/SQLConnection.h"
 #include "r2rml/SQLRow.h"
 #include "r2rml/SQLResultSet.h"
@@ -17,7 +22,32 @@ PredicateObjectMap::~PredicateObjectMap() = default;
 
 void PredicateObjectMap::processRow(const SQLRow &row, const SerdNode &subject, SerdWriter &rdfWriter,
                                     const R2RMLMapping &mapping, SQLConnection &dbConnection,
-                                    const std::vector<std::unique_ptr<GraphMap>> &subjectGraphMaps) const {
+                                    const std::vector<std::unique_ptr<GraphMap>> &subjectGraphMaps,
+                                    JoinIndexCache *joinIndexes) const {
+	SerdWriterSink rdfSink(rdfWriter);
+	processRow(row, subject, rdfSink, mapping, dbConnection, subjectGraphMaps, joinIndexes);
+}
+
+void PredicateObjectMap::processRow(const SQLRow &row, const SerdNode &subject, StatementSink &rdfSink,
+                                    const R2RMLMapping &mapping, SQLConnection &dbConnection,
+                                    const std::vector<std::unique_ptr<GraphMap>> &subjectGraphMaps,
+                                    JoinIndexCache *joinIndexes) const {
+	const SerdEnv *env = mapping.serdEnvironment;
+	static SerdEnv *fallbackEnv = nullptr;
+	if (!env) {
+		if (!fallbackEnv) {
+			fallbackEnv = serd_env_new(nullptr);
+		}
+		env = fallbackEnv;
+	}
+	RowGraphs subjectGraphs;
+	subjectGraphs.resolve(subjectGraphMaps, row, *env);
+	processRow(row, subject, rdfSink, mapping, dbConnection, subjectGraphs, joinIndexes);
+}
+
+void PredicateObjectMap::processRow(const SQLRow &row, const SerdNode &subject, StatementSink &rdfSink,
+                                    const R2RMLMapping &mapping, SQLConnection &dbConnection,
+                                    const RowGraphs &subjectGraphs, JoinIndexCache *joinIndexes) const {
 	const SerdEnv *env = mapping.serdEnvironment;
 	static SerdEnv *fallbackEnv = nullptr;
 	if (!env) {
@@ -27,6 +57,11 @@ void PredicateObjectMap::processRow(const SQLRow &row, const SerdNode &subject,
 		env = fallbackEnv;
 	}
 
+	// This map's graphs, like the subject map's, are the same for every
+	// triple of the row.
+	RowGraphs graphs;
+	graphs.resolve(graphMaps, row, *env);
+
 	// For each predicate/object combination, emit a triple.
 	for (const auto &predMap : predicateMaps) {
 		if (!predMap) {
@@ -45,7 +80,23 @@ void PredicateObjectMap::processRow(const SQLRow &row, const SerdNode &subject,
 			// Check if this object map is a ReferencingObjectMap (join).
 			ReferencingObjectMap *rom = dynamic_cast<ReferencingObjectMap *>(objMap.get());
 
-			if (rom) {
+			if (rom && joinIndexes && joinIndexes->isPushedDown(*rom)) {
+				continue; // evaluated by a database-side join instead
+			} else if (rom && joinIndexes) {
+				// Join: look the row up in the parent's index and use each
+				// matching parent subject as object.
+				JoinIndex &index = joinIndexes->get(*rom, dbConnection, *env);
+				const std::vector<std::size_t> *matches = index.probe(*rom, row);
+				if (!matches) {
+					continue;
+				}
+				for (std::size_t match : *matches) {
+					SerdNode object = index.subject(match);
+					forEachGraphNode(subjectGraphs, graphs, [&](const SerdNode *graph) {
+						rdfSink.write(graph, subject, predicate, object, nullptr, nullptr);
+					});
+				}
+			} else if (rom) {
 				// Join: query the parent table and use parent subject as object.
 				auto parentRows = rom->getJoinedRows(dbConnection, row);
 				if (!parentRows) {
@@ -57,9 +108,8 @@ void PredicateObjectMap::processRow(const SQLRow &row, const SerdNode &subject,
 					if (object.type == SERD_NOTHING) {
 						continue;
 					}
-					forEachGraphNode(subjectGraphMaps, graphMaps, row, *env, [&](const SerdNode *graph) {
-						checkWriteStatus(serd_writer_write_statement(&rdfWriter, 0, graph, &subject, &predicate,
-						                                             &object, nullptr, nullptr));
+					forEachGraphNode(subjectGraphs, graphs, [&](const SerdNode *graph) {
+						rdfSink.write(graph, subject, predicate, object, nullptr, nullptr);
 					});
 				}
 			} else {
@@ -73,31 +123,259 @@ void PredicateObjectMap::processRow(const SQLRow &row, const SerdNode &subject,
 				SerdNode langNode = SERD_NODE_NULL;
 				const SerdNode *datatype = nullptr;
 				const SerdNode *lang = nullptr;
-				// dtIRI must outlive datatypeNode (whose buf points into it).
-				std::string dtIRI;
 
-				if (object.type == SERD_LITERAL && objMap->languageTag) {
+				if (object.type == SERD_LITERAL && objMap->languageNode.buf) {
+					lang = &objMap->languageNode;
+				} else if (object.type == SERD_LITERAL && objMap->languageTag) {
 					langNode = serd_node_from_string(SERD_LITERAL,
 					                                 reinterpret_cast<const uint8_t *>(objMap->languageTag->c_str()));
 					lang = &langNode;
+				} else if (object.type == SERD_LITERAL && objMap->datatypeNode.buf) {
+					datatype = &objMap->datatypeNode; // a static rr:datatype wins over the value's own
 				} else if (object.type == SERD_LITERAL) {
-					dtIRI = objMap->computeDatatypeIRI(row);
+					// borrowed from the row's column; the pool already holds the
+					// natural datatypes, so this rarely builds a node
+					const std::string &dtIRI = objMap->datatypeIRIView(row);
 					if (!dtIRI.empty()) {
+						datatype = mapping.constants.find(SERD_URI, dtIRI);
+					}
+					if (!datatype && !dtIRI.empty()) {
 						datatypeNode =
 						    serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>(dtIRI.c_str()));
 						datatype = &datatypeNode;
 					}
 				}
 
-				forEachGraphNode(subjectGraphMaps, graphMaps, row, *env, [&](const SerdNode *graph) {
-					checkWriteStatus(serd_writer_write_statement(&rdfWriter, 0, graph, &subject, &predicate, &object,
-					                                             datatype, lang));
+				forEachGraphNode(subjectGraphs, graphs, [&](const SerdNode *graph) {
+					rdfSink.write(graph, subject, predicate, object, datatype, lang);
 				});
 			}
 		}
 	}
 }
 
+void PredicateObjectMap::bindColumns(const RowBatch &batch, BatchTerms &terms) const {
+	terms.predicateColumns.assign(predicateMaps.size(), ColumnOrdinals());
+	for (std::size_t p = 0; p < predicateMaps.size(); ++p) {
+		if (predicateMaps[p]) {
+			terms.predicateColumns[p] = predicateMaps[p]->bindColumns(batch);
+		}
+	}
+
+	terms.objectColumns.assign(objectMaps.size(), ColumnOrdinals());
+	terms.joinColumns.assign(objectMaps.size(), ColumnOrdinals());
+	for (std::size_t o = 0; o < objectMaps.size(); ++o) {
+		const TermMap *objMap = objectMaps[o].get();
+		if (!objMap) {
+			continue;
+		}
+		if (const auto *rom = dynamic_cast<const ReferencingObjectMap *>(objMap)) {
+			for (const JoinCondition &jc : rom->joinConditions) {
+				terms.joinColumns[o].push_back(batch.findColumn(jc.childColumn));
+			}
+		} else {
+			terms.objectColumns[o] = objMap->bindColumns(batch);
+		}
+	}
+
+	terms.graphColumns = bindGraphColumns(graphMaps, batch);
+}
+
+void PredicateObjectMap::generateTerms(const RowBatch &batch, const SerdEnv &env, BatchTerms &terms,
+                                       const ConstantPool *constants) const {
+	terms.probed = false;
+	terms.predicates.resize(predicateMaps.size());
+	for (std::size_t p = 0; p < predicateMaps.size(); ++p) {
+		terms.predicates[p].clear();
+		if (predicateMaps[p]) {
+			predicateMaps[p]->generateRDFTerms(batch, terms.predicateColumns[p], env, terms.predicates[p]);
+		}
+	}
+
+	terms.objects.resize(objectMaps.size());
+	terms.datatypes.resize(objectMaps.size());
+	terms.datatypeNodes.assign(objectMaps.size(), SERD_NODE_NULL);
+	terms.languageNodes.assign(objectMaps.size(), SERD_NODE_NULL);
+	for (std::size_t o = 0; o < objectMaps.size(); ++o) {
+		terms.objects[o].clear();
+		terms.datatypes[o].clear();
+		const TermMap *objMap = objectMaps[o].get();
+		if (!objMap || dynamic_cast<const ReferencingObjectMap *>(objMap)) {
+			continue;
+		}
+		objMap->generateRDFTerms(batch, terms.objectColumns[o], env, terms.objects[o]);
+		if (objMap->languageTag) {
+			terms.languageNodes[o] =
+			    objMap->languageNode.buf
+			        ? objMap->languageNode
+			        : serd_node_from_string(SERD_LITERAL,
+			                                reinterpret_cast<const uint8_t *>(objMap->languageTag->c_str()));
+			continue;
+		}
+		terms.datatypes[o] = objMap->computeDatatypeIRI(batch, terms.objectColumns[o]);
+		if (objMap->datatypeNode.buf) {
+			terms.datatypeNodes[o] = objMap->datatypeNode;
+		} else if (!terms.datatypes[o].empty()) {
+			const SerdNode *pooled = constants ? constants->find(SERD_URI, terms.datatypes[o]) : nullptr;
+			terms.datatypeNodes[o] =
+			    pooled ? *pooled
+			           : serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>(terms.datatypes[o].c_str()));
+		}
+	}
+
+	generateGraphTerms(graphMaps, batch, terms.graphColumns, env, terms.graphs);
+}
+
+bool PredicateObjectMap::probeJoins(const RowBatch &batch, const TermBatch &subjects, const SerdEnv &env,
+                                    BatchTerms &terms, SQLConnection &dbConnection, JoinIndexCache &joinIndexes,
+                                    PredicateObjectMapMetrics *metrics) const {
+	terms.probed = true;
+	bool joined = false;
+	terms.joinIndexes.assign(objectMaps.size(), nullptr);
+	terms.joinMatches.resize(objectMaps.size());
+	// The rows processRow() gets as far as the object maps of.
+	auto emits = [&](std::size_t row) {
+		if (subjects.isNull(row)) {
+			return false;
+		}
+		for (std::size_t p = 0; p < predicateMaps.size(); ++p) {
+			if (predicateMaps[p] && !terms.predicates[p].isNull(row)) {
+				return true;
+			}
+		}
+		return false;
+	};
+	for (std::size_t o = 0; o < objectMaps.size(); ++o) {
+		std::vector<const std::vector<std::size_t> *> &matches = terms.joinMatches[o];
+		matches.clear();
+		const ReferencingObjectMap *rom = dynamic_cast<const ReferencingObjectMap *>(objectMaps[o].get());
+		if (!rom || joinIndexes.isPushedDown(*rom)) {
+			continue;
+		}
+		JoinIndex &index = joinIndexes.get(*rom, dbConnection, env);
+		terms.joinIndexes[o] = &index;
+		joined = true;
+		matches.assign(batch.size(), nullptr);
+		for (std::size_t row = 0; row < batch.size(); ++row) {
+			if (emits(row)) {
+				matches[row] = index.probe(batch, terms.joinColumns[o], row);
+				if (metrics) {
+					++metrics->joinProbes;
+				}
+			}
+		}
+	}
+	return joined;
+}
+
+void PredicateObjectMap::processRow(const RowBatch &batch, std::size_t row, const SerdNode &subject,
+                                    const BatchTerms &terms, StatementSink &rdfSink, const R2RMLMapping &mapping,
+                                    SQLConnection &dbConnection, const std::vector<TermBatch> &subjectGraphs,
+                                    JoinIndexCache *joinIndexes) const {
+	RowGraphs rowSubjectGraphs;
+	rowSubjectGraphs.resolve(subjectGraphs, row);
+	processRow(batch, row, subject, terms, rdfSink, mapping, dbConnection, rowSubjectGraphs, joinIndexes);
+}
+
+void PredicateObjectMap::processRow(const RowBatch &batch, std::size_t row, const SerdNode &subject,
+                                    const BatchTerms &terms, StatementSink &rdfSink, const R2RMLMapping &mapping,
+                                    SQLConnection &dbConnection, const RowGraphs &subjectGraphs,
+                                    JoinIndexCache *joinIndexes, PredicateObjectMapMetrics *metrics) const {
+	const SerdEnv *env = mapping.serdEnvironment;
+	static SerdEnv *fallbackEnv = nullptr;
+	if (!env) {
+		if (!fallbackEnv) {
+			fallbackEnv = serd_env_new(nullptr);
+		}
+		env = fallbackEnv;
+	}
+
+	RowGraphs graphs;
+	graphs.resolve(graphMaps, terms.graphs, row);
+
+	for (std::size_t p = 0; p < predicateMaps.size(); ++p) {
+		if (!predicateMaps[p]) {
+			continue;
+		}
+		if (terms.predicates[p].isNull(row)) {
+			if (metrics) {
+				++metrics->nullsSkipped;
+			}
+			continue;
+		}
+		SerdNode predicate = terms.predicates[p].node(row);
+
+		for (std::size_t o = 0; o < objectMaps.size(); ++o) {
+			const TermMap *objMap = objectMaps[o].get();
+			if (!objMap) {
+				continue;
+			}
+
+			const ReferencingObjectMap *rom = dynamic_cast<const ReferencingObjectMap *>(objMap);
+			if (rom && joinIndexes && joinIndexes->isPushedDown(*rom)) {
+				continue; // evaluated by a database-side join instead
+			}
+			if (rom && joinIndexes) {
+				JoinIndex *index = terms.probed ? terms.joinIndexes[o] : &joinIndexes->get(*rom, dbConnection, *env);
+				const std::vector<std::size_t> *matches =
+				    terms.probed ? terms.joinMatches[o][row] : index->probe(batch, terms.joinColumns[o], row);
+				if (!terms.probed && metrics) {
+					++metrics->joinProbes;
+				}
+				if (!matches) {
+					continue;
+				}
+				for (std::size_t match : *matches) {
+					SerdNode object = index->subject(match);
+					forEachGraphNode(subjectGraphs, graphs, [&](const SerdNode *graph) {
+						rdfSink.write(graph, subject, predicate, object, nullptr, nullptr);
+					});
+				}
+				continue;
+			}
+			if (rom) {
+				// Without an index joins stay row-at-a-time: query the parent
+				// and use its subject.
+				RowBatchRow childRow(batch, row);
+				auto parentRows = rom->getJoinedRows(dbConnection, childRow);
+				if (!parentRows) {
+					continue;
+				}
+				while (parentRows->next()) {
+					SerdNode object = rom->generateRDFTerm(childRow, parentRows->getCurrentRow(), *env);
+					if (object.type == SERD_NOTHING) {
+						continue;
+					}
+					forEachGraphNode(subjectGraphs, graphs, [&](const SerdNode *graph) {
+						rdfSink.write(graph, subject, predicate, object, nullptr, nullptr);
+					});
+				}
+				continue;
+			}
+
+			if (terms.objects[o].isNull(row)) {
+				if (metrics) {
+					++metrics->nullsSkipped;
+				}
+				continue;
+			}
+			SerdNode object = terms.objects[o].node(row);
+
+			const SerdNode *datatype = nullptr;
+			const SerdNode *lang = nullptr;
+			if (object.type == SERD_LITERAL && terms.languageNodes[o].buf) {
+				lang = &terms.languageNodes[o];
+			} else if (object.type == SERD_LITERAL && terms.datatypeNodes[o].buf) {
+				datatype = &terms.datatypeNodes[o];
+			}
+
+			forEachGraphNode(subjectGraphs, graphs, [&](const SerdNode *graph) {
+				rdfSink.write(graph, subject, predicate, object, datatype, lang);
+			});
+		}
+	}
+}
+
 bool PredicateObjectMap::isValid() const {
 	if (predicateMaps.empty() || objectMaps.empty()) {
 		return false;
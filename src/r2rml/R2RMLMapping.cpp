@@ -1,22 +1,234 @@
 #include "r2rml/R2RMLMapping.h"
 #include "r2rml/TriplesMap.h"
+#include "r2rml/BoundTriplesMap.h"
+#include "r2rml/DedupSink.h"
+#include "r2rml/DuplicateFilter.h"
+#include "r2rml/GraphMap.h"
+#include "r2rml/JoinCondition.h"
+#include "r2rml/JoinIndex.h"
+#include "r2rml/PredicateObjectMap.h"
+#include "r2rml/ReferencingObjectMap.h"
 #include "r2rml/LogicalTable.h"
+#include "r2rml/NTriplesWriter.h"
+#include "r2rml/RowBatch.h"
 #include "r2rml/SQLConnection.h"
 #include "r2rml/SQLResultSet.h"
 #include "r2rml/SQLRow.h"
+#include "r2rml/SQLValue.h"
+#include "r2rml/ShardedOutput.h"
+#include "r2rml/SubjectMap.h"
+#include "r2rml/WatermarkState.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <set>
 #include <ostream>
+#include <stdexcept>
+#include <thread>
 #include <utility>
 
 namespace r2rml {
 
+namespace {
+
+/** SerdSink appending to a std::string. */
+size_t appendToString(const void *buf, size_t len, void *stream) {
+	static_cast<std::string *>(stream)->append(static_cast<const char *>(buf), len);
+	return len;
+}
+
+/** An inclusive range of partition keys; empty when lower > upper. */
+struct KeyRange {
+	long long lower {0};
+	long long upper {-1};
+};
+
+long long parsePartitionKey(const SQLValue &value, const LogicalTable &table) {
+	const std::string &text = value.asString();
+	char *end = nullptr;
+	errno = 0;
+	long long key = std::strtoll(text.c_str(), &end, 10);
+	if (text.empty() || *end != '\0' || errno == ERANGE) {
+		throw std::runtime_error("R2RML: partition key " + table.partitionKey() + " is not an integer: " + text);
+	}
+	return key;
+}
+
+/** The lowest and highest partition key of `table`. */
+KeyRange queryPartitionBounds(const LogicalTable &table, SQLConnection &dbConnection) {
+	KeyRange bounds;
+	auto rows = dbConnection.execute(table.partitionBoundsQuery());
+	if (!rows || !rows->next()) {
+		return bounds;
+	}
+	std::unique_ptr<SQLValue> lower = rows->getCurrentRow().getValue("lower");
+	std::unique_ptr<SQLValue> upper = rows->getCurrentRow().getValue("upper");
+	if (lower && upper && !lower->isNull() && !upper->isNull()) {
+		bounds.lower = parsePartitionKey(*lower, table);
+		bounds.upper = parsePartitionKey(*upper, table);
+	}
+	return bounds;
+}
+
+/**
+ * Part `part` of `bounds` split into `parts` ranges whose widths differ by at
+ * most one.
+ */
+KeyRange partitionRange(const KeyRange &bounds, unsigned part, unsigned parts) {
+	KeyRange range;
+	if (bounds.lower > bounds.upper) {
+		return range;
+	}
+	// Offsets from bounds.lower, in unsigned arithmetic so no width overflows.
+	unsigned long long span =
+	    static_cast<unsigned long long>(bounds.upper) - static_cast<unsigned long long>(bounds.lower);
+	unsigned long long width = span / parts;
+	unsigned long long extra = span % parts + 1; // ranges one wider than `width`
+	unsigned long long first = width * part + std::min<unsigned long long>(part, extra);
+	unsigned long long size = width + (part < extra ? 1 : 0);
+	if (size == 0) {
+		return range;
+	}
+	range.lower = static_cast<long long>(static_cast<unsigned long long>(bounds.lower) + first);
+	range.upper = static_cast<long long>(static_cast<unsigned long long>(bounds.lower) + first + size - 1);
+	return range;
+}
+
+/** The TriplesMaps an export runs, in mapping order. */
+std::vector<const TriplesMap *> exportedTriplesMaps(const std::vector<std::unique_ptr<TriplesMap>> &triplesMaps) {
+	std::vector<const TriplesMap *> maps;
+	for (const auto &tm : triplesMaps) {
+		if (tm && tm->isValid()) {
+			maps.push_back(tm.get());
+		}
+	}
+	return maps;
+}
+
+/**
+ * Zeroed metrics for `maps` (ExportReport::triplesMaps) when
+ * `options.metrics` asks for them; empty otherwise.
+ */
+std::vector<TriplesMapMetrics> emptyMetrics(const std::vector<const TriplesMap *> &maps,
+                                            const ExportOptions &options) {
+	std::vector<TriplesMapMetrics> metrics;
+	if (options.metrics) {
+		metrics.resize(maps.size());
+		for (std::size_t m = 0; m < maps.size(); ++m) {
+			metrics[m].id = maps[m]->id;
+			metrics[m].predicateObjectMaps.resize(maps[m]->predicateObjectMaps.size());
+		}
+	}
+	return metrics;
+}
+
+/** Add the workers' metrics for the same TriplesMaps together. */
+std::vector<TriplesMapMetrics> sumMetrics(const std::vector<ExportReport> &reports) {
+	std::vector<TriplesMapMetrics> metrics;
+	for (const ExportReport &r : reports) {
+		if (metrics.empty()) {
+			metrics = r.triplesMaps;
+			continue;
+		}
+		for (std::size_t m = 0; m < r.triplesMaps.size(); ++m) {
+			metrics[m] += r.triplesMaps[m];
+		}
+	}
+	return metrics;
+}
+
+/** A unit of work of a parallel export: a TriplesMap, or one key range of a partitioned one. */
+struct Part {
+	std::size_t map;
+	unsigned part;
+	unsigned parts;
+};
+
+/** Whether `table` is exported as a delta above its watermark (ExportOptions::watermarks). */
+bool incremental(const LogicalTable &table, const ExportOptions &options) {
+	return options.watermarks && !table.watermarkBoundQuery().empty();
+}
+
+/** The parts of `maps`, in output order (see ExportOptions::partitions). */
+std::vector<Part> splitIntoParts(const std::vector<const TriplesMap *> &maps, const ExportOptions &options) {
+	std::vector<Part> parts;
+	for (std::size_t m = 0; m < maps.size(); ++m) {
+		const LogicalTable &table = *maps[m]->logicalTable;
+		unsigned n = options.partitions > 1 && !table.partitionBoundsQuery().empty() && !incremental(table, options)
+		                 ? options.partitions
+		                 : 1;
+		for (unsigned p = 0; p < n; ++p) {
+			parts.push_back(Part {m, p, n});
+		}
+	}
+	return parts;
+}
+
+/**
+ * Key bounds of a partitioned TriplesMap's table, queried by the first
+ * worker to reach one of its parts.
+ */
+struct PartitionBounds {
+	std::mutex mutex;
+	bool known {false};
+	KeyRange keys;
+	/** The default key doesn't exist (a view has no rowid): the last part exports the whole table. */
+	bool whole {false};
+};
+
+/**
+ * The row query of `part` of `tm` in `query`: empty for a whole table.
+ * False when the part has no rows to export.
+ */
+bool partRowQuery(const Part &part, const TriplesMap &tm, PartitionBounds &bounds, SQLConnection &dbConnection,
+                  std::string &query) {
+	query.clear();
+	if (part.parts == 1) {
+		return true;
+	}
+	KeyRange range;
+	{
+		std::lock_guard<std::mutex> lock(bounds.mutex);
+		if (!bounds.known) {
+			try {
+				bounds.keys = queryPartitionBounds(*tm.logicalTable, dbConnection);
+			} catch (const std::exception &) {
+				// An rr:tableName naming a view has no rowid; a declared
+				// partitionColumn that fails is the mapping's error.
+				if (!tm.logicalTable->partitionColumn.empty()) {
+					throw;
+				}
+				bounds.whole = true;
+			}
+			bounds.known = true;
+		}
+		if (bounds.whole) {
+			// The last part, so that it runs the pushed-down joins as well.
+			return part.part + 1 == part.parts;
+		}
+		range = partitionRange(bounds.keys, part.part, part.parts);
+	}
+	query = tm.logicalTable->partitionQuery(range.lower, range.upper);
+	return true;
+}
+
+} // namespace
+
 R2RMLMapping::R2RMLMapping() = default;
 
 R2RMLMapping::R2RMLMapping(R2RMLMapping &&other) noexcept
-    : triplesMaps(std::move(other.triplesMaps)), parseErrors(std::move(other.parseErrors)) {
+    : triplesMaps(std::move(other.triplesMaps)), parseErrors(std::move(other.parseErrors)),
+      constants(std::move(other.constants)), compiled_(other.compiled_) {
 	this->serdEnvironment = other.serdEnvironment;
 	other.serdEnvironment = nullptr;
+	other.compiled_ = false;
 }
 
 R2RMLMapping &R2RMLMapping::operator=(R2RMLMapping &&other) noexcept {
@@ -26,6 +238,9 @@ R2RMLMapping &R2RMLMapping::operator=(R2RMLMapping &&other) noexcept {
 		}
 		triplesMaps = std::move(other.triplesMaps);
 		parseErrors = std::move(other.parseErrors);
+		constants = std::move(other.constants);
+		compiled_ = other.compiled_;
+		other.compiled_ = false;
 		this->serdEnvironment = other.serdEnvironment;
 		other.serdEnvironment = nullptr;
 	}
@@ -42,21 +257,534 @@ void R2RMLMapping::loadMapping(const std::string & /*mappingFilePath*/) {
 	// stub – callers should use R2RMLParser::parse() instead.
 }
 
-void R2RMLMapping::processDatabase(SQLConnection &dbConnection, SerdWriter &rdfWriter) {
+void R2RMLMapping::compile() {
 	for (const auto &tm : triplesMaps) {
-		if (!tm || !tm->isValid()) {
+		if (!tm) {
 			continue;
 		}
+		if (tm->subjectMap) {
+			tm->subjectMap->internConstants(constants);
+		}
+		for (const auto &pom : tm->predicateObjectMaps) {
+			if (!pom) {
+				continue;
+			}
+			for (const auto &pm : pom->predicateMaps) {
+				if (pm) {
+					pm->internConstants(constants);
+				}
+			}
+			for (const auto &om : pom->objectMaps) {
+				if (om) {
+					om->internConstants(constants);
+				}
+			}
+			for (const auto &gm : pom->graphMaps) {
+				if (gm) {
+					gm->internConstants(constants);
+				}
+			}
+		}
+	}
 
-		auto rows = tm->logicalTable->getRows(dbConnection);
-		if (!rows) {
+	// Project each logical table onto the columns its TriplesMap reads, then
+	// those TriplesMaps joining it read from it through rr:parent.  One read
+	// by a term map that doesn't report its columns selects them all.
+	std::map<const TriplesMap *, std::vector<std::string>> reads;
+	std::set<const TriplesMap *> unknown;
+	std::vector<std::pair<const TriplesMap *, std::string>> parentColumns;
+	for (const auto &tm : triplesMaps) {
+		if (!tm || !tm->logicalTable) {
 			continue;
 		}
+		if (!tm->referencedColumns(reads[tm.get()])) {
+			unknown.insert(tm.get());
+		}
+		for (const auto &pom : tm->predicateObjectMaps) {
+			if (!pom) {
+				continue;
+			}
+			for (const auto &om : pom->objectMaps) {
+				const ReferencingObjectMap *rom = dynamic_cast<const ReferencingObjectMap *>(om.get());
+				if (!rom || !rom->parentTriplesMap) {
+					continue;
+				}
+				for (const JoinCondition &jc : rom->joinConditions) {
+					parentColumns.emplace_back(rom->parentTriplesMap, jc.parentColumn);
+				}
+			}
+		}
+	}
+	for (const auto &parentColumn : parentColumns) {
+		std::vector<std::string> &columns = reads[parentColumn.first];
+		if (std::find(columns.begin(), columns.end(), parentColumn.second) == columns.end()) {
+			columns.push_back(parentColumn.second);
+		}
+	}
+	for (const auto &tm : triplesMaps) {
+		if (tm && tm->logicalTable) {
+			tm->logicalTable->projection = unknown.count(tm.get()) ? std::vector<std::string>() : reads[tm.get()];
+			// Refreshed here, before any export, so getRows() never writes it.
+			std::string query = tm->logicalTable->rowQuery();
+			if (!query.empty()) {
+				tm->logicalTable->effectiveSqlQuery = query;
+			}
+		}
+	}
+	compiled_ = true;
+}
+
+void R2RMLMapping::processDatabase(SQLConnection &dbConnection, SerdWriter &rdfWriter, ExportReport *report) {
+	processDatabase(dbConnection, rdfWriter, ExportOptions(), report);
+}
+
+void R2RMLMapping::processDatabase(SQLConnection &dbConnection, SerdWriter &rdfWriter, const ExportOptions &options,
+                                   ExportReport *report) {
+	SerdWriterSink rdfSink(rdfWriter);
+	processDatabase(dbConnection, rdfSink, options, report);
+}
 
-		while (rows->next()) {
-			const SQLRow &row = rows->getCurrentRow();
-			tm->generateTriples(row, rdfWriter, *this, dbConnection);
+void R2RMLMapping::processDatabase(SQLConnection &dbConnection, StatementSink &rdfSink, const ExportOptions &options,
+                                   ExportReport *report) {
+	if (options.dedup) {
+		DedupSink dedup(rdfSink, options.dedupMemory);
+		ExportOptions rest = options;
+		rest.dedup = false;
+		processDatabase(dbConnection, dedup, rest, report);
+		dedup.flush();
+		if (report) {
+			report->duplicatesDropped = dedup.duplicates();
+			report->dedupSpills = dedup.spills();
 		}
+		return;
+	}
+	if (!compiled_) {
+		compile();
+	}
+	JoinIndexCache joinIndexes;
+	std::size_t joinQueries = 0;
+	std::size_t statements = 0;
+	CountingSink counting(rdfSink, &statements);
+	StatementSink &sink = report ? static_cast<StatementSink &>(counting) : rdfSink;
+	std::vector<const TriplesMap *> maps = exportedTriplesMaps(triplesMaps);
+	std::vector<TriplesMapMetrics> metrics = emptyMetrics(maps, options);
+	for (std::size_t m = 0; m < maps.size(); ++m) {
+		exportTriplesMap(*maps[m], dbConnection, sink, options, joinIndexes, joinQueries, std::string(), true,
+		                 metrics.empty() ? nullptr : &metrics[m]);
+	}
+
+	if (report) {
+		report->statements = statements;
+		report->triplesMaps.swap(metrics);
+		report->joinIndexBuilds = joinIndexes.builds();
+		report->joinIndexProbes = joinIndexes.probes();
+		report->joinQueries = joinQueries;
+	}
+}
+
+void R2RMLMapping::processDatabase(const ConnectionFactory &connect, SerdSyntax syntax, SerdStyle style,
+                                   SerdSink sink, void *stream, const ExportOptions &options, ExportReport *report) {
+	// Term generation falls back to a lazily created static environment when
+	// the mapping has none; make one up front so workers never race to.
+	if (!serdEnvironment) {
+		serdEnvironment = serd_env_new(nullptr);
+	}
+	if (!compiled_) {
+		compile();
+	}
+	if (options.dedup && !NTriplesWriter::supports(syntax)) {
+		throw std::invalid_argument("R2RML: a parallel export can only drop duplicates from N-Triples or N-Quads");
+	}
+
+	std::vector<const TriplesMap *> maps = exportedTriplesMaps(triplesMaps);
+	std::vector<Part> parts = splitIntoParts(maps, options);
+	unsigned threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+	threads = std::max(1u, std::min(threads, static_cast<unsigned>(parts.size())));
+
+	std::vector<PartitionBounds> bounds(maps.size());
+
+	// One slot per part, filled by whichever worker exported it.
+	struct Slot {
+		std::string output;
+		std::exception_ptr error;
+		bool done {false};
+	};
+	std::vector<Slot> slots(parts.size());
+	std::vector<ExportReport> reports(threads);
+	for (ExportReport &r : reports) {
+		r.triplesMaps = emptyMetrics(maps, options);
+	}
+	std::mutex mutex;
+	std::condition_variable finished;
+	std::atomic<std::size_t> next {0};
+	std::atomic<bool> stop {false};
+
+	auto work = [&](unsigned worker) {
+		std::unique_ptr<SQLConnection> dbConnection;
+		std::exception_ptr connectError;
+		try {
+			dbConnection = connect();
+			if (!dbConnection) {
+				throw std::runtime_error("R2RML: connection factory returned no connection");
+			}
+		} catch (...) {
+			connectError = std::current_exception();
+		}
+
+		JoinIndexCache joinIndexes;
+		std::size_t joinQueries = 0;
+		std::size_t partitionQueries = 0;
+		std::size_t statements = 0;
+		std::vector<TriplesMapMetrics> &metrics = reports[worker].triplesMaps;
+		for (std::size_t i = next++; i < parts.size() && !stop; i = next++) {
+			const Part &part = parts[i];
+			const TriplesMap &tm = *maps[part.map];
+			TriplesMapMetrics *partMetrics = metrics.empty() ? nullptr : &metrics[part.map];
+			std::string output;
+			std::exception_ptr error = connectError;
+			if (!error) {
+				try {
+					std::string rowQuery;
+					const bool hasRows = partRowQuery(part, tm, bounds[part.map], *dbConnection, rowQuery);
+					if (!rowQuery.empty()) {
+						++partitionQueries;
+					}
+					// Pushed-down joins cover the whole table, so only the last part runs them.
+					const bool pushedDownJoins = part.part + 1 == part.parts;
+					if (!hasRows) {
+						// A part of a table exported whole by its last part.
+					} else if (NTriplesWriter::supports(syntax)) {
+						NTriplesWriter writer(syntax, serdEnvironment, &constants, appendToString, &output);
+						CountingSink counting(writer, &statements);
+						exportTriplesMap(tm, *dbConnection, counting, options, joinIndexes, joinQueries, rowQuery,
+						                 pushedDownJoins, partMetrics);
+						writer.flush();
+					} else {
+						std::unique_ptr<SerdWriter, void (*)(SerdWriter *)> writer(
+						    serd_writer_new(syntax, style, serdEnvironment, nullptr, appendToString, &output),
+						    serd_writer_free);
+						SerdWriterSink rdfSink(*writer);
+						CountingSink counting(rdfSink, &statements);
+						exportTriplesMap(tm, *dbConnection, counting, options, joinIndexes, joinQueries, rowQuery,
+						                 pushedDownJoins, partMetrics);
+						serd_writer_finish(writer.get());
+					}
+				} catch (...) {
+					error = std::current_exception();
+				}
+			}
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				slots[i].output.swap(output);
+				slots[i].error = error;
+				slots[i].done = true;
+			}
+			finished.notify_all();
+		}
+		reports[worker].statements = statements;
+		reports[worker].joinIndexBuilds = joinIndexes.builds();
+		reports[worker].joinIndexProbes = joinIndexes.probes();
+		reports[worker].joinQueries = joinQueries;
+		reports[worker].partitionQueries = partitionQueries;
+	};
+
+	std::vector<std::thread> workers;
+	try {
+		for (unsigned w = 0; w < threads; ++w) {
+			workers.emplace_back(work, w);
+		}
+	} catch (...) {
+		stop = true;
+		for (std::thread &t : workers) {
+			t.join();
+		}
+		throw;
+	}
+
+	// Merge on this thread: each part's output goes out as soon as it and
+	// everything before it are done.  With dedup its lines, one statement
+	// each, go through a DuplicateFilter first.
+	std::string kept;
+	std::unique_ptr<DuplicateFilter> dedup;
+	if (options.dedup) {
+		dedup.reset(new DuplicateFilter(options.dedupMemory, [&kept](const char *line, std::size_t size) {
+			kept.append(line, size);
+		}));
+	}
+	auto filter = [&](std::string &output) {
+		kept.clear();
+		for (std::size_t start = 0; start < output.size();) {
+			std::size_t end = output.find('\n', start);
+			end = end == std::string::npos ? output.size() : end + 1;
+			dedup->add(output.data() + start, end - start);
+			start = end;
+		}
+		output.swap(kept);
+	};
+	std::exception_ptr error;
+	for (std::size_t i = 0; i <= slots.size() && !error; ++i) {
+		std::string output;
+		if (i < slots.size()) {
+			std::unique_lock<std::mutex> lock(mutex);
+			finished.wait(lock, [&] { return slots[i].done; });
+			output.swap(slots[i].output);
+			error = slots[i].error;
+		}
+		try {
+			if (!error && dedup && i < slots.size()) {
+				filter(output);
+			} else if (!error && dedup) {
+				// the held-back lines, once every part is through
+				kept.clear();
+				dedup->finish();
+				output.swap(kept);
+			}
+		} catch (...) {
+			error = std::current_exception();
+		}
+		if (!error && !output.empty() && sink(output.data(), output.size(), stream) != output.size()) {
+			error = std::make_exception_ptr(std::runtime_error("R2RML: failed to write RDF output"));
+		}
+	}
+	stop = error != nullptr;
+	for (std::thread &t : workers) {
+		t.join();
+	}
+	if (error) {
+		std::rethrow_exception(error);
+	}
+
+	if (report) {
+		*report = ExportReport();
+		for (const ExportReport &r : reports) {
+			report->statements += r.statements;
+			report->joinIndexBuilds += r.joinIndexBuilds;
+			report->joinIndexProbes += r.joinIndexProbes;
+			report->joinQueries += r.joinQueries;
+			report->partitionQueries += r.partitionQueries;
+		}
+		report->triplesMaps = sumMetrics(reports);
+		if (dedup) {
+			report->duplicatesDropped = dedup->duplicates();
+			report->dedupSpills = dedup->spills();
+		}
+	}
+}
+
+void R2RMLMapping::processDatabase(const ConnectionFactory &connect, ShardedOutput &output,
+                                   const ExportOptions &options, ExportReport *report) {
+	if (options.dedup) {
+		throw std::invalid_argument("R2RML: a sharded export can't drop duplicates");
+	}
+	if (!serdEnvironment) {
+		serdEnvironment = serd_env_new(nullptr);
+	}
+	if (!compiled_) {
+		compile();
+	}
+
+	std::vector<const TriplesMap *> maps = exportedTriplesMaps(triplesMaps);
+	std::vector<Part> parts = splitIntoParts(maps, options);
+	unsigned threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+	threads = std::max(1u, std::min(threads, static_cast<unsigned>(parts.size())));
+
+	std::vector<PartitionBounds> bounds(maps.size());
+	std::vector<ExportReport> reports(threads);
+	for (ExportReport &r : reports) {
+		r.triplesMaps = emptyMetrics(maps, options);
+	}
+	std::mutex mutex;
+	std::exception_ptr error;
+	std::atomic<std::size_t> next {0};
+	std::atomic<bool> stop {false};
+
+	// Workers write their own shards as they go; nothing is merged.
+	auto work = [&](unsigned worker) {
+		try {
+			std::unique_ptr<SQLConnection> dbConnection = connect();
+			if (!dbConnection) {
+				throw std::runtime_error("R2RML: connection factory returned no connection");
+			}
+			ShardWriter writer(output, serdEnvironment, &constants);
+			std::size_t statements = 0;
+			CountingSink counting(writer, &statements);
+			JoinIndexCache joinIndexes;
+			std::size_t joinQueries = 0;
+			std::size_t partitionQueries = 0;
+			for (std::size_t i = next++; i < parts.size() && !stop; i = next++) {
+				const Part &part = parts[i];
+				const TriplesMap &tm = *maps[part.map];
+				std::string rowQuery;
+				if (!partRowQuery(part, tm, bounds[part.map], *dbConnection, rowQuery)) {
+					continue;
+				}
+				if (!rowQuery.empty()) {
+					++partitionQueries;
+				}
+				writer.startTriplesMap(tm.id);
+				std::vector<TriplesMapMetrics> &metrics = reports[worker].triplesMaps;
+				exportTriplesMap(tm, *dbConnection, counting, options, joinIndexes, joinQueries, rowQuery,
+				                 part.part + 1 == part.parts, metrics.empty() ? nullptr : &metrics[part.map]);
+			}
+			writer.finish();
+			reports[worker].statements = statements;
+			reports[worker].joinIndexBuilds = joinIndexes.builds();
+			reports[worker].joinIndexProbes = joinIndexes.probes();
+			reports[worker].joinQueries = joinQueries;
+			reports[worker].partitionQueries = partitionQueries;
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!error) {
+				error = std::current_exception();
+			}
+			stop = true;
+		}
+	};
+
+	if (threads == 1) {
+		work(0);
+	} else {
+		std::vector<std::thread> workers;
+		try {
+			for (unsigned w = 0; w < threads; ++w) {
+				workers.emplace_back(work, w);
+			}
+		} catch (...) {
+			stop = true;
+			for (std::thread &t : workers) {
+				t.join();
+			}
+			throw;
+		}
+		for (std::thread &t : workers) {
+			t.join();
+		}
+	}
+	if (error) {
+		std::rethrow_exception(error);
+	}
+
+	if (report) {
+		*report = ExportReport();
+		for (const ExportReport &r : reports) {
+			report->statements += r.statements;
+			report->joinIndexBuilds += r.joinIndexBuilds;
+			report->joinIndexProbes += r.joinIndexProbes;
+			report->joinQueries += r.joinQueries;
+			report->partitionQueries += r.partitionQueries;
+		}
+		report->triplesMaps = sumMetrics(reports);
+	}
+}
+
+void R2RMLMapping::exportTriplesMap(const TriplesMap &tm, SQLConnection &dbConnection, StatementSink &rdfSink,
+                                    const ExportOptions &options, JoinIndexCache &joinIndexes,
+                                    std::size_t &joinQueries, const std::string &rowQuery, bool pushedDownJoins,
+                                    TriplesMapMetrics *metrics) const {
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point start = metrics ? Clock::now() : Clock::time_point();
+
+	// An incremental export takes the rows between the recorded watermark
+	// and the current highest one.  A pushed-down join would cover the
+	// whole table, so the delta's joins use the index.
+	const bool delta = incremental(*tm.logicalTable, options);
+	std::string watermark;
+	std::string query = rowQuery;
+	if (delta) {
+		std::string after;
+		const bool marked = options.watermarks->get(tm.id, after);
+		auto bound = dbConnection.execute(tm.logicalTable->watermarkBoundQuery());
+		std::unique_ptr<SQLValue> upper;
+		if (bound && bound->next()) {
+			upper = bound->getCurrentRow().getValue("upper");
+		}
+		bound.reset();
+		if (!upper || upper->isNull()) {
+			return; // no rows with a watermark, so none to export
+		}
+		watermark = upper->asString();
+		query = tm.logicalTable->watermarkQuery(marked ? after : std::string(), watermark);
+	}
+
+	// rr:refObjectMaps the database can join are taken out of the row
+	// pass below and run as one joint query each once it is done.
+	// (by index in tm.predicateObjectMaps)
+	std::vector<std::pair<std::size_t, const ReferencingObjectMap *>> pushedDown;
+	if (options.pushDownJoins && !delta) {
+		for (std::size_t i = 0; i < tm.predicateObjectMaps.size(); ++i) {
+			for (const auto &objMap : tm.predicateObjectMaps[i]->objectMaps) {
+				const auto *rom = dynamic_cast<const ReferencingObjectMap *>(objMap.get());
+				if (rom && !rom->joinQuery(*tm.logicalTable).empty()) {
+					joinIndexes.markPushedDown(*rom);
+					pushedDown.emplace_back(i, rom);
+				}
+			}
+		}
+	}
+
+	// The other rr:refObjectMaps' parent indexes are built now, so no parent
+	// query runs while the child result below is open and streaming.
+	std::unique_ptr<SerdEnv, void (*)(SerdEnv *)> emptyEnv(nullptr, serd_env_free);
+	for (const auto &pom : tm.predicateObjectMaps) {
+		for (const auto &objMap : pom->objectMaps) {
+			const auto *rom = dynamic_cast<const ReferencingObjectMap *>(objMap.get());
+			if (!rom || !rom->parentTriplesMap || joinIndexes.isPushedDown(*rom)) {
+				continue;
+			}
+			if (!serdEnvironment && !emptyEnv) {
+				emptyEnv.reset(serd_env_new(nullptr));
+			}
+			joinIndexes.build(*rom, dbConnection, serdEnvironment ? *serdEnvironment : *emptyEnv);
+		}
+	}
+
+	auto rows = query.empty() ? tm.logicalTable->getRows(dbConnection) : dbConnection.execute(query);
+	if (metrics) {
+		Clock::time_point now = Clock::now();
+		metrics->executeSeconds += std::chrono::duration<double>(now - start).count();
+		start = now;
+	}
+	if (!rows) {
+		return;
+	}
+
+	// Column references are resolved once for the whole result set.  With
+	// metrics, the time outside generateTriples() is spent fetching batches.
+	BoundTriplesMap bound(tm, *this);
+	bound.collectMetrics(metrics);
+	RowBatch batch;
+	double generated = metrics ? metrics->termSeconds + metrics->joinSeconds + metrics->writeSeconds : 0;
+	while (rows->nextBatch(batch)) {
+		bound.generateTriples(batch, rdfSink, dbConnection, &joinIndexes);
+	}
+	rows.reset();
+	if (metrics) {
+		Clock::time_point now = Clock::now();
+		generated = metrics->termSeconds + metrics->joinSeconds + metrics->writeSeconds - generated;
+		metrics->iterateSeconds += std::chrono::duration<double>(now - start).count() - generated;
+		start = now;
+	}
+	if (!watermark.empty()) {
+		options.watermarks->set(tm.id, watermark);
+	}
+
+	if (!pushedDownJoins) {
+		return;
+	}
+	for (const auto &join : pushedDown) {
+		const PredicateObjectMap &pom = *tm.predicateObjectMaps[join.first];
+		if (metrics) {
+			CountingSink counting(rdfSink, &metrics->predicateObjectMaps[join.first].triples);
+			std::size_t before = *counting.count;
+			tm.generateJoinedTriples(pom, *join.second, counting, *this, dbConnection);
+			metrics->triples += *counting.count - before;
+		} else {
+			tm.generateJoinedTriples(pom, *join.second, rdfSink, *this, dbConnection);
+		}
+		++joinQueries;
+	}
+	if (metrics && !pushedDown.empty()) {
+		metrics->executeSeconds += std::chrono::duration<double>(Clock::now() - start).count();
 	}
 }
 
@@ -355,6 +355,34 @@ public:
 		return SERD_NODE_NULL;
 	}
 
+	void generateRDFTerms(const RowBatch &batch, const SerdEnv &env, TermBatch &out) const override {
+		if (valueMap) {
+			valueMap->generateRDFTerms(batch, env, out);
+		} else {
+			TermMap::generateRDFTerms(batch, env, out);
+		}
+	}
+
+	void generateRDFTerms(const RowBatch &batch, const ColumnOrdinals &columns, const SerdEnv &env,
+	                      TermBatch &out) const override {
+		if (valueMap) {
+			valueMap->generateRDFTerms(batch, columns, env, out);
+		} else {
+			TermMap::generateRDFTerms(batch, env, out);
+		}
+	}
+
+	std::vector<std::string> referencedColumns() const override {
+		return valueMap ? valueMap->referencedColumns() : std::vector<std::string>();
+	}
+
+	void internConstants(ConstantPool &pool) override {
+		SubjectMap::internConstants(pool);
+		if (valueMap) {
+			valueMap->internConstants(pool);
+		}
+	}
+
 	const TermMap *valueTermMap() const override {
 		return valueMap.get();
 	}
@@ -411,6 +439,39 @@ public:
 		return SERD_NODE_NULL;
 	}
 
+	void generateRDFTerms(const RowBatch &batch, const SerdEnv &env, TermBatch &out) const override {
+		if (valueMap) {
+			valueMap->generateRDFTerms(batch, env, out);
+		} else {
+			TermMap::generateRDFTerms(batch, env, out);
+		}
+	}
+
+	void generateRDFTerms(const RowBatch &batch, const ColumnOrdinals &columns, const SerdEnv &env,
+	                      TermBatch &out) const override {
+		if (valueMap) {
+			valueMap->generateRDFTerms(batch, columns, env, out);
+		} else {
+			TermMap::generateRDFTerms(batch, env, out);
+		}
+	}
+
+	std::vector<std::string> referencedColumns() const override {
+		return valueMap ? valueMap->referencedColumns() : std::vector<std::string>();
+	}
+
+	void internConstants(ConstantPool &pool) override {
+		TermMap::internConstants(pool);
+		if (valueMap) {
+			valueMap->internConstants(pool);
+		}
+		kind = Kind::PerRow;
+		namedGraph = SERD_NODE_NULL;
+		if (const ConstantTermMap *constant = dynamic_cast<const ConstantTermMap *>(valueMap.get())) {
+			classifyConstant(constant->constantValue);
+		}
+	}
+
 	std::ostream &print(std::ostream &os) const override {
 		os << "GraphMap {";
 		if (valueMap) {
@@ -847,6 +908,7 @@ static R2RMLMapping buildMappingFromTriples(TripleStore &triples, SerdEnv *env,
 		}
 	}
 
+	mapping.compile();
 	return mapping;
 }
 
@@ -7,16 +7,45 @@
 namespace r2rml {
 
 R2RMLView::R2RMLView(const std::string &query) : sqlQuery(query) {
+	effectiveSqlQuery = sqlQuery;
 }
 R2RMLView::~R2RMLView() = default;
 
 std::unique_ptr<SQLResultSet> R2RMLView::getRows(SQLConnection &dbConnection) {
-	effectiveSqlQuery = sqlQuery;
-	return dbConnection.execute(sqlQuery);
+	// As BaseTableOrView::getRows(), effectiveSqlQuery is left alone.
+	return dbConnection.execute(rowQuery());
+}
+
+std::string R2RMLView::rowQuery() const {
+	// Unprojected, the query runs as written.
+	return projection.empty() ? sqlQuery : selectQuery();
+}
+
+std::string R2RMLView::selectQuery() const {
+	return projectedQuery(false);
+}
+
+std::string R2RMLView::partitionSource() const {
+	std::string query = projectedQuery(true);
+	return query.empty() ? std::string() : "(" + query + ") AS \"partition\"";
+}
+
+std::string R2RMLView::projectedQuery(bool keys) const {
+	// rr:sqlQuery text commonly ends in ';', which is not allowed in a subquery.
+	std::size_t end = sqlQuery.find_last_not_of(" \t\r\n;");
+	if (end == std::string::npos) {
+		return std::string();
+	}
+	if (projection.empty()) {
+		return sqlQuery.substr(0, end + 1);
+	}
+	// The subquery closes on its own line so a trailing "--" comment can't
+	// swallow the parenthesis (as in ReferencingObjectMap::joinQuery()).
+	return "SELECT " + selectList(keys) + " FROM (\n" + sqlQuery.substr(0, end + 1) + "\n) AS \"view\"";
 }
 
 std::vector<std::string> R2RMLView::getColumnNames() {
-	return {};
+	return projection;
 }
 
 std::ostream &R2RMLView::print(std::ostream &os) const {
@@ -0,0 +1,125 @@
+#include "r2rml/RdfSink.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/SQLConnection.h"
+#include "r2rml/SQLResultSet.h"
+#include "r2rml/TriplesMap.h"
+
+#include <stdexcept>
+
+namespace r2rml {
+
+namespace {
+
+/// The SQLConnection handed to BoundTriplesMap.  An inside-out triples map
+/// has no rr:refObjectMap, so nothing ever queries it.
+class NoQueryConnection : public SQLConnection {
+public:
+	std::unique_ptr<SQLResultSet> execute(const std::string & /*sqlQuery*/) override {
+		throw std::logic_error("R2RML: an inside-out export cannot run SQL queries");
+	}
+};
+
+/// The local name of a triples map IRI: what follows its last '#' or '/'.
+std::string localName(const std::string &iri) {
+	std::size_t pos = iri.find_last_of("#/");
+	return pos == std::string::npos ? iri : iri.substr(pos + 1);
+}
+
+} // namespace
+
+RdfSink::RdfSink(const R2RMLMapping &mapping, const TriplesMap &triplesMap, StatementSink &out)
+    : triplesMap_(triplesMap), out_(out), bound_(triplesMap, mapping),
+      noQueries_(new NoQueryConnection()) {
+	if (!triplesMap.isValidInsideOut()) {
+		throw std::invalid_argument("R2RML: triples map <" + triplesMap.id +
+		                            "> cannot run inside-out (it has a logical table or an rr:refObjectMap)");
+	}
+}
+
+RdfSink::~RdfSink() = default;
+
+void RdfSink::begin(const std::vector<Column> &schema) {
+	if (open_) {
+		throw std::logic_error("R2RML: RdfSink::begin() called twice without finish()");
+	}
+	RowBatch layout;
+	schema_.clear();
+	for (const Column &column : schema) {
+		layout.addColumn(column.name, column.type).datatypeIRI = column.datatypeIRI;
+		schema_.push_back(column.name);
+	}
+	std::vector<std::string> columns;
+	triplesMap_.referencedColumns(columns);
+	for (const std::string &name : columns) {
+		if (layout.findColumn(name) == RowBatch::npos) {
+			throw std::invalid_argument("R2RML: triples map <" + triplesMap_.id + "> reads column \"" + name +
+			                            "\", which the input does not have");
+		}
+	}
+	bound_.bind(layout);
+	open_ = true;
+	rows_ = 0;
+}
+
+void RdfSink::consume(const RowBatch &batch) {
+	if (!open_) {
+		throw std::logic_error("R2RML: RdfSink::consume() outside begin()/finish()");
+	}
+	bool matches = batch.columnCount() == schema_.size();
+	for (std::size_t i = 0; matches && i < schema_.size(); ++i) {
+		matches = batch.column(i).name == schema_[i];
+	}
+	if (!matches) {
+		throw std::invalid_argument("R2RML: RdfSink::consume() got a batch whose columns differ from begin()'s");
+	}
+	bound_.generateTriples(batch, out_, *noQueries_);
+	rows_ += batch.size();
+}
+
+void RdfSink::finish() {
+	if (!open_) {
+		throw std::logic_error("R2RML: RdfSink::finish() without begin()");
+	}
+	open_ = false;
+	out_.flush();
+}
+
+const TriplesMap &RdfSink::findTriplesMap(const R2RMLMapping &mapping, const std::string &id) {
+	std::string name = id;
+	if (name.size() >= 2 && name.front() == '<' && name.back() == '>') {
+		name = name.substr(1, name.size() - 2);
+	}
+	if (!name.empty() && name.front() == '#') {
+		name.erase(0, 1);
+	}
+
+	const TriplesMap *found = nullptr;
+	std::size_t candidates = 0;
+	for (const auto &tm : mapping.triplesMaps) {
+		if (!tm) {
+			continue;
+		}
+		if (!name.empty() && tm->id == name) {
+			return *tm; // an exact IRI is never ambiguous
+		}
+		if (name.empty() || localName(tm->id) == name) {
+			found = tm.get();
+			++candidates;
+		}
+	}
+	if (candidates == 1) {
+		return *found;
+	}
+	if (candidates == 0 && name.empty()) {
+		throw std::invalid_argument("R2RML: the mapping has no triples maps");
+	}
+	if (candidates == 0) {
+		throw std::invalid_argument("R2RML: the mapping has no triples map <" + id + ">");
+	}
+	if (name.empty()) {
+		throw std::invalid_argument("R2RML: the mapping has several triples maps; name the one to export");
+	}
+	throw std::invalid_argument("R2RML: triples map name \"" + id + "\" is ambiguous");
+}
+
+} // namespace r2rml
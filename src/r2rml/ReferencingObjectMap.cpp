@@ -1,4 +1,5 @@
 #include "r2rml/ReferencingObjectMap.h"
+#include "r2rml/ConstantTermMap.h"
 #include "r2rml/JoinCondition.h"
 #include "r2rml/TriplesMap.h"
 #include "r2rml/SubjectMap.h"
@@ -36,8 +37,11 @@ private:
 	std::vector<std::unique_ptr<SQLRow>> rows_;
 	int cursor_ {-1};
 };
+
 } // anonymous namespace
 
+const char *const ReferencingObjectMap::parentColumnPrefix = "__PARENT_";
+
 ReferencingObjectMap::ReferencingObjectMap() = default;
 ReferencingObjectMap::~ReferencingObjectMap() = default;
 
@@ -67,9 +71,7 @@ std::unique_ptr<SQLResultSet> ReferencingObjectMap::getJoinedRows(SQLConnection
 		const SQLRow &parentRow = parentResult->getCurrentRow();
 		bool ok = true;
 		for (const JoinCondition &jc : joinConditions) {
-			auto childVal = childRow.getValue(jc.childColumn);
-			auto parentVal = parentRow.getValue(jc.parentColumn);
-			if (childVal->isNull() || parentVal->isNull() || childVal->asString() != parentVal->asString()) {
+			if (!childRow.getValueView(jc.childColumn).sameValue(parentRow.getValueView(jc.parentColumn))) {
 				ok = false;
 				break;
 			}
@@ -82,6 +84,53 @@ std::unique_ptr<SQLResultSet> ReferencingObjectMap::getJoinedRows(SQLConnection
 	return std::unique_ptr<SQLResultSet>(new VectorResultSet(std::move(matched)));
 }
 
+std::vector<std::string> ReferencingObjectMap::parentSubjectColumns() const {
+	if (!parentTriplesMap || !parentTriplesMap->subjectMap || !parentTriplesMap->subjectMap->valueTermMap()) {
+		return {};
+	}
+	return parentTriplesMap->subjectMap->valueTermMap()->referencedColumns();
+}
+
+std::string ReferencingObjectMap::joinQuery(const LogicalTable &childTable) const {
+	if (!parentTriplesMap || !parentTriplesMap->logicalTable || !parentTriplesMap->subjectMap) {
+		return std::string();
+	}
+	const TermMap *parentSubject = parentTriplesMap->subjectMap->valueTermMap();
+	if (!parentSubject) {
+		return std::string();
+	}
+	std::vector<std::string> parentColumns = parentSubjectColumns();
+	if (parentColumns.empty() && !dynamic_cast<const ConstantTermMap *>(parentSubject)) {
+		return std::string(); // a subject map that doesn't report its inputs
+	}
+	std::string childQuery = childTable.selectQuery();
+	std::string parentQuery = parentTriplesMap->logicalTable->selectQuery();
+	if (childQuery.empty() || parentQuery.empty()) {
+		return std::string();
+	}
+
+	// Subqueries close on their own line so a trailing "--" comment in an
+	// rr:sqlQuery can't swallow the parenthesis.
+	std::string sql = "SELECT child.*";
+	for (const std::string &col : parentColumns) {
+		sql += ", parent." + quoteIdentifier(col) + " AS " + quoteIdentifier(parentColumnPrefix + col);
+	}
+	sql += " FROM (\n" + childQuery + "\n) AS child";
+	if (joinConditions.empty()) {
+		sql += " CROSS JOIN (\n" + parentQuery + "\n) AS parent";
+	} else {
+		sql += " JOIN (\n" + parentQuery + "\n) AS parent ON ";
+		for (std::size_t i = 0; i < joinConditions.size(); ++i) {
+			if (i) {
+				sql += " AND ";
+			}
+			sql += "child." + quoteIdentifier(joinConditions[i].childColumn) + " = parent." +
+			       quoteIdentifier(joinConditions[i].parentColumn);
+		}
+	}
+	return sql;
+}
+
 SerdNode ReferencingObjectMap::generateRDFTerm(const SQLRow & /*childRow*/, const SQLRow &parentRow,
                                                const SerdEnv &env) const {
 	if (!parentTriplesMap || !parentTriplesMap->subjectMap) {
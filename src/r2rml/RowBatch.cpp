@@ -0,0 +1,159 @@
+#include "r2rml/RowBatch.h"
+#include "r2rml/MapSQLRow.h"
+#include "r2rml/StringSQLValue.h"
+
+namespace r2rml {
+
+const std::size_t RowBatch::kDefaultCapacity;
+const std::size_t RowBatch::npos;
+
+// ---------------------------------------------------------------------------
+// RowBatch::Column
+// ---------------------------------------------------------------------------
+void RowBatch::Column::append(const char *s, std::size_t n) {
+	chars_.append(s, n);
+	chars_.push_back('\0');
+	offsets_.push_back(chars_.size());
+	valid_.push_back(1);
+}
+
+void RowBatch::Column::appendNull() {
+	chars_.push_back('\0');
+	offsets_.push_back(chars_.size());
+	valid_.push_back(0);
+}
+
+void RowBatch::Column::clear() {
+	chars_.clear();
+	offsets_.resize(1);
+	valid_.clear();
+}
+
+// ---------------------------------------------------------------------------
+// RowBatch
+// ---------------------------------------------------------------------------
+std::size_t RowBatch::findColumn(const std::string &name) const {
+	auto it = index_.find(name);
+	return it == index_.end() ? npos : it->second;
+}
+
+RowBatch::Column &RowBatch::addColumn(const std::string &name, SQLValue::Type type) {
+	if (columnCount_ == columns_.size()) {
+		columns_.emplace_back(new Column());
+	}
+	Column &col = *columns_[columnCount_];
+	col.clear();
+	col.name = name;
+	col.type = type;
+	col.datatypeIRI.clear();
+	for (std::size_t i = 0; i < size_; ++i) {
+		col.appendNull();
+	}
+	index_[name] = columnCount_;
+	++columnCount_;
+	return col;
+}
+
+void RowBatch::reset() {
+	columnCount_ = 0;
+	size_ = 0;
+	index_.clear();
+}
+
+// ---------------------------------------------------------------------------
+// RowBatchRow
+// ---------------------------------------------------------------------------
+namespace {
+
+/// A non-null value copied out of a batch column; keeps the column's type
+/// and datatype so per-row consumers see what the batch consumer would.
+class BatchSQLValue : public SQLValue {
+public:
+	BatchSQLValue(Type type, std::string value, std::string datatype)
+	    : type_(type), string_(std::move(value)), datatype_(std::move(datatype)) {
+	}
+
+	Type type() const override {
+		return type_;
+	}
+	const std::string &asString() const override {
+		return string_;
+	}
+	bool isNull() const override {
+		return false;
+	}
+	std::unique_ptr<SQLValue> clone() const override {
+		return std::unique_ptr<SQLValue>(new BatchSQLValue(type_, string_, datatype_));
+	}
+	std::string datatypeIRI() const override {
+		return datatype_;
+	}
+
+private:
+	Type type_;
+	std::string string_;
+	std::string datatype_;
+};
+
+std::unique_ptr<SQLValue> cellValue(const RowBatch::Column &col, std::size_t row) {
+	if (col.isNull(row)) {
+		return std::unique_ptr<SQLValue>(new StringSQLValue());
+	}
+	// A column whose type the backend could not tell is reported as text.
+	SQLValue::Type type = col.type == SQLValue::Type::Null ? SQLValue::Type::String : col.type;
+	return std::unique_ptr<SQLValue>(new BatchSQLValue(type, col.str(row), col.datatypeIRI));
+}
+
+} // namespace
+
+std::unique_ptr<SQLValue> RowBatchRow::getValue(const std::string &columnName) const {
+	std::size_t col = batch_->findColumn(columnName);
+	if (col == RowBatch::npos) {
+		return std::unique_ptr<SQLValue>(new StringSQLValue());
+	}
+	return cellValue(batch_->column(col), row_);
+}
+
+SQLValueView RowBatchRow::getValueView(const std::string &columnName) const {
+	std::size_t c = batch_->findColumn(columnName);
+	if (c == RowBatch::npos || batch_->column(c).isNull(row_)) {
+		return SQLValueView();
+	}
+	const RowBatch::Column &col = batch_->column(c);
+	SQLValue::Type type = col.type == SQLValue::Type::Null ? SQLValue::Type::String : col.type;
+	return SQLValueView(type, col.data(row_), col.length(row_));
+}
+
+const std::string &RowBatchRow::getDatatypeIRI(const std::string &columnName) const {
+	static const std::string none;
+	std::size_t c = batch_->findColumn(columnName);
+	if (c == RowBatch::npos || batch_->column(c).isNull(row_)) {
+		return none;
+	}
+	return batch_->column(c).datatypeIRI;
+}
+
+bool RowBatchRow::isNull(const std::string &columnName) const {
+	std::size_t col = batch_->findColumn(columnName);
+	return col == RowBatch::npos || batch_->column(col).isNull(row_);
+}
+
+std::vector<std::string> RowBatchRow::columnNames() const {
+	std::vector<std::string> names;
+	names.reserve(batch_->columnCount());
+	for (std::size_t i = 0; i < batch_->columnCount(); ++i) {
+		names.push_back(batch_->column(i).name);
+	}
+	return names;
+}
+
+std::unique_ptr<SQLRow> RowBatchRow::clone() const {
+	std::map<std::string, std::unique_ptr<SQLValue>> cloned;
+	for (std::size_t i = 0; i < batch_->columnCount(); ++i) {
+		const RowBatch::Column &col = batch_->column(i);
+		cloned[col.name] = cellValue(col, row_);
+	}
+	return std::unique_ptr<SQLRow>(new MapSQLRow(std::move(cloned)));
+}
+
+} // namespace r2rml
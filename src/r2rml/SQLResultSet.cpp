@@ -0,0 +1,43 @@
+#include "r2rml/SQLResultSet.h"
+#include "r2rml/SQLRow.h"
+#include "r2rml/SQLValue.h"
+
+#include <string>
+#include <vector>
+
+namespace r2rml {
+
+bool SQLResultSet::nextBatch(RowBatch &batch, std::size_t maxRows) {
+	batch.reset();
+	std::vector<bool> typed;
+	std::size_t rows = 0;
+	while (rows < maxRows && next()) {
+		const SQLRow &row = getCurrentRow();
+		// Columns this row introduces are back-filled with nulls by addColumn.
+		for (const std::string &name : row.columnNames()) {
+			if (batch.findColumn(name) == RowBatch::npos) {
+				batch.addColumn(name);
+				typed.push_back(false);
+			}
+		}
+		for (std::size_t c = 0; c < batch.columnCount(); ++c) {
+			RowBatch::Column &col = batch.column(c);
+			SQLValueView val = row.getValueView(col.name);
+			if (val.isNull()) {
+				col.appendNull();
+				continue;
+			}
+			if (!typed[c]) {
+				// The datatype is fixed per column; fetch it once.
+				col.type = val.type();
+				col.datatypeIRI = row.getDatatypeIRI(col.name);
+				typed[c] = true;
+			}
+			col.append(val.data(), val.length());
+		}
+		batch.setSize(++rows);
+	}
+	return rows > 0;
+}
+
+} // namespace r2rml
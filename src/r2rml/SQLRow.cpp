@@ -1,2 +1,25 @@
-// SQLRow is a pure abstract interface; see MapSQLRow for the default
-// map-backed implementation.
+// SQLRow is an abstract interface; see MapSQLRow for the default map-backed
+// implementation.
+#include "r2rml/SQLRow.h"
+
+namespace r2rml {
+
+SQLValueView SQLRow::getValueView(const std::string &columnName) const {
+	borrowed_ = getValue(columnName);
+	if (!borrowed_ || borrowed_->isNull()) {
+		return SQLValueView();
+	}
+	return SQLValueView(borrowed_->type(), borrowed_->asString());
+}
+
+const std::string &SQLRow::getDatatypeIRI(const std::string &columnName) const {
+	std::unique_ptr<SQLValue> val = getValue(columnName);
+	if (!val || val->isNull()) {
+		borrowedDatatype_.clear();
+	} else {
+		borrowedDatatype_ = val->datatypeIRI();
+	}
+	return borrowedDatatype_;
+}
+
+} // namespace r2rml
@@ -0,0 +1,210 @@
+#include "r2rml/ShardedOutput.h"
+#include "r2rml/Json.h"
+#include "r2rml/NTriplesWriter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace r2rml {
+
+const char *const ShardedOutput::manifestName = "manifest.json";
+
+namespace {
+
+void makeDirectory(const std::string &directory) {
+#ifdef _WIN32
+	int rc = _mkdir(directory.c_str());
+#else
+	int rc = mkdir(directory.c_str(), 0777);
+#endif
+	if (rc != 0 && errno != EEXIST) {
+		throw std::runtime_error("R2RML: cannot create shard directory '" + directory + "': " + std::strerror(errno));
+	}
+}
+
+} // namespace
+
+ShardedOutput::ShardedOutput(const std::string &directory, SerdSyntax syntax, bool perTriplesMap,
+                             std::size_t maxStatements, std::size_t maxBytes)
+    : directory_(directory), syntax_(syntax), perTriplesMap_(perTriplesMap), maxStatements_(maxStatements),
+      maxBytes_(maxBytes) {
+	if (!NTriplesWriter::supports(syntax)) {
+		throw std::invalid_argument("R2RML: sharded output must be N-Triples or N-Quads");
+	}
+	makeDirectory(directory_);
+}
+
+std::vector<ShardedOutput::Shard> ShardedOutput::shards() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	std::vector<Shard> finished;
+	for (const Shard &shard : shards_) {
+		if (!shard.file.empty()) {
+			finished.push_back(shard);
+		}
+	}
+	return finished;
+}
+
+std::string ShardedOutput::writeManifest() const {
+	std::vector<Shard> finished = shards();
+	std::size_t statements = 0;
+	std::size_t bytes = 0;
+	std::string json = "{\n  \"syntax\": ";
+	appendJsonString(json, syntax_ == SERD_NQUADS ? "N-Quads" : "N-Triples");
+	json += ",\n  \"shards\": [";
+	for (std::size_t i = 0; i < finished.size(); ++i) {
+		const Shard &shard = finished[i];
+		json += i ? ",\n    {\"file\": " : "\n    {\"file\": ";
+		appendJsonString(json, shard.file);
+		json += ", \"statements\": " + std::to_string(shard.statements);
+		json += ", \"bytes\": " + std::to_string(shard.bytes);
+		json += ", \"triplesMaps\": [";
+		for (std::size_t m = 0; m < shard.triplesMaps.size(); ++m) {
+			if (m) {
+				json += ", ";
+			}
+			appendJsonString(json, shard.triplesMaps[m]);
+		}
+		json += "]}";
+		statements += shard.statements;
+		bytes += shard.bytes;
+	}
+	json += finished.empty() ? "],\n" : "\n  ],\n";
+	json += "  \"statements\": " + std::to_string(statements) + ",\n";
+	json += "  \"bytes\": " + std::to_string(bytes) + "\n}\n";
+
+	const std::string manifest = path(manifestName);
+	std::FILE *file = std::fopen(manifest.c_str(), "wb");
+	if (!file) {
+		throw std::runtime_error("R2RML: cannot create shard manifest '" + manifest + "': " + std::strerror(errno));
+	}
+	const bool written = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+	if (std::fclose(file) != 0 || !written) {
+		throw std::runtime_error("R2RML: cannot write shard manifest '" + manifest + "'");
+	}
+	return manifest;
+}
+
+std::string ShardedOutput::startShard(std::size_t &index) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	index = shards_.size();
+	shards_.emplace_back();
+	std::string number = std::to_string(index);
+	if (number.size() < 5) {
+		number.insert(0, 5 - number.size(), '0');
+	}
+	return "shard-" + number + (syntax_ == SERD_NQUADS ? ".nq" : ".nt");
+}
+
+void ShardedOutput::finishShard(std::size_t index, const Shard &shard) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	shards_[index] = shard;
+}
+
+std::string ShardedOutput::path(const std::string &file) const {
+	if (directory_.empty() || directory_.back() == '/') {
+		return directory_ + file;
+	}
+	return directory_ + '/' + file;
+}
+
+ShardWriter::ShardWriter(ShardedOutput &output, const SerdEnv *env, const ConstantPool *constants)
+    : output_(output), env_(env), constants_(constants) {
+}
+
+ShardWriter::~ShardWriter() {
+	try {
+		finish();
+	} catch (...) { // NOLINT(bugprone-empty-catch) - errors are reported by an explicit finish()
+	}
+}
+
+void ShardWriter::startTriplesMap(const std::string &id) {
+	if (output_.perTriplesMap_ && file_) {
+		finish();
+	}
+	triplesMap_ = id;
+	newTriplesMap_ = true;
+}
+
+void ShardWriter::write(const SerdNode *graph, const SerdNode &subject, const SerdNode &predicate,
+                        const SerdNode &object, const SerdNode *datatype, const SerdNode *lang) {
+	if (file_ && ((output_.maxStatements_ && shard_.statements >= output_.maxStatements_) ||
+	              (output_.maxBytes_ && written_ + writer_->buffered() >= output_.maxBytes_))) {
+		finish();
+	}
+	if (!file_) {
+		open();
+	}
+	writer_->write(graph, subject, predicate, object, datatype, lang);
+	++shard_.statements;
+	if (newTriplesMap_) {
+		if (std::find(shard_.triplesMaps.begin(), shard_.triplesMaps.end(), triplesMap_) ==
+		    shard_.triplesMaps.end()) {
+			shard_.triplesMaps.push_back(triplesMap_);
+		}
+		newTriplesMap_ = false;
+	}
+}
+
+void ShardWriter::flush() {
+	if (writer_) {
+		writer_->flush();
+	}
+}
+
+bool ShardWriter::writesGraphs() const {
+	return output_.syntax() == SERD_NQUADS;
+}
+
+void ShardWriter::finish() {
+	if (!file_) {
+		return;
+	}
+	bool complete = true;
+	try {
+		writer_->flush();
+	} catch (const std::runtime_error &) {
+		complete = false;
+	}
+	writer_.reset();
+	std::FILE *file = file_;
+	file_ = nullptr;
+	newTriplesMap_ = true; // the next shard lists it again
+	if (std::fclose(file) != 0 || !complete) {
+		throw std::runtime_error("R2RML: failed to write shard '" + output_.path(shard_.file) + "'");
+	}
+	shard_.bytes = written_;
+	output_.finishShard(index_, shard_);
+}
+
+void ShardWriter::open() {
+	shard_ = ShardedOutput::Shard();
+	std::string file = output_.startShard(index_);
+	const std::string path = output_.path(file);
+	file_ = std::fopen(path.c_str(), "wb");
+	if (!file_) {
+		throw std::runtime_error("R2RML: cannot create shard '" + path + "': " + std::strerror(errno));
+	}
+	shard_.file = file;
+	written_ = 0;
+	newTriplesMap_ = true;
+	writer_.reset(new NTriplesWriter(output_.syntax(), env_, constants_, sink, this));
+}
+
+std::size_t ShardWriter::sink(const void *buf, std::size_t len, void *stream) {
+	ShardWriter *self = static_cast<ShardWriter *>(stream);
+	std::size_t written = std::fwrite(buf, 1, len, self->file_);
+	self->written_ += written;
+	return written;
+}
+
+} // namespace r2rml
@@ -0,0 +1,20 @@
+#include "r2rml/StatementSink.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace r2rml {
+
+StatementSink::~StatementSink() = default;
+
+void SerdWriterSink::write(const SerdNode *graph, const SerdNode &subject, const SerdNode &predicate,
+                           const SerdNode &object, const SerdNode *datatype, const SerdNode *lang) {
+	SerdStatus status =
+	    serd_writer_write_statement(&rdfWriter_, 0, graph, &subject, &predicate, &object, datatype, lang);
+	if (status != SERD_SUCCESS) {
+		throw std::runtime_error(std::string("R2RML: failed to write RDF statement: ") +
+		                         reinterpret_cast<const char *>(serd_strerror(status)));
+	}
+}
+
+} // namespace r2rml
@@ -1,4 +1,5 @@
 #include "r2rml/SubjectMap.h"
+#include "r2rml/ConstantPool.h"
 #include "r2rml/GraphMap.h"
 
 #include <algorithm>
@@ -12,6 +13,19 @@ bool SubjectMap::isValid() const {
 	                   [](const std::unique_ptr<GraphMap> &gm) { return gm && gm->isValid(); });
 }
 
+void SubjectMap::internConstants(ConstantPool &pool) {
+	TermMap::internConstants(pool);
+	classNodes.clear();
+	for (const std::string &classIRI : classIRIs) {
+		classNodes.push_back(pool.intern(SERD_URI, classIRI));
+	}
+	for (const std::unique_ptr<GraphMap> &gm : graphMaps) {
+		if (gm) {
+			gm->internConstants(pool);
+		}
+	}
+}
+
 std::ostream &SubjectMap::print(std::ostream &os) const {
 	os << "SubjectMap {";
 	if (!classIRIs.empty()) {
@@ -1,51 +1,108 @@
 #include "r2rml/TemplateTermMap.h"
+#include "r2rml/ConstantPool.h"
+#include "r2rml/RowBatch.h"
 #include "r2rml/SQLRow.h"
 #include "r2rml/SQLValue.h"
+#include "r2rml/TermBatch.h"
 
+#include <algorithm>
 #include <ostream>
 #include <string>
+#include <vector>
 
 namespace r2rml {
 
 TemplateTermMap::TemplateTermMap(const std::string &templ) : templateString(templ) {
+	buildPlan();
 }
 
 TemplateTermMap::~TemplateTermMap() = default;
 
-SerdNode TemplateTermMap::generateRDFTerm(const SQLRow &row, const SerdEnv & /*env*/) const {
+SerdType TemplateTermMap::nodeType() const {
 	// A template term map is an IRI unless rr:termType says otherwise (R2RML
 	// 7.4); the rr:BlankNode case takes the expanded string as the blank node
 	// identifier. R2RML 7.3 only prescribes percent-encoding of substituted
 	// values for rr:IRI: applying it to rr:Literal would corrupt the lexical
 	// form, and to rr:BlankNode could emit a '%' that BLANK_NODE_LABEL forbids.
-	SerdType nodeType = SERD_URI;
 	if (termType == TermType::BlankNode) {
-		nodeType = SERD_BLANK;
-	} else if (termType == TermType::Literal) {
-		nodeType = SERD_LITERAL;
+		return SERD_BLANK;
 	}
-	const bool shouldPercentEncode = (nodeType == SERD_URI);
+	if (termType == TermType::Literal) {
+		return SERD_LITERAL;
+	}
+	return SERD_URI;
+}
 
-	// Expand {COLUMN} placeholders from the row.
-	expanded_.clear();
+void TemplateTermMap::internConstants(ConstantPool &pool) {
+	TermMap::internConstants(pool);
+	buildPlan();
+	if (nodeType() == SERD_URI && !plan_.segments.empty() && plan_.segments.front().slot == Plan::npos) {
+		pool.addIRIPrefix(plan_.segments.front().text);
+	}
+}
+
+namespace {
+
+// Bytes reserved per placeholder when sizing an expansion.
+const std::size_t kPlaceholderSizeHint = 16;
+
+} // namespace
+
+const std::size_t TemplateTermMap::Plan::npos;
+
+void TemplateTermMap::setTemplate(const std::string &templ) {
+	templateString = templ;
+	buildPlan();
+}
+
+void TemplateTermMap::buildPlan() {
+	plan_ = Plan();
 	std::size_t i = 0;
 	const std::size_t n = templateString.size();
 	while (i < n) {
 		if (templateString[i] == '{') {
 			std::size_t end = templateString.find('}', i + 1);
 			if (end == std::string::npos) {
-				break; // malformed template – treat rest as literal
+				break; // malformed template – the rest is dropped
 			}
-			std::string colName = templateString.substr(i + 1, end - i - 1);
-			auto val = row.getValue(colName);
-			if (val->isNull()) {
-				return SERD_NODE_NULL; // required column is missing/null
+			std::string name = templateString.substr(i + 1, end - i - 1);
+			std::size_t slot = std::find(plan_.columns.begin(), plan_.columns.end(), name) - plan_.columns.begin();
+			if (slot == plan_.columns.size()) {
+				plan_.columns.push_back(std::move(name));
 			}
-			expanded_ += shouldPercentEncode ? percentEncode(val->asString()) : val->asString();
+			plan_.segments.push_back({std::string(), slot});
+			plan_.sizeHint += kPlaceholderSizeHint;
 			i = end + 1;
 		} else {
-			expanded_ += templateString[i];
-			++i;
+			std::size_t next = std::min(templateString.find('{', i), n);
+			plan_.segments.push_back({templateString.substr(i, next - i), Plan::npos});
+			plan_.sizeHint += next - i;
+			i = next;
+		}
+	}
+}
+
+SerdNode TemplateTermMap::generateRDFTerm(const SQLRow &row, const SerdEnv & /*env*/) const {
+	const SerdType nodeType = this->nodeType();
+	const bool shouldPercentEncode = (nodeType == SERD_URI);
+	const Plan &plan = plan_;
+
+	// Expand {COLUMN} placeholders from the row.
+	expanded_.clear();
+	expanded_.reserve(plan.sizeHint);
+	for (const Plan::Segment &seg : plan.segments) {
+		if (seg.slot == Plan::npos) {
+			expanded_ += seg.text;
+			continue;
+		}
+		SQLValueView val = row.getValueView(plan.columns[seg.slot]);
+		if (val.isNull()) {
+			return SERD_NODE_NULL; // required column is missing/null
+		}
+		if (shouldPercentEncode) {
+			appendPercentEncoded(expanded_, val.data(), val.length());
+		} else {
+			expanded_.append(val.data(), val.length());
 		}
 	}
 
@@ -53,6 +110,61 @@ SerdNode TemplateTermMap::generateRDFTerm(const SQLRow &row, const SerdEnv & /*e
 	return serd_node_from_string(nodeType, reinterpret_cast<const uint8_t *>(expanded_.c_str()));
 }
 
+void TemplateTermMap::generateRDFTerms(const RowBatch &batch, const SerdEnv &env, TermBatch &out) const {
+	generateRDFTerms(batch, bindColumns(batch), env, out);
+}
+
+void TemplateTermMap::generateRDFTerms(const RowBatch &batch, const ColumnOrdinals &columns, const SerdEnv & /*env*/,
+                                       TermBatch &out) const {
+	out.clear();
+	const SerdType nodeType = this->nodeType();
+	const bool shouldPercentEncode = (nodeType == SERD_URI);
+	const Plan &plan = plan_;
+
+	// A placeholder whose column the batch lacks makes every row null.
+	if (std::find(columns.begin(), columns.end(), RowBatch::npos) != columns.end()) {
+		for (std::size_t row = 0; row < batch.size(); ++row) {
+			out.appendNull();
+		}
+		return;
+	}
+
+	// A local buffer rather than expanded_, so batches can be expanded from
+	// several threads at once (a parent subject map is shared by every
+	// TriplesMap joining it).
+	std::string expanded;
+	expanded.reserve(plan.sizeHint);
+	for (std::size_t row = 0; row < batch.size(); ++row) {
+		expanded.clear();
+		bool null = false;
+		for (const Plan::Segment &seg : plan.segments) {
+			if (seg.slot == Plan::npos) {
+				expanded += seg.text;
+				continue;
+			}
+			const RowBatch::Column &values = batch.column(columns[seg.slot]);
+			if (values.isNull(row)) {
+				null = true;
+				break;
+			}
+			if (shouldPercentEncode) {
+				appendPercentEncoded(expanded, values.data(row), values.length(row));
+			} else {
+				expanded.append(values.data(row), values.length(row));
+			}
+		}
+		if (null) {
+			out.appendNull();
+		} else {
+			out.append(nodeType, expanded);
+		}
+	}
+}
+
+std::vector<std::string> TemplateTermMap::referencedColumns() const {
+	return plan_.columns;
+}
+
 std::ostream &TemplateTermMap::print(std::ostream &os) const {
 	os << "TemplateTermMap { template=\"" << templateString << "\" ";
 	TermMap::print(os);
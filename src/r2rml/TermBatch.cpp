@@ -0,0 +1,51 @@
+#include "r2rml/TermBatch.h"
+
+namespace r2rml {
+
+void TermBatch::clear() {
+	chars_.clear();
+	offsets_.clear();
+	types_.clear();
+	constant_ = false;
+	constantNode_ = SERD_NODE_NULL;
+	constantRows_ = 0;
+}
+
+void TermBatch::append(SerdType type, const char *s, std::size_t n) {
+	offsets_.push_back(chars_.size());
+	types_.push_back(type);
+	chars_.append(s, n);
+	chars_.push_back('\0');
+}
+
+void TermBatch::append(const SerdNode &node) {
+	if (node.type == SERD_NOTHING) {
+		appendNull();
+		return;
+	}
+	append(node.type, reinterpret_cast<const char *>(node.buf), node.n_bytes);
+}
+
+void TermBatch::appendNull() {
+	offsets_.push_back(chars_.size());
+	types_.push_back(SERD_NOTHING);
+}
+
+void TermBatch::setConstant(const SerdNode &node, std::size_t rows) {
+	clear();
+	constant_ = true;
+	constantNode_ = node;
+	constantRows_ = rows;
+}
+
+SerdNode TermBatch::node(std::size_t row) const {
+	if (constant_) {
+		return constantNode_;
+	}
+	if (types_[row] == SERD_NOTHING) {
+		return SERD_NODE_NULL;
+	}
+	return serd_node_from_string(types_[row], reinterpret_cast<const uint8_t *>(chars_.data() + offsets_[row]));
+}
+
+} // namespace r2rml
@@ -1,5 +1,8 @@
 #include "r2rml/TermMap.h"
+#include "r2rml/ConstantPool.h"
+#include "r2rml/RowBatch.h"
 #include "r2rml/SQLRow.h"
+#include "r2rml/TermBatch.h"
 
 #include <ostream>
 
@@ -14,6 +17,57 @@ std::string TermMap::computeDatatypeIRI(const SQLRow & /*row*/) const {
 	return std::string();
 }
 
+const std::string &TermMap::datatypeIRIView(const SQLRow & /*row*/) const {
+	static const std::string none;
+	return datatypeIRI ? *datatypeIRI : none;
+}
+
+void TermMap::generateRDFTerms(const RowBatch &batch, const SerdEnv &env, TermBatch &out) const {
+	out.clear();
+	RowBatchRow row(batch, 0);
+	for (std::size_t i = 0; i < batch.size(); ++i) {
+		row.setRow(i);
+		out.append(generateRDFTerm(row, env));
+	}
+}
+
+void TermMap::generateRDFTerms(const RowBatch &batch, const ColumnOrdinals & /*columns*/, const SerdEnv &env,
+                               TermBatch &out) const {
+	generateRDFTerms(batch, env, out);
+}
+
+std::string TermMap::computeDatatypeIRI(const RowBatch & /*batch*/) const {
+	if (datatypeIRI) {
+		return *datatypeIRI;
+	}
+	return std::string();
+}
+
+std::string TermMap::computeDatatypeIRI(const RowBatch &batch, const ColumnOrdinals & /*columns*/) const {
+	return computeDatatypeIRI(batch);
+}
+
+std::vector<std::string> TermMap::referencedColumns() const {
+	return {};
+}
+
+ColumnOrdinals TermMap::bindColumns(const RowBatch &batch) const {
+	ColumnOrdinals columns;
+	for (const std::string &name : referencedColumns()) {
+		columns.push_back(batch.findColumn(name));
+	}
+	return columns;
+}
+
+void TermMap::internConstants(ConstantPool &pool) {
+	if (datatypeIRI) {
+		datatypeNode = pool.intern(SERD_URI, *datatypeIRI);
+	}
+	if (languageTag) {
+		languageNode = pool.intern(SERD_LITERAL, *languageTag);
+	}
+}
+
 static const char *termTypeName(TermType t) {
 	switch (t) {
 	case TermType::IRI:
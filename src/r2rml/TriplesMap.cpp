@@ -1,24 +1,69 @@
 #include "r2rml/TriplesMap.h"
+#include "r2rml/BoundTriplesMap.h"
+#include "r2rml/ConstantTermMap.h"
+#include "r2rml/JoinCondition.h"
 #include "r2rml/LogicalTable.h"
 #include "r2rml/SubjectMap.h"
 #include "r2rml/GraphMap.h"
 #include "r2rml/PredicateObjectMap.h"
 #include "r2rml/R2RMLMapping.h"
+#include "r2rml/ReferencingObjectMap.h"
+#include "r2rml/RowBatch.h"
 #include "r2rml/SQLConnection.h"
+#include "r2rml/SQLResultSet.h"
 #include "r2rml/SQLRow.h"
+#include "r2rml/TermBatch.h"
 
 #include <algorithm>
 #include <ostream>
 
 namespace r2rml {
 
-static const uint8_t RDF_TYPE_URI[] = "http://www.w3.org/1999/02/22-rdf-syntax-ns#type";
+namespace {
+
+/** Whether `termMap`, whose referencedColumns() is empty, reads no column at all. */
+bool readsNoColumns(const TermMap &termMap) {
+	if (dynamic_cast<const ConstantTermMap *>(&termMap)) {
+		return true;
+	}
+	if (const SubjectMap *subjectMap = dynamic_cast<const SubjectMap *>(&termMap)) {
+		return subjectMap->valueTermMap() && readsNoColumns(*subjectMap->valueTermMap());
+	}
+	// R2RMLParser's graph maps report the columns of their value strategy.
+	return dynamic_cast<const GraphMap *>(&termMap) != nullptr;
+}
+
+void addColumn(const std::string &column, std::vector<std::string> &columns) {
+	if (std::find(columns.begin(), columns.end(), column) == columns.end()) {
+		columns.push_back(column);
+	}
+}
+
+/** Add the columns `termMap` (may be null) reads; false if it doesn't say. */
+bool addColumns(const TermMap *termMap, std::vector<std::string> &columns) {
+	if (!termMap) {
+		return true;
+	}
+	std::vector<std::string> referenced = termMap->referencedColumns();
+	for (const std::string &column : referenced) {
+		addColumn(column, columns);
+	}
+	return !referenced.empty() || readsNoColumns(*termMap);
+}
+
+} // namespace
 
 TriplesMap::TriplesMap() = default;
 TriplesMap::~TriplesMap() = default;
 
 void TriplesMap::generateTriples(const SQLRow &row, SerdWriter &rdfWriter, const R2RMLMapping &mapping,
-                                 SQLConnection &dbConnection) const {
+                                 SQLConnection &dbConnection, JoinIndexCache *joinIndexes) const {
+	SerdWriterSink rdfSink(rdfWriter);
+	generateTriples(row, rdfSink, mapping, dbConnection, joinIndexes);
+}
+
+void TriplesMap::generateTriples(const SQLRow &row, StatementSink &rdfSink, const R2RMLMapping &mapping,
+                                 SQLConnection &dbConnection, JoinIndexCache *joinIndexes) const {
 	if (!subjectMap) {
 		return;
 	}
@@ -41,24 +86,133 @@ void TriplesMap::generateTriples(const SQLRow &row, SerdWriter &rdfWriter, const
 		return; // null subject – skip row
 	}
 
+	// The subject map's graphs apply to every triple of the row; resolve them once.
+	RowGraphs subjectGraphs;
+	subjectGraphs.resolve(subjectMap->graphMaps, row, *env);
+
 	// Emit rdf:type triples for each rr:class. Only the subject map's own
 	// graph maps apply here – there is no predicate-object map involved.
-	static const std::vector<std::unique_ptr<GraphMap>> noGraphMaps;
-	if (!subjectMap->classIRIs.empty()) {
-		SerdNode rdfType = serd_node_from_string(SERD_URI, RDF_TYPE_URI);
-		for (const std::string &classIRI : subjectMap->classIRIs) {
-			SerdNode classNode = serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>(classIRI.c_str()));
-			forEachGraphNode(subjectMap->graphMaps, noGraphMaps, row, *env, [&](const SerdNode *graph) {
-				checkWriteStatus(serd_writer_write_statement(&rdfWriter, 0, graph, &subject, &rdfType, &classNode,
-				                                             nullptr, nullptr));
-			});
-		}
+	static const RowGraphs noGraphs;
+	const SerdNode &rdfType = mapping.constants.rdfType();
+	const bool compiled = subjectMap->classNodes.size() == subjectMap->classIRIs.size();
+	for (std::size_t c = 0; c < subjectMap->classIRIs.size(); ++c) {
+		SerdNode classNode =
+		    compiled ? subjectMap->classNodes[c]
+		             : serd_node_from_string(SERD_URI,
+		                                     reinterpret_cast<const uint8_t *>(subjectMap->classIRIs[c].c_str()));
+		forEachGraphNode(subjectGraphs, noGraphs, [&](const SerdNode *graph) {
+			rdfSink.write(graph, subject, rdfType, classNode, nullptr, nullptr);
+		});
 	}
 
 	// Process each predicate-object map.
 	for (const auto &pom : predicateObjectMaps) {
 		if (pom) {
-			pom->processRow(row, subject, rdfWriter, mapping, dbConnection, subjectMap->graphMaps);
+			pom->processRow(row, subject, rdfSink, mapping, dbConnection, subjectGraphs, joinIndexes);
+		}
+	}
+}
+
+void TriplesMap::generateTriples(const RowBatch &batch, StatementSink &rdfSink, const R2RMLMapping &mapping,
+                                 SQLConnection &dbConnection, JoinIndexCache *joinIndexes) const {
+	BoundTriplesMap(*this, mapping).generateTriples(batch, rdfSink, dbConnection, joinIndexes);
+}
+
+void TriplesMap::generateTriples(const RowBatch &batch, SerdWriter &rdfWriter, const R2RMLMapping &mapping,
+                                 SQLConnection &dbConnection, JoinIndexCache *joinIndexes) const {
+	SerdWriterSink rdfSink(rdfWriter);
+	generateTriples(batch, rdfSink, mapping, dbConnection, joinIndexes);
+}
+
+void TriplesMap::generateJoinedTriples(const PredicateObjectMap &pom, const ReferencingObjectMap &rom,
+                                       StatementSink &rdfSink, const R2RMLMapping &mapping,
+                                       SQLConnection &dbConnection) const {
+	if (!subjectMap || !logicalTable) {
+		return;
+	}
+	std::string query = rom.joinQuery(*logicalTable);
+	if (query.empty()) {
+		return;
+	}
+	auto rows = dbConnection.execute(query);
+	if (!rows) {
+		return;
+	}
+
+	const SerdEnv *env = mapping.serdEnvironment;
+	static SerdEnv *fallbackEnv = nullptr;
+	if (!env) {
+		if (!fallbackEnv) {
+			fallbackEnv = serd_env_new(nullptr);
+		}
+		env = fallbackEnv;
+	}
+
+	const std::vector<std::string> parentColumns = rom.parentSubjectColumns();
+	RowBatch batch;
+	RowBatch parentBatch;
+	TermBatch subjects;
+	TermBatch objects;
+	std::vector<TermBatch> predicates(pom.predicateMaps.size());
+	std::vector<TermBatch> subjectGraphs;
+	std::vector<TermBatch> pomGraphs;
+	while (rows->nextBatch(batch)) {
+		// Child-side terms read the child's own columns directly...
+		subjectMap->generateRDFTerms(batch, *env, subjects);
+		generateGraphTerms(subjectMap->graphMaps, batch, *env, subjectGraphs);
+		generateGraphTerms(pom.graphMaps, batch, *env, pomGraphs);
+		for (std::size_t p = 0; p < pom.predicateMaps.size(); ++p) {
+			predicates[p].clear();
+			if (pom.predicateMaps[p]) {
+				pom.predicateMaps[p]->generateRDFTerms(batch, *env, predicates[p]);
+			}
+		}
+
+		// ...while the parent subject map needs its aliased columns back under
+		// their own names.
+		parentBatch.reset();
+		for (const std::string &name : parentColumns) {
+			std::size_t in = batch.findColumn(ReferencingObjectMap::parentColumnPrefix + name);
+			if (in == RowBatch::npos) {
+				RowBatch::Column &out = parentBatch.addColumn(name);
+				for (std::size_t row = 0; row < batch.size(); ++row) {
+					out.appendNull();
+				}
+				continue;
+			}
+			const RowBatch::Column &src = batch.column(in);
+			RowBatch::Column &out = parentBatch.addColumn(name, src.type);
+			out.datatypeIRI = src.datatypeIRI;
+			for (std::size_t row = 0; row < batch.size(); ++row) {
+				if (src.isNull(row)) {
+					out.appendNull();
+				} else {
+					out.append(src.data(row), src.length(row));
+				}
+			}
+		}
+		parentBatch.setSize(batch.size());
+		rom.parentTriplesMap->subjectMap->generateRDFTerms(parentBatch, *env, objects);
+
+		RowGraphs rowSubjectGraphs;
+		RowGraphs rowPomGraphs;
+		for (std::size_t row = 0; row < batch.size(); ++row) {
+			if (subjects.isNull(row) || objects.isNull(row)) {
+				continue;
+			}
+			SerdNode subject = subjects.node(row);
+			SerdNode object = objects.node(row);
+			rowSubjectGraphs.resolve(subjectMap->graphMaps, subjectGraphs, row);
+			rowPomGraphs.resolve(pom.graphMaps, pomGraphs, row);
+			for (std::size_t p = 0; p < predicates.size(); ++p) {
+				if (!pom.predicateMaps[p] || predicates[p].isNull(row)) {
+					continue;
+				}
+				SerdNode predicate = predicates[p].node(row);
+				forEachGraphNode(rowSubjectGraphs, rowPomGraphs, [&](const SerdNode *graph) {
+					rdfSink.write(graph, subject, predicate, object, nullptr, nullptr);
+				});
+			}
 		}
 	}
 }
@@ -74,6 +228,38 @@ bool TriplesMap::isValid() const {
 	                   [](const std::unique_ptr<PredicateObjectMap> &pom) { return pom && pom->isValid(); });
 }
 
+bool TriplesMap::referencedColumns(std::vector<std::string> &columns) const {
+	bool known = true;
+	if (subjectMap) {
+		known &= addColumns(subjectMap.get(), columns);
+		for (const auto &gm : subjectMap->graphMaps) {
+			known &= addColumns(gm.get(), columns);
+		}
+	}
+	for (const auto &pom : predicateObjectMaps) {
+		if (!pom) {
+			continue;
+		}
+		for (const auto &pm : pom->predicateMaps) {
+			known &= addColumns(pm.get(), columns);
+		}
+		for (const auto &om : pom->objectMaps) {
+			const ReferencingObjectMap *rom = dynamic_cast<const ReferencingObjectMap *>(om.get());
+			if (!rom) {
+				known &= addColumns(om.get(), columns);
+				continue;
+			}
+			for (const JoinCondition &jc : rom->joinConditions) {
+				addColumn(jc.childColumn, columns);
+			}
+		}
+		for (const auto &gm : pom->graphMaps) {
+			known &= addColumns(gm.get(), columns);
+		}
+	}
+	return known;
+}
+
 bool TriplesMap::isValidInsideOut() const {
 	// rr:LogicalTable (including rr:sqlQuery) is not supported inside-out.
 	if (logicalTable) {
@@ -0,0 +1,151 @@
+#include "r2rml/WatermarkState.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace r2rml {
+
+namespace {
+
+void appendEscaped(std::string &out, const std::string &value) {
+	for (char c : value) {
+		switch (c) {
+		case '\\':
+			out += "\\\\";
+			break;
+		case '\t':
+			out += "\\t";
+			break;
+		case '\n':
+			out += "\\n";
+			break;
+		default:
+			out += c;
+		}
+	}
+}
+
+bool unescape(const std::string &line, std::size_t begin, std::size_t end, std::string &value) {
+	value.clear();
+	for (std::size_t i = begin; i < end; ++i) {
+		if (line[i] != '\\') {
+			value += line[i];
+			continue;
+		}
+		if (++i == end) {
+			return false;
+		}
+		switch (line[i]) {
+		case '\\':
+			value += '\\';
+			break;
+		case 't':
+			value += '\t';
+			break;
+		case 'n':
+			value += '\n';
+			break;
+		default:
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+void WatermarkState::load(const std::string &path) {
+	std::map<std::string, std::string> marks;
+	std::FILE *file = std::fopen(path.c_str(), "rb");
+	if (!file) {
+		if (errno != ENOENT) {
+			throw std::runtime_error("R2RML: cannot read watermark state '" + path + "': " + std::strerror(errno));
+		}
+	} else {
+		std::string data;
+		char buf[4096];
+		std::size_t got;
+		while ((got = std::fread(buf, 1, sizeof(buf), file)) > 0) {
+			data.append(buf, got);
+		}
+		const bool failed = std::ferror(file) != 0;
+		std::fclose(file);
+		if (failed) {
+			throw std::runtime_error("R2RML: cannot read watermark state '" + path + "'");
+		}
+
+		std::size_t number = 0;
+		for (std::size_t start = 0; start < data.size();) {
+			std::size_t end = data.find('\n', start);
+			end = end == std::string::npos ? data.size() : end;
+			++number;
+			std::size_t tab = data.find('\t', start);
+			std::string id;
+			std::string value;
+			if (tab >= end || !unescape(data, start, tab, id) || !unescape(data, tab + 1, end, value) || id.empty() ||
+			    value.empty()) {
+				throw std::runtime_error("R2RML: malformed watermark state '" + path + "' at line " +
+				                         std::to_string(number));
+			}
+			marks[id] = value;
+			start = end + 1;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	marks_.swap(marks);
+}
+
+void WatermarkState::save(const std::string &path) const {
+	std::string data;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (const auto &mark : marks_) {
+			appendEscaped(data, mark.first);
+			data += '\t';
+			appendEscaped(data, mark.second);
+			data += '\n';
+		}
+	}
+
+	const std::string temporary = path + ".tmp";
+	std::FILE *file = std::fopen(temporary.c_str(), "wb");
+	if (!file) {
+		throw std::runtime_error("R2RML: cannot write watermark state '" + temporary + "': " + std::strerror(errno));
+	}
+	const bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+	if (std::fclose(file) != 0 || !written) {
+		std::remove(temporary.c_str());
+		throw std::runtime_error("R2RML: cannot write watermark state '" + temporary + "'");
+	}
+#ifdef _WIN32
+	std::remove(path.c_str()); // rename() doesn't replace files on Windows
+#endif
+	if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+		throw std::runtime_error("R2RML: cannot replace watermark state '" + path + "': " + std::strerror(errno));
+	}
+}
+
+bool WatermarkState::get(const std::string &triplesMap, std::string &value) const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = marks_.find(triplesMap);
+	if (it == marks_.end()) {
+		return false;
+	}
+	value = it->second;
+	return true;
+}
+
+void WatermarkState::set(const std::string &triplesMap, const std::string &value) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	marks_[triplesMap] = value;
+}
+
+std::size_t WatermarkState::size() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return marks_.size();
+}
+
+} // namespace r2rml
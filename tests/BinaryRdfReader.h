@@ -0,0 +1,232 @@
+#pragma once
+
+/**
+ * Decoder for the stream BinaryRdfWriter writes, for round-trip tests.  It
+ * resolves the prefix and name tables and repeats back into whole terms and
+ * throws std::runtime_error on anything malformed, so a test can compare the
+ * statements with what went in.
+ */
+
+#include <serd/serd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "r2rml/BinaryRdfWriter.h"
+#include "r2rml/StatementSink.h"
+
+namespace r2rml {
+namespace testing {
+
+// ---------------------------------------------------------------------------
+// BinaryRdfTerm / BinaryRdfStatement
+//
+// A decoded term: SERD_URI, SERD_BLANK or SERD_LITERAL, with the datatype IRI
+// or language tag of a literal that has one.
+// ---------------------------------------------------------------------------
+struct BinaryRdfTerm {
+	SerdType type {SERD_NOTHING};
+	std::string value;
+	std::string datatype;
+	std::string lang;
+};
+
+struct BinaryRdfStatement {
+	BinaryRdfTerm subject;
+	BinaryRdfTerm predicate;
+	BinaryRdfTerm object;
+	bool hasGraph {false};
+	BinaryRdfTerm graph;
+};
+
+// ---------------------------------------------------------------------------
+// BinaryRdfReader
+//
+// Decodes a whole stream up front; the tables it ends up with are kept for
+// tests that check what was put in them.
+// ---------------------------------------------------------------------------
+class BinaryRdfReader {
+public:
+	explicit BinaryRdfReader(const std::string &data) : data_(data) {
+		if (data_.compare(0, 4, "SRDF") != 0 || data_.size() < 5) {
+			fail("bad magic");
+		}
+		if (static_cast<unsigned char>(data_[4]) != BinaryRdfWriter::version) {
+			fail("unknown version");
+		}
+		at_ = 5;
+		while (at_ < data_.size()) {
+			readRecord();
+		}
+	}
+
+	const std::vector<BinaryRdfStatement> &statements() const {
+		return statements_;
+	}
+
+	/// Prefix table entries, by id - 1.
+	const std::vector<std::string> &prefixes() const {
+		return prefixes_;
+	}
+
+	/// Name table entries, by id - 1.
+	const std::vector<std::string> &names() const {
+		return names_;
+	}
+
+	/// Write every statement to `sink`, for comparison with a text export.
+	void replay(StatementSink &sink) const {
+		for (const BinaryRdfStatement &st : statements_) {
+			SerdNode s = node(st.subject.type, st.subject.value);
+			SerdNode p = node(st.predicate.type, st.predicate.value);
+			SerdNode o = node(st.object.type, st.object.value);
+			SerdNode g = st.hasGraph ? node(st.graph.type, st.graph.value) : SERD_NODE_NULL;
+			SerdNode dt = node(SERD_URI, st.object.datatype);
+			SerdNode lang = node(SERD_LITERAL, st.object.lang);
+			sink.write(st.hasGraph ? &g : nullptr, s, p, o, st.object.datatype.empty() ? nullptr : &dt,
+			           st.object.lang.empty() ? nullptr : &lang);
+		}
+	}
+
+private:
+	enum Position { Subject, Predicate, Object, Graph, Positions };
+
+	static SerdNode node(SerdType type, const std::string &value) {
+		return serd_node_from_substring(type, reinterpret_cast<const uint8_t *>(value.data()), value.size());
+	}
+
+	[[noreturn]] static void fail(const std::string &what) {
+		throw std::runtime_error("binary RDF: " + what);
+	}
+
+	unsigned char byte() {
+		if (at_ >= data_.size()) {
+			fail("truncated stream");
+		}
+		return static_cast<unsigned char>(data_[at_++]);
+	}
+
+	std::uint64_t varint() {
+		std::uint64_t value = 0;
+		for (unsigned shift = 0;; shift += 7) {
+			if (shift > 63) {
+				fail("varint too long");
+			}
+			unsigned char b = byte();
+			value |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+			if (!(b & 0x80)) {
+				return value;
+			}
+		}
+	}
+
+	std::string string() {
+		std::uint64_t size = varint();
+		if (size > data_.size() - at_) {
+			fail("truncated string");
+		}
+		std::string s = data_.substr(at_, static_cast<std::size_t>(size));
+		at_ += static_cast<std::size_t>(size);
+		return s;
+	}
+
+	// Table ids are handed out densely from 1, in order.
+	void define(std::vector<std::string> &table, const char *what) {
+		std::uint64_t id = varint();
+		if (id != table.size() + 1) {
+			fail(std::string("out of order ") + what + " id");
+		}
+		table.push_back(string());
+	}
+
+	const std::string &lookup(const std::vector<std::string> &table, std::uint64_t id, const char *what) const {
+		if (id == 0 || id > table.size()) {
+			fail(std::string("undefined ") + what + " id");
+		}
+		return table[static_cast<std::size_t>(id - 1)];
+	}
+
+	void readRecord() {
+		switch (byte()) {
+		case 0x01:
+			define(prefixes_, "prefix");
+			break;
+		case 0x02:
+			define(names_, "name");
+			break;
+		case 0x03:
+		case 0x04: {
+			const bool quad = static_cast<unsigned char>(data_[at_ - 1]) == 0x04;
+			BinaryRdfStatement st;
+			st.subject = readTerm(Subject);
+			st.predicate = readTerm(Predicate);
+			st.object = readTerm(Object);
+			if (quad) {
+				st.hasGraph = true;
+				st.graph = readTerm(Graph);
+			}
+			statements_.push_back(st);
+			break;
+		}
+		default:
+			fail("unknown record");
+		}
+	}
+
+	BinaryRdfTerm readTerm(Position position) {
+		BinaryRdfTerm term;
+		switch (byte()) {
+		case 0x00:
+			if (previous_[position].type == SERD_NOTHING) {
+				fail("repeat with nothing to repeat");
+			}
+			return previous_[position];
+		case 0x01:
+			term.type = SERD_URI;
+			term.value = lookup(names_, varint(), "name");
+			break;
+		case 0x02: {
+			term.type = SERD_URI;
+			std::uint64_t prefix = varint();
+			term.value = prefix ? lookup(prefixes_, prefix, "prefix") : std::string();
+			term.value += string();
+			break;
+		}
+		case 0x03:
+			term.type = SERD_BLANK;
+			term.value = string();
+			break;
+		case 0x04:
+			term.type = SERD_LITERAL;
+			term.value = string();
+			break;
+		case 0x05:
+			term.type = SERD_LITERAL;
+			term.value = string();
+			term.datatype = lookup(names_, varint(), "name");
+			break;
+		case 0x06:
+			term.type = SERD_LITERAL;
+			term.value = string();
+			term.lang = lookup(names_, varint(), "name");
+			break;
+		default:
+			fail("unknown term");
+		}
+		previous_[position] = term;
+		return term;
+	}
+
+	std::string data_;
+	std::size_t at_ {0};
+	std::vector<std::string> prefixes_;
+	std::vector<std::string> names_;
+	std::vector<BinaryRdfStatement> statements_;
+	BinaryRdfTerm previous_[Positions];
+};
+
+} // namespace testing
+} // namespace r2rml
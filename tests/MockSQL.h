@@ -3,16 +3,25 @@
 /**
  * Concrete mock implementations of the abstract SQL interfaces for use in
  * unit tests.  Include this header from any test file that needs a database
- * connection without a real backend.
+ * connection without a real backend, or that parses and exports a mapping.
  */
 
+#include "r2rml/ExportOptions.h"
+#include "r2rml/ExportReport.h"
 #include "r2rml/MapSQLRow.h"
+#include "r2rml/NTriplesWriter.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/R2RMLParser.h"
 #include "r2rml/SQLConnection.h"
 #include "r2rml/SQLResultSet.h"
 #include "r2rml/SQLRow.h"
 #include "r2rml/SQLValue.h"
 #include "r2rml/StringSQLValue.h"
 
+#include <catch2/catch_test_macros.hpp>
+#include <serd/serd.h>
+
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -93,5 +102,102 @@ inline MapSQLRow makeRow(std::initializer_list<std::pair<const std::string, Stri
 	return MapSQLRow(std::move(m));
 }
 
+// ---------------------------------------------------------------------------
+// EMP / DEPT fixtures
+//
+// The W3C R2RML specification's example tables (spec.pdf, section 2), with a
+// second employee and department so exports and joins see more than one row:
+//
+//   EMP:   EMPNO=7369, ENAME="SMITH", JOB="CLERK", MGR=7400, DEPTNO=10
+//          EMPNO=7400, ENAME="JONES", JOB="CLERK", MGR=NULL, DEPTNO=20
+//   DEPT:  DEPTNO=10, DNAME="APPSERVER", LOC="NEW YORK", STAFF=1
+//          DEPTNO=20, DNAME="RESEARCH",  LOC="BOSTON",   STAFF=1
+//
+// empConnection() answers queries on the quoted table name "EMP";
+// empDeptConnection() also answers "DEPT" and any query selecting DNAME,
+// which covers the rr:sqlQuery view in example_emp_dept.ttl (an unquoted
+// "DEPT" key would match EMP's DEPTNO too).  Tests that need other rows pass
+// their own.
+// ---------------------------------------------------------------------------
+inline std::vector<MapSQLRow> empRows() {
+	std::vector<MapSQLRow> rows;
+	rows.push_back(makeRow({{"EMPNO", StringSQLValue(7369)},
+	                        {"ENAME", StringSQLValue(std::string("SMITH"))},
+	                        {"JOB", StringSQLValue(std::string("CLERK"))},
+	                        {"MGR", StringSQLValue(7400)},
+	                        {"DEPTNO", StringSQLValue(10)}}));
+	rows.push_back(makeRow({{"EMPNO", StringSQLValue(7400)},
+	                        {"ENAME", StringSQLValue(std::string("JONES"))},
+	                        {"JOB", StringSQLValue(std::string("CLERK"))},
+	                        {"MGR", StringSQLValue()},
+	                        {"DEPTNO", StringSQLValue(20)}}));
+	return rows;
+}
+
+inline std::vector<MapSQLRow> deptRows() {
+	std::vector<MapSQLRow> rows;
+	rows.push_back(makeRow({{"DEPTNO", StringSQLValue(10)},
+	                        {"DNAME", StringSQLValue(std::string("APPSERVER"))},
+	                        {"LOC", StringSQLValue(std::string("NEW YORK"))},
+	                        {"STAFF", StringSQLValue(1)}}));
+	rows.push_back(makeRow({{"DEPTNO", StringSQLValue(20)},
+	                        {"DNAME", StringSQLValue(std::string("RESEARCH"))},
+	                        {"LOC", StringSQLValue(std::string("BOSTON"))},
+	                        {"STAFF", StringSQLValue(1)}}));
+	return rows;
+}
+
+inline std::unique_ptr<MockSQLConnection> empConnection(std::vector<MapSQLRow> emp = empRows()) {
+	std::unique_ptr<MockSQLConnection> conn(new MockSQLConnection);
+	conn->addResult("\"EMP\"", std::move(emp));
+	return conn;
+}
+
+inline std::unique_ptr<MockSQLConnection> empDeptConnection(std::vector<MapSQLRow> emp = empRows(),
+                                                            std::vector<MapSQLRow> dept = deptRows()) {
+	std::unique_ptr<MockSQLConnection> conn(new MockSQLConnection);
+	// Registered first, so DEPT wins a tie with EMP's key in a joined query.
+	conn->addResult("\"DEPT\"", dept);
+	conn->addResult("DNAME", std::move(dept));
+	conn->addResult("\"EMP\"", std::move(emp));
+	return conn;
+}
+
+// ---------------------------------------------------------------------------
+// appendToString
+//
+// A SerdSink (and NTriplesWriter sink) appending to the std::string that
+// `stream` points to.
+// ---------------------------------------------------------------------------
+inline size_t appendToString(const void *buf, size_t len, void *stream) {
+	static_cast<std::string *>(stream)->append(static_cast<const char *>(buf), len);
+	return len;
+}
+
+// ---------------------------------------------------------------------------
+// parseMapping / exportNTriples
+//
+// parseMapping() parses a Turtle mapping against http://example.com/mapping/
+// and REQUIREs it to be valid.  exportNTriples() runs processDatabase() on
+// `conn` and returns what the writer wrote: N-Triples unless another syntax
+// is given, with the export's figures in `report` if one is.
+// ---------------------------------------------------------------------------
+inline R2RMLMapping parseMapping(const char *ttl) {
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(ttl, "http://example.com/mapping/");
+	REQUIRE(mapping.isValid());
+	return mapping;
+}
+
+inline std::string exportNTriples(R2RMLMapping &mapping, SQLConnection &conn,
+                                  const ExportOptions &options = ExportOptions(), ExportReport *report = nullptr,
+                                  SerdSyntax syntax = SERD_NTRIPLES) {
+	std::string output;
+	NTriplesWriter writer(syntax, mapping.serdEnvironment, &mapping.constants, appendToString, &output);
+	mapping.processDatabase(conn, writer, options, report);
+	writer.flush();
+	return output;
+}
+
 } // namespace testing
 } // namespace r2rml
@@ -0,0 +1,171 @@
+/**
+ * Behaviour of DuckDBConnection's result sets against a real in-memory
+ * DuckDB: chunk-at-a-time streaming, nested queries while a stream is open,
+ * per-column natural datatypes, and the opt-in materialized fetch mode.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "DuckDBConnection.h"
+#include "r2rml/RowBatch.h"
+#include "r2rml/SQLResultSet.h"
+#include "r2rml/SQLRow.h"
+#include "r2rml/SQLValue.h"
+
+using r2rml::DuckDBConnection;
+using r2rml::SQLResultSet;
+using r2rml::SQLRow;
+
+namespace {
+
+// More rows than one DuckDB vector (2048), so iteration has to cross chunks.
+const int kRowCount = 5000;
+
+void seed(DuckDBConnection &conn) {
+	conn.execute("CREATE TABLE nums AS SELECT range AS id, 'n' || range::VARCHAR AS label FROM range(" +
+	             std::to_string(kRowCount) + ")");
+	conn.execute("CREATE TABLE parents (id INTEGER, name VARCHAR)");
+	conn.execute("INSERT INTO parents VALUES (1, 'one'), (2, 'two')");
+}
+
+std::vector<std::string> drainIds(SQLResultSet &rs) {
+	std::vector<std::string> ids;
+	while (rs.next()) {
+		ids.push_back(rs.getCurrentRow().getValue("ID")->asString());
+	}
+	return ids;
+}
+
+} // namespace
+
+TEST_CASE("DuckDBConnection streams results across chunk boundaries", "[duckdb][connection]") {
+	DuckDBConnection conn(":memory:");
+	seed(conn);
+
+	auto rs = conn.execute("SELECT id, label FROM nums ORDER BY id");
+	int expected = 0;
+	while (rs->next()) {
+		const SQLRow &row = rs->getCurrentRow();
+		REQUIRE(row.getValue("ID")->asString() == std::to_string(expected));
+		REQUIRE(row.getValue("LABEL")->asString() == "n" + std::to_string(expected));
+		REQUIRE(row.isNull("MISSING"));
+		++expected;
+	}
+	CHECK(expected == kRowCount);
+	CHECK_FALSE(rs->next());
+}
+
+TEST_CASE("DuckDBConnection row views expose upper-cased column names", "[duckdb][connection]") {
+	DuckDBConnection conn(":memory:");
+	auto rs = conn.execute("SELECT 1 AS lower_case, NULL AS empty");
+	REQUIRE(rs->next());
+	const SQLRow &row = rs->getCurrentRow();
+	CHECK(row.columnNames() == std::vector<std::string> {"EMPTY", "LOWER_CASE"});
+	CHECK(row.isNull("EMPTY"));
+	CHECK_FALSE(row.isNull("LOWER_CASE"));
+	CHECK(row.getValue("LOWER_CASE")->type() == r2rml::SQLValue::Type::Integer);
+}
+
+TEST_CASE("DuckDBConnection keeps an open stream when another query runs", "[duckdb][connection]") {
+	DuckDBConnection conn(":memory:");
+	seed(conn);
+
+	auto outer = conn.execute("SELECT id FROM nums ORDER BY id");
+	int seen = 0;
+	while (outer->next()) {
+		REQUIRE(outer->getCurrentRow().getValue("ID")->asString() == std::to_string(seen));
+		if (seen % 1000 == 0) {
+			// Same pattern as rr:refObjectMap evaluation: a nested query per
+			// child row on the connection that is still streaming the child.
+			auto inner = conn.execute("SELECT name FROM parents ORDER BY id");
+			REQUIRE(inner->next());
+			CHECK(inner->getCurrentRow().getValue("NAME")->asString() == "one");
+		}
+		++seen;
+	}
+	CHECK(seen == kRowCount);
+}
+
+TEST_CASE("DuckDBConnection cloned rows outlive the current chunk", "[duckdb][connection]") {
+	DuckDBConnection conn(":memory:");
+	seed(conn);
+
+	auto rs = conn.execute("SELECT id FROM nums ORDER BY id");
+	REQUIRE(rs->next());
+	std::unique_ptr<SQLRow> first = rs->getCurrentRow().clone();
+	while (rs->next()) {
+	}
+	CHECK(first->getValue("ID")->asString() == "0");
+}
+
+TEST_CASE("DuckDBConnection value views match copied values", "[duckdb][connection]") {
+	DuckDBConnection conn(":memory:");
+	auto rs = conn.execute("SELECT 42 AS n, 'text' AS s, 1.5::DOUBLE AS d, true AS b, NULL::VARCHAR AS z, "
+	                       "DATE '2024-01-02' AS day");
+	REQUIRE(rs->next());
+	const SQLRow &row = rs->getCurrentRow();
+	for (const std::string &name : {"N", "S", "D", "B", "DAY"}) {
+		r2rml::SQLValueView view = row.getValueView(name);
+		std::unique_ptr<r2rml::SQLValue> value = row.getValue(name);
+		REQUIRE_FALSE(view.isNull());
+		CHECK(view.str() == value->asString());
+		CHECK(view.type() == value->type());
+	}
+	CHECK(row.getValueView("Z").isNull());
+	CHECK(row.getValueView("MISSING").isNull());
+	// Views of different columns stay valid side by side.
+	r2rml::SQLValueView n = row.getValueView("N");
+	r2rml::SQLValueView d = row.getValueView("D");
+	CHECK(n.str() == "42");
+	CHECK(d.str() == row.getValue("D")->asString());
+}
+
+TEST_CASE("DuckDBConnection reports each column's natural datatype", "[duckdb][connection]") {
+	const std::string xsd = "http://www.w3.org/2001/XMLSchema#";
+	DuckDBConnection conn(":memory:");
+	auto rs = conn.execute("SELECT 42 AS n, 9000000000::BIGINT AS big, 1.5::DOUBLE AS d, 12.50::DECIMAL(9,2) AS dec, "
+	                       "true AS b, 'text' AS s, DATE '2024-01-02' AS day, TIMESTAMP '2024-01-02 03:04:05' AS ts, "
+	                       "NULL::INTEGER AS z");
+	REQUIRE(rs->next());
+	const SQLRow &row = rs->getCurrentRow();
+	CHECK(row.getDatatypeIRI("N") == xsd + "integer");
+	CHECK(row.getDatatypeIRI("BIG") == xsd + "integer");
+	CHECK(row.getDatatypeIRI("D") == xsd + "double");
+	CHECK(row.getDatatypeIRI("DEC") == xsd + "decimal");
+	CHECK(row.getDatatypeIRI("B") == xsd + "boolean");
+	CHECK(row.getDatatypeIRI("DAY") == xsd + "date");
+	// strings stay plain, and so do timestamps (rendered with a space)
+	CHECK(row.getDatatypeIRI("S").empty());
+	CHECK(row.getDatatypeIRI("TS").empty());
+	CHECK(row.getDatatypeIRI("Z").empty());
+	CHECK(row.getValue("DEC")->datatypeIRI() == xsd + "decimal");
+	CHECK(row.clone()->getValue("N")->datatypeIRI() == xsd + "integer");
+
+	// the batch path carries the same datatypes per column
+	auto batched = conn.execute("SELECT 42 AS n, 'text' AS s");
+	r2rml::RowBatch batch;
+	REQUIRE(batched->nextBatch(batch, 16));
+	CHECK(batch.column(batch.findColumn("N")).datatypeIRI == xsd + "integer");
+	CHECK(batch.column(batch.findColumn("S")).datatypeIRI.empty());
+}
+
+TEST_CASE("DuckDBConnection materialized mode returns the same rows", "[duckdb][connection]") {
+	DuckDBConnection streaming(":memory:");
+	DuckDBConnection materialized(":memory:", DuckDBConnection::FetchMode::Materialized);
+	seed(streaming);
+	seed(materialized);
+
+	auto a = streaming.execute("SELECT id FROM nums ORDER BY id");
+	auto b = materialized.execute("SELECT id FROM nums ORDER BY id");
+	CHECK(drainIds(*a) == drainIds(*b));
+}
+
+TEST_CASE("DuckDBConnection reports query errors from execute", "[duckdb][connection]") {
+	DuckDBConnection conn(":memory:");
+	CHECK_THROWS_AS(conn.execute("SELECT * FROM no_such_table"), std::runtime_error);
+}
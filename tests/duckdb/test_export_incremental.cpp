@@ -0,0 +1,85 @@
+/**
+ * Incremental export against a real DuckDB: the recorded watermark must be
+ * the column's maximum exactly as the database holds it, so that a
+ * non-integral mark neither skips nor repeats rows on the next run.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <serd/serd.h>
+
+#include <string>
+
+#include "DuckDBConnection.h"
+#include "r2rml/ExportOptions.h"
+#include "r2rml/LogicalTable.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/TriplesMap.h"
+#include "r2rml/WatermarkState.h"
+#include "MockSQL.h"
+
+using r2rml::DuckDBConnection;
+using r2rml::ExportOptions;
+using r2rml::R2RMLMapping;
+using r2rml::WatermarkState;
+using r2rml::testing::exportNTriples;
+using r2rml::testing::parseMapping;
+
+namespace {
+
+const char *const EMP_MAPPING = R"(
+@prefix rr: <http://www.w3.org/ns/r2rml#>.
+@prefix ex: <http://example.com/ns#>.
+<#Names>
+    rr:logicalTable [ rr:tableName "EMP" ];
+    rr:subjectMap [ rr:template "http://data.example.com/employee/{EMPNO}" ];
+    rr:predicateObjectMap [ rr:predicate ex:name; rr:objectMap [ rr:column "ENAME" ] ].
+)";
+
+} // namespace
+
+TEST_CASE("Incremental export keeps a DOUBLE watermark to its last digit", "[duckdb][export]") {
+	DuckDBConnection conn(":memory:");
+	conn.execute("CREATE TABLE EMP (EMPNO INTEGER, ENAME VARCHAR, UPDATED DOUBLE)");
+	conn.execute("INSERT INTO EMP VALUES (1, 'A', 0.12345678), (2, 'B', 0.1234567891)");
+	R2RMLMapping mapping = parseMapping(EMP_MAPPING);
+	mapping.triplesMaps[0]->logicalTable->watermarkColumn = "UPDATED";
+	WatermarkState state;
+	ExportOptions options;
+	options.watermarks = &state;
+
+	std::string first = exportNTriples(mapping, conn, options);
+	CHECK(first.find("employee/1>") != std::string::npos);
+	CHECK(first.find("employee/2>") != std::string::npos);
+	std::string mark;
+	REQUIRE(state.get(mapping.triplesMaps[0]->id, mark));
+	CHECK(mark == "0.1234567891");
+
+	// Above the mark but below its six-decimal rounding, 0.123457.
+	conn.execute("INSERT INTO EMP VALUES (3, 'C', 0.1234569)");
+	std::string second = exportNTriples(mapping, conn, options);
+	CHECK(second == "<http://data.example.com/employee/3> <http://example.com/ns#name> \"C\" .\n");
+}
+
+TEST_CASE("Incremental export leaves rows with a null watermark out of every run", "[duckdb][export]") {
+	DuckDBConnection conn(":memory:");
+	conn.execute("CREATE TABLE EMP (EMPNO INTEGER, ENAME VARCHAR, UPDATED TIMESTAMP)");
+	conn.execute("INSERT INTO EMP VALUES (1, 'A', NULL)");
+	R2RMLMapping mapping = parseMapping(EMP_MAPPING);
+	mapping.triplesMaps[0]->logicalTable->watermarkColumn = "UPDATED";
+	WatermarkState state;
+	ExportOptions options;
+	options.watermarks = &state;
+
+	// Nothing has a watermark yet, so nothing is exported, again and again.
+	CHECK(exportNTriples(mapping, conn, options).empty());
+	CHECK(exportNTriples(mapping, conn, options).empty());
+	CHECK(state.size() == 0);
+
+	conn.execute("INSERT INTO EMP VALUES (2, 'B', TIMESTAMP '2024-01-31 10:00:00')");
+	CHECK(exportNTriples(mapping, conn, options) ==
+	      "<http://data.example.com/employee/2> <http://example.com/ns#name> \"B\" .\n");
+
+	conn.execute("INSERT INTO EMP VALUES (3, 'C', NULL), (4, 'D', TIMESTAMP '2024-02-01 10:00:00')");
+	CHECK(exportNTriples(mapping, conn, options) ==
+	      "<http://data.example.com/employee/4> <http://example.com/ns#name> \"D\" .\n");
+}
@@ -0,0 +1,169 @@
+/**
+ * COPY ... TO (FORMAT rdf) against the embedded DuckDB: the extension must
+ * write what the pull-style export writes for the same rows, in order on one
+ * thread and as the same set of lines from parallel sinks.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <serd/serd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef SOURCE_R2RML_DIR
+#define SOURCE_R2RML_DIR ""
+#endif
+
+#include "DuckDBConnection.h"
+#include "extension/Sql2rdfExtension.h"
+#include "r2rml/NTriplesWriter.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/R2RMLParser.h"
+#include "r2rml/RdfSink.h"
+#include "r2rml/RowBatch.h"
+#include "r2rml/SQLResultSet.h"
+#include "MockSQL.h"
+
+#include "duckdb.hpp"
+
+using r2rml::DuckDBConnection;
+using r2rml::R2RMLMapping;
+using r2rml::R2RMLParser;
+using r2rml::RdfSink;
+using r2rml::testing::appendToString;
+
+namespace {
+
+const char *const EMP_TABLE = "CREATE TABLE EMP AS SELECT range::INTEGER AS EMPNO, 'E' || range::VARCHAR AS ENAME, "
+                              "(range % 4) * 10 AS DEPTNO FROM range(20000)";
+
+const char *const MAPPING = SOURCE_R2RML_DIR "inside_out_valid.ttl";
+
+std::string readFile(const std::string &path) {
+	std::ifstream in(path, std::ios::binary);
+	std::ostringstream text;
+	text << in.rdbuf();
+	return text.str();
+}
+
+std::vector<std::string> sortedLines(const std::string &text) {
+	std::vector<std::string> lines;
+	std::istringstream in(text);
+	std::string line;
+	while (std::getline(in, line)) {
+		lines.push_back(line);
+	}
+	std::sort(lines.begin(), lines.end());
+	return lines;
+}
+
+/// An output file in the working directory, removed again at the end of the test.
+struct OutputFile {
+	std::string path;
+	explicit OutputFile(const std::string &name) : path("sql2rdf_copy_test_" + name) {
+	}
+	~OutputFile() {
+		std::remove(path.c_str());
+	}
+};
+
+/// An embedded database with the extension loaded and EMP created.
+struct ExtensionDatabase {
+	duckdb::DuckDB db {nullptr};
+	duckdb::Connection con {db};
+
+	ExtensionDatabase() {
+		db.LoadStaticExtension<r2rml::Sql2rdfExtension>();
+		REQUIRE_FALSE(con.Query(EMP_TABLE)->HasError());
+	}
+
+	/// Run `sql`; returns its error, empty on success.
+	std::string run(const std::string &sql) {
+		auto result = con.Query(sql);
+		return result->HasError() ? result->GetError() : std::string();
+	}
+};
+
+/// The pull-style export of `query` through RdfSink and DuckDBConnection.
+std::string pullExport(const std::string &query, SerdSyntax syntax) {
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parse(MAPPING);
+	DuckDBConnection conn(":memory:");
+	conn.execute(EMP_TABLE);
+
+	std::string out;
+	r2rml::NTriplesWriter writer(syntax, mapping.serdEnvironment, &mapping.constants, appendToString, &out);
+	RdfSink sink(mapping, RdfSink::findTriplesMap(mapping, ""), writer);
+	sink.begin({{"EMPNO", r2rml::SQLValue::Type::Integer, "http://www.w3.org/2001/XMLSchema#integer"},
+	            {"ENAME"},
+	            {"DEPTNO", r2rml::SQLValue::Type::String, "http://www.w3.org/2001/XMLSchema#integer"}});
+	std::unique_ptr<r2rml::SQLResultSet> rows = conn.execute(query);
+	r2rml::RowBatch batch;
+	while (rows->nextBatch(batch)) {
+		sink.consume(batch);
+	}
+	sink.finish();
+	return out;
+}
+
+} // namespace
+
+TEST_CASE("COPY TO (FORMAT ntriples) writes what the pull export writes") {
+	ExtensionDatabase db;
+	OutputFile file("ordered.nt");
+	REQUIRE(db.run("COPY EMP TO '" + file.path + "' (FORMAT ntriples, MAPPING '" + MAPPING + "')") == "");
+
+	std::string expected = pullExport("SELECT * FROM EMP", SERD_NTRIPLES);
+	REQUIRE(sortedLines(expected).size() == 20000 * 3);
+	CHECK(readFile(file.path) == expected);
+}
+
+TEST_CASE("COPY TO runs parallel sinks when insertion order need not be kept") {
+	ExtensionDatabase db;
+	REQUIRE(db.run("SET threads = 4") == "");
+	REQUIRE(db.run("SET preserve_insertion_order = false") == "");
+	OutputFile file("parallel.nt");
+	REQUIRE(db.run("COPY (SELECT * FROM EMP) TO '" + file.path + "' (FORMAT rdf, MAPPING '" + MAPPING +
+	               "', TRIPLES_MAP 'TriplesMapIO')") == "");
+
+	std::string written = readFile(file.path);
+	CHECK(sortedLines(written) == sortedLines(pullExport("SELECT * FROM EMP", SERD_NTRIPLES)));
+	CHECK(written.back() == '\n');
+}
+
+TEST_CASE("COPY TO picks N-Quads by format or file extension") {
+	ExtensionDatabase db;
+	std::string query = "SELECT * FROM EMP WHERE EMPNO < 10";
+	std::string expected = pullExport(query, SERD_NQUADS);
+
+	OutputFile byFormat("format.out");
+	REQUIRE(db.run("COPY (" + query + ") TO '" + byFormat.path + "' (FORMAT nquads, MAPPING '" + MAPPING + "')") ==
+	        "");
+	CHECK(readFile(byFormat.path) == expected);
+
+	OutputFile byExtension("extension.nq");
+	REQUIRE(db.run("COPY (" + query + ") TO '" + byExtension.path + "' (FORMAT rdf, MAPPING '" + MAPPING + "')") ==
+	        "");
+	CHECK(readFile(byExtension.path) == expected);
+}
+
+TEST_CASE("COPY TO reports mapping errors when binding") {
+	ExtensionDatabase db;
+	OutputFile file("errors.nt");
+
+	CHECK(db.run("COPY EMP TO '" + file.path + "' (FORMAT ntriples)").find("MAPPING") != std::string::npos);
+	CHECK(db.run("COPY EMP TO '" + file.path + "' (FORMAT ntriples, MAPPING '" + MAPPING + "', BOGUS 1)")
+	          .find("BOGUS") != std::string::npos);
+	CHECK(db.run("COPY EMP TO '" + file.path + "' (FORMAT ntriples, MAPPING '" + MAPPING + "', TRIPLES_MAP 'X')")
+	          .find("no triples map") != std::string::npos);
+	CHECK(db.run("COPY (SELECT EMPNO, ENAME FROM EMP) TO '" + file.path + "' (FORMAT ntriples, MAPPING '" +
+	             MAPPING + "')")
+	          .find("DEPTNO") != std::string::npos);
+	CHECK(db.run("COPY EMP TO '" + file.path + "' (FORMAT ntriples, MAPPING '" SOURCE_R2RML_DIR "example1.ttl')")
+	          .find("inside-out") != std::string::npos);
+}
@@ -0,0 +1,220 @@
+/**
+ * Tests for BinaryRdfWriter, the binary output format: exports decoded by
+ * tests/BinaryRdfReader.h must give back the N-Triples/N-Quads export
+ * exactly, with template prefixes, names and repeats doing their job.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <serd/serd.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "r2rml/BinaryRdfWriter.h"
+#include "r2rml/ExportOptions.h"
+#include "r2rml/NTriplesWriter.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/SQLConnection.h"
+#include "r2rml/StringSQLValue.h"
+#include "BinaryRdfReader.h"
+#include "MockSQL.h"
+
+using r2rml::BinaryRdfWriter;
+using r2rml::ExportOptions;
+using r2rml::NTriplesWriter;
+using r2rml::R2RMLMapping;
+using r2rml::SQLConnection;
+using r2rml::StringSQLValue;
+using r2rml::testing::appendToString;
+using r2rml::testing::empConnection;
+using r2rml::testing::exportNTriples;
+using r2rml::testing::BinaryRdfReader;
+using r2rml::testing::BinaryRdfStatement;
+using r2rml::testing::makeRow;
+using r2rml::testing::parseMapping;
+
+namespace {
+
+size_t refuse(const void *, size_t, void *) {
+	return 0;
+}
+
+SerdNode uri(const char *iri) {
+	return serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>(iri));
+}
+
+SerdNode literal(const char *value) {
+	return serd_node_from_string(SERD_LITERAL, reinterpret_cast<const uint8_t *>(value));
+}
+
+// IRI subjects and objects from templates, typed and language-tagged
+// literals, blank nodes and a graph per department.
+const char *const MAPPING = R"(
+@prefix rr: <http://www.w3.org/ns/r2rml#>.
+@prefix ex: <http://example.com/ns#>.
+@prefix xsd: <http://www.w3.org/2001/XMLSchema#>.
+<#Emp>
+    rr:logicalTable [ rr:tableName "EMP" ];
+    rr:subjectMap [
+        rr:template "http://data.example.com/employee/{EMPNO}";
+        rr:class ex:Employee;
+        rr:graphMap [ rr:template "http://data.example.com/graph/{DEPTNO}" ]
+    ];
+    rr:predicateObjectMap [ rr:predicate ex:name; rr:objectMap [ rr:column "ENAME"; rr:language "en" ] ];
+    rr:predicateObjectMap [ rr:predicate ex:salary; rr:objectMap [ rr:column "SAL"; rr:datatype xsd:integer ] ];
+    rr:predicateObjectMap [ rr:predicate ex:job; rr:objectMap [ rr:column "JOB" ] ];
+    rr:predicateObjectMap [
+        rr:predicate ex:department;
+        rr:objectMap [ rr:template "http://data.example.com/department/{DEPTNO}" ]
+    ];
+    rr:predicateObjectMap [
+        rr:predicate ex:badge;
+        rr:objectMap [ rr:template "badge{EMPNO}"; rr:termType rr:BlankNode ]
+    ].
+)";
+
+std::vector<r2rml::MapSQLRow> employees() {
+	std::vector<r2rml::MapSQLRow> rows;
+	for (int i = 0; i < 50; ++i) {
+		rows.push_back(makeRow({{"EMPNO", StringSQLValue(7000 + i)},
+		                        {"ENAME", StringSQLValue(std::string("Employee \"") + std::to_string(i) + "\"")},
+		                        {"SAL", StringSQLValue(1000 + 10 * i)},
+		                        {"JOB", StringSQLValue(std::string(i % 3 ? "CLERK" : "caf\xc3\xa9"))},
+		                        {"DEPTNO", StringSQLValue(10 * (i % 4))}}));
+	}
+	return rows;
+}
+
+std::string exportBinary(R2RMLMapping &mapping) {
+	std::unique_ptr<SQLConnection> conn = empConnection(employees());
+	std::string output;
+	BinaryRdfWriter writer(mapping.serdEnvironment, &mapping.constants, appendToString, &output, 256);
+	mapping.processDatabase(*conn, writer, ExportOptions());
+	writer.flush();
+	return output;
+}
+
+std::string replay(const BinaryRdfReader &reader, SerdSyntax syntax) {
+	std::string output;
+	NTriplesWriter writer(syntax, nullptr, nullptr, appendToString, &output);
+	reader.replay(writer);
+	writer.flush();
+	return output;
+}
+
+} // namespace
+
+TEST_CASE("Template prefixes are collected into the constant pool") {
+	R2RMLMapping mapping = parseMapping(MAPPING);
+	const std::vector<std::string> &prefixes = mapping.constants.iriPrefixes();
+	for (const char *prefix : {"http://data.example.com/employee/", "http://data.example.com/graph/",
+	                           "http://data.example.com/department/"}) {
+		CHECK(std::count(prefixes.begin(), prefixes.end(), std::string(prefix)) == 1);
+	}
+	// blank node templates make no IRIs
+	CHECK(std::find(prefixes.begin(), prefixes.end(), std::string("badge")) == prefixes.end());
+}
+
+TEST_CASE("Binary export decodes to the N-Quads and N-Triples exports") {
+	R2RMLMapping mapping = parseMapping(MAPPING);
+	std::string binary = exportBinary(mapping);
+	BinaryRdfReader reader(binary);
+	REQUIRE(reader.statements().size() == 50 * 6);
+
+	std::unique_ptr<SQLConnection> conn = empConnection(employees());
+	const std::string nquads = exportNTriples(mapping, *conn, ExportOptions(), nullptr, SERD_NQUADS);
+	CHECK(replay(reader, SERD_NQUADS) == nquads);
+	CHECK(replay(reader, SERD_NTRIPLES) == exportNTriples(mapping, *conn));
+	CHECK(binary.size() < nquads.size() / 3);
+
+	// predicates, classes, datatypes and language tags are names; the rest
+	// split at a template prefix
+	const std::vector<std::string> &names = reader.names();
+	for (const char *name : {"http://example.com/ns#name", "http://example.com/ns#Employee",
+	                         "http://www.w3.org/2001/XMLSchema#integer", "en"}) {
+		CHECK(std::count(names.begin(), names.end(), std::string(name)) == 1);
+	}
+	CHECK(std::find(names.begin(), names.end(), std::string("http://data.example.com/employee/7000")) ==
+	      names.end());
+	CHECK(reader.prefixes().size() == mapping.constants.iriPrefixes().size());
+}
+
+TEST_CASE("BinaryRdfWriter writes repeats, literals and blank nodes") {
+	SerdNode s = uri("http://example.com/people/1");
+	SerdNode p = uri("http://example.com/ns#p");
+	SerdNode q = uri("http://example.com/ns#q");
+	SerdNode o = literal("x");
+	SerdNode dt = uri("http://www.w3.org/2001/XMLSchema#string");
+	SerdNode lang = literal("de");
+	SerdNode b = serd_node_from_string(SERD_BLANK, reinterpret_cast<const uint8_t *>("b0"));
+	SerdNode g = uri("http://example.com/g");
+
+	std::string output;
+	BinaryRdfWriter writer(nullptr, nullptr, appendToString, &output);
+	writer.addPrefix("http://example.com/");
+	writer.addPrefix("http://example.com/people/");
+	writer.addPrefix("http://example.com/");
+	writer.write(nullptr, s, p, o, nullptr, nullptr);
+	writer.write(nullptr, s, p, o, nullptr, nullptr);
+	writer.write(nullptr, s, q, o, &dt, nullptr);
+	writer.write(&g, b, q, o, nullptr, &lang);
+	writer.write(&g, s, p, b, nullptr, nullptr);
+	writer.write(nullptr, uri("http://other.org/x"), p, uri("http://example.com/people/2"), nullptr, nullptr);
+	CHECK(output.empty());
+	writer.flush();
+
+	BinaryRdfReader reader(output);
+	CHECK(reader.prefixes() == std::vector<std::string> {"http://example.com/", "http://example.com/people/"});
+	const std::vector<BinaryRdfStatement> &st = reader.statements();
+	REQUIRE(st.size() == 6);
+	CHECK(st[1].subject.value == "http://example.com/people/1");
+	CHECK(st[2].object.datatype == "http://www.w3.org/2001/XMLSchema#string");
+	CHECK(st[3].subject.type == SERD_BLANK);
+	CHECK(st[3].object.lang == "de");
+	CHECK(st[3].hasGraph);
+	CHECK(st[4].object.value == "b0");
+	CHECK_FALSE(st[5].hasGraph);
+	CHECK(st[5].subject.value == "http://other.org/x");
+	CHECK(st[5].object.value == "http://example.com/people/2");
+
+	std::string expected;
+	{
+		NTriplesWriter text(SERD_NQUADS, nullptr, nullptr, appendToString, &expected);
+		text.write(nullptr, s, p, o, nullptr, nullptr);
+		text.write(nullptr, s, p, o, nullptr, nullptr);
+		text.write(nullptr, s, q, o, &dt, nullptr);
+		text.write(&g, b, q, o, nullptr, &lang);
+		text.write(&g, s, p, b, nullptr, nullptr);
+		text.write(nullptr, uri("http://other.org/x"), p, uri("http://example.com/people/2"), nullptr, nullptr);
+	}
+	CHECK(replay(reader, SERD_NQUADS) == expected);
+
+	SECTION("a repeated statement is four bytes") {
+		std::string repeated;
+		BinaryRdfWriter again(nullptr, nullptr, appendToString, &repeated);
+		again.write(nullptr, s, p, o, nullptr, nullptr);
+		again.flush();
+		const std::size_t once = repeated.size();
+		again.write(nullptr, s, p, o, nullptr, nullptr);
+		again.flush();
+		CHECK(repeated.size() == once + 4);
+	}
+}
+
+TEST_CASE("BinaryRdfWriter reports bad statements and short writes") {
+	SerdNode s = uri("http://example.com/s");
+	SerdNode p = uri("http://example.com/p");
+	SerdNode o = literal("x");
+	std::string output;
+	BinaryRdfWriter writer(nullptr, nullptr, appendToString, &output);
+	CHECK_THROWS_AS(writer.write(nullptr, o, p, o, nullptr, nullptr), std::runtime_error);
+	SerdNode curie = serd_node_from_string(SERD_CURIE, reinterpret_cast<const uint8_t *>("ex:s"));
+	CHECK_THROWS_AS(writer.write(nullptr, curie, p, o, nullptr, nullptr), std::runtime_error);
+
+	BinaryRdfWriter refused(nullptr, nullptr, refuse, nullptr);
+	refused.write(nullptr, s, p, o, nullptr, nullptr);
+	CHECK_THROWS_AS(refused.flush(), std::runtime_error);
+}
@@ -0,0 +1,164 @@
+/**
+ * Tests for BlockCompressor, the CLI's parallel output compression: gzip
+ * written on any number of workers, in blocks of any size, must inflate
+ * back to exactly the input, as a single gzip member.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <serd/serd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "r2rml/NTriplesWriter.h"
+#include "sql2rdf/BlockCompressor.h"
+#include "MockSQL.h"
+
+using r2rml::testing::appendToString;
+using sql2rdf::BlockCompressor;
+using sql2rdf::Compression;
+
+namespace {
+
+std::string readAll(std::FILE *file) {
+	std::string data;
+	std::rewind(file);
+	char buf[4096];
+	std::size_t got;
+	while ((got = std::fread(buf, 1, sizeof(buf), file)) > 0) {
+		data.append(buf, got);
+	}
+	return data;
+}
+
+// Inflate one gzip member; `consumed` is how much of `gz` it took up.
+std::string gunzip(const std::string &gz, std::size_t &consumed) {
+	z_stream stream {};
+	REQUIRE(inflateInit2(&stream, 16 + 15) == Z_OK);
+	stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(gz.data()));
+	stream.avail_in = static_cast<uInt>(gz.size());
+	std::string out;
+	char buf[65536];
+	int rc;
+	do {
+		stream.next_out = reinterpret_cast<Bytef *>(buf);
+		stream.avail_out = sizeof(buf);
+		rc = inflate(&stream, Z_NO_FLUSH);
+		out.append(buf, sizeof(buf) - stream.avail_out);
+	} while (rc == Z_OK);
+	consumed = gz.size() - stream.avail_in;
+	inflateEnd(&stream);
+	CHECK(rc == Z_STREAM_END);
+	return out;
+}
+
+// Lines that repeat with small changes, like an N-Triples dump.
+std::string sampleText(int lines) {
+	std::string text;
+	for (int i = 0; i < lines; ++i) {
+		text += "<http://data.example.com/employee/" + std::to_string(i) + "> <http://example.com/ns#name> \"E" +
+		        std::to_string(i * 7919 % 1000) + "\" .\n";
+	}
+	return text;
+}
+
+} // namespace
+
+TEST_CASE("Compression is chosen by file extension or name") {
+	CHECK(sql2rdf::compressionForPath("out.nt.gz") == Compression::Gzip);
+	CHECK(sql2rdf::compressionForPath("OUT.NQ.GZ") == Compression::Gzip);
+	CHECK(sql2rdf::compressionForPath("out.nt.zst") == Compression::Zstd);
+	CHECK(sql2rdf::compressionForPath("out.nt") == Compression::None);
+	CHECK(sql2rdf::compressionForPath("gz") == Compression::None);
+	CHECK(sql2rdf::parseCompression("gzip") == Compression::Gzip);
+	CHECK(sql2rdf::parseCompression("zst") == Compression::Zstd);
+	CHECK(sql2rdf::parseCompression("none") == Compression::None);
+	CHECK_THROWS_AS(sql2rdf::parseCompression("bzip2"), std::invalid_argument);
+	CHECK(sql2rdf::compressionAvailable(Compression::Gzip));
+}
+
+TEST_CASE("Gzip output inflates back to the input") {
+	const std::string text = sampleText(5000);
+	for (unsigned threads : {1u, 4u}) {
+		for (std::size_t blockSize : {std::size_t(1000), std::size_t(1) << 16, std::size_t(1) << 20}) {
+			std::FILE *file = std::tmpfile();
+			REQUIRE(file);
+			{
+				BlockCompressor compressor(Compression::Gzip, file, threads, blockSize);
+				// uneven writes, straddling block boundaries
+				for (std::size_t at = 0; at < text.size(); at += 777) {
+					compressor.write(text.data() + at, std::min<std::size_t>(777, text.size() - at));
+				}
+				compressor.finish();
+				CHECK(compressor.bytesIn() == text.size());
+				CHECK(compressor.bytesOut() < text.size() / 4);
+			}
+			std::string gz = readAll(file);
+			std::fclose(file);
+			std::size_t consumed = 0;
+			CHECK(gunzip(gz, consumed) == text);
+			// one member, nothing after it
+			CHECK(consumed == gz.size());
+		}
+	}
+}
+
+TEST_CASE("Gzip output of nothing is a valid empty stream") {
+	std::FILE *file = std::tmpfile();
+	REQUIRE(file);
+	{
+		BlockCompressor compressor(Compression::Gzip, file, 2);
+		// the destructor finishes the stream
+	}
+	std::string gz = readAll(file);
+	std::fclose(file);
+	std::size_t consumed = 0;
+	CHECK(gunzip(gz, consumed).empty());
+	CHECK(consumed == gz.size());
+}
+
+TEST_CASE("BlockCompressor is a SerdSink for the writers") {
+	const char *line = "<http://example.com/s> <http://example.com/p> \"caf\xc3\xa9\" .\n";
+	SerdNode s = serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>("http://example.com/s"));
+	SerdNode p = serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>("http://example.com/p"));
+	SerdNode o = serd_node_from_string(SERD_LITERAL, reinterpret_cast<const uint8_t *>("caf\xc3\xa9"));
+
+	std::string plain;
+	std::FILE *file = std::tmpfile();
+	REQUIRE(file);
+	{
+		BlockCompressor compressor(Compression::Gzip, file, 2, 64);
+		r2rml::NTriplesWriter writer(SERD_NTRIPLES, nullptr, BlockCompressor::sink, &compressor, 16);
+		r2rml::NTriplesWriter reference(SERD_NTRIPLES, nullptr, appendToString, &plain);
+		for (int i = 0; i < 100; ++i) {
+			writer.write(nullptr, s, p, o, nullptr, nullptr);
+			reference.write(nullptr, s, p, o, nullptr, nullptr);
+		}
+		writer.flush();
+		reference.flush();
+		compressor.finish();
+	}
+	std::string gz = readAll(file);
+	std::fclose(file);
+	std::size_t consumed = 0;
+	CHECK(gunzip(gz, consumed) == plain);
+	CHECK(plain.size() == 100 * std::string(line).size());
+}
+
+TEST_CASE("BlockCompressor rejects what it can't write") {
+	std::FILE *file = std::tmpfile();
+	REQUIRE(file);
+	CHECK_THROWS_AS(BlockCompressor(Compression::None, file), std::invalid_argument);
+	if (!sql2rdf::compressionAvailable(Compression::Zstd)) {
+		CHECK_THROWS_AS(BlockCompressor(Compression::Zstd, file), std::invalid_argument);
+	}
+	{
+		BlockCompressor compressor(Compression::Gzip, file, 1);
+		compressor.finish();
+		CHECK_THROWS_AS(compressor.write("x", 1), std::logic_error);
+	}
+	std::fclose(file);
+}
@@ -0,0 +1,313 @@
+/**
+ * Tests for ConstantPool and mapping compilation: interning, the
+ * pre-serialized forms NTriplesWriter copies, term maps holding pooled nodes
+ * after R2RMLMapping::compile(), and both generation paths emitting those
+ * nodes instead of rebuilding them per row.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <serd/serd.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "r2rml/ColumnTermMap.h"
+#include "r2rml/ConstantPool.h"
+#include "r2rml/ConstantTermMap.h"
+#include "r2rml/NTriplesWriter.h"
+#include "r2rml/PredicateObjectMap.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/R2RMLParser.h"
+#include "r2rml/StatementSink.h"
+#include "r2rml/StringSQLValue.h"
+#include "r2rml/SubjectMap.h"
+#include "r2rml/TriplesMap.h"
+#include "MockSQL.h"
+
+using r2rml::ConstantPool;
+using r2rml::ConstantTermMap;
+using r2rml::NTriplesWriter;
+using r2rml::R2RMLMapping;
+using r2rml::StringSQLValue;
+using r2rml::testing::appendToString;
+using r2rml::testing::empConnection;
+using r2rml::testing::MockSQLConnection;
+
+namespace {
+
+const char *const MAPPING = R"(
+@prefix rr: <http://www.w3.org/ns/r2rml#>.
+@prefix ex: <http://example.com/ns#>.
+<#Emp>
+    rr:logicalTable [ rr:tableName "EMP" ];
+    rr:subjectMap [ rr:template "http://data.example.com/emp/{EMPNO}"; rr:class ex:Employee;
+                    rr:graph ex:staff ];
+    rr:predicateObjectMap [ rr:predicate ex:name; rr:objectMap [ rr:column "ENAME"; rr:language "en" ] ];
+    rr:predicateObjectMap [ rr:predicate ex:code; rr:objectMap [ rr:column "ENAME"; rr:datatype ex:Code ] ];
+    rr:predicateObjectMap [ rr:predicate ex:no; rr:objectMap [ rr:column "EMPNO" ] ];
+    rr:predicateObjectMap [ rr:predicate ex:kind; rr:object ex:Person ].
+)";
+
+std::string nodeString(const SerdNode &node) {
+	return node.buf ? std::string(reinterpret_cast<const char *>(node.buf), node.n_bytes) : std::string();
+}
+
+// Records the node buffers of every statement written.
+struct Recorded {
+	const uint8_t *predicate;
+	const uint8_t *object;
+	const uint8_t *datatype;
+	const uint8_t *lang;
+	const uint8_t *graph;
+};
+
+class RecordingSink : public r2rml::StatementSink {
+public:
+	void write(const SerdNode *graph, const SerdNode & /*subject*/, const SerdNode &predicate,
+	           const SerdNode &object, const SerdNode *datatype, const SerdNode *lang) override {
+		statements.push_back(Recorded {predicate.buf, object.buf, datatype ? datatype->buf : nullptr,
+		                               lang ? lang->buf : nullptr, graph ? graph->buf : nullptr});
+	}
+
+	std::vector<Recorded> statements;
+};
+
+// Every node a compiled mapping writes in constant position must be the
+// pool's own, which the pool can hand back serialized.
+void requirePooled(const R2RMLMapping &mapping, const std::vector<Recorded> &statements) {
+	REQUIRE_FALSE(statements.empty());
+	for (const Recorded &st : statements) {
+		SerdNode predicate = serd_node_from_string(SERD_URI, st.predicate);
+		CHECK(mapping.constants.encoded(predicate) != nullptr);
+		REQUIRE(st.graph != nullptr);
+		CHECK(mapping.constants.encoded(serd_node_from_string(SERD_URI, st.graph)) != nullptr);
+		if (nodeString(predicate) == "http://www.w3.org/1999/02/22-rdf-syntax-ns#type" ||
+		    nodeString(predicate) == "http://example.com/ns#kind") {
+			CHECK(mapping.constants.encoded(serd_node_from_string(SERD_URI, st.object)) != nullptr);
+		}
+		if (st.datatype) {
+			CHECK(mapping.constants.encoded(serd_node_from_string(SERD_URI, st.datatype)) != nullptr);
+		}
+		if (st.lang) {
+			const SerdNode *en = mapping.constants.find(SERD_LITERAL, "en");
+			REQUIRE(en != nullptr);
+			CHECK(st.lang == en->buf);
+		}
+	}
+}
+
+} // namespace
+
+TEST_CASE("ConstantPool interns each term once at a stable address") {
+	ConstantPool pool;
+	const SerdNode &a = pool.intern(SERD_URI, std::string("http://ex.com/a"));
+	const uint8_t *buf = a.buf;
+	for (int i = 0; i < 1000; ++i) {
+		pool.intern(SERD_URI, "http://ex.com/n" + std::to_string(i));
+	}
+	const SerdNode &again = pool.intern(SERD_URI, std::string("http://ex.com/a"));
+	CHECK(&again == &a);
+	CHECK(again.buf == buf);
+	CHECK(nodeString(again) == "http://ex.com/a");
+
+	// the same text as another type is another term
+	const SerdNode &lit = pool.intern(SERD_LITERAL, std::string("http://ex.com/a"));
+	CHECK(lit.buf != buf);
+	CHECK(lit.type == SERD_LITERAL);
+
+	REQUIRE(pool.find(SERD_URI, "http://ex.com/a") == &a);
+	CHECK(pool.find(SERD_URI, "http://ex.com/missing") == nullptr);
+	CHECK(pool.find(SERD_BLANK, "http://ex.com/a") == nullptr);
+
+	ConstantPool moved(std::move(pool));
+	CHECK(moved.find(SERD_URI, "http://ex.com/a") == &a);
+	CHECK(nodeString(a) == "http://ex.com/a");
+}
+
+TEST_CASE("ConstantPool starts with rdf:type and the SQL value datatypes") {
+	ConstantPool pool;
+	CHECK(nodeString(pool.rdfType()) == "http://www.w3.org/1999/02/22-rdf-syntax-ns#type");
+	CHECK(pool.find(SERD_URI, StringSQLValue(1).datatypeIRI()) != nullptr);
+	CHECK(pool.find(SERD_URI, StringSQLValue(1.5).datatypeIRI()) != nullptr);
+	CHECK(pool.find(SERD_URI, StringSQLValue(true).datatypeIRI()) != nullptr);
+	// natural datatypes of typed result columns
+	CHECK(pool.find(SERD_URI, "http://www.w3.org/2001/XMLSchema#decimal") != nullptr);
+	CHECK(pool.find(SERD_URI, "http://www.w3.org/2001/XMLSchema#date") != nullptr);
+	CHECK(pool.find(SERD_URI, "http://www.w3.org/2001/XMLSchema#time") != nullptr);
+}
+
+TEST_CASE("ConstantPool serializes only environment-independent terms") {
+	ConstantPool pool;
+	const SerdNode &iri = pool.intern(SERD_URI, std::string("http://ex.com/a b"));
+	const SerdNode &bnode = pool.intern(SERD_BLANK, std::string("b1"));
+	const SerdNode &relative = pool.intern(SERD_URI, std::string("a/b"));
+	const SerdNode &curie = pool.intern(SERD_CURIE, std::string("ex:a"));
+	const SerdNode &lit = pool.intern(SERD_LITERAL, std::string("x"));
+
+	REQUIRE(pool.encoded(iri) != nullptr);
+	CHECK(*pool.encoded(iri) == "<http://ex.com/a\\u0020b>");
+	REQUIRE(pool.encoded(bnode) != nullptr);
+	CHECK(*pool.encoded(bnode) == "_:b1");
+	CHECK(pool.encoded(relative) == nullptr);
+	CHECK(pool.encoded(curie) == nullptr);
+	CHECK(pool.encoded(lit) == nullptr);
+
+	// only the pool's own node, not an equal copy or a prefix of it
+	std::string copy = "http://ex.com/a b";
+	CHECK(pool.encoded(serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>(copy.c_str()))) == nullptr);
+	SerdNode prefix = serd_node_from_substring(SERD_URI, iri.buf, 8);
+	CHECK(pool.encoded(prefix) == nullptr);
+}
+
+TEST_CASE("NTriplesWriter copies pooled terms as the pool serialized them") {
+	ConstantPool pool;
+	const SerdNode &s = pool.intern(SERD_URI, std::string("http://ex.com/s"));
+	const SerdNode &p = pool.intern(SERD_URI, std::string("http://ex.com/p q"));
+	const SerdNode &o = pool.intern(SERD_BLANK, std::string("o"));
+	const SerdNode &g = pool.intern(SERD_URI, std::string("http://ex.com/g"));
+	const SerdNode &dt = pool.intern(SERD_URI, std::string("http://ex.com/dt"));
+	SerdNode lit = serd_node_from_string(SERD_LITERAL, reinterpret_cast<const uint8_t *>("v"));
+
+	std::string pooled;
+	std::string plain;
+	{
+		NTriplesWriter withPool(SERD_NQUADS, nullptr, &pool, appendToString, &pooled);
+		NTriplesWriter withoutPool(SERD_NQUADS, nullptr, appendToString, &plain);
+		for (NTriplesWriter *writer : {&withPool, &withoutPool}) {
+			writer->write(&g, s, p, o, nullptr, nullptr);
+			writer->write(&g, s, p, lit, &dt, nullptr);
+		}
+	}
+	CHECK(pooled == "<http://ex.com/s> <http://ex.com/p\\u0020q> _:o <http://ex.com/g> .\n"
+	                "<http://ex.com/s> <http://ex.com/p\\u0020q> \"v\"^^<http://ex.com/dt> <http://ex.com/g> .\n");
+	CHECK(pooled == plain);
+}
+
+TEST_CASE("Parsed mappings are compiled into their constant pool") {
+	r2rml::R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(MAPPING, "http://example.com/mapping/");
+	REQUIRE(mapping.isValid());
+	REQUIRE(mapping.triplesMaps.size() == 1);
+	const r2rml::TriplesMap &tm = *mapping.triplesMaps[0];
+
+	const r2rml::SubjectMap &subjectMap = *tm.subjectMap;
+	REQUIRE(subjectMap.classNodes.size() == 1);
+	CHECK(nodeString(subjectMap.classNodes[0]) == "http://example.com/ns#Employee");
+	CHECK(mapping.constants.encoded(subjectMap.classNodes[0]) != nullptr);
+
+	for (const auto &pom : tm.predicateObjectMaps) {
+		const auto *predicate = dynamic_cast<const ConstantTermMap *>(pom->predicateMaps.at(0).get());
+		REQUIRE(predicate != nullptr);
+		CHECK(mapping.constants.encoded(predicate->constantValue) != nullptr);
+
+		const r2rml::TermMap &object = *pom->objectMaps.at(0);
+		if (object.languageTag) {
+			CHECK(nodeString(object.languageNode) == "en");
+		} else {
+			CHECK(object.languageNode.buf == nullptr);
+		}
+		if (object.datatypeIRI) {
+			CHECK(nodeString(object.datatypeNode) == "http://example.com/ns#Code");
+			CHECK(mapping.constants.encoded(object.datatypeNode) != nullptr);
+		} else {
+			CHECK(object.datatypeNode.buf == nullptr);
+		}
+		if (const auto *constant = dynamic_cast<const ConstantTermMap *>(&object)) {
+			CHECK(mapping.constants.encoded(constant->constantValue) != nullptr);
+		}
+	}
+
+	// compiling again interns nothing new
+	std::size_t size = mapping.constants.size();
+	mapping.compile();
+	CHECK(mapping.constants.size() == size);
+}
+
+TEST_CASE("Compiled mappings emit pooled constants on both generation paths") {
+	r2rml::R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(MAPPING, "http://example.com/mapping/");
+	std::unique_ptr<MockSQLConnection> conn = empConnection();
+
+	SECTION("batch path") {
+		RecordingSink sink;
+		mapping.processDatabase(*conn, sink, r2rml::ExportOptions());
+		requirePooled(mapping, sink.statements);
+		// rdf:type + name + code + no + kind, per row
+		CHECK(sink.statements.size() == 10);
+	}
+
+	SECTION("row path") {
+		RecordingSink sink;
+		auto rows = conn->execute("SELECT * FROM \"EMP\"");
+		while (rows->next()) {
+			mapping.triplesMaps[0]->generateTriples(rows->getCurrentRow(), sink, mapping, *conn);
+		}
+		requirePooled(mapping, sink.statements);
+		CHECK(sink.statements.size() == 10);
+	}
+}
+
+TEST_CASE("Compiling a mapping does not change its output") {
+	r2rml::R2RMLParser parser;
+	std::unique_ptr<MockSQLConnection> conn = empConnection();
+
+	// SerdWriter, and NTriplesWriter with and without the pool, write the
+	// same bytes from the compiled nodes.
+	R2RMLMapping mapping = parser.parseString(MAPPING, "http://example.com/mapping/");
+	auto exportNQuads = [&](bool pool) {
+		std::string out;
+		NTriplesWriter writer(SERD_NQUADS, mapping.serdEnvironment, pool ? &mapping.constants : nullptr,
+		                      appendToString, &out);
+		mapping.processDatabase(*conn, writer, r2rml::ExportOptions());
+		writer.flush();
+		return out;
+	};
+
+	SerdChunk chunk {nullptr, 0};
+	SerdWriter *serdWriter =
+	    serd_writer_new(SERD_NQUADS, (SerdStyle)0, mapping.serdEnvironment, nullptr, serd_chunk_sink, &chunk);
+	mapping.processDatabase(*conn, *serdWriter);
+	serd_writer_finish(serdWriter);
+	uint8_t *raw = serd_chunk_sink_finish(&chunk);
+	std::string expected = raw ? std::string(reinterpret_cast<const char *>(raw)) : std::string();
+	serd_free(raw);
+	serd_writer_free(serdWriter);
+
+	CHECK(expected.find("<http://data.example.com/emp/7369> <http://www.w3.org/1999/02/22-rdf-syntax-ns#type> "
+	                    "<http://example.com/ns#Employee> <http://example.com/ns#staff> .\n") != std::string::npos);
+	CHECK(expected.find("\"SMITH\"@en") != std::string::npos);
+	CHECK(expected.find("\"SMITH\"^^<http://example.com/ns#Code>") != std::string::npos);
+	CHECK(expected.find("\"7369\"^^<http://www.w3.org/2001/XMLSchema#integer>") != std::string::npos);
+	CHECK(exportNQuads(true) == expected);
+	CHECK(exportNQuads(false) == expected);
+}
+
+TEST_CASE("Uncompiled term maps build their constants per row") {
+	// A mapping assembled in code, never compiled, on the row path.
+	R2RMLMapping mapping;
+	auto tm = std::unique_ptr<r2rml::TriplesMap>(new r2rml::TriplesMap());
+	r2rml::R2RMLParser parser;
+	R2RMLMapping parsed = parser.parseString(MAPPING, "http://example.com/mapping/");
+	tm->subjectMap = std::move(parsed.triplesMaps[0]->subjectMap);
+	tm->subjectMap->classNodes.clear();
+	auto pom = std::unique_ptr<r2rml::PredicateObjectMap>(new r2rml::PredicateObjectMap());
+	SerdNode predicate = serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>("http://ex.com/p"));
+	pom->predicateMaps.emplace_back(new ConstantTermMap(predicate));
+	auto object = std::unique_ptr<r2rml::ColumnTermMap>(new r2rml::ColumnTermMap("ENAME"));
+	object->termType = r2rml::TermType::Literal;
+	object->languageTag = std::unique_ptr<std::string>(new std::string("fr"));
+	pom->objectMaps.push_back(std::move(object));
+	tm->predicateObjectMaps.push_back(std::move(pom));
+
+	std::unique_ptr<MockSQLConnection> conn = empConnection();
+	RecordingSink sink;
+	auto rows = conn->execute("SELECT * FROM \"EMP\"");
+	REQUIRE(rows->next());
+	tm->generateTriples(rows->getCurrentRow(), sink, mapping, *conn);
+	REQUIRE(sink.statements.size() == 2);
+	CHECK(nodeString(serd_node_from_string(SERD_URI, sink.statements[0].object)) == "http://example.com/ns#Employee");
+	CHECK(nodeString(serd_node_from_string(SERD_LITERAL, sink.statements[1].lang)) == "fr");
+	CHECK(mapping.constants.find(SERD_LITERAL, "fr") == nullptr);
+}
@@ -12,6 +12,8 @@
 #include <serd/serd.h>
 
 #include <algorithm>
+#include <cctype>
+#include <cstdio>
 #include <functional>
 #include <memory>
 #include <sstream>
@@ -23,8 +25,10 @@
 #define SOURCE_R2RML_DIR ""
 #endif
 
+#include "r2rml/AbstractMap.h"
 #include "r2rml/BaseTableOrView.h"
 #include "r2rml/ColumnTermMap.h"
+#include "r2rml/ConstantPool.h"
 #include "r2rml/ConstantTermMap.h"
 #include "r2rml/GraphMap.h"
 #include "r2rml/JoinCondition.h"
@@ -336,6 +340,46 @@ TEST_CASE("MapSQLRow::columnNames lists every column, order-independent") {
 	REQUIRE(std::find(names.begin(), names.end(), "AGE") != names.end());
 }
 
+TEST_CASE("MapSQLRow::getValueView borrows the stored value") {
+	auto row = makeRow({{"NAME", StringSQLValue(std::string("SMITH"))}, {"AGE", StringSQLValue(42)},
+	                    {"NOTE", StringSQLValue()}});
+	r2rml::SQLValueView name = row.getValueView("NAME");
+	REQUIRE_FALSE(name.isNull());
+	CHECK(name.str() == "SMITH");
+	CHECK(name.type() == SQLValue::Type::String);
+	CHECK(row.getValueView("AGE").type() == SQLValue::Type::Integer);
+	CHECK(row.getValueView("NOTE").isNull());
+	CHECK(row.getValueView("MISSING").isNull());
+	CHECK(name.sameValue(makeRow({{"X", StringSQLValue(std::string("SMITH"))}}).getValueView("X")));
+	CHECK_FALSE(row.getValueView("NOTE").sameValue(row.getValueView("NOTE")));
+}
+
+// A row type that only implements the required SQLRow methods.
+class GetValueOnlyRow : public SQLRow {
+public:
+	std::unique_ptr<SQLValue> getValue(const std::string &columnName) const override {
+		return std::unique_ptr<SQLValue>(columnName == "ID" ? new StringSQLValue(7) : new StringSQLValue());
+	}
+	bool isNull(const std::string &columnName) const override {
+		return columnName != "ID";
+	}
+	std::vector<std::string> columnNames() const override {
+		return {"ID"};
+	}
+	std::unique_ptr<SQLRow> clone() const override {
+		return std::unique_ptr<SQLRow>(new GetValueOnlyRow());
+	}
+};
+
+TEST_CASE("SQLRow::getValueView default implementation wraps getValue") {
+	GetValueOnlyRow row;
+	r2rml::SQLValueView id = row.getValueView("ID");
+	REQUIRE_FALSE(id.isNull());
+	CHECK(id.str() == "7");
+	CHECK(id.type() == SQLValue::Type::Integer);
+	CHECK(row.getValueView("OTHER").isNull());
+}
+
 // ---------------------------------------------------------------------------
 // TemplateTermMap: IRI-safe percent-encoding of reserved characters, and the
 // malformed-template ("{" with no matching "}") recovery path.
@@ -352,6 +396,39 @@ TEST_CASE("TemplateTermMap percent-encodes reserved characters in column values"
 	serd_env_free(env);
 }
 
+// Exposes AbstractMap's protected percent-encoder.
+class PercentEncoder : public r2rml::AbstractMap {
+public:
+	using AbstractMap::percentEncode;
+	std::ostream &print(std::ostream &os) const override {
+		return os;
+	}
+};
+
+TEST_CASE("percentEncode matches DuckDB's url_encode for every byte and offset") {
+	// url_encode() keeps A-Z a-z 0-9 - _ . ~ and writes %XX (uppercase hex)
+	// for every other byte, NUL and bytes >= 0x80 included.
+	for (int b = 0; b < 256; ++b) {
+		const char c = static_cast<char>(b);
+		const bool keep = std::isalnum(b) || c == '-' || c == '_' || c == '.' || c == '~';
+		char hex[4];
+		std::snprintf(hex, sizeof(hex), "%%%02X", b);
+		const std::string expected = keep ? std::string(1, c) : std::string(hex);
+		// Place the byte at every offset of a 40-byte unreserved run, so each
+		// lane of the vectorized scan and the scalar tail see it.
+		for (std::size_t at = 0; at < 40; ++at) {
+			std::string value(40, 'a');
+			value[at] = c;
+			INFO("byte " << b << " at offset " << at);
+			REQUIRE(PercentEncoder::percentEncode(value) ==
+			        std::string(at, 'a') + expected + std::string(39 - at, 'a'));
+		}
+	}
+	CHECK(PercentEncoder::percentEncode("") == "");
+	CHECK(PercentEncoder::percentEncode("1234567890123456789") == "1234567890123456789");
+	CHECK(PercentEncoder::percentEncode("a b/c\xC3\xBC") == "a%20b%2Fc%C3%BC");
+}
+
 TEST_CASE("TemplateTermMap leaves unreserved characters untouched") {
 	TemplateTermMap tt("http://data.example.com/name/{NAME}");
 	SerdEnv *env = serd_env_new(nullptr);
@@ -407,6 +484,36 @@ TEST_CASE("TemplateTermMap malformed template (unmatched '{') truncates graceful
 	serd_env_free(env);
 }
 
+TEST_CASE("TemplateTermMap parses its template once into a plan") {
+	TemplateTermMap tt("http://ex.com/{A}/{B}-{A}");
+	const TemplateTermMap::Plan &plan = tt.plan();
+	REQUIRE(plan.segments.size() == 6);
+	CHECK(plan.segments[0].text == "http://ex.com/");
+	CHECK(plan.segments[0].slot == TemplateTermMap::Plan::npos);
+	CHECK(plan.segments[1].slot == 0);
+	CHECK(plan.segments[3].slot == 1);
+	CHECK(plan.segments[4].text == "-");
+	CHECK(plan.segments[5].slot == 0);
+	CHECK(plan.columns == std::vector<std::string> {"A", "B"});
+	CHECK(plan.sizeHint >= std::string("http://ex.com///-").size());
+	CHECK(&tt.plan() == &plan);
+
+	// setTemplate() re-plans at once.
+	tt.setTemplate("urn:{C}");
+	CHECK(tt.referencedColumns() == std::vector<std::string> {"C"});
+	SerdEnv *env = serd_env_new(nullptr);
+	auto row = makeRow({{"C", StringSQLValue(std::string("x y"))}});
+	CHECK(nodeUri(tt.generateRDFTerm(row, *env)) == "urn:x%20y");
+
+	// A template assigned directly is planned when the mapping is compiled.
+	tt.templateString = "urn:c/{C}";
+	CHECK(tt.referencedColumns() == std::vector<std::string> {"C"});
+	r2rml::ConstantPool pool;
+	tt.internConstants(pool);
+	CHECK(nodeUri(tt.generateRDFTerm(row, *env)) == "urn:c/x%20y");
+	serd_env_free(env);
+}
+
 // ---------------------------------------------------------------------------
 // TermMap base print()/computeDatatypeIRI(): languageTag, datatypeIRI and all
 // three TermType enumerators (only IRI/Literal were previously exercised).
@@ -0,0 +1,251 @@
+/**
+ * Tests for duplicate elimination (ExportOptions::dedup): the DuplicateFilter
+ * with and without spilling to disk, DedupSink in front of an
+ * NTriplesWriter, and both processDatabase() paths with the option set.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <serd/serd.h>
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "r2rml/DedupSink.h"
+#include "r2rml/DuplicateFilter.h"
+#include "r2rml/ExportOptions.h"
+#include "r2rml/ExportReport.h"
+#include "r2rml/NTriplesWriter.h"
+#include "r2rml/R2RMLMapping.h"
+#include "MockSQL.h"
+
+using r2rml::DedupSink;
+using r2rml::DuplicateFilter;
+using r2rml::ExportOptions;
+using r2rml::ExportReport;
+using r2rml::NTriplesWriter;
+using r2rml::R2RMLMapping;
+using r2rml::testing::appendToString;
+using r2rml::testing::empConnection;
+using r2rml::testing::exportNTriples;
+using r2rml::testing::parseMapping;
+
+namespace {
+
+std::vector<std::string> lines(const std::string &text) {
+	std::vector<std::string> result;
+	for (std::size_t start = 0; start < text.size();) {
+		std::size_t end = text.find('\n', start);
+		end = end == std::string::npos ? text.size() : end;
+		result.push_back(text.substr(start, end - start));
+		start = end + 1;
+	}
+	return result;
+}
+
+struct Collector {
+	std::vector<std::string> records;
+
+	DuplicateFilter::Emit emit() {
+		return [this](const char *data, std::size_t size) { records.emplace_back(data, size); };
+	}
+};
+
+// Two triples maps over the same table, both typing every employee as an
+// ex:Employee: the class triples come out twice.
+const char *const MAPPING = R"(
+@prefix rr: <http://www.w3.org/ns/r2rml#>.
+@prefix ex: <http://example.com/ns#>.
+<#Names>
+    rr:logicalTable [ rr:tableName "EMP" ];
+    rr:subjectMap [ rr:template "http://data.example.com/employee/{EMPNO}"; rr:class ex:Employee ];
+    rr:predicateObjectMap [ rr:predicate ex:name; rr:objectMap [ rr:column "ENAME" ] ].
+<#Jobs>
+    rr:logicalTable [ rr:tableName "EMP" ];
+    rr:subjectMap [ rr:template "http://data.example.com/employee/{EMPNO}"; rr:class ex:Employee ];
+    rr:predicateObjectMap [ rr:predicate ex:job; rr:objectMap [ rr:column "JOB" ] ].
+)";
+
+} // namespace
+
+TEST_CASE("DuplicateFilter passes first occurrences on in order") {
+	Collector out;
+	DuplicateFilter filter(1 << 20, out.emit());
+	for (const char *record : {"a", "b", "a", "c", "b", "a", ""}) {
+		filter.add(record, std::string(record).size());
+	}
+	CHECK(out.records == std::vector<std::string> {"a", "b", "c", ""});
+	filter.finish();
+	CHECK(out.records.size() == 4);
+	CHECK(filter.duplicates() == 3);
+	CHECK(filter.spills() == 0);
+}
+
+TEST_CASE("DuplicateFilter hashes all of a record") {
+	CHECK(DuplicateFilter::hash("abc", 3) == DuplicateFilter::hash("abc", 3));
+	CHECK_FALSE(DuplicateFilter::hash("abc", 3) == DuplicateFilter::hash("abd", 3));
+	CHECK_FALSE(DuplicateFilter::hash("abc", 3) == DuplicateFilter::hash("abc", 2));
+	std::string longer(40, 'x');
+	std::string other = longer;
+	other[33] = 'y';
+	CHECK_FALSE(DuplicateFilter::hash(longer.data(), longer.size()) ==
+	            DuplicateFilter::hash(other.data(), other.size()));
+}
+
+TEST_CASE("DuplicateFilter spills runs once over its memory limit") {
+	Collector out;
+	// room for a handful of hashes and pending records only
+	DuplicateFilter filter(256, out.emit());
+	std::set<std::string> expected;
+	std::size_t added = 0;
+	for (int pass = 0; pass < 3; ++pass) {
+		for (int i = 0; i < 200; ++i) {
+			std::string record = "<http://example.com/s/" + std::to_string((i * 7 + pass) % 150) + ">";
+			expected.insert(record);
+			filter.add(record.data(), record.size());
+			++added;
+		}
+	}
+	std::size_t early = out.records.size();
+	CHECK(early < expected.size());
+	CHECK(filter.spills() > 1);
+	filter.finish();
+
+	std::set<std::string> unique(out.records.begin(), out.records.end());
+	CHECK(unique == expected);
+	CHECK(out.records.size() == expected.size());
+	CHECK(filter.duplicates() == added - expected.size());
+
+	SECTION("records added after finish() are checked against everything emitted") {
+		std::size_t spills = filter.spills();
+		std::string seen = "<http://example.com/s/3>";
+		std::string fresh = "<http://example.com/s/new>";
+		filter.add(seen.data(), seen.size());
+		filter.add(fresh.data(), fresh.size());
+		filter.finish();
+		CHECK(out.records.size() == expected.size() + 1);
+		CHECK(out.records.back() == fresh);
+		CHECK(filter.duplicates() == added - expected.size() + 1);
+		CHECK(filter.spills() > spills);
+	}
+}
+
+TEST_CASE("DedupSink drops repeated statements in front of a writer") {
+	SerdNode s = serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>("http://example.com/s"));
+	SerdNode p = serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>("http://example.com/p"));
+	SerdNode o = serd_node_from_string(SERD_LITERAL, reinterpret_cast<const uint8_t *>("1"));
+	SerdNode dt = serd_node_from_string(SERD_URI,
+	                                    reinterpret_cast<const uint8_t *>("http://www.w3.org/2001/XMLSchema#integer"));
+	SerdNode g1 = serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>("http://example.com/g1"));
+	SerdNode g2 = serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>("http://example.com/g2"));
+
+	for (std::size_t memory : {std::size_t(1) << 20, std::size_t(0)}) {
+		SECTION("N-Triples ignores graphs, memory " + std::to_string(memory)) {
+			std::string output;
+			NTriplesWriter writer(SERD_NTRIPLES, nullptr, nullptr, appendToString, &output);
+			DedupSink dedup(writer, memory);
+			CHECK_FALSE(dedup.writesGraphs());
+			dedup.write(&g1, s, p, o, &dt, nullptr);
+			dedup.write(&g2, s, p, o, &dt, nullptr);
+			dedup.write(nullptr, s, p, o, nullptr, nullptr);
+			dedup.flush();
+			std::vector<std::string> got = lines(output);
+			std::sort(got.begin(), got.end());
+			CHECK(got == std::vector<std::string> {
+			                 "<http://example.com/s> <http://example.com/p> \"1\" .",
+			                 "<http://example.com/s> <http://example.com/p> "
+			                 "\"1\"^^<http://www.w3.org/2001/XMLSchema#integer> .",
+			             });
+			CHECK(dedup.duplicates() == 1);
+			CHECK((dedup.spills() > 0) == (memory == 0));
+		}
+
+		SECTION("N-Quads keeps statements in different graphs, memory " + std::to_string(memory)) {
+			std::string output;
+			NTriplesWriter writer(SERD_NQUADS, nullptr, nullptr, appendToString, &output);
+			DedupSink dedup(writer, memory);
+			CHECK(dedup.writesGraphs());
+			dedup.write(&g1, s, p, o, nullptr, nullptr);
+			dedup.write(&g2, s, p, o, nullptr, nullptr);
+			dedup.write(&g1, s, p, o, nullptr, nullptr);
+			dedup.write(nullptr, s, p, o, nullptr, nullptr);
+			dedup.flush();
+			std::vector<std::string> got = lines(output);
+			std::sort(got.begin(), got.end());
+			CHECK(got == std::vector<std::string> {
+			                 "<http://example.com/s> <http://example.com/p> \"1\" .",
+			                 "<http://example.com/s> <http://example.com/p> \"1\" <http://example.com/g1> .",
+			                 "<http://example.com/s> <http://example.com/p> \"1\" <http://example.com/g2> .",
+			             });
+			CHECK(dedup.duplicates() == 1);
+		}
+	}
+}
+
+TEST_CASE("Export with dedup drops repeated triples") {
+	R2RMLMapping mapping = parseMapping(MAPPING);
+	ExportReport plain;
+	std::string all = exportNTriples(mapping, *empConnection(), ExportOptions(), &plain);
+	CHECK(plain.duplicatesDropped == 0);
+	CHECK(lines(all).size() == 8);
+
+	ExportOptions options;
+	options.dedup = true;
+	ExportReport report;
+	std::string deduped = exportNTriples(mapping, *empConnection(), options, &report);
+	CHECK(report.duplicatesDropped == 2);
+	CHECK(report.dedupSpills == 0);
+	CHECK(report.statements == 8); // generated, duplicates included
+
+	// first occurrences, in the order the plain export wrote them
+	std::vector<std::string> expected;
+	std::set<std::string> seen;
+	for (const std::string &line : lines(all)) {
+		if (seen.insert(line).second) {
+			expected.push_back(line);
+		}
+	}
+	CHECK(lines(deduped) == expected);
+
+	SECTION("with a memory limit too small for any hash") {
+		options.dedupMemory = 0;
+		ExportReport spilled;
+		std::vector<std::string> got = lines(exportNTriples(mapping, *empConnection(), options, &spilled));
+		CHECK(spilled.duplicatesDropped == 2);
+		CHECK(spilled.dedupSpills > 0);
+		std::sort(got.begin(), got.end());
+		std::sort(expected.begin(), expected.end());
+		CHECK(got == expected);
+	}
+}
+
+TEST_CASE("Parallel export with dedup drops repeated lines") {
+	R2RMLMapping mapping = parseMapping(MAPPING);
+	ExportReport sequential;
+	ExportOptions dedup;
+	dedup.dedup = true;
+	std::string expected = exportNTriples(mapping, *empConnection(), dedup, &sequential);
+	auto connect = []() { return empConnection(); };
+
+	for (unsigned threads : {1u, 2u}) {
+		ExportOptions options;
+		options.threads = threads;
+		options.dedup = true;
+		ExportReport report;
+		std::string output;
+		mapping.processDatabase(connect, SERD_NTRIPLES, (SerdStyle)0, appendToString, &output, options, &report);
+		CHECK(output == expected);
+		CHECK(report.duplicatesDropped == 2);
+		CHECK(report.statements == 8);
+	}
+
+	ExportOptions turtle;
+	turtle.dedup = true;
+	std::string output;
+	CHECK_THROWS_AS(
+	    mapping.processDatabase(connect, SERD_TURTLE, (SerdStyle)0, appendToString, &output, turtle),
+	    std::invalid_argument);
+	CHECK(output.empty());
+}
@@ -0,0 +1,185 @@
+/**
+ * Tests for export metrics (ExportOptions::metrics): the per-TriplesMap and
+ * per-PredicateObjectMap counters processDatabase() fills in, the same from
+ * the sequential and parallel exports, and ExportReport::toJson().
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <serd/serd.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "r2rml/ExportOptions.h"
+#include "r2rml/ExportReport.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/SQLConnection.h"
+#include "r2rml/StringSQLValue.h"
+#include "r2rml/TriplesMap.h"
+#include "MockSQL.h"
+
+using r2rml::ExportOptions;
+using r2rml::ExportReport;
+using r2rml::PredicateObjectMapMetrics;
+using r2rml::R2RMLMapping;
+using r2rml::SQLConnection;
+using r2rml::StringSQLValue;
+using r2rml::TriplesMapMetrics;
+using r2rml::testing::appendToString;
+using r2rml::testing::empDeptConnection;
+using r2rml::testing::exportNTriples;
+using r2rml::testing::makeRow;
+using r2rml::testing::parseMapping;
+
+namespace {
+
+// Employees typed and named, joined to their department; one employee has
+// no name and one no number, so no subject.
+const char *const MAPPING = R"(
+@prefix rr: <http://www.w3.org/ns/r2rml#>.
+@prefix ex: <http://example.com/ns#>.
+<#Emps>
+    rr:logicalTable [ rr:tableName "EMP" ];
+    rr:subjectMap [ rr:template "http://data.example.com/employee/{EMPNO}"; rr:class ex:Employee ];
+    rr:predicateObjectMap [ rr:predicate ex:name; rr:objectMap [ rr:column "ENAME" ] ];
+    rr:predicateObjectMap [
+        rr:predicate ex:dept;
+        rr:objectMap [ rr:parentTriplesMap <#Depts>;
+                       rr:joinCondition [ rr:child "DEPTNO"; rr:parent "DEPTNO" ] ] ].
+<#Depts>
+    rr:logicalTable [ rr:tableName "DEPT" ];
+    rr:subjectMap [ rr:template "http://data.example.com/dept/{DEPTNO}" ];
+    rr:predicateObjectMap [ rr:predicate ex:name; rr:objectMap [ rr:column "DNAME" ] ].
+)";
+
+std::unique_ptr<SQLConnection> connection() {
+	return empDeptConnection({makeRow({{"EMPNO", StringSQLValue(1)},
+	                                   {"ENAME", StringSQLValue(std::string("SMITH"))},
+	                                   {"DEPTNO", StringSQLValue(10)}}),
+	                          makeRow({{"EMPNO", StringSQLValue(2)}, {"ENAME", StringSQLValue()},
+	                                   {"DEPTNO", StringSQLValue(10)}}),
+	                          makeRow({{"EMPNO", StringSQLValue()},
+	                                   {"ENAME", StringSQLValue(std::string("JONES"))},
+	                                   {"DEPTNO", StringSQLValue(20)}})});
+}
+
+const TriplesMapMetrics &metricsOf(const ExportReport &report, const std::string &name) {
+	auto it = std::find_if(report.triplesMaps.begin(), report.triplesMaps.end(), [&](const TriplesMapMetrics &m) {
+		return m.id.size() >= name.size() && m.id.compare(m.id.size() - name.size(), name.size(), name) == 0;
+	});
+	REQUIRE(it != report.triplesMaps.end());
+	return *it;
+}
+
+// The counters every export of MAPPING must report.
+void checkCounts(const ExportReport &report) {
+	REQUIRE(report.triplesMaps.size() == 2);
+
+	const TriplesMapMetrics &emps = metricsOf(report, "#Emps");
+	CHECK(emps.rows == 3);
+	CHECK(emps.nullsSkipped == 1);
+	CHECK(emps.triples == 5); // 2 rdf:type, 1 name, 2 dept
+	CHECK(emps.joinProbes == 2);
+	REQUIRE(emps.predicateObjectMaps.size() == 2);
+	std::size_t names = emps.predicateObjectMaps[0].joinProbes ? 1 : 0; // POM order follows the parser
+	const PredicateObjectMapMetrics &name = emps.predicateObjectMaps[names];
+	const PredicateObjectMapMetrics &dept = emps.predicateObjectMaps[1 - names];
+	CHECK(name.triples == 1);
+	CHECK(name.nullsSkipped == 1);
+	CHECK(name.joinProbes == 0);
+	CHECK(name.joinSeconds == 0);
+	CHECK(dept.triples == 2);
+	CHECK(dept.nullsSkipped == 0);
+	CHECK(dept.joinProbes == 2);
+
+	const TriplesMapMetrics &depts = metricsOf(report, "#Depts");
+	CHECK(depts.rows == 2);
+	CHECK(depts.triples == 2);
+	CHECK(depts.nullsSkipped == 0);
+	REQUIRE(depts.predicateObjectMaps.size() == 1);
+	CHECK(depts.predicateObjectMaps[0].triples == 2);
+	CHECK(depts.joinSeconds == 0);
+
+	for (const TriplesMapMetrics &tm : report.triplesMaps) {
+		CHECK(tm.executeSeconds >= 0);
+		CHECK(tm.iterateSeconds >= 0);
+		CHECK(tm.termSeconds >= 0);
+		CHECK(tm.joinSeconds >= 0);
+		CHECK(tm.writeSeconds >= 0);
+	}
+}
+
+} // namespace
+
+TEST_CASE("Sequential export reports per-TriplesMap metrics") {
+	R2RMLMapping mapping = parseMapping(MAPPING);
+	ExportOptions options;
+	options.metrics = true;
+	ExportReport report;
+	std::string output = exportNTriples(mapping, *connection(), options, &report);
+
+	checkCounts(report);
+	std::size_t triples = 0;
+	for (const TriplesMapMetrics &tm : report.triplesMaps) {
+		triples += tm.triples;
+	}
+	CHECK(triples == static_cast<std::size_t>(std::count(output.begin(), output.end(), '\n')));
+	CHECK(report.statements == triples);
+	CHECK(report.joinIndexProbes == 2);
+}
+
+TEST_CASE("Exports without metrics report none") {
+	R2RMLMapping mapping = parseMapping(MAPPING);
+	ExportReport report;
+	std::string output = exportNTriples(mapping, *connection(), ExportOptions(), &report);
+	CHECK(report.triplesMaps.empty());
+	// The statement total is counted all the same.
+	CHECK(report.statements == static_cast<std::size_t>(std::count(output.begin(), output.end(), '\n')));
+}
+
+TEST_CASE("Parallel export sums its workers' metrics") {
+	R2RMLMapping mapping = parseMapping(MAPPING);
+	for (unsigned threads : {1u, 2u}) {
+		ExportOptions options;
+		options.metrics = true;
+		options.threads = threads;
+		ExportReport report;
+		std::string output;
+		mapping.processDatabase(connection, SERD_NTRIPLES, (SerdStyle)0, appendToString, &output, options,
+		                        &report);
+		checkCounts(report);
+		CHECK(report.statements == static_cast<std::size_t>(std::count(output.begin(), output.end(), '\n')));
+		// Mapping order, whichever worker ran each TriplesMap.
+		CHECK(report.triplesMaps[0].id == mapping.triplesMaps[0]->id);
+		CHECK(report.triplesMaps[1].id == mapping.triplesMaps[1]->id);
+	}
+}
+
+TEST_CASE("ExportReport writes metrics as JSON") {
+	ExportReport report;
+	report.statements = 10;
+	report.joinIndexBuilds = 1;
+	TriplesMapMetrics tm;
+	tm.id = "http://example.com/mapping/#\"Emps\"";
+	tm.rows = 4;
+	tm.triples = 10;
+	tm.executeSeconds = 0.5;
+	tm.joinSeconds = 0.5;
+	tm.writeSeconds = 1.5;
+	tm.predicateObjectMaps.resize(1);
+	tm.predicateObjectMaps[0].triples = 6;
+	report.triplesMaps.push_back(tm);
+
+	std::string json = report.toJson();
+	CHECK(json.find("{\n  \"statements\": 10,\n  \"joinIndexBuilds\": 1,") != std::string::npos);
+	CHECK(json.find("{\"id\": \"http://example.com/mapping/#\\\"Emps\\\"\", \"rows\": 4, \"triples\": 10") !=
+	      std::string::npos);
+	CHECK(json.find("\"execute\": 0.500000") != std::string::npos);
+	CHECK(json.find("\"join\": 0.500000, \"write\": 1.500000, \"total\": 2.500000") != std::string::npos);
+	CHECK(json.find("\"rowsPerSecond\": 1.600000, \"triplesPerSecond\": 4.000000") != std::string::npos);
+	CHECK(json.find("{\"triples\": 6, \"nullsSkipped\": 0") != std::string::npos);
+
+	CHECK(ExportReport().toJson().find("\"triplesMaps\": []") != std::string::npos);
+}
@@ -0,0 +1,340 @@
+/**
+ * Tests for incremental exports (ExportOptions::watermarks): the watermark
+ * queries of a LogicalTable, saving and loading a WatermarkState, and
+ * processDatabase() exporting only the rows past each TriplesMap's mark,
+ * sequentially and partitioned.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <serd/serd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "r2rml/ExportOptions.h"
+#include "r2rml/LogicalTable.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/SQLConnection.h"
+#include "r2rml/StringSQLValue.h"
+#include "r2rml/TriplesMap.h"
+#include "r2rml/WatermarkState.h"
+#include "MockSQL.h"
+
+using r2rml::ExportOptions;
+using r2rml::R2RMLMapping;
+using r2rml::SQLConnection;
+using r2rml::SQLResultSet;
+using r2rml::StringSQLValue;
+using r2rml::WatermarkState;
+using r2rml::testing::appendToString;
+using r2rml::testing::exportNTriples;
+using r2rml::testing::makeRow;
+using r2rml::testing::MockSQLConnection;
+using r2rml::testing::parseMapping;
+
+namespace {
+
+// A state file path for one test, removed afterwards.
+struct TempFile {
+	std::string path;
+
+	TempFile() {
+		char name[] = "/tmp/sql2rdf-watermarks-XXXXXX";
+		int fd = mkstemp(name);
+		REQUIRE(fd >= 0);
+		close(fd);
+		path = name;
+		std::remove(path.c_str());
+	}
+
+	~TempFile() {
+		std::remove(path.c_str());
+		std::remove((path + ".tmp").c_str());
+	}
+
+	void write(const std::string &data) const {
+		std::FILE *file = std::fopen(path.c_str(), "wb");
+		REQUIRE(file);
+		std::fwrite(data.data(), 1, data.size(), file);
+		std::fclose(file);
+	}
+};
+
+const char *const EMP_MAPPING = R"(
+@prefix rr: <http://www.w3.org/ns/r2rml#>.
+@prefix ex: <http://example.com/ns#>.
+<#Names>
+    rr:logicalTable [ rr:tableName "EMP" ];
+    rr:subjectMap [ rr:template "http://data.example.com/employee/{EMPNO}" ];
+    rr:predicateObjectMap [ rr:predicate ex:name; rr:objectMap [ rr:column "ENAME" ] ].
+)";
+
+// Answers the watermark queries over EMP."UPDATED": the highest watermark
+// is `upper` (null when no row has one), a first run's delta is the two
+// rows with a watermark and a later one only the row updated last.
+// Records the queries it is sent.
+class EmpConnection : public MockSQLConnection {
+public:
+	explicit EmpConnection(const std::string &upper, std::vector<std::string> *queries = nullptr) : queries_(queries) {
+		addResult("max(\"UPDATED\")", {makeRow({{"upper", upper.empty() ? StringSQLValue()
+		                                                                : StringSQLValue(upper)}})});
+		addResult("WHERE \"UPDATED\" <= ", {row(7369, "SMITH"), row(7499, "ALLEN")});
+		addResult("WHERE \"UPDATED\" > ", {row(7499, "ALLEN")});
+		addResult("EMP", {row(7369, "SMITH"), row(7499, "ALLEN"), row(7521, "WARD")});
+	}
+
+	std::unique_ptr<SQLResultSet> execute(const std::string &query) override {
+		if (queries_) {
+			queries_->push_back(query);
+		}
+		return MockSQLConnection::execute(query);
+	}
+
+private:
+	static r2rml::MapSQLRow row(int empno, const char *ename) {
+		return makeRow({{"EMPNO", StringSQLValue(empno)}, {"ENAME", StringSQLValue(std::string(ename))}});
+	}
+
+	std::vector<std::string> *queries_;
+};
+
+// EMP rows with an "UPDATED" text watermark ("" for null), answering the
+// watermark queries by evaluating their comparisons as SQL would: a null
+// watermark fails every one.
+class EmpTable : public SQLConnection {
+public:
+	struct Row {
+		int empno;
+		std::string updated;
+	};
+
+	std::unique_ptr<SQLResultSet> execute(const std::string &query) override {
+		std::vector<r2rml::MapSQLRow> result;
+		if (query.find("max(") != std::string::npos) {
+			std::string upper;
+			for (const Row &row : rows) {
+				upper = std::max(upper, row.updated);
+			}
+			result.push_back(makeRow({{"upper", upper.empty() ? StringSQLValue() : StringSQLValue(upper)}}));
+		} else {
+			std::string after = literalAfter(query, "> '");
+			std::string upto = literalAfter(query, "<= '");
+			for (const Row &row : rows) {
+				bool isNull = row.updated.empty();
+				if ((after.empty() || (!isNull && row.updated > after)) &&
+				    (upto.empty() || (!isNull && row.updated <= upto))) {
+					result.push_back(makeRow({{"EMPNO", StringSQLValue(row.empno)},
+					                          {"ENAME", StringSQLValue(std::string("E"))}}));
+				}
+			}
+		}
+		return std::unique_ptr<SQLResultSet>(new r2rml::testing::MockSQLResultSet(std::move(result)));
+	}
+
+	std::vector<Row> rows;
+
+private:
+	// The text of the SQL literal following `prefix` in `query`; "" if none.
+	static std::string literalAfter(const std::string &query, const std::string &prefix) {
+		std::size_t start = query.find(prefix);
+		if (start == std::string::npos) {
+			return std::string();
+		}
+		start += prefix.size();
+		return query.substr(start, query.find('\'', start) - start);
+	}
+};
+
+std::string employee(int empno) {
+	return "<http://data.example.com/employee/" + std::to_string(empno) + "> <http://example.com/ns#name> \"E\" .\n";
+}
+
+// EMP_MAPPING, its one table watermarked on UPDATED.
+R2RMLMapping watermarkedMapping() {
+	R2RMLMapping mapping = parseMapping(EMP_MAPPING);
+	REQUIRE(mapping.triplesMaps.size() == 1);
+	mapping.triplesMaps[0]->logicalTable->watermarkColumn = "UPDATED";
+	return mapping;
+}
+
+bool contains(const std::string &text, const std::string &part) {
+	return text.find(part) != std::string::npos;
+}
+
+} // namespace
+
+TEST_CASE("LogicalTable builds watermark queries") {
+	R2RMLMapping mapping = watermarkedMapping();
+	const r2rml::LogicalTable &table = *mapping.triplesMaps[0]->logicalTable;
+	CHECK(table.watermarkBoundQuery() == "SELECT CAST(max(\"UPDATED\") AS VARCHAR) AS \"upper\" FROM \"EMP\"");
+	CHECK(table.watermarkQuery("", "2024-02-01") ==
+	      "SELECT \"EMPNO\", \"ENAME\" FROM \"EMP\" WHERE \"UPDATED\" <= '2024-02-01'");
+	CHECK(table.watermarkQuery("O'Brien", "P") ==
+	      "SELECT \"EMPNO\", \"ENAME\" FROM \"EMP\" WHERE \"UPDATED\" > 'O''Brien' AND \"UPDATED\" <= 'P'");
+
+	// The column is quoted as an identifier, embedded quotes doubled.
+	mapping.triplesMaps[0]->logicalTable->watermarkColumn = "UP\"DATED";
+	CHECK(table.watermarkBoundQuery() == "SELECT CAST(max(\"UP\"\"DATED\") AS VARCHAR) AS \"upper\" FROM \"EMP\"");
+	CHECK(table.watermarkQuery("1", "2") ==
+	      "SELECT \"EMPNO\", \"ENAME\" FROM \"EMP\" WHERE \"UP\"\"DATED\" > '1' AND \"UP\"\"DATED\" <= '2'");
+
+	mapping.triplesMaps[0]->logicalTable->watermarkColumn.clear();
+	CHECK(table.watermarkBoundQuery().empty());
+	CHECK(table.watermarkQuery("", "1").empty());
+}
+
+TEST_CASE("WatermarkState saves and loads marks") {
+	TempFile file;
+	WatermarkState state;
+	state.load(file.path);
+	CHECK(state.size() == 0);
+
+	state.set("http://example.com/mapping/#Names", "2024-02-01 10:00:00");
+	state.set("odd\tid\\", "line\none");
+	state.save(file.path);
+
+	WatermarkState loaded;
+	loaded.load(file.path);
+	CHECK(loaded.size() == 2);
+	std::string value;
+	REQUIRE(loaded.get("http://example.com/mapping/#Names", value));
+	CHECK(value == "2024-02-01 10:00:00");
+	REQUIRE(loaded.get("odd\tid\\", value));
+	CHECK(value == "line\none");
+	CHECK_FALSE(loaded.get("missing", value));
+
+	file.write("no tab here\n");
+	CHECK_THROWS_AS(loaded.load(file.path), std::runtime_error);
+	file.write("id\tbad \\x escape\n");
+	CHECK_THROWS_AS(loaded.load(file.path), std::runtime_error);
+	CHECK(loaded.size() == 2);
+}
+
+TEST_CASE("Incremental export exports the rows past each mark") {
+	R2RMLMapping mapping = watermarkedMapping();
+	const std::string id = mapping.triplesMaps[0]->id;
+	WatermarkState state;
+	ExportOptions options;
+	options.watermarks = &state;
+
+	SECTION("a first run exports every row up to the highest watermark") {
+		std::vector<std::string> queries;
+		EmpConnection conn("2024-01-31", &queries);
+		std::string output = exportNTriples(mapping, conn, options);
+		CHECK(contains(output, "employee/7369"));
+		CHECK(contains(output, "employee/7499"));
+		CHECK_FALSE(contains(output, "employee/7521"));
+		REQUIRE(queries.size() == 2);
+		CHECK(contains(queries[1], "<= '2024-01-31'"));
+		std::string mark;
+		REQUIRE(state.get(id, mark));
+		CHECK(mark == "2024-01-31");
+	}
+
+	SECTION("a later run exports only the rows above the mark") {
+		state.set(id, "2024-01-31");
+		std::vector<std::string> queries;
+		EmpConnection conn("2024-02-29", &queries);
+		std::string output = exportNTriples(mapping, conn, options);
+		CHECK_FALSE(contains(output, "employee/7369"));
+		CHECK(contains(output, "employee/7499"));
+		REQUIRE(queries.size() == 2);
+		CHECK(contains(queries[1], "\"UPDATED\" > '2024-01-31' AND \"UPDATED\" <= '2024-02-29'"));
+		std::string mark;
+		REQUIRE(state.get(id, mark));
+		CHECK(mark == "2024-02-29");
+	}
+
+	SECTION("a non-integral mark is kept as the database wrote it") {
+		state.set(id, "0.1234567891");
+		std::vector<std::string> queries;
+		EmpConnection conn("0.12345678912345678", &queries);
+		CHECK(contains(exportNTriples(mapping, conn, options), "employee/7499"));
+		REQUIRE(queries.size() == 2);
+		CHECK(contains(queries[0], "CAST(max(\"UPDATED\") AS VARCHAR)"));
+		CHECK(contains(queries[1], "\"UPDATED\" > '0.1234567891' AND \"UPDATED\" <= '0.12345678912345678'"));
+		std::string mark;
+		REQUIRE(state.get(id, mark));
+		CHECK(mark == "0.12345678912345678");
+	}
+
+	SECTION("a marked table without watermarks has nothing new") {
+		state.set(id, "2024-01-31");
+		std::vector<std::string> queries;
+		EmpConnection conn("", &queries);
+		CHECK(exportNTriples(mapping, conn, options).empty());
+		CHECK(queries.size() == 1);
+		std::string mark;
+		REQUIRE(state.get(id, mark));
+		CHECK(mark == "2024-01-31");
+	}
+
+	SECTION("an unmarked table without watermarks exports nothing") {
+		std::vector<std::string> queries;
+		EmpConnection conn("", &queries);
+		CHECK(exportNTriples(mapping, conn, options).empty());
+		CHECK(queries.size() == 1);
+		CHECK(state.size() == 0);
+	}
+
+	SECTION("rows with a null watermark are left out of first and later runs alike") {
+		EmpTable table;
+		table.rows = {{7369, "2024-01-15"}, {7499, ""}};
+		CHECK(exportNTriples(mapping, table, options) == employee(7369));
+		// A null watermark and a newer one arrive between the runs.
+		table.rows.push_back({7521, ""});
+		table.rows.push_back({7566, "2024-02-10"});
+		CHECK(exportNTriples(mapping, table, options) == employee(7566));
+		CHECK(exportNTriples(mapping, table, options).empty());
+	}
+
+	SECTION("a table whose watermarks are all null is taken up once one is set") {
+		EmpTable table;
+		table.rows = {{7369, ""}, {7499, ""}};
+		CHECK(exportNTriples(mapping, table, options).empty());
+		CHECK(exportNTriples(mapping, table, options).empty());
+		table.rows.push_back({7521, "2024-02-10"});
+		CHECK(exportNTriples(mapping, table, options) == employee(7521));
+		std::string mark;
+		REQUIRE(state.get(id, mark));
+		CHECK(mark == "2024-02-10");
+	}
+
+	SECTION("without watermarks the column is ignored") {
+		std::vector<std::string> queries;
+		EmpConnection conn("2024-01-31", &queries);
+		std::string output = exportNTriples(mapping, conn, ExportOptions());
+		CHECK(contains(output, "employee/7521"));
+		REQUIRE(queries.size() == 1);
+		CHECK_FALSE(contains(queries[0], "UPDATED"));
+		CHECK(state.size() == 0);
+	}
+}
+
+TEST_CASE("Incremental export doesn't partition watermarked tables") {
+	R2RMLMapping mapping = watermarkedMapping();
+	const std::string id = mapping.triplesMaps[0]->id;
+	WatermarkState state;
+	state.set(id, "2024-01-31");
+	ExportOptions options;
+	options.watermarks = &state;
+	options.threads = 2;
+	options.partitions = 3;
+	r2rml::ConnectionFactory connect = []() {
+		return std::unique_ptr<SQLConnection>(new EmpConnection("2024-02-29"));
+	};
+	std::string output;
+	mapping.processDatabase(connect, SERD_NTRIPLES, (SerdStyle)0, appendToString, &output, options);
+	CHECK_FALSE(contains(output, "employee/7369"));
+	CHECK(contains(output, "employee/7499"));
+	std::string mark;
+	REQUIRE(state.get(id, mark));
+	CHECK(mark == "2024-02-29");
+}
@@ -0,0 +1,434 @@
+/**
+ * Tests for rr:refObjectMap evaluation during export: JoinIndex must match
+ * exactly what ReferencingObjectMap::getJoinedRows() selects,
+ * processDatabase() must scan each parent once per join column list while
+ * producing the same triples as re-querying the parent per child row, and
+ * the pushDownJoins mode must produce those triples from SQL joins.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <serd/serd.h>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "r2rml/BaseTableOrView.h"
+#include "r2rml/ExportOptions.h"
+#include "r2rml/ExportReport.h"
+#include "r2rml/GraphMap.h"
+#include "r2rml/JoinIndex.h"
+#include "r2rml/LogicalTable.h"
+#include "r2rml/MapSQLRow.h"
+#include "r2rml/PredicateObjectMap.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/R2RMLParser.h"
+#include "r2rml/R2RMLView.h"
+#include "r2rml/ReferencingObjectMap.h"
+#include "r2rml/SQLResultSet.h"
+#include "r2rml/SQLRow.h"
+#include "r2rml/SQLValue.h"
+#include "r2rml/StringSQLValue.h"
+#include "r2rml/TriplesMap.h"
+#include "MockSQL.h"
+
+using r2rml::ExportReport;
+using r2rml::JoinIndex;
+using r2rml::JoinIndexCache;
+using r2rml::R2RMLMapping;
+using r2rml::R2RMLParser;
+using r2rml::ReferencingObjectMap;
+using r2rml::StringSQLValue;
+using r2rml::testing::makeRow;
+using r2rml::testing::MockSQLConnection;
+
+namespace {
+
+// Counts the queries that hit the DEPT table.
+class CountingConnection : public MockSQLConnection {
+public:
+	std::unique_ptr<r2rml::SQLResultSet> execute(const std::string &query) override {
+		if (query.find("\"DEPT\"") != std::string::npos) {
+			++deptQueries;
+		}
+		return MockSQLConnection::execute(query);
+	}
+
+	int deptQueries {0};
+};
+
+// Counts the queries sent while an earlier result set is still open, which a
+// streaming backend could only answer by buffering that result.
+class OneResultConnection : public MockSQLConnection {
+public:
+	std::unique_ptr<r2rml::SQLResultSet> execute(const std::string &query) override {
+		if (open > 0) {
+			++overlapping;
+		}
+		return std::unique_ptr<r2rml::SQLResultSet>(new Result(MockSQLConnection::execute(query), open));
+	}
+
+	int open {0};
+	int overlapping {0};
+
+private:
+	class Result : public r2rml::SQLResultSet {
+	public:
+		Result(std::unique_ptr<r2rml::SQLResultSet> rows, int &open) : rows_(std::move(rows)), open_(open) {
+			++open_;
+		}
+
+		~Result() override {
+			--open_;
+		}
+
+		bool next() override {
+			return rows_->next();
+		}
+
+		const r2rml::SQLRow &getCurrentRow() const override {
+			return rows_->getCurrentRow();
+		}
+
+	private:
+		std::unique_ptr<r2rml::SQLResultSet> rows_;
+		int &open_;
+	};
+};
+
+std::vector<r2rml::MapSQLRow> deptRows() {
+	return {makeRow({{"DEPTNO", StringSQLValue(10)}, {"DNAME", StringSQLValue(std::string("A"))}}),
+	        makeRow({{"DEPTNO", StringSQLValue(20)}, {"DNAME", StringSQLValue(std::string("B"))}}),
+	        makeRow({{"DEPTNO", StringSQLValue(10)}, {"DNAME", StringSQLValue(std::string("C"))}}),
+	        makeRow({{"DEPTNO", StringSQLValue()}, {"DNAME", StringSQLValue(std::string("D"))}})};
+}
+
+std::vector<r2rml::MapSQLRow> empRows() {
+	return {makeRow({{"EMPNO", StringSQLValue(1)},
+	                 {"DEPTNO", StringSQLValue(10)},
+	                 {"UNIT", StringSQLValue(std::string("B"))}}),
+	        makeRow({{"EMPNO", StringSQLValue(2)}, {"DEPTNO", StringSQLValue(20)}}),
+	        makeRow({{"EMPNO", StringSQLValue(3)}, {"DEPTNO", StringSQLValue()}}),
+	        makeRow({{"EMPNO", StringSQLValue(4)},
+	                 {"DEPTNO", StringSQLValue(10)},
+	                 {"UNIT", StringSQLValue(std::string("D"))}})};
+}
+
+void addDept(MockSQLConnection &conn) {
+	conn.addResult("\"DEPT\"", deptRows());
+}
+
+// What ReferencingObjectMap::joinQuery() returns for EMP joined to DEPT on
+// childCol = parentCol (no condition when childCol is empty): every EMP
+// column plus DEPT's DNAME, the parent subject's only input, as __PARENT_DNAME.
+std::vector<r2rml::MapSQLRow> joinedRows(const std::string &childCol, const std::string &parentCol) {
+	std::vector<r2rml::MapSQLRow> joined;
+	for (const auto &child : empRows()) {
+		for (const auto &parent : deptRows()) {
+			if (!childCol.empty()) {
+				auto c = child.getValue(childCol);
+				auto p = parent.getValue(parentCol);
+				if (c->isNull() || p->isNull() || c->asString() != p->asString()) {
+					continue;
+				}
+			}
+			std::map<std::string, std::unique_ptr<r2rml::SQLValue>> values;
+			for (const std::string &name : child.columnNames()) {
+				values[name] = child.getValue(name);
+			}
+			values["__PARENT_DNAME"] = parent.getValue("DNAME");
+			joined.push_back(r2rml::MapSQLRow(std::move(values)));
+		}
+	}
+	return joined;
+}
+
+std::vector<std::string> sortedLines(const std::string &text) {
+	std::vector<std::string> lines;
+	std::istringstream in(text);
+	std::string line;
+	while (std::getline(in, line)) {
+		lines.push_back(line);
+	}
+	std::sort(lines.begin(), lines.end());
+	return lines;
+}
+
+std::string nodeString(const SerdNode &node) {
+	return std::string(reinterpret_cast<const char *>(node.buf), node.n_bytes);
+}
+
+std::string captureNTriples(const std::function<void(SerdWriter &)> &produce) {
+	SerdChunk chunk {nullptr, 0};
+	SerdEnv *env = serd_env_new(nullptr);
+	SerdWriter *writer = serd_writer_new(SERD_NTRIPLES, (SerdStyle)0, env, nullptr, serd_chunk_sink, &chunk);
+	produce(*writer);
+	serd_writer_finish(writer);
+	uint8_t *raw = serd_chunk_sink_finish(&chunk);
+	std::string result;
+	if (raw) {
+		result = std::string(reinterpret_cast<const char *>(raw));
+		serd_free(raw);
+	}
+	serd_writer_free(writer);
+	serd_env_free(env);
+	return result;
+}
+
+// Two rr:refObjectMaps joining DEPT on DEPTNO, one joining it on DNAME and
+// one without a join condition.
+const char *kJoinMapping = "@prefix rr: <http://www.w3.org/ns/r2rml#>.\n"
+                           "@prefix ex: <http://example.com/ns#>.\n"
+                           "<#Dept>\n"
+                           "    rr:logicalTable [ rr:tableName \"DEPT\" ];\n"
+                           "    rr:subjectMap [ rr:template \"http://data.example.com/dept/{DNAME}\" ].\n"
+                           "<#Emp>\n"
+                           "    rr:logicalTable [ rr:tableName \"EMP\" ];\n"
+                           "    rr:subjectMap [ rr:template \"http://data.example.com/emp/{EMPNO}\" ];\n"
+                           "    rr:predicateObjectMap [\n"
+                           "        rr:predicate ex:department;\n"
+                           "        rr:objectMap [ rr:parentTriplesMap <#Dept>;\n"
+                           "            rr:joinCondition [ rr:child \"DEPTNO\"; rr:parent \"DEPTNO\" ] ];\n"
+                           "    ];\n"
+                           "    rr:predicateObjectMap [\n"
+                           "        rr:predicate ex:worksIn;\n"
+                           "        rr:objectMap [ rr:parentTriplesMap <#Dept>;\n"
+                           "            rr:joinCondition [ rr:child \"DEPTNO\"; rr:parent \"DEPTNO\" ] ];\n"
+                           "    ];\n"
+                           "    rr:predicateObjectMap [\n"
+                           "        rr:predicate ex:unit;\n"
+                           "        rr:objectMap [ rr:parentTriplesMap <#Dept>;\n"
+                           "            rr:joinCondition [ rr:child \"UNIT\"; rr:parent \"DNAME\" ] ];\n"
+                           "    ];\n"
+                           "    rr:predicateObjectMap [\n"
+                           "        rr:predicate ex:anyDept;\n"
+                           "        rr:objectMap [ rr:parentTriplesMap <#Dept> ];\n"
+                           "    ].\n";
+
+// The rr:refObjectMap of the i-th predicate-object map of <#Emp>.
+const ReferencingObjectMap &refObjectMap(const R2RMLMapping &mapping, std::size_t i) {
+	for (const auto &tm : mapping.triplesMaps) {
+		if (tm->id == "http://example.com/mapping/#Emp") {
+			return dynamic_cast<const ReferencingObjectMap &>(*tm->predicateObjectMaps.at(i)->objectMaps.at(0));
+		}
+	}
+	throw std::runtime_error("no <#Emp> TriplesMap");
+}
+
+} // namespace
+
+TEST_CASE("JoinIndex selects the same parent rows as getJoinedRows") {
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(kJoinMapping, "http://example.com/mapping/");
+	REQUIRE(mapping.isValid());
+	const ReferencingObjectMap &rom = refObjectMap(mapping, 0);
+
+	MockSQLConnection conn;
+	addDept(conn);
+	SerdEnv *env = serd_env_new(nullptr);
+	JoinIndex index(rom, conn, *env);
+	// The parent row with a null DEPTNO can never match and is not indexed.
+	CHECK(index.size() == 3);
+
+	std::vector<r2rml::MapSQLRow> children;
+	children.push_back(makeRow({{"DEPTNO", StringSQLValue(10)}}));
+	children.push_back(makeRow({{"DEPTNO", StringSQLValue(20)}}));
+	children.push_back(makeRow({{"DEPTNO", StringSQLValue(30)}}));
+	children.push_back(makeRow({{"DEPTNO", StringSQLValue()}}));
+	children.push_back(makeRow({{"OTHER", StringSQLValue(10)}}));
+
+	for (const auto &child : children) {
+		std::vector<std::string> expected;
+		auto joined = rom.getJoinedRows(conn, child);
+		REQUIRE(joined != nullptr);
+		while (joined->next()) {
+			expected.push_back(nodeString(rom.generateRDFTerm(child, joined->getCurrentRow(), *env)));
+		}
+
+		std::vector<std::string> actual;
+		const std::vector<std::size_t> *matches = index.probe(rom, child);
+		if (matches) {
+			for (std::size_t m : *matches) {
+				actual.push_back(nodeString(index.subject(m)));
+			}
+		}
+		CHECK(actual == expected);
+	}
+	CHECK(index.probes() == children.size());
+
+	// DEPTNO=10 matches two parent rows, in parent-table order.
+	const std::vector<std::size_t> *ten = index.probe(rom, children[0]);
+	REQUIRE(ten != nullptr);
+	REQUIRE(ten->size() == 2);
+	CHECK(nodeString(index.subject((*ten)[0])) == "http://data.example.com/dept/A");
+	CHECK(nodeString(index.subject((*ten)[1])) == "http://data.example.com/dept/C");
+
+	// Without join conditions every parent row with a subject matches.
+	const ReferencingObjectMap &cross = refObjectMap(mapping, 3);
+	JoinIndex all(cross, conn, *env);
+	const std::vector<std::size_t> *everything = all.probe(cross, children[2]);
+	REQUIRE(everything != nullptr);
+	CHECK(everything->size() == 4);
+
+	serd_env_free(env);
+}
+
+TEST_CASE("JoinIndexCache shares one index per parent and parent column list") {
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(kJoinMapping, "http://example.com/mapping/");
+	REQUIRE(mapping.isValid());
+	const ReferencingObjectMap &a = refObjectMap(mapping, 0);
+	const ReferencingObjectMap &b = refObjectMap(mapping, 1);
+	const ReferencingObjectMap &c = refObjectMap(mapping, 2);
+
+	CountingConnection conn;
+	addDept(conn);
+	SerdEnv *env = serd_env_new(nullptr);
+	JoinIndexCache cache;
+	CHECK(&cache.get(a, conn, *env) == &cache.get(b, conn, *env));
+	CHECK(&cache.get(a, conn, *env) != &cache.get(c, conn, *env));
+	CHECK(cache.builds() == 2);
+	CHECK(conn.deptQueries == 2);
+
+	auto child = makeRow({{"DEPTNO", StringSQLValue(20)}});
+	JoinIndex &index = cache.get(b, conn, *env);
+	const std::vector<std::size_t> *matches = index.probe(b, child);
+	REQUIRE(matches != nullptr);
+	REQUIRE(matches->size() == 1);
+	CHECK(nodeString(index.subject(matches->front())) == "http://data.example.com/dept/B");
+	CHECK(cache.probes() == 1);
+	serd_env_free(env);
+}
+
+TEST_CASE("processDatabase joins through a shared index with unchanged output") {
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(kJoinMapping, "http://example.com/mapping/");
+	REQUIRE(mapping.isValid());
+
+	CountingConnection conn;
+	addDept(conn);
+	conn.addResult("\"EMP\"", empRows());
+
+	// Reference output: every child row re-queries the parent.
+	std::string expected = captureNTriples([&](SerdWriter &writer) {
+		for (const auto &tm : mapping.triplesMaps) {
+			auto rows = tm->logicalTable->getRows(conn);
+			while (rows->next()) {
+				tm->generateTriples(rows->getCurrentRow(), writer, mapping, conn);
+			}
+		}
+	});
+	REQUIRE(expected.find("<http://data.example.com/emp/1> <http://example.com/ns#worksIn> "
+	                      "<http://data.example.com/dept/C>") != std::string::npos);
+	REQUIRE(expected.find("<http://data.example.com/emp/4> <http://example.com/ns#unit> "
+	                      "<http://data.example.com/dept/D>") != std::string::npos);
+
+	conn.deptQueries = 0;
+	ExportReport report;
+	std::string actual = captureNTriples([&](SerdWriter &writer) { mapping.processDatabase(conn, writer, &report); });
+	CHECK(actual == expected);
+
+	// One scan of DEPT for <#Dept> itself plus one per parent column list;
+	// the two DEPTNO joins share an index.
+	CHECK(conn.deptQueries == 4);
+	CHECK(report.joinIndexBuilds == 3);
+	CHECK(report.joinIndexProbes == 4 * 4);
+}
+
+TEST_CASE("processDatabase probes each child row once however many predicates share the join") {
+	const char *mappingText = "@prefix rr: <http://www.w3.org/ns/r2rml#>.\n"
+	                          "@prefix ex: <http://example.com/ns#>.\n"
+	                          "<#Dept>\n"
+	                          "    rr:logicalTable [ rr:tableName \"DEPT\" ];\n"
+	                          "    rr:subjectMap [ rr:template \"http://data.example.com/dept/{DNAME}\" ].\n"
+	                          "<#Emp>\n"
+	                          "    rr:logicalTable [ rr:tableName \"EMP\" ];\n"
+	                          "    rr:subjectMap [ rr:template \"http://data.example.com/emp/{EMPNO}\" ];\n"
+	                          "    rr:predicateObjectMap [\n"
+	                          "        rr:predicate ex:department, ex:worksIn;\n"
+	                          "        rr:objectMap [ rr:parentTriplesMap <#Dept>;\n"
+	                          "            rr:joinCondition [ rr:child \"DEPTNO\"; rr:parent \"DEPTNO\" ] ];\n"
+	                          "    ].\n";
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(mappingText, "http://example.com/mapping/");
+	REQUIRE(mapping.isValid());
+	CountingConnection conn;
+	addDept(conn);
+	conn.addResult("\"EMP\"", empRows());
+
+	ExportReport report;
+	std::string output = captureNTriples([&](SerdWriter &writer) { mapping.processDatabase(conn, writer, &report); });
+	CHECK(output.find("<http://data.example.com/emp/1> <http://example.com/ns#department> "
+	                  "<http://data.example.com/dept/C>") != std::string::npos);
+	CHECK(output.find("<http://data.example.com/emp/1> <http://example.com/ns#worksIn> "
+	                  "<http://data.example.com/dept/C>") != std::string::npos);
+	CHECK(report.joinIndexProbes == 4);
+}
+
+TEST_CASE("processDatabase builds the parent indexes before opening the child rows") {
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(kJoinMapping, "http://example.com/mapping/");
+	REQUIRE(mapping.isValid());
+
+	OneResultConnection conn;
+	addDept(conn);
+	conn.addResult("\"EMP\"", empRows());
+	ExportReport report;
+	std::string output = captureNTriples([&](SerdWriter &writer) { mapping.processDatabase(conn, writer, &report); });
+	CHECK(output.find("<http://data.example.com/emp/4> <http://example.com/ns#unit> "
+	                  "<http://data.example.com/dept/D>") != std::string::npos);
+	CHECK(report.joinIndexBuilds == 3);
+	CHECK(conn.overlapping == 0);
+	CHECK(conn.open == 0);
+}
+
+TEST_CASE("ReferencingObjectMap::joinQuery renders the R2RML joint SQL query") {
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(kJoinMapping, "http://example.com/mapping/");
+	REQUIRE(mapping.isValid());
+	r2rml::BaseTableOrView child("EMP");
+	CHECK(refObjectMap(mapping, 0).joinQuery(child) ==
+	      "SELECT child.*, parent.\"DNAME\" AS \"__PARENT_DNAME\" FROM (\nSELECT * FROM \"EMP\"\n) AS child"
+	      " JOIN (\nSELECT \"DNAME\", \"DEPTNO\" FROM \"DEPT\"\n) AS parent ON child.\"DEPTNO\" = parent.\"DEPTNO\"");
+	CHECK(refObjectMap(mapping, 3).joinQuery(child) ==
+	      "SELECT child.*, parent.\"DNAME\" AS \"__PARENT_DNAME\" FROM (\nSELECT * FROM \"EMP\"\n) AS child"
+	      " CROSS JOIN (\nSELECT \"DNAME\", \"DEPTNO\" FROM \"DEPT\"\n) AS parent");
+
+	// An rr:sqlQuery child loses its trailing semicolon inside the subquery.
+	r2rml::R2RMLView view("SELECT EMPNO, DEPTNO FROM EMP WHERE DEPTNO > 0;\n");
+	CHECK(refObjectMap(mapping, 0).joinQuery(view).find("FROM (\nSELECT EMPNO, DEPTNO FROM EMP WHERE DEPTNO > 0\n) AS "
+	                                                    "child") != std::string::npos);
+}
+
+TEST_CASE("processDatabase with pushDownJoins evaluates rr:refObjectMaps as SQL joins") {
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(kJoinMapping, "http://example.com/mapping/");
+	REQUIRE(mapping.isValid());
+
+	CountingConnection conn;
+	addDept(conn);
+	conn.addResult("\"EMP\"", empRows());
+	conn.addResult("ON child.\"DEPTNO\" = parent.\"DEPTNO\"", joinedRows("DEPTNO", "DEPTNO"));
+	conn.addResult("ON child.\"UNIT\" = parent.\"DNAME\"", joinedRows("UNIT", "DNAME"));
+	conn.addResult("CROSS JOIN", joinedRows("", ""));
+
+	std::string expected = captureNTriples([&](SerdWriter &writer) { mapping.processDatabase(conn, writer); });
+
+	r2rml::ExportOptions options;
+	options.pushDownJoins = true;
+	ExportReport report;
+	std::string actual =
+	    captureNTriples([&](SerdWriter &writer) { mapping.processDatabase(conn, writer, options, &report); });
+
+	// Same triples; a pushed-down join's are written after the rest of its
+	// TriplesMap's, so only the order differs.
+	CHECK(sortedLines(actual) == sortedLines(expected));
+	CHECK(report.joinQueries == 4);
+	CHECK(report.joinIndexBuilds == 0);
+	CHECK(report.joinIndexProbes == 0);
+}
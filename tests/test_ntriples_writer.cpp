@@ -0,0 +1,247 @@
+/**
+ * Tests for NTriplesWriter: N-Triples/N-Quads formatting and escaping as
+ * SerdWriter does it, buffering, errors, and exporting a mapping through it
+ * with the same output as through a SerdWriter.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <serd/serd.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#ifndef SOURCE_R2RML_DIR
+#define SOURCE_R2RML_DIR ""
+#endif
+
+#include "r2rml/NTriplesWriter.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/R2RMLParser.h"
+#include "r2rml/SQLConnection.h"
+#include "MockSQL.h"
+
+using r2rml::NTriplesWriter;
+using r2rml::testing::appendToString;
+using r2rml::testing::empDeptConnection;
+using r2rml::testing::MockSQLConnection;
+
+namespace {
+
+size_t refuse(const void * /*buf*/, size_t /*len*/, void * /*stream*/) {
+	return 0;
+}
+
+SerdNode uri(const char *s) {
+	return serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>(s));
+}
+
+SerdNode literal(const char *s) {
+	return serd_node_from_string(SERD_LITERAL, reinterpret_cast<const uint8_t *>(s));
+}
+
+SerdNode blank(const char *s) {
+	return serd_node_from_string(SERD_BLANK, reinterpret_cast<const uint8_t *>(s));
+}
+
+// One N-Triples line for a literal object `text`.
+std::string literalLine(const char *text) {
+	std::string out;
+	{
+		NTriplesWriter writer(SERD_NTRIPLES, nullptr, appendToString, &out);
+		SerdNode s = uri("http://ex.com/s");
+		SerdNode p = uri("http://ex.com/p");
+		SerdNode o = literal(text);
+		writer.write(nullptr, s, p, o, nullptr, nullptr);
+	}
+	return out;
+}
+
+// One N-Triples line for an IRI object `iri`.
+std::string uriLine(const char *iri) {
+	std::string out;
+	{
+		NTriplesWriter writer(SERD_NTRIPLES, nullptr, appendToString, &out);
+		SerdNode s = uri("http://ex.com/s");
+		SerdNode p = uri("http://ex.com/p");
+		SerdNode o = uri(iri);
+		writer.write(nullptr, s, p, o, nullptr, nullptr);
+	}
+	return out;
+}
+
+} // namespace
+
+TEST_CASE("NTriplesWriter formats statements") {
+	SerdNode s = uri("http://ex.com/s");
+	SerdNode p = uri("http://ex.com/p");
+	SerdNode g = uri("http://ex.com/g");
+	SerdNode b = blank("b0");
+	SerdNode o = literal("hello");
+	SerdNode dt = uri("http://www.w3.org/2001/XMLSchema#integer");
+	SerdNode lang = literal("en");
+	SerdNode n = literal("42");
+
+	SECTION("N-Triples leaves out graphs") {
+		std::string out;
+		NTriplesWriter writer(SERD_NTRIPLES, nullptr, appendToString, &out);
+		writer.write(&g, s, p, o, nullptr, &lang);
+		writer.write(nullptr, b, p, n, &dt, nullptr);
+		writer.write(nullptr, s, p, b, nullptr, nullptr);
+		CHECK(out.empty()); // still buffered
+		writer.flush();
+		CHECK(out == "<http://ex.com/s> <http://ex.com/p> \"hello\"@en .\n"
+		             "_:b0 <http://ex.com/p> \"42\"^^<http://www.w3.org/2001/XMLSchema#integer> .\n"
+		             "<http://ex.com/s> <http://ex.com/p> _:b0 .\n");
+	}
+
+	SECTION("N-Quads writes them after the object") {
+		std::string out;
+		{
+			NTriplesWriter writer(SERD_NQUADS, nullptr, appendToString, &out);
+			writer.write(&g, s, p, o, nullptr, nullptr);
+			writer.write(nullptr, s, p, o, nullptr, nullptr);
+		}
+		CHECK(out == "<http://ex.com/s> <http://ex.com/p> \"hello\" <http://ex.com/g> .\n"
+		             "<http://ex.com/s> <http://ex.com/p> \"hello\" .\n");
+	}
+}
+
+TEST_CASE("NTriplesWriter escapes literals like SerdWriter") {
+	CHECK(literalLine("plain") == "<http://ex.com/s> <http://ex.com/p> \"plain\" .\n");
+	CHECK(literalLine("say \"hi\"\\\n\r\t") ==
+	      "<http://ex.com/s> <http://ex.com/p> \"say \\\"hi\\\"\\\\\\n\\r\\t\" .\n");
+	CHECK(literalLine("bell\x07 del\x7F") == "<http://ex.com/s> <http://ex.com/p> \"bell\\u0007 del\\u007F\" .\n");
+	// UTF-8 is copied; bytes that aren't become U+FFFD, continuation bytes and all.
+	CHECK(literalLine("M\xC3\xBCnchen") == "<http://ex.com/s> <http://ex.com/p> \"M\xC3\xBCnchen\" .\n");
+	CHECK(literalLine("a\xFF\x80\x80z") == "<http://ex.com/s> <http://ex.com/p> \"a\xEF\xBF\xBDz\" .\n");
+	CHECK(literalLine("cut \xE6\x9D") == "<http://ex.com/s> <http://ex.com/p> \"cut \xEF\xBF\xBD\" .\n");
+	// Escapes past the first sixteen bytes, where the vector scan finds them.
+	CHECK(literalLine("0123456789abcdefghij\"klmnopqrstuvwxyz0123456789\n") ==
+	      "<http://ex.com/s> <http://ex.com/p> \"0123456789abcdefghij\\\"klmnopqrstuvwxyz0123456789\\n\" .\n");
+}
+
+TEST_CASE("NTriplesWriter escapes IRIs like SerdWriter") {
+	CHECK(uriLine("http://ex.com/a~b_c-d.e?f=g&h#i") ==
+	      "<http://ex.com/s> <http://ex.com/p> <http://ex.com/a~b_c-d.e?f=g&h#i> .\n");
+	CHECK(uriLine("http://ex.com/a b") == "<http://ex.com/s> <http://ex.com/p> <http://ex.com/a\\u0020b> .\n");
+	CHECK(uriLine("http://ex.com/0123456789/{x}|<y>^`\\\"") ==
+	      "<http://ex.com/s> <http://ex.com/p> <http://ex.com/0123456789/\\u007Bx\\u007D\\u007C\\u003Cy\\u003E"
+	      "\\u005E\\u0060\\u005C\\u0022> .\n");
+	CHECK(uriLine("http://ex.com/M\xC3\xBCnchen/\xFF") ==
+	      "<http://ex.com/s> <http://ex.com/p> <http://ex.com/M\xC3\xBCnchen/\xEF\xBF\xBD> .\n");
+}
+
+TEST_CASE("NTriplesWriter resolves names through the environment") {
+	SerdNode base = uri("http://ex.com/base/");
+	SerdEnv *env = serd_env_new(&base);
+	SerdNode name = literal("ex");
+	SerdNode ns = uri("http://ex.com/ns#");
+	serd_env_set_prefix(env, &name, &ns);
+
+	SerdNode s = uri("http://ex.com/s");
+	SerdNode relative = uri("thing");
+	SerdNode curie = serd_node_from_string(SERD_CURIE, reinterpret_cast<const uint8_t *>("ex:name"));
+	SerdNode undefined = serd_node_from_string(SERD_CURIE, reinterpret_cast<const uint8_t *>("nope:name"));
+	SerdNode o = literal("x");
+
+	std::string out;
+	{
+		NTriplesWriter writer(SERD_NTRIPLES, env, appendToString, &out);
+		writer.write(nullptr, s, curie, o, nullptr, nullptr);
+		writer.write(nullptr, s, curie, relative, nullptr, nullptr); // written as-is, as SerdWriter does
+		CHECK_THROWS_AS(writer.write(nullptr, s, undefined, o, nullptr, nullptr), std::runtime_error);
+	}
+	CHECK(out == "<http://ex.com/s> <http://ex.com/ns#name> \"x\" .\n"
+	             "<http://ex.com/s> <http://ex.com/ns#name> <thing> .\n");
+
+	// Without a base URI a relative IRI can't be written.
+	std::string none;
+	NTriplesWriter writer(SERD_NTRIPLES, nullptr, appendToString, &none);
+	CHECK_THROWS_AS(writer.write(nullptr, s, s, relative, nullptr, nullptr), std::runtime_error);
+	serd_env_free(env);
+}
+
+TEST_CASE("NTriplesWriter rejects what SerdWriter rejects") {
+	SerdNode s = uri("http://ex.com/s");
+	SerdNode o = literal("x");
+	std::string out;
+	NTriplesWriter writer(SERD_NTRIPLES, nullptr, appendToString, &out);
+	writer.write(nullptr, s, s, o, nullptr, nullptr);
+	CHECK_THROWS_AS(writer.write(nullptr, o, s, o, nullptr, nullptr), std::runtime_error);
+	CHECK_THROWS_AS(writer.write(nullptr, s, o, o, nullptr, nullptr), std::runtime_error);
+	CHECK_THROWS_AS(writer.write(nullptr, s, s, SERD_NODE_NULL, nullptr, nullptr), std::runtime_error);
+	SerdNode relative = uri("thing");
+	CHECK_THROWS_AS(writer.write(nullptr, s, s, relative, nullptr, nullptr), std::runtime_error);
+	writer.flush();
+	// Failed statements leave nothing half-written behind.
+	CHECK(out == "<http://ex.com/s> <http://ex.com/s> \"x\" .\n");
+
+	CHECK_THROWS_AS(NTriplesWriter(SERD_TURTLE, nullptr, appendToString, &out), std::invalid_argument);
+}
+
+TEST_CASE("NTriplesWriter flushes when its buffer fills") {
+	SerdNode s = uri("http://ex.com/s");
+	SerdNode p = uri("http://ex.com/p");
+	SerdNode o = literal("x");
+	const std::string line = "<http://ex.com/s> <http://ex.com/p> \"x\" .\n";
+
+	std::string out;
+	NTriplesWriter writer(SERD_NTRIPLES, nullptr, appendToString, &out, 2 * line.size());
+	writer.write(nullptr, s, p, o, nullptr, nullptr);
+	CHECK(out.empty());
+	writer.write(nullptr, s, p, o, nullptr, nullptr);
+	CHECK(out == line + line);
+	writer.write(nullptr, s, p, o, nullptr, nullptr);
+	CHECK(out.size() == 2 * line.size());
+	writer.flush();
+	CHECK(out == line + line + line);
+
+	NTriplesWriter failing(SERD_NTRIPLES, nullptr, refuse, nullptr);
+	failing.write(nullptr, s, p, o, nullptr, nullptr);
+	CHECK_THROWS_AS(failing.flush(), std::runtime_error);
+}
+
+TEST_CASE("NTriplesWriter re-serializes a reused predicate buffer") {
+	char predicate[] = "http://ex.com/p1";
+	SerdNode s = uri("http://ex.com/s");
+	SerdNode p = uri(predicate);
+	SerdNode o = literal("x");
+	std::string out;
+	{
+		NTriplesWriter writer(SERD_NTRIPLES, nullptr, appendToString, &out);
+		writer.write(nullptr, s, p, o, nullptr, nullptr);
+		writer.write(nullptr, s, p, o, nullptr, nullptr);
+		predicate[15] = '2'; // same address and length, different IRI
+		writer.write(nullptr, s, p, o, nullptr, nullptr);
+	}
+	CHECK(out == "<http://ex.com/s> <http://ex.com/p1> \"x\" .\n"
+	             "<http://ex.com/s> <http://ex.com/p1> \"x\" .\n"
+	             "<http://ex.com/s> <http://ex.com/p2> \"x\" .\n");
+}
+
+TEST_CASE("Exporting through NTriplesWriter matches SerdWriter") {
+	r2rml::R2RMLParser parser;
+	r2rml::R2RMLMapping mapping = parser.parse(SOURCE_R2RML_DIR "example_emp_dept.ttl");
+	REQUIRE(mapping.isValid());
+	std::unique_ptr<MockSQLConnection> conn = empDeptConnection();
+
+	for (SerdSyntax syntax : {SERD_NTRIPLES, SERD_NQUADS}) {
+		SerdChunk chunk {nullptr, 0};
+		SerdWriter *serdWriter =
+		    serd_writer_new(syntax, (SerdStyle)0, mapping.serdEnvironment, nullptr, serd_chunk_sink, &chunk);
+		mapping.processDatabase(*conn, *serdWriter);
+		serd_writer_finish(serdWriter);
+		uint8_t *raw = serd_chunk_sink_finish(&chunk);
+		std::string expected = raw ? std::string(reinterpret_cast<const char *>(raw)) : std::string();
+		serd_free(raw);
+		serd_writer_free(serdWriter);
+		REQUIRE_FALSE(expected.empty());
+
+		std::string out;
+		NTriplesWriter writer(syntax, mapping.serdEnvironment, appendToString, &out);
+		mapping.processDatabase(*conn, writer, r2rml::ExportOptions());
+		writer.flush();
+		CHECK(out == expected);
+	}
+}
@@ -0,0 +1,265 @@
+/**
+ * Tests for the parallel R2RMLMapping::processDatabase() overload: whatever
+ * the thread count, its N-Triples output must be byte-for-byte that of the
+ * single-threaded export, and worker errors must reach the caller.  Also
+ * covers partitioned logical tables (ExportOptions::partitions).
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <serd/serd.h>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#ifndef SOURCE_R2RML_DIR
+#define SOURCE_R2RML_DIR ""
+#endif
+
+#include "r2rml/BaseTableOrView.h"
+#include "r2rml/ExportOptions.h"
+#include "r2rml/ExportReport.h"
+#include "r2rml/LogicalTable.h"
+#include "r2rml/MapSQLRow.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/R2RMLParser.h"
+#include "r2rml/R2RMLView.h"
+#include "r2rml/SQLConnection.h"
+#include "r2rml/StringSQLValue.h"
+#include "r2rml/TriplesMap.h"
+#include "MockSQL.h"
+
+using r2rml::BaseTableOrView;
+using r2rml::ExportOptions;
+using r2rml::ExportReport;
+using r2rml::R2RMLMapping;
+using r2rml::R2RMLParser;
+using r2rml::R2RMLView;
+using r2rml::SQLConnection;
+using r2rml::StringSQLValue;
+using r2rml::testing::appendToString;
+using r2rml::testing::empDeptConnection;
+using r2rml::testing::makeRow;
+using r2rml::testing::MockSQLConnection;
+
+namespace {
+
+std::string sequentialExport(R2RMLMapping &mapping, ExportReport &report) {
+	std::unique_ptr<SQLConnection> conn = empDeptConnection();
+	SerdChunk chunk {nullptr, 0};
+	SerdWriter *writer =
+	    serd_writer_new(SERD_NTRIPLES, (SerdStyle)0, mapping.serdEnvironment, nullptr, serd_chunk_sink, &chunk);
+	mapping.processDatabase(*conn, *writer, &report);
+	serd_writer_finish(writer);
+	uint8_t *raw = serd_chunk_sink_finish(&chunk);
+	std::string result = raw ? std::string(reinterpret_cast<const char *>(raw)) : std::string();
+	serd_free(raw);
+	serd_writer_free(writer);
+	return result;
+}
+
+const char *const EMP_MAPPING = R"(
+@prefix rr: <http://www.w3.org/ns/r2rml#>.
+@prefix ex: <http://example.com/ns#>.
+<#Emp>
+    rr:logicalTable [ rr:tableName "EMP" ];
+    rr:subjectMap [ rr:template "http://data.example.com/employee/{EMPNO}" ];
+    rr:predicateObjectMap [ rr:predicate ex:name; rr:objectMap [ rr:column "ENAME" ] ].
+)";
+
+r2rml::MapSQLRow employee(int empno, const char *ename) {
+	return makeRow({{"EMPNO", StringSQLValue(empno)}, {"ENAME", StringSQLValue(std::string(ename))}});
+}
+
+// EMP with rowids 1..5, answering the bounds query and two- or three-way
+// rowid range queries.
+std::unique_ptr<SQLConnection> partitionedEmpConnection() {
+	std::unique_ptr<MockSQLConnection> conn(new MockSQLConnection);
+	conn->addResult("EMP", {employee(1, "A"), employee(2, "B"), employee(3, "C"), employee(4, "D"),
+	                        employee(5, "E")});
+	conn->addResult("min(rowid)", {makeRow({{"lower", StringSQLValue(1)}, {"upper", StringSQLValue(5)}})});
+	conn->addResult("rowid >= 1 AND rowid <= 3", {employee(1, "A"), employee(2, "B"), employee(3, "C")});
+	conn->addResult("rowid >= 4 AND rowid <= 5", {employee(4, "D"), employee(5, "E")});
+	conn->addResult("rowid >= 1 AND rowid <= 2", {employee(1, "A"), employee(2, "B")});
+	conn->addResult("rowid >= 3 AND rowid <= 4", {employee(3, "C"), employee(4, "D")});
+	conn->addResult("rowid >= 5 AND rowid <= 5", {employee(5, "E")});
+	return std::unique_ptr<SQLConnection>(conn.release());
+}
+
+// EMP as a view: DuckDB fails any query on its (missing) rowid.
+class EmpViewConnection : public MockSQLConnection {
+public:
+	EmpViewConnection() {
+		addResult("EMP", {employee(1, "A"), employee(2, "B"), employee(3, "C")});
+	}
+
+	std::unique_ptr<r2rml::SQLResultSet> execute(const std::string &query) override {
+		if (query.find("rowid") != std::string::npos || query.find("min(") != std::string::npos) {
+			throw std::runtime_error("Binder Error: Referenced column \"rowid\" not found");
+		}
+		return MockSQLConnection::execute(query);
+	}
+};
+
+} // namespace
+
+TEST_CASE("Parallel export output matches the sequential export") {
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parse(SOURCE_R2RML_DIR "example_emp_dept.ttl");
+	REQUIRE(mapping.isValid());
+	ExportReport sequential;
+	std::string expected = sequentialExport(mapping, sequential);
+	REQUIRE_FALSE(expected.empty());
+
+	for (unsigned threads : {1u, 2u, 8u, 0u}) {
+		std::atomic<unsigned> connections {0};
+		ExportOptions options;
+		options.threads = threads;
+		ExportReport report;
+		std::string output;
+		mapping.processDatabase(
+		    [&]() {
+			    ++connections;
+			    return empDeptConnection();
+		    },
+		    SERD_NTRIPLES, (SerdStyle)0, appendToString, &output, options, &report);
+		CHECK(output == expected);
+		CHECK(connections >= 1);
+		CHECK(connections <= mapping.triplesMaps.size());
+		// Join indexes are per worker, so a parent may be indexed more than once.
+		CHECK(report.joinIndexBuilds >= sequential.joinIndexBuilds);
+		CHECK(report.joinIndexProbes == sequential.joinIndexProbes);
+	}
+}
+
+TEST_CASE("Parallel export rethrows worker errors") {
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parse(SOURCE_R2RML_DIR "example_emp_dept.ttl");
+	REQUIRE(mapping.isValid());
+	ExportOptions options;
+	options.threads = 2;
+	std::string output;
+
+	SECTION("the factory throws") {
+		r2rml::ConnectionFactory connect = []() -> std::unique_ptr<SQLConnection> {
+			throw std::runtime_error("no database");
+		};
+		CHECK_THROWS_AS(
+		    mapping.processDatabase(connect, SERD_NTRIPLES, (SerdStyle)0, appendToString, &output, options),
+		    std::runtime_error);
+	}
+
+	SECTION("the factory returns no connection") {
+		r2rml::ConnectionFactory connect = []() { return std::unique_ptr<SQLConnection>(); };
+		CHECK_THROWS_AS(
+		    mapping.processDatabase(connect, SERD_NTRIPLES, (SerdStyle)0, appendToString, &output, options),
+		    std::runtime_error);
+	}
+	CHECK(output.empty());
+}
+
+TEST_CASE("Logical tables build partition queries") {
+	BaseTableOrView table("EMP");
+	CHECK(table.partitionKey() == "rowid");
+	CHECK(table.partitionBoundsQuery() == "SELECT min(rowid) AS \"lower\", max(rowid) AS \"upper\" FROM \"EMP\"");
+	CHECK(table.partitionQuery(10, 19) == "SELECT * FROM \"EMP\" WHERE rowid >= 10 AND rowid <= 19");
+	table.partitionColumn = "EMPNO";
+	CHECK(table.partitionQuery(-5, 5) == "SELECT * FROM \"EMP\" WHERE \"EMPNO\" >= -5 AND \"EMPNO\" <= 5");
+	// Embedded quotes are doubled, so the name stays one identifier.
+	table.partitionColumn = "EMP\"NO";
+	CHECK(table.partitionKey() == "\"EMP\"\"NO\"");
+	CHECK(table.partitionBoundsQuery() ==
+	      "SELECT min(\"EMP\"\"NO\") AS \"lower\", max(\"EMP\"\"NO\") AS \"upper\" FROM \"EMP\"");
+
+	// A query result has no rowid: views partition only on a declared column.
+	R2RMLView view("SELECT EMPNO, ENAME FROM EMP;");
+	CHECK(view.partitionKey().empty());
+	CHECK(view.partitionBoundsQuery().empty());
+	CHECK(view.partitionQuery(0, 1).empty());
+	view.partitionColumn = "EMPNO";
+	CHECK(view.partitionQuery(0, 1) == "SELECT * FROM (SELECT EMPNO, ENAME FROM EMP) AS \"partition\" "
+	                                   "WHERE \"EMPNO\" >= 0 AND \"EMPNO\" <= 1");
+}
+
+TEST_CASE("Partitioned export splits a table into key ranges") {
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(EMP_MAPPING, "http://example.com/mapping/");
+	REQUIRE(mapping.isValid());
+	REQUIRE(mapping.triplesMaps.size() == 1);
+
+	std::string expected;
+	{
+		std::unique_ptr<SQLConnection> conn = partitionedEmpConnection();
+		SerdChunk chunk {nullptr, 0};
+		SerdWriter *writer =
+		    serd_writer_new(SERD_NTRIPLES, (SerdStyle)0, mapping.serdEnvironment, nullptr, serd_chunk_sink, &chunk);
+		mapping.processDatabase(*conn, *writer);
+		serd_writer_finish(writer);
+		uint8_t *raw = serd_chunk_sink_finish(&chunk);
+		expected = raw ? std::string(reinterpret_cast<const char *>(raw)) : std::string();
+		serd_free(raw);
+		serd_writer_free(writer);
+	}
+	REQUIRE(expected.find("employee/5") != std::string::npos);
+
+	for (unsigned partitions : {2u, 3u}) {
+		for (unsigned threads : {1u, 4u}) {
+			ExportOptions options;
+			options.threads = threads;
+			options.partitions = partitions;
+			ExportReport report;
+			std::string output;
+			mapping.processDatabase(partitionedEmpConnection, SERD_NTRIPLES, (SerdStyle)0, appendToString, &output,
+			                        options, &report);
+			CHECK(output == expected);
+			CHECK(report.partitionQueries == partitions);
+		}
+	}
+}
+
+TEST_CASE("Partitioned export rejects a non-integer key") {
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(EMP_MAPPING, "http://example.com/mapping/");
+	REQUIRE(mapping.isValid());
+	mapping.triplesMaps[0]->logicalTable->partitionColumn = "ENAME";
+	r2rml::ConnectionFactory connect = []() {
+		std::unique_ptr<MockSQLConnection> conn(new MockSQLConnection);
+		conn->addResult("min(\"ENAME\")", {makeRow({{"lower", StringSQLValue(std::string("ADAMS"))},
+		                                            {"upper", StringSQLValue(std::string("WARD"))}})});
+		return std::unique_ptr<SQLConnection>(conn.release());
+	};
+	ExportOptions options;
+	options.partitions = 2;
+	std::string output;
+	CHECK_THROWS_AS(mapping.processDatabase(connect, SERD_NTRIPLES, (SerdStyle)0, appendToString, &output, options),
+	                std::runtime_error);
+}
+
+TEST_CASE("Partitioned export exports a table without the default key whole") {
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(EMP_MAPPING, "http://example.com/mapping/");
+	REQUIRE(mapping.isValid());
+	r2rml::ConnectionFactory connect = []() { return std::unique_ptr<SQLConnection>(new EmpViewConnection); };
+
+	for (unsigned threads : {1u, 3u}) {
+		ExportOptions options;
+		options.threads = threads;
+		options.partitions = 3;
+		ExportReport report;
+		std::string output;
+		mapping.processDatabase(connect, SERD_NTRIPLES, (SerdStyle)0, appendToString, &output, options, &report);
+		CHECK(output == "<http://data.example.com/employee/1> <http://example.com/ns#name> \"A\" .\n"
+		                "<http://data.example.com/employee/2> <http://example.com/ns#name> \"B\" .\n"
+		                "<http://data.example.com/employee/3> <http://example.com/ns#name> \"C\" .\n");
+		CHECK(report.partitionQueries == 0);
+	}
+
+	// A declared column is the mapping's own; its failure isn't hidden.
+	mapping.triplesMaps[0]->logicalTable->partitionColumn = "EMPNO";
+	ExportOptions options;
+	options.partitions = 3;
+	std::string output;
+	CHECK_THROWS_AS(mapping.processDatabase(connect, SERD_NTRIPLES, (SerdStyle)0, appendToString, &output, options),
+	                std::runtime_error);
+}
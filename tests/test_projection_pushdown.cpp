@@ -0,0 +1,205 @@
+/**
+ * Tests for projection pushdown (LogicalTable::projection): the columns
+ * R2RMLMapping::compile() finds each TriplesMap reading from its logical
+ * table, including those joined on through rr:parent, and the SELECT lists
+ * the row, partition and watermark queries build from them.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <serd/serd.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "r2rml/BaseTableOrView.h"
+#include "r2rml/ExportOptions.h"
+#include "r2rml/GraphMap.h"
+#include "r2rml/LogicalTable.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/R2RMLView.h"
+#include "r2rml/SQLConnection.h"
+#include "r2rml/StringSQLValue.h"
+#include "r2rml/SubjectMap.h"
+#include "r2rml/TriplesMap.h"
+#include "MockSQL.h"
+
+using r2rml::BaseTableOrView;
+using r2rml::R2RMLMapping;
+using r2rml::R2RMLView;
+using r2rml::SQLResultSet;
+using r2rml::StringSQLValue;
+using r2rml::TriplesMap;
+using r2rml::testing::exportNTriples;
+using r2rml::testing::makeRow;
+using r2rml::testing::MockSQLConnection;
+using r2rml::testing::parseMapping;
+
+namespace {
+
+// Employees with a two-column template, a graph map and a join to their
+// department; departments through an rr:sqlQuery view.  Neither table's
+// other columns are read.
+const char *const MAPPING = R"(
+@prefix rr: <http://www.w3.org/ns/r2rml#>.
+@prefix ex: <http://example.com/ns#>.
+<#Emps>
+    rr:logicalTable [ rr:tableName "EMP" ];
+    rr:subjectMap [ rr:template "http://data.example.com/employee/{EMPNO}"; rr:class ex:Employee;
+                    rr:graphMap [ rr:template "http://data.example.com/graph/{REGION}" ] ];
+    rr:predicateObjectMap [ rr:predicate ex:name; rr:objectMap [ rr:template "{FIRST} {LAST}";
+                                                                  rr:termType rr:Literal ] ];
+    rr:predicateObjectMap [ rr:predicate ex:active; rr:objectMap [ rr:constant "true" ] ];
+    rr:predicateObjectMap [
+        rr:predicate ex:dept;
+        rr:objectMap [ rr:parentTriplesMap <#Depts>;
+                       rr:joinCondition [ rr:child "DEPTNO"; rr:parent "ID" ] ] ].
+<#Depts>
+    rr:logicalTable [ rr:sqlQuery "SELECT ID, DNAME, LOC, BUDGET FROM DEPT;" ];
+    rr:subjectMap [ rr:template "http://data.example.com/dept/{DNAME}" ];
+    rr:predicateObjectMap [ rr:predicate ex:location; rr:objectMap [ rr:column "LOC" ] ].
+)";
+
+TriplesMap &triplesMap(R2RMLMapping &mapping, const std::string &name) {
+	auto it = std::find_if(mapping.triplesMaps.begin(), mapping.triplesMaps.end(),
+	                       [&](const std::unique_ptr<TriplesMap> &tm) {
+		                       return tm->id.size() >= name.size() &&
+		                              tm->id.compare(tm->id.size() - name.size(), name.size(), name) == 0;
+	                       });
+	REQUIRE(it != mapping.triplesMaps.end());
+	return **it;
+}
+
+// Answers EMP and the DEPT view with rows carrying unmapped columns too, and
+// records the queries it is sent.
+class EmpDeptConnection : public MockSQLConnection {
+public:
+	EmpDeptConnection() {
+		addResult("FROM \"EMP\"", {makeRow({{"EMPNO", StringSQLValue(7369)},
+		                                    {"FIRST", StringSQLValue(std::string("John"))},
+		                                    {"LAST", StringSQLValue(std::string("Smith"))},
+		                                    {"REGION", StringSQLValue(std::string("east"))},
+		                                    {"SALARY", StringSQLValue(800)},
+		                                    {"DEPTNO", StringSQLValue(10)}})});
+		addResult("FROM DEPT", {makeRow({{"ID", StringSQLValue(10)},
+		                                 {"DNAME", StringSQLValue(std::string("ACCOUNTING"))},
+		                                 {"LOC", StringSQLValue(std::string("NEW YORK"))},
+		                                 {"BUDGET", StringSQLValue(5000)}})});
+	}
+
+	std::unique_ptr<SQLResultSet> execute(const std::string &query) override {
+		queries.push_back(query);
+		return MockSQLConnection::execute(query);
+	}
+
+	std::vector<std::string> queries;
+};
+
+// A subject map that reads its row without reporting which columns.
+class OpaqueSubjectMap : public r2rml::SubjectMap {
+public:
+	SerdNode generateRDFTerm(const r2rml::SQLRow & /*row*/, const SerdEnv & /*env*/) const override {
+		return SERD_NODE_NULL;
+	}
+
+	const r2rml::TermMap *valueTermMap() const override {
+		return nullptr;
+	}
+};
+
+} // namespace
+
+TEST_CASE("compile() projects each logical table onto the columns read from it") {
+	R2RMLMapping mapping = parseMapping(MAPPING);
+	TriplesMap &emps = triplesMap(mapping, "#Emps");
+	TriplesMap &depts = triplesMap(mapping, "#Depts");
+
+	// Subject, its graph, the POM templates and the join's child column.
+	CHECK(emps.logicalTable->projection == std::vector<std::string>({"EMPNO", "REGION", "FIRST", "LAST", "DEPTNO"}));
+	// The view's own columns, then the one <#Emps> joins on.
+	CHECK(depts.logicalTable->projection == std::vector<std::string>({"DNAME", "LOC", "ID"}));
+	CHECK(emps.logicalTable->getColumnNames() == emps.logicalTable->projection);
+
+	CHECK(emps.logicalTable->selectQuery() ==
+	      "SELECT \"EMPNO\", \"REGION\", \"FIRST\", \"LAST\", \"DEPTNO\" FROM \"EMP\"");
+	CHECK(depts.logicalTable->selectQuery() ==
+	      "SELECT \"DNAME\", \"LOC\", \"ID\" FROM (\nSELECT ID, DNAME, LOC, BUDGET FROM DEPT\n) AS \"view\"");
+	// Set by compile(), so getRows() needn't write it during an export.
+	CHECK(emps.logicalTable->effectiveSqlQuery == emps.logicalTable->selectQuery());
+	CHECK(depts.logicalTable->effectiveSqlQuery == depts.logicalTable->selectQuery());
+
+	SECTION("a term map that doesn't report its columns selects them all") {
+		emps.subjectMap.reset(new OpaqueSubjectMap);
+		mapping.compile();
+		CHECK(emps.logicalTable->projection.empty());
+		CHECK(emps.logicalTable->selectQuery() == "SELECT * FROM \"EMP\"");
+		CHECK(depts.logicalTable->projection == std::vector<std::string>({"DNAME", "LOC", "ID"}));
+	}
+}
+
+TEST_CASE("TriplesMap::referencedColumns() appends the columns a row is read through") {
+	R2RMLMapping mapping = parseMapping(MAPPING);
+	TriplesMap &emps = triplesMap(mapping, "#Emps");
+
+	std::vector<std::string> columns = {"LAST", "SALARY"};
+	CHECK(emps.referencedColumns(columns));
+	// The join's child column, not its parent's.
+	CHECK(columns == std::vector<std::string>({"LAST", "SALARY", "EMPNO", "REGION", "FIRST", "DEPTNO"}));
+
+	emps.subjectMap.reset(new OpaqueSubjectMap);
+	columns.clear();
+	CHECK_FALSE(emps.referencedColumns(columns));
+	CHECK(columns == std::vector<std::string>({"FIRST", "LAST", "DEPTNO"}));
+}
+
+TEST_CASE("Projected logical tables select their partition and watermark columns only where needed") {
+	BaseTableOrView table("EMP");
+	table.projection = {"EMPNO", "EN\"AME"};
+	table.partitionColumn = "DEPTNO";
+	table.watermarkColumn = "UPDATED";
+	CHECK(table.selectQuery() == "SELECT \"EMPNO\", \"EN\"\"AME\" FROM \"EMP\"");
+	CHECK(table.partitionQuery(0, 9) ==
+	      "SELECT \"EMPNO\", \"EN\"\"AME\" FROM \"EMP\" WHERE \"DEPTNO\" >= 0 AND \"DEPTNO\" <= 9");
+	CHECK(table.watermarkBoundQuery() == "SELECT CAST(max(\"UPDATED\") AS VARCHAR) AS \"upper\" FROM \"EMP\"");
+
+	// A view's keys must come through the subquery the partition and
+	// watermark queries filter.
+	R2RMLView view("SELECT * FROM EMP -- all of it");
+	view.projection = {"EMPNO"};
+	view.partitionColumn = "DEPTNO";
+	view.watermarkColumn = "UPDATED";
+	CHECK(view.selectQuery() == "SELECT \"EMPNO\" FROM (\nSELECT * FROM EMP -- all of it\n) AS \"view\"");
+	CHECK(view.partitionQuery(0, 9) ==
+	      "SELECT \"EMPNO\" FROM (SELECT \"EMPNO\", \"DEPTNO\", \"UPDATED\" FROM (\nSELECT * FROM EMP -- all of it\n) "
+	      "AS \"view\") AS \"partition\" WHERE \"DEPTNO\" >= 0 AND \"DEPTNO\" <= 9");
+	CHECK(view.watermarkBoundQuery() ==
+	      "SELECT CAST(max(\"UPDATED\") AS VARCHAR) AS \"upper\" FROM (SELECT \"EMPNO\", \"DEPTNO\", \"UPDATED\" "
+	      "FROM (\nSELECT * FROM EMP -- all of it\n) AS \"view\") AS \"partition\"");
+
+	CHECK(view.rowQuery() == view.selectQuery());
+
+	// Unprojected, a view runs as written.  getRows() doesn't record it.
+	view.projection.clear();
+	CHECK(view.rowQuery() == "SELECT * FROM EMP -- all of it");
+	view.effectiveSqlQuery.clear();
+	MockSQLConnection conn;
+	view.getRows(conn);
+	CHECK(view.effectiveSqlQuery.empty());
+}
+
+TEST_CASE("Export queries select only the mapped columns") {
+	R2RMLMapping mapping = parseMapping(MAPPING);
+	EmpDeptConnection conn;
+	std::string output = exportNTriples(mapping, conn, r2rml::ExportOptions(), nullptr, SERD_NQUADS);
+
+	CHECK(output.find("<http://data.example.com/employee/7369> <http://example.com/ns#name> \"John Smith\" "
+	                  "<http://data.example.com/graph/east>") != std::string::npos);
+	CHECK(output.find("<http://data.example.com/employee/7369> <http://example.com/ns#dept> "
+	                  "<http://data.example.com/dept/ACCOUNTING>") != std::string::npos);
+	REQUIRE_FALSE(conn.queries.empty());
+	for (const std::string &query : conn.queries) {
+		CHECK(query.find('*') == std::string::npos);
+		CHECK(query.find("SALARY") == std::string::npos);
+	}
+}
@@ -127,6 +127,20 @@ TEST_CASE("ColumnTermMap computeDatatypeIRI from SQL value type") {
 	}
 }
 
+TEST_CASE("ColumnTermMap datatypeIRIView borrows the datatype") {
+	using r2rml::testing::makeRow;
+	ColumnTermMap col("VAL");
+	auto row = makeRow({{"VAL", StringSQLValue(7)}});
+	CHECK(col.datatypeIRIView(row) == "http://www.w3.org/2001/XMLSchema#integer");
+	CHECK(row.getDatatypeIRI("MISSING").empty());
+
+	col.datatypeIRI = std::unique_ptr<std::string>(new std::string("http://example.com/mytype"));
+	CHECK(&col.datatypeIRIView(row) == col.datatypeIRI.get());
+
+	TemplateTermMap tt("{VAL}");
+	CHECK(tt.datatypeIRIView(row).empty());
+}
+
 TEST_CASE("ColumnTermMap computeDatatypeIRI static rr:datatype takes priority") {
 	using r2rml::testing::makeRow;
 	ColumnTermMap col("VAL");
@@ -844,3 +858,115 @@ TEST_CASE("R2RML parser populates rr:graphMap on a predicate-object map as a tem
 	        "http://example.com/graph/jobs/CLERK");
 	serd_env_free(env);
 }
+
+TEST_CASE("Compiling a mapping classifies constant graph maps once") {
+	const char *ttl = R"(
+@prefix rr: <http://www.w3.org/ns/r2rml#>.
+@prefix ex: <http://example.com/ns#>.
+<#Emp>
+    rr:logicalTable [ rr:tableName "EMP" ];
+    rr:subjectMap [ rr:template "http://data.example.com/emp/{EMPNO}"; rr:graph ex:staff, rr:defaultGraph ];
+    rr:predicateObjectMap [ rr:predicate ex:job; rr:objectMap [ rr:column "JOB" ];
+                            rr:graphMap [ rr:template "http://example.com/graph/jobs/{JOB}" ] ].
+)";
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(ttl, "http://example.com/mapping/");
+	REQUIRE(mapping.isValid());
+	const auto &tm = *mapping.triplesMaps[0];
+
+	const auto &subjectGraphs = tm.subjectMap->graphMaps;
+	REQUIRE(subjectGraphs.size() == 2);
+	std::size_t named = subjectGraphs[0]->kind == r2rml::GraphMap::Kind::NamedGraph ? 0 : 1;
+	const r2rml::GraphMap &staff = *subjectGraphs[named];
+	const r2rml::GraphMap &defaultGraph = *subjectGraphs[1 - named];
+	REQUIRE(staff.kind == r2rml::GraphMap::Kind::NamedGraph);
+	CHECK(std::string(reinterpret_cast<const char *>(staff.namedGraph.buf), staff.namedGraph.n_bytes) ==
+	      "http://example.com/ns#staff");
+	CHECK(mapping.constants.encoded(staff.namedGraph) != nullptr);
+	CHECK(defaultGraph.kind == r2rml::GraphMap::Kind::DefaultGraph);
+	CHECK(tm.predicateObjectMaps[0]->graphMaps[0]->kind == r2rml::GraphMap::Kind::PerRow);
+
+	SerdEnv *env = serd_env_new(nullptr);
+	MapSQLRow row = r2rml::testing::makeRow({{"JOB", StringSQLValue(std::string("CLERK"))}});
+	r2rml::RowGraphs graphs;
+	graphs.resolve(subjectGraphs, row, *env);
+	REQUIRE(graphs.size() == 1); // rr:defaultGraph is not a named graph
+	CHECK(graphs[0].buf == staff.namedGraph.buf);
+	serd_env_free(env);
+}
+
+namespace {
+
+// A graph map yielding a fixed IRI, counting its evaluations.
+class FixedGraphMap : public r2rml::GraphMap {
+public:
+	explicit FixedGraphMap(const char *iri) : iri_(iri) {
+	}
+	SerdNode generateRDFTerm(const r2rml::SQLRow & /*row*/, const SerdEnv & /*env*/) const override {
+		++calls;
+		return iri_ ? serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>(iri_)) : SERD_NODE_NULL;
+	}
+	std::ostream &print(std::ostream &os) const override {
+		return os << "FixedGraphMap";
+	}
+	mutable int calls {0};
+
+private:
+	const char *iri_;
+};
+
+} // namespace
+
+TEST_CASE("RowGraphs resolves each graph map once and emits the union") {
+	std::vector<std::unique_ptr<r2rml::GraphMap>> subjectMaps;
+	std::vector<std::unique_ptr<r2rml::GraphMap>> pomMaps;
+	for (int i = 0; i < 5; ++i) {
+		subjectMaps.emplace_back(new FixedGraphMap("http://ex.com/g"));
+	}
+	subjectMaps.emplace_back(new FixedGraphMap("http://www.w3.org/ns/r2rml#defaultGraph"));
+	subjectMaps.emplace_back(new FixedGraphMap(nullptr));
+	subjectMaps.emplace_back(nullptr);
+	pomMaps.emplace_back(new FixedGraphMap("http://ex.com/p"));
+	FixedGraphMap *constant = new FixedGraphMap("http://ex.com/never-evaluated");
+	static const char kNamed[] = "http://ex.com/named";
+	constant->classifyConstant(serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>(kNamed)));
+	pomMaps.emplace_back(constant);
+
+	SerdEnv *env = serd_env_new(nullptr);
+	MapSQLRow row;
+	r2rml::RowGraphs subjectGraphs;
+	r2rml::RowGraphs pomGraphs;
+	subjectGraphs.resolve(subjectMaps, row, *env);
+	pomGraphs.resolve(pomMaps, row, *env);
+	serd_env_free(env);
+
+	CHECK(subjectGraphs.size() == 5); // past the inline capacity
+	CHECK(pomGraphs.size() == 2);
+	CHECK(constant->calls == 0);
+	for (const auto &gm : subjectMaps) {
+		if (gm) {
+			CHECK(static_cast<const FixedGraphMap &>(*gm).calls == 1);
+		}
+	}
+
+	std::vector<std::string> emitted;
+	for (int triple = 0; triple < 3; ++triple) {
+		r2rml::forEachGraphNode(subjectGraphs, pomGraphs, [&](const SerdNode *graph) {
+			REQUIRE(graph);
+			emitted.emplace_back(reinterpret_cast<const char *>(graph->buf), graph->n_bytes);
+		});
+	}
+	CHECK(emitted.size() == 21);
+	CHECK(emitted[4] == "http://ex.com/g");
+	CHECK(emitted[5] == "http://ex.com/p");
+	CHECK(emitted[6] == kNamed);
+	CHECK(static_cast<const FixedGraphMap &>(*pomMaps[0]).calls == 1);
+
+	r2rml::RowGraphs none;
+	int defaults = 0;
+	r2rml::forEachGraphNode(none, none, [&](const SerdNode *graph) {
+		CHECK(graph == nullptr);
+		++defaults;
+	});
+	CHECK(defaults == 1);
+}
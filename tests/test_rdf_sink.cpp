@@ -0,0 +1,196 @@
+/**
+ * Tests for RdfSink, the push-style inside-out export: binding a triples map
+ * to an incoming column layout, emitting the same statements as the pull
+ * path batch by batch, and rejecting what inside-out execution can't run.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <serd/serd.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef SOURCE_R2RML_DIR
+#define SOURCE_R2RML_DIR ""
+#endif
+
+#include "r2rml/NTriplesWriter.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/R2RMLParser.h"
+#include "r2rml/RdfSink.h"
+#include "r2rml/RowBatch.h"
+#include "r2rml/SQLValue.h"
+#include "r2rml/TriplesMap.h"
+#include "MockSQL.h"
+
+using r2rml::NTriplesWriter;
+using r2rml::R2RMLMapping;
+using r2rml::R2RMLParser;
+using r2rml::RdfSink;
+using r2rml::RowBatch;
+using r2rml::SQLValue;
+using r2rml::testing::appendToString;
+
+namespace {
+
+const char *const MAPPING = R"(
+@prefix rr: <http://www.w3.org/ns/r2rml#>.
+@prefix ex: <http://example.com/ns#>.
+<#Emp>
+    rr:subjectMap [ rr:template "http://data.example.com/emp/{EMPNO}"; rr:class ex:Employee;
+                    rr:graph ex:staff ];
+    rr:predicateObjectMap [ rr:predicate ex:name; rr:objectMap [ rr:column "ENAME" ] ];
+    rr:predicateObjectMap [ rr:predicate ex:no; rr:objectMap [ rr:column "EMPNO" ] ];
+    rr:predicateObjectMap [ rr:predicate ex:job; rr:objectMap [ rr:column "JOB" ];
+                            rr:graphMap [ rr:template "http://example.com/graph/{JOB}" ] ].
+)";
+
+const char *const XSD_INTEGER = "http://www.w3.org/2001/XMLSchema#integer";
+
+std::vector<RdfSink::Column> empSchema() {
+	return {{"EMPNO", SQLValue::Type::Integer, XSD_INTEGER},
+	        {"ENAME", SQLValue::Type::String, ""},
+	        {"JOB", SQLValue::Type::String, ""}};
+}
+
+// Rows [first, last) of a small EMP table, as the host would hand them over.
+void fillBatch(RowBatch &batch, int first, int last) {
+	batch.reset();
+	RowBatch::Column &no = batch.addColumn("EMPNO", SQLValue::Type::Integer);
+	no.datatypeIRI = XSD_INTEGER;
+	RowBatch::Column &name = batch.addColumn("ENAME", SQLValue::Type::String);
+	RowBatch::Column &job = batch.addColumn("JOB", SQLValue::Type::String);
+	for (int i = first; i < last; ++i) {
+		no.append(std::to_string(7000 + i));
+		name.append("E" + std::to_string(i));
+		if (i % 3 == 0) {
+			job.appendNull();
+		} else {
+			job.append(i % 2 ? "CLERK" : "ANALYST");
+		}
+	}
+	batch.setSize(static_cast<std::size_t>(last - first));
+}
+
+} // namespace
+
+TEST_CASE("RdfSink emits what the pull path emits, batch by batch") {
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(MAPPING, "http://example.com/mapping/");
+	const r2rml::TriplesMap &tm = RdfSink::findTriplesMap(mapping, "Emp");
+	RowBatch batch;
+
+	std::string pulled;
+	{
+		NTriplesWriter writer(SERD_NQUADS, mapping.serdEnvironment, &mapping.constants, appendToString, &pulled);
+		r2rml::testing::MockSQLConnection conn;
+		fillBatch(batch, 0, 10);
+		tm.generateTriples(batch, writer, mapping, conn);
+		writer.flush();
+	}
+
+	std::string pushed;
+	NTriplesWriter writer(SERD_NQUADS, mapping.serdEnvironment, &mapping.constants, appendToString, &pushed);
+	RdfSink sink(mapping, tm, writer);
+	sink.begin(empSchema());
+	fillBatch(batch, 0, 4);
+	sink.consume(batch);
+	fillBatch(batch, 4, 4); // an empty vector
+	sink.consume(batch);
+	fillBatch(batch, 4, 10);
+	sink.consume(batch);
+	CHECK(sink.rows() == 10);
+	sink.finish();
+
+	REQUIRE_FALSE(pulled.empty());
+	CHECK(pushed == pulled);
+	CHECK(pushed.find("\"7003\"^^<http://www.w3.org/2001/XMLSchema#integer> <http://example.com/ns#staff> .") !=
+	      std::string::npos);
+	CHECK(pushed.find("\"CLERK\" <http://example.com/graph/CLERK> .") != std::string::npos);
+}
+
+TEST_CASE("RdfSink::finish flushes the statement sink") {
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(MAPPING, "http://example.com/mapping/");
+	std::string out;
+	NTriplesWriter writer(SERD_NQUADS, mapping.serdEnvironment, &mapping.constants, appendToString, &out);
+	RdfSink sink(mapping, RdfSink::findTriplesMap(mapping, ""), writer);
+
+	RowBatch batch;
+	sink.begin(empSchema());
+	fillBatch(batch, 0, 2);
+	sink.consume(batch);
+	CHECK(out.empty()); // still in the writer's buffer
+	sink.finish();
+	CHECK_FALSE(out.empty());
+
+	// a sink can run another stream after finish()
+	sink.begin(empSchema());
+	CHECK(sink.rows() == 0);
+	sink.finish();
+}
+
+TEST_CASE("RdfSink checks the stream it is given") {
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(MAPPING, "http://example.com/mapping/");
+	std::string out;
+	NTriplesWriter writer(SERD_NTRIPLES, mapping.serdEnvironment, appendToString, &out);
+	RdfSink sink(mapping, RdfSink::findTriplesMap(mapping, ""), writer);
+	RowBatch batch;
+	fillBatch(batch, 0, 1);
+
+	CHECK_THROWS_AS(sink.consume(batch), std::logic_error);
+	CHECK_THROWS_AS(sink.finish(), std::logic_error);
+
+	// JOB is read by a graph map and an object map
+	std::vector<RdfSink::Column> noJob = empSchema();
+	noJob.pop_back();
+	CHECK_THROWS_AS(sink.begin(noJob), std::invalid_argument);
+
+	sink.begin(empSchema());
+	CHECK_THROWS_AS(sink.begin(empSchema()), std::logic_error);
+	RowBatch other;
+	other.addColumn("EMPNO");
+	other.addColumn("ENAME");
+	other.addColumn("JOBS");
+	CHECK_THROWS_AS(sink.consume(other), std::invalid_argument);
+	sink.consume(batch);
+	CHECK(sink.rows() == 1);
+}
+
+TEST_CASE("RdfSink only runs triples maps that are valid inside-out") {
+	R2RMLParser parser;
+	R2RMLMapping withTable = parser.parse(SOURCE_R2RML_DIR "example1.ttl");
+	REQUIRE(withTable.triplesMaps.size() == 1);
+	std::string out;
+	NTriplesWriter writer(SERD_NTRIPLES, nullptr, appendToString, &out);
+	CHECK_THROWS_AS(RdfSink(withTable, *withTable.triplesMaps[0], writer), std::invalid_argument);
+
+	R2RMLMapping insideOut = parser.parse(SOURCE_R2RML_DIR "inside_out_valid.ttl");
+	REQUIRE(insideOut.isValidInsideOut());
+	CHECK_NOTHROW(RdfSink(insideOut, *insideOut.triplesMaps[0], writer));
+}
+
+TEST_CASE("RdfSink::findTriplesMap accepts full and local names") {
+	const char *twoMaps = R"(
+@prefix rr: <http://www.w3.org/ns/r2rml#>.
+<#A> rr:subjectMap [ rr:template "http://ex.com/a/{ID}" ].
+<#B> rr:subjectMap [ rr:template "http://ex.com/b/{ID}" ].
+)";
+	R2RMLParser parser;
+	R2RMLMapping mapping = parser.parseString(twoMaps, "http://example.com/mapping/");
+	REQUIRE(mapping.triplesMaps.size() == 2);
+
+	const r2rml::TriplesMap &b = RdfSink::findTriplesMap(mapping, "B");
+	CHECK(b.id == "http://example.com/mapping/#B");
+	CHECK(&RdfSink::findTriplesMap(mapping, "#B") == &b);
+	CHECK(&RdfSink::findTriplesMap(mapping, "<#B>") == &b);
+	CHECK(&RdfSink::findTriplesMap(mapping, "http://example.com/mapping/#B") == &b);
+	CHECK(&RdfSink::findTriplesMap(mapping, "<http://example.com/mapping/#B>") == &b);
+	CHECK_THROWS_AS(RdfSink::findTriplesMap(mapping, ""), std::invalid_argument);
+	CHECK_THROWS_AS(RdfSink::findTriplesMap(mapping, "C"), std::invalid_argument);
+
+	R2RMLMapping empty;
+	CHECK_THROWS_AS(RdfSink::findTriplesMap(empty, ""), std::invalid_argument);
+}
@@ -0,0 +1,291 @@
+/**
+ * Tests for the columnar batch path: RowBatch, the default
+ * SQLResultSet::nextBatch() built on next()/getCurrentRow(), batch term
+ * generation, and TriplesMap::generateTriples(batch, ...) producing exactly
+ * the output of the per-row overload.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <serd/serd.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef SOURCE_R2RML_DIR
+#define SOURCE_R2RML_DIR ""
+#endif
+
+#include "r2rml/ColumnTermMap.h"
+#include "r2rml/LogicalTable.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/R2RMLParser.h"
+#include "r2rml/RowBatch.h"
+#include "r2rml/SQLResultSet.h"
+#include "r2rml/SQLRow.h"
+#include "r2rml/StringSQLValue.h"
+#include "r2rml/TemplateTermMap.h"
+#include "r2rml/TermBatch.h"
+#include "r2rml/TriplesMap.h"
+#include "MockSQL.h"
+
+using r2rml::ColumnTermMap;
+using r2rml::R2RMLMapping;
+using r2rml::R2RMLParser;
+using r2rml::RowBatch;
+using r2rml::RowBatchRow;
+using r2rml::SQLValue;
+using r2rml::StringSQLValue;
+using r2rml::TemplateTermMap;
+using r2rml::TermBatch;
+using r2rml::testing::makeRow;
+using r2rml::testing::MockSQLConnection;
+using r2rml::testing::MockSQLResultSet;
+
+namespace {
+
+std::string nodeString(const SerdNode &node) {
+	return node.buf ? std::string(reinterpret_cast<const char *>(node.buf), node.n_bytes) : std::string();
+}
+
+// Serialise whatever `produce` writes as N-Quads.
+std::string captureNQuads(const std::function<void(SerdWriter &)> &produce) {
+	SerdChunk chunk {nullptr, 0};
+	SerdEnv *env = serd_env_new(nullptr);
+	SerdWriter *writer = serd_writer_new(SERD_NQUADS, (SerdStyle)0, env, nullptr, serd_chunk_sink, &chunk);
+	produce(*writer);
+	serd_writer_finish(writer);
+	uint8_t *raw = serd_chunk_sink_finish(&chunk);
+	std::string result;
+	if (raw) {
+		result = std::string(reinterpret_cast<const char *>(raw));
+		serd_free(raw);
+	}
+	serd_writer_free(writer);
+	serd_env_free(env);
+	return result;
+}
+
+// Output of every valid TriplesMap, fed either row by row or in batches of
+// `batchRows` rows.
+std::string exportMapping(R2RMLMapping &mapping, MockSQLConnection &conn, std::size_t batchRows) {
+	return captureNQuads([&](SerdWriter &writer) {
+		for (const auto &tm : mapping.triplesMaps) {
+			if (!tm->isValid()) {
+				continue;
+			}
+			auto rows = tm->logicalTable->getRows(conn);
+			if (batchRows == 0) {
+				while (rows->next()) {
+					tm->generateTriples(rows->getCurrentRow(), writer, mapping, conn);
+				}
+			} else {
+				RowBatch batch;
+				while (rows->nextBatch(batch, batchRows)) {
+					tm->generateTriples(batch, writer, mapping, conn);
+				}
+			}
+		}
+	});
+}
+
+} // namespace
+
+TEST_CASE("RowBatch columns store contiguous lexical values and nulls") {
+	RowBatch batch;
+	RowBatch::Column &col = batch.addColumn("ID", SQLValue::Type::Integer);
+	col.append("7369");
+	col.appendNull();
+	col.append(std::string("10"));
+	batch.setSize(3);
+
+	REQUIRE(batch.size() == 3);
+	REQUIRE(batch.findColumn("ID") == 0);
+	REQUIRE(batch.findColumn("MISSING") == RowBatch::npos);
+	CHECK(col.str(0) == "7369");
+	CHECK(col.isNull(1));
+	CHECK(col.length(2) == 2);
+	CHECK(std::string(col.data(2)) == "10");
+
+	// A column added later reads as null for rows already in the batch.
+	RowBatch::Column &late = batch.addColumn("LATE");
+	CHECK(late.size() == 3);
+	CHECK(late.isNull(0));
+
+	batch.reset();
+	CHECK(batch.empty());
+	CHECK(batch.columnCount() == 0);
+}
+
+TEST_CASE("Default nextBatch builds the union schema from rows") {
+	std::vector<r2rml::MapSQLRow> rows;
+	rows.push_back(makeRow({{"A", StringSQLValue(std::string("x"))}, {"N", StringSQLValue()}}));
+	rows.push_back(makeRow({{"A", StringSQLValue(std::string("y"))}, {"N", StringSQLValue(5)}}));
+	rows.push_back(makeRow({{"B", StringSQLValue(true)}}));
+	MockSQLResultSet rs(rows);
+
+	RowBatch batch;
+	REQUIRE(rs.nextBatch(batch, 2));
+	REQUIRE(batch.size() == 2);
+	std::size_t n = batch.findColumn("N");
+	REQUIRE(n != RowBatch::npos);
+	CHECK(batch.column(n).isNull(0));
+	CHECK(batch.column(n).str(1) == "5");
+	CHECK(batch.column(n).type == SQLValue::Type::Integer);
+	CHECK(batch.column(n).datatypeIRI == "http://www.w3.org/2001/XMLSchema#integer");
+
+	REQUIRE(rs.nextBatch(batch, 2));
+	REQUIRE(batch.size() == 1);
+	std::size_t b = batch.findColumn("B");
+	REQUIRE(b != RowBatch::npos);
+	CHECK(batch.column(b).str(0) == "true");
+	CHECK(batch.findColumn("A") == RowBatch::npos);
+
+	CHECK_FALSE(rs.nextBatch(batch, 2));
+	CHECK(batch.empty());
+}
+
+TEST_CASE("RowBatchRow exposes a batch row through the SQLRow interface") {
+	RowBatch batch;
+	RowBatch::Column &col = batch.addColumn("COUNT", SQLValue::Type::Integer);
+	col.datatypeIRI = "http://www.w3.org/2001/XMLSchema#integer";
+	col.append("42");
+	batch.setSize(1);
+
+	RowBatchRow row(batch, 0);
+	auto val = row.getValue("COUNT");
+	CHECK(val->asString() == "42");
+	CHECK(val->type() == SQLValue::Type::Integer);
+	CHECK(val->datatypeIRI() == "http://www.w3.org/2001/XMLSchema#integer");
+	CHECK(row.isNull("OTHER"));
+	CHECK(row.clone()->getValue("COUNT")->asString() == "42");
+}
+
+TEST_CASE("RowBatchRow value views borrow the column buffers") {
+	RowBatch batch;
+	RowBatch::Column &col = batch.addColumn("COUNT", SQLValue::Type::Integer);
+	RowBatch::Column &untyped = batch.addColumn("NOTE");
+	col.append("42");
+	untyped.append("hi");
+	col.appendNull();
+	untyped.append("");
+	batch.setSize(2);
+
+	RowBatchRow row(batch, 0);
+	r2rml::SQLValueView count = row.getValueView("COUNT");
+	CHECK(count.data() == col.data(0));
+	CHECK(count.length() == 2);
+	CHECK(count.type() == SQLValue::Type::Integer);
+	CHECK(row.getValueView("NOTE").type() == SQLValue::Type::String);
+	CHECK(row.getValueView("OTHER").isNull());
+
+	row.setRow(1);
+	CHECK(row.getValueView("COUNT").isNull());
+	r2rml::SQLValueView empty = row.getValueView("NOTE");
+	CHECK_FALSE(empty.isNull());
+	CHECK(empty.length() == 0);
+}
+
+TEST_CASE("RowBatchRow reports the column datatype without copying values") {
+	RowBatch batch;
+	RowBatch::Column &col = batch.addColumn("COUNT", SQLValue::Type::Integer);
+	col.datatypeIRI = "http://www.w3.org/2001/XMLSchema#integer";
+	RowBatch::Column &untyped = batch.addColumn("NOTE");
+	col.append("42");
+	untyped.append("hi");
+	col.appendNull();
+	untyped.append("ho");
+	batch.setSize(2);
+
+	RowBatchRow row(batch, 0);
+	const std::string &dt = row.getDatatypeIRI("COUNT");
+	CHECK(&dt == &col.datatypeIRI);
+	CHECK(row.getDatatypeIRI("NOTE").empty());
+	CHECK(row.getDatatypeIRI("OTHER").empty());
+
+	ColumnTermMap count("COUNT");
+	CHECK(&count.datatypeIRIView(row) == &col.datatypeIRI);
+	CHECK(count.computeDatatypeIRI(row) == "http://www.w3.org/2001/XMLSchema#integer");
+
+	row.setRow(1);
+	CHECK(row.getDatatypeIRI("COUNT").empty()); // null
+}
+
+TEST_CASE("Batch term generation matches per-row generation") {
+	RowBatch batch;
+	RowBatch::Column &id = batch.addColumn("ID");
+	RowBatch::Column &name = batch.addColumn("NAME");
+	id.append("1");
+	name.append("a b");
+	id.append("2");
+	name.appendNull();
+	batch.setSize(2);
+
+	SerdEnv *env = serd_env_new(nullptr);
+	TemplateTermMap tt("http://ex.com/{ID}/{NAME}");
+	ColumnTermMap ct("NAME");
+	ct.termType = r2rml::TermType::Literal;
+
+	for (const r2rml::TermMap *tm : std::vector<const r2rml::TermMap *> {&tt, &ct}) {
+		TermBatch terms;
+		tm->generateRDFTerms(batch, *env, terms);
+		REQUIRE(terms.size() == batch.size());
+		for (std::size_t i = 0; i < batch.size(); ++i) {
+			SerdNode expected = tm->generateRDFTerm(RowBatchRow(batch, i), *env);
+			SerdNode actual = terms.node(i);
+			CHECK(actual.type == expected.type);
+			CHECK(nodeString(actual) == nodeString(expected));
+		}
+	}
+
+	TermBatch terms;
+	tt.generateRDFTerms(batch, *env, terms);
+	CHECK(nodeString(terms.node(0)) == "http://ex.com/1/a%20b");
+	CHECK(terms.isNull(1));
+	serd_env_free(env);
+}
+
+TEST_CASE("Batch generateTriples emits the same output as the per-row path") {
+	R2RMLParser parser;
+
+	SECTION("graph maps and classes") {
+		R2RMLMapping mapping = parser.parse(SOURCE_R2RML_DIR "subject_named_graph.ttl");
+		REQUIRE(mapping.isValid());
+		MockSQLConnection conn;
+		conn.addResult("EMP", {makeRow({{"EMPNO", StringSQLValue(std::string("7369"))},
+		                                {"ENAME", StringSQLValue(std::string("SMITH"))},
+		                                {"JOB", StringSQLValue(std::string("CLERK"))}}),
+		                       makeRow({{"EMPNO", StringSQLValue(std::string("7400"))},
+		                                {"ENAME", StringSQLValue()},
+		                                {"JOB", StringSQLValue(std::string("NIGHT GUARD"))}})});
+
+		std::string perRow = exportMapping(mapping, conn, 0);
+		REQUIRE_FALSE(perRow.empty());
+		CHECK(exportMapping(mapping, conn, 1) == perRow);
+		CHECK(exportMapping(mapping, conn, RowBatch::kDefaultCapacity) == perRow);
+	}
+
+	SECTION("referencing object maps and typed columns") {
+		R2RMLMapping mapping = parser.parse(SOURCE_R2RML_DIR "example_emp_dept.ttl");
+		REQUIRE(mapping.isValid());
+		MockSQLConnection conn;
+		conn.addResult("EMP", {makeRow({{"EMPNO", StringSQLValue(7369)},
+		                                {"ENAME", StringSQLValue(std::string("SMITH"))},
+		                                {"MGR", StringSQLValue(7400)},
+		                                {"DEPTNO", StringSQLValue(10)}}),
+		                       makeRow({{"EMPNO", StringSQLValue(7400)},
+		                                {"ENAME", StringSQLValue(std::string("JONES"))},
+		                                {"MGR", StringSQLValue()},
+		                                {"DEPTNO", StringSQLValue(20)}})});
+		conn.addResult("DNAME", {makeRow({{"DEPTNO", StringSQLValue(10)},
+		                                  {"DNAME", StringSQLValue(std::string("APPSERVER"))},
+		                                  {"LOC", StringSQLValue(std::string("NEW YORK"))},
+		                                  {"STAFF", StringSQLValue(1)}})});
+
+		std::string perRow = exportMapping(mapping, conn, 0);
+		REQUIRE(perRow.find("<http://example.com/ns#department>") != std::string::npos);
+		CHECK(exportMapping(mapping, conn, 1) == perRow);
+		CHECK(exportMapping(mapping, conn, RowBatch::kDefaultCapacity) == perRow);
+	}
+}
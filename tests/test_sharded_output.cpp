@@ -0,0 +1,278 @@
+/**
+ * Tests for sharded exports (ShardedOutput / ShardWriter and the sharded
+ * R2RMLMapping::processDatabase() overload): shards read back in manifest
+ * order must hold exactly the unsharded export, split per TriplesMap or at
+ * the statement and byte limits, on one thread or several.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <serd/serd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "r2rml/ExportOptions.h"
+#include "r2rml/ExportReport.h"
+#include "r2rml/R2RMLMapping.h"
+#include "r2rml/SQLConnection.h"
+#include "r2rml/ShardedOutput.h"
+#include "r2rml/StringSQLValue.h"
+#include "r2rml/TriplesMap.h"
+#include "MockSQL.h"
+
+using r2rml::ExportOptions;
+using r2rml::ExportReport;
+using r2rml::R2RMLMapping;
+using r2rml::ShardedOutput;
+using r2rml::ShardWriter;
+using r2rml::SQLConnection;
+using r2rml::StringSQLValue;
+using r2rml::testing::empDeptConnection;
+using r2rml::testing::exportNTriples;
+using r2rml::testing::makeRow;
+using r2rml::testing::parseMapping;
+
+namespace {
+
+std::string readFile(const std::string &path) {
+	std::string data;
+	std::FILE *file = std::fopen(path.c_str(), "rb");
+	REQUIRE(file);
+	char buf[4096];
+	std::size_t got;
+	while ((got = std::fread(buf, 1, sizeof(buf), file)) > 0) {
+		data.append(buf, got);
+	}
+	std::fclose(file);
+	return data;
+}
+
+std::size_t countLines(const std::string &text) {
+	return static_cast<std::size_t>(std::count(text.begin(), text.end(), '\n'));
+}
+
+// A fresh directory for one test's shards, removed with what was written.
+struct TempDirectory {
+	std::string path;
+
+	TempDirectory() {
+		char name[] = "/tmp/sql2rdf-shards-XXXXXX";
+		REQUIRE(mkdtemp(name));
+		path = name;
+	}
+
+	~TempDirectory() {
+		for (int i = 0; i < 100; ++i) {
+			std::string number = std::to_string(i);
+			number.insert(0, 5 - number.size(), '0');
+			for (const char *ext : {".nt", ".nq"}) {
+				std::remove((path + "/shard-" + number + ext).c_str());
+			}
+		}
+		std::remove((path + "/" + ShardedOutput::manifestName).c_str());
+		rmdir(path.c_str());
+	}
+};
+
+// Three triples maps over two tables.
+const char *const MAPPING = R"(
+@prefix rr: <http://www.w3.org/ns/r2rml#>.
+@prefix ex: <http://example.com/ns#>.
+<#Names>
+    rr:logicalTable [ rr:tableName "EMP" ];
+    rr:subjectMap [ rr:template "http://data.example.com/employee/{EMPNO}"; rr:class ex:Employee ];
+    rr:predicateObjectMap [ rr:predicate ex:name; rr:objectMap [ rr:column "ENAME" ] ].
+<#Jobs>
+    rr:logicalTable [ rr:tableName "EMP" ];
+    rr:subjectMap [
+        rr:template "http://data.example.com/employee/{EMPNO}";
+        rr:graphMap [ rr:constant <http://data.example.com/graph/jobs> ]
+    ];
+    rr:predicateObjectMap [ rr:predicate ex:job; rr:objectMap [ rr:column "JOB" ] ].
+<#Depts>
+    rr:logicalTable [ rr:tableName "DEPT" ];
+    rr:subjectMap [ rr:template "http://data.example.com/department/{DEPTNO}" ];
+    rr:predicateObjectMap [ rr:predicate ex:name; rr:objectMap [ rr:column "DNAME" ] ].
+)";
+
+std::unique_ptr<SQLConnection> connection() {
+	std::vector<r2rml::MapSQLRow> emp;
+	for (int i = 0; i < 20; ++i) {
+		emp.push_back(makeRow({{"EMPNO", StringSQLValue(7000 + i)},
+		                       {"ENAME", StringSQLValue("E" + std::to_string(i))},
+		                       {"JOB", StringSQLValue(std::string(i % 2 ? "CLERK" : "ANALYST"))}}));
+	}
+	return empDeptConnection(std::move(emp));
+}
+
+// The shards' contents, in manifest order, checking each against its entry.
+std::string readShards(const ShardedOutput &output) {
+	std::string all;
+	for (const ShardedOutput::Shard &shard : output.shards()) {
+		std::string data = readFile(output.directory() + "/" + shard.file);
+		CHECK(data.size() == shard.bytes);
+		CHECK(countLines(data) == shard.statements);
+		CHECK_FALSE(shard.triplesMaps.empty());
+		all += data;
+	}
+	return all;
+}
+
+} // namespace
+
+TEST_CASE("Sharded export writes one shard per TriplesMap") {
+	R2RMLMapping mapping = parseMapping(MAPPING);
+	TempDirectory dir;
+	ShardedOutput output(dir.path, SERD_NQUADS, true);
+	ExportReport report;
+	mapping.processDatabase(connection, output, ExportOptions(), &report);
+
+	std::vector<ShardedOutput::Shard> shards = output.shards();
+	REQUIRE(shards.size() == 3);
+	CHECK(shards[0].file == "shard-00000.nq");
+	CHECK(shards[2].file == "shard-00002.nq");
+	// in the parser's order of triples maps, which isn't the document's
+	for (std::size_t i = 0; i < shards.size(); ++i) {
+		const std::string &id = mapping.triplesMaps[i]->id;
+		REQUIRE(shards[i].triplesMaps.size() == 1);
+		CHECK(shards[i].triplesMaps[0] == id);
+		std::size_t statements = 2;
+		if (id.find("Names") != std::string::npos) {
+			statements = 40;
+		} else if (id.find("Jobs") != std::string::npos) {
+			statements = 20;
+		}
+		CHECK(shards[i].statements == statements);
+	}
+	CHECK(readShards(output) == exportNTriples(mapping, *connection(), ExportOptions(), nullptr, SERD_NQUADS));
+	CHECK(report.statements == 62);
+
+	std::string manifest = readFile(output.writeManifest());
+	CHECK(manifest.find("\"syntax\": \"N-Quads\"") != std::string::npos);
+	const std::string entry = "{\"file\": \"shard-00001.nq\", \"statements\": " + std::to_string(shards[1].statements) +
+	                          ", \"bytes\": " + std::to_string(shards[1].bytes) + ", \"triplesMaps\": [\"" +
+	                          mapping.triplesMaps[1]->id + "\"]}";
+	CHECK(manifest.find(entry) != std::string::npos);
+	CHECK(manifest.find("\"statements\": 62,") != std::string::npos);
+}
+
+TEST_CASE("Sharded export rolls over at the statement and byte limits") {
+	R2RMLMapping mapping = parseMapping(MAPPING);
+	const std::string expected = exportNTriples(mapping, *connection());
+
+	SECTION("statements") {
+		TempDirectory dir;
+		ShardedOutput output(dir.path, SERD_NTRIPLES, false, 25);
+		mapping.processDatabase(connection, output, ExportOptions());
+		std::vector<ShardedOutput::Shard> shards = output.shards();
+		REQUIRE(shards.size() == 3);
+		CHECK(shards[0].statements == 25);
+		CHECK(shards[1].statements == 25);
+		CHECK(shards[2].statements == 12);
+		CHECK(shards[0].triplesMaps.size() + shards[1].triplesMaps.size() + shards[2].triplesMaps.size() > 3);
+		CHECK(readShards(output) == expected);
+	}
+
+	SECTION("bytes") {
+		TempDirectory dir;
+		ShardedOutput output(dir.path, SERD_NTRIPLES, false, 0, 1000);
+		mapping.processDatabase(connection, output, ExportOptions());
+		std::vector<ShardedOutput::Shard> shards = output.shards();
+		CHECK(shards.size() > 3);
+		for (const ShardedOutput::Shard &shard : shards) {
+			// over the limit by less than one line
+			CHECK(shard.bytes < 1000 + 120);
+		}
+		CHECK(readShards(output) == expected);
+	}
+
+	SECTION("both, per TriplesMap") {
+		TempDirectory dir;
+		ShardedOutput output(dir.path, SERD_NTRIPLES, true, 15, 100000);
+		mapping.processDatabase(connection, output, ExportOptions());
+		std::vector<std::size_t> statements;
+		for (const ShardedOutput::Shard &shard : output.shards()) {
+			statements.push_back(shard.statements);
+			CHECK(shard.triplesMaps.size() == 1);
+		}
+		std::sort(statements.begin(), statements.end());
+		CHECK(statements == std::vector<std::size_t> {2, 5, 10, 15, 15, 15});
+		CHECK(readShards(output) == expected);
+	}
+}
+
+TEST_CASE("Parallel sharded export writes every statement once") {
+	R2RMLMapping mapping = parseMapping(MAPPING);
+	std::string expected = exportNTriples(mapping, *connection());
+	std::vector<std::string> expectedLines;
+	for (std::size_t start = 0; start < expected.size();) {
+		std::size_t end = expected.find('\n', start) + 1;
+		expectedLines.push_back(expected.substr(start, end - start));
+		start = end;
+	}
+	std::sort(expectedLines.begin(), expectedLines.end());
+
+	for (bool perTriplesMap : {true, false}) {
+		TempDirectory dir;
+		ShardedOutput output(dir.path, SERD_NTRIPLES, perTriplesMap, 30);
+		ExportOptions options;
+		options.threads = 3;
+		mapping.processDatabase(connection, output, options);
+
+		std::vector<std::string> lines;
+		std::string all = readShards(output);
+		for (std::size_t start = 0; start < all.size();) {
+			std::size_t end = all.find('\n', start) + 1;
+			lines.push_back(all.substr(start, end - start));
+			start = end;
+		}
+		std::sort(lines.begin(), lines.end());
+		CHECK(lines == expectedLines);
+		if (perTriplesMap) {
+			CHECK(output.shards().size() == 4);
+		}
+	}
+}
+
+TEST_CASE("Sharded export rejects what it can't shard") {
+	TempDirectory dir;
+	CHECK_THROWS_AS(ShardedOutput(dir.path, SERD_TURTLE, true), std::invalid_argument);
+	CHECK_THROWS_AS(ShardedOutput(dir.path + "/missing/parent", SERD_NTRIPLES, true), std::runtime_error);
+
+	R2RMLMapping mapping = parseMapping(MAPPING);
+	ShardedOutput output(dir.path, SERD_NTRIPLES, true);
+	ExportOptions options;
+	options.dedup = true;
+	CHECK_THROWS_AS(mapping.processDatabase(connection, output, options), std::invalid_argument);
+	CHECK(output.shards().empty());
+
+	ExportOptions failing;
+	CHECK_THROWS_AS(mapping.processDatabase([]() { return std::unique_ptr<SQLConnection>(); }, output, failing),
+	                std::runtime_error);
+}
+
+TEST_CASE("ShardWriter only opens a shard for a statement") {
+	TempDirectory dir;
+	ShardedOutput output(dir.path, SERD_NTRIPLES, true);
+	{
+		ShardWriter writer(output, nullptr, nullptr);
+		writer.startTriplesMap("a");
+		writer.startTriplesMap("b");
+		SerdNode s = serd_node_from_string(SERD_URI, reinterpret_cast<const uint8_t *>("http://example.com/s"));
+		SerdNode o = serd_node_from_string(SERD_LITERAL, reinterpret_cast<const uint8_t *>("o"));
+		writer.write(nullptr, s, s, o, nullptr, nullptr);
+		writer.startTriplesMap("c");
+		writer.finish();
+	}
+	std::vector<ShardedOutput::Shard> shards = output.shards();
+	REQUIRE(shards.size() == 1);
+	CHECK(shards[0].triplesMaps == std::vector<std::string> {"b"});
+	CHECK(readFile(dir.path + "/shard-00000.nt") == "<http://example.com/s> <http://example.com/s> \"o\" .\n");
+}